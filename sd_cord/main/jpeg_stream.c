@@ -0,0 +1,270 @@
+/*
+ * JPEG流式显示实现
+ * 从SD卡分块读取JPEG, 用ROM中的TJpgDec按MCU行解码到条带DMA缓冲区并送给ST7789,
+ * 解码下一MCU行时上一MCU行正在DMA传输, 不需要整图缓冲区
+ */
+
+#include "jpeg_stream.h"
+#include "st7789.h"
+#include "rgb565.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "rom/tjpgd.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "JPEG_STREAM";
+
+/**
+ * @brief 解码上下文, 通过JDEC.device传给回调
+ */
+typedef struct {
+    int fd;                                     // 文件描述符
+    uint8_t *read_buf;                          // SD读缓冲区
+    size_t read_len;                            // 读缓冲区中的有效字节数
+    size_t read_pos;                            // 读缓冲区中的读取位置
+    uint16_t *stripe_bufs[JPEG_STREAM_BUF_NUM]; // MCU行条带缓冲区
+    int cur;                                    // 当前写入的条带缓冲区
+    int stripe_top;                             // 当前条带在图片中的起始行
+    int stripe_lines;                           // 当前条带行数
+    bool stripe_dirty;                          // 当前条带有未提交的数据
+    int x0;                                     // 图片在屏幕上的左上角
+    int y0;
+    size_t free_before;                         // 开始前的内部RAM剩余
+    size_t min_free;                            // 解码期间内部RAM最低剩余
+    esp_err_t err;                              // 回调中发生的错误
+    jpeg_stream_stats_t *stats;
+} jpeg_stream_ctx_t;
+
+/**
+ * @brief 记录内部RAM最低剩余
+ */
+static void jpeg_stream_sample_heap(jpeg_stream_ctx_t *ctx)
+{
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (free_now < ctx->min_free) {
+        ctx->min_free = free_now;
+    }
+}
+
+/**
+ * @brief TJpgDec输入回调: 从读缓冲区取数据, 读完再从SD卡整块读取; buf为NULL时跳过数据
+ */
+static uint32_t jpeg_stream_input(JDEC *jd, uint8_t *buf, uint32_t len)
+{
+    jpeg_stream_ctx_t *ctx = jd->device;
+    uint32_t done = 0;
+
+    while (done < len) {
+        if (ctx->read_pos == ctx->read_len) {
+            ssize_t n = read(ctx->fd, ctx->read_buf, JPEG_STREAM_READ_BUF_SIZE);
+            if (n <= 0) {
+                break;
+            }
+            ctx->read_len = n;
+            ctx->read_pos = 0;
+            ctx->stats->read_calls++;
+            ctx->stats->bytes_read += n;
+        }
+        size_t chunk = ctx->read_len - ctx->read_pos;
+        if (chunk > len - done) {
+            chunk = len - done;
+        }
+        if (buf != NULL) {
+            memcpy(buf + done, ctx->read_buf + ctx->read_pos, chunk);
+        }
+        ctx->read_pos += chunk;
+        done += chunk;
+    }
+    return done;
+}
+
+/**
+ * @brief 提交当前条带, 切换到另一块缓冲区并等待它上一次的传输完成
+ */
+static esp_err_t jpeg_stream_flush_stripe(jpeg_stream_ctx_t *ctx)
+{
+    jpeg_stream_stats_t *stats = ctx->stats;
+    int y = ctx->y0 + ctx->stripe_top;
+
+    ctx->stripe_dirty = false;
+    esp_err_t ret = st7789_draw_bitmap(ctx->x0, y, ctx->x0 + stats->out_width, y + ctx->stripe_lines,
+                                       ctx->stripe_bufs[ctx->cur]);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    stats->stripes++;
+    ctx->cur = (ctx->cur + 1) % JPEG_STREAM_BUF_NUM;
+
+    int64_t t0 = esp_timer_get_time();
+    ret = st7789_wait_flush_pending(JPEG_STREAM_BUF_NUM - 1, JPEG_STREAM_TIMEOUT_MS);
+    stats->wait_us += (uint32_t)(esp_timer_get_time() - t0);
+    jpeg_stream_sample_heap(ctx);
+    return ret;
+}
+
+/**
+ * @brief TJpgDec输出回调: RGB888块转换为RGB565写入条带, MCU行结束时提交
+ */
+static uint32_t jpeg_stream_output(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    jpeg_stream_ctx_t *ctx = jd->device;
+    int out_w = ctx->stats->out_width;
+
+    if (rect->right >= out_w || rect->bottom - rect->top >= JPEG_STREAM_MCU_MAX_LINES) {
+        ctx->err = ESP_ERR_INVALID_SIZE;
+        return 0;
+    }
+
+    // 新的MCU行开始时, 上一行如果还没提交 (缩放后最后一块宽度为0的情况) 先提交
+    if (ctx->stripe_dirty && rect->top != ctx->stripe_top) {
+        ctx->err = jpeg_stream_flush_stripe(ctx);
+        if (ctx->err != ESP_OK) {
+            return 0;
+        }
+    }
+    ctx->stripe_top = rect->top;
+    ctx->stripe_lines = rect->bottom - rect->top + 1;
+
+    int w = rect->right - rect->left + 1;
+    const uint8_t *src = bitmap;
+    uint16_t *dst = ctx->stripe_bufs[ctx->cur] + rect->left;
+    for (int y = 0; y < ctx->stripe_lines; y++) {
+        rgb888_to_rgb565(dst, src, w);
+        src += w * 3;
+        dst += out_w;
+    }
+    ctx->stripe_dirty = true;
+
+    // MCU行的最后一块
+    if (rect->right == out_w - 1) {
+        ctx->err = jpeg_stream_flush_stripe(ctx);
+        if (ctx->err != ESP_OK) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 图片没有铺满屏幕时先把整屏刷成黑色
+ */
+static esp_err_t jpeg_stream_clear(uint16_t *buf)
+{
+    rgb565_fill(buf, 0x0000, LCD_H_RES * JPEG_STREAM_MCU_MAX_LINES);
+    for (int y = 0; y < LCD_V_RES; y += JPEG_STREAM_MCU_MAX_LINES) {
+        int lines = (y + JPEG_STREAM_MCU_MAX_LINES > LCD_V_RES) ? (LCD_V_RES - y) : JPEG_STREAM_MCU_MAX_LINES;
+        esp_err_t ret = st7789_draw_bitmap(0, y, LCD_H_RES, y + lines, buf);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return st7789_wait_flush_done(JPEG_STREAM_TIMEOUT_MS);
+}
+
+/**
+ * @brief 从文件解码JPEG并居中显示
+ */
+esp_err_t jpeg_stream_show(const char *path, jpeg_stream_stats_t *stats)
+{
+    if (path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpeg_stream_stats_t local_stats;
+    jpeg_stream_ctx_t ctx = {
+        .fd = -1,
+        .stats = (stats != NULL) ? stats : &local_stats,
+    };
+    *ctx.stats = (jpeg_stream_stats_t){0};
+    ctx.free_before = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    ctx.min_free = ctx.free_before;
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+    void *work = NULL;
+
+    ctx.fd = open(path, O_RDONLY);
+    if (ctx.fd < 0) {
+        ESP_LOGE(TAG, "打开文件失败: %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 读缓冲区和工作区不需要DMA, 条带缓冲区必须在内部DMA内存中
+    ctx.read_buf = heap_caps_malloc(JPEG_STREAM_READ_BUF_SIZE, MALLOC_CAP_INTERNAL);
+    work = heap_caps_malloc(JPEG_STREAM_WORK_SIZE, MALLOC_CAP_INTERNAL);
+    bool alloc_ok = (ctx.read_buf != NULL && work != NULL);
+    for (int i = 0; i < JPEG_STREAM_BUF_NUM; i++) {
+        ctx.stripe_bufs[i] = heap_caps_malloc(LCD_H_RES * JPEG_STREAM_MCU_MAX_LINES * sizeof(uint16_t),
+                                              MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        alloc_ok = alloc_ok && (ctx.stripe_bufs[i] != NULL);
+    }
+    if (!alloc_ok) {
+        ESP_LOGE(TAG, "分配解码缓冲区失败");
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+    jpeg_stream_sample_heap(&ctx);
+
+    JDEC jd;
+    JRESULT res = jd_prepare(&jd, jpeg_stream_input, work, JPEG_STREAM_WORK_SIZE, &ctx);
+    if (res != JDR_OK) {
+        ESP_LOGE(TAG, "解析JPEG头失败 (%d): %s", res, path);
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    // 选择能放进屏幕的最小缩放
+    uint8_t scale = 0;
+    while (scale < 3 && ((jd.width >> scale) > LCD_H_RES || (jd.height >> scale) > LCD_V_RES)) {
+        scale++;
+    }
+    ctx.stats->width = jd.width;
+    ctx.stats->height = jd.height;
+    ctx.stats->scale = scale;
+    ctx.stats->out_width = jd.width >> scale;
+    ctx.stats->out_height = jd.height >> scale;
+    if (ctx.stats->out_width > LCD_H_RES || ctx.stats->out_height > LCD_V_RES ||
+        ctx.stats->out_width == 0 || ctx.stats->out_height == 0) {
+        ESP_LOGE(TAG, "图片尺寸不支持: %ux%u", jd.width, jd.height);
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+    ctx.x0 = (LCD_H_RES - ctx.stats->out_width) / 2;
+    ctx.y0 = (LCD_V_RES - ctx.stats->out_height) / 2;
+
+    if (ctx.stats->out_width < LCD_H_RES || ctx.stats->out_height < LCD_V_RES) {
+        ret = jpeg_stream_clear(ctx.stripe_bufs[0]);
+        if (ret != ESP_OK) {
+            goto cleanup;
+        }
+    }
+
+    res = jd_decomp(&jd, jpeg_stream_output, scale);
+    if (res == JDR_OK && ctx.stripe_dirty) {
+        ctx.err = jpeg_stream_flush_stripe(&ctx);
+    }
+    if (ctx.err != ESP_OK) {
+        ESP_LOGE(TAG, "显示失败: %s", esp_err_to_name(ctx.err));
+        ret = ctx.err;
+    } else if (res != JDR_OK) {
+        ESP_LOGE(TAG, "JPEG解码失败 (%d): %s", res, path);
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+
+cleanup:
+    // 缓冲区可能仍在DMA传输中
+    if (st7789_wait_flush_done(JPEG_STREAM_TIMEOUT_MS) == ESP_OK) {
+        for (int i = 0; i < JPEG_STREAM_BUF_NUM; i++) {
+            heap_caps_free(ctx.stripe_bufs[i]);
+        }
+    }
+    ctx.stats->total_us = (uint32_t)(esp_timer_get_time() - start);
+    ctx.stats->peak_ram = ctx.free_before - ctx.min_free;
+    heap_caps_free(work);
+    heap_caps_free(ctx.read_buf);
+    close(ctx.fd);
+    return ret;
+}
@@ -0,0 +1,56 @@
+/*
+ * JPEG流式显示头文件
+ * 从SD卡分块读取JPEG, 用ROM中的TJpgDec按MCU行解码到条带DMA缓冲区并送给ST7789,
+ * 解码下一MCU行时上一MCU行正在DMA传输, 不需要整图缓冲区
+ */
+
+#ifndef JPEG_STREAM_H
+#define JPEG_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 流式解码配置
+#define JPEG_STREAM_READ_BUF_SIZE   4096    // SD读缓冲区 (与FAT扇区大小一致)
+#define JPEG_STREAM_WORK_SIZE       3100    // TJpgDec工作区大小
+#define JPEG_STREAM_MCU_MAX_LINES   16      // MCU最大高度 (4:2:0采样时为16行)
+#define JPEG_STREAM_BUF_NUM         2       // 条带缓冲区数量 (乒乓)
+#define JPEG_STREAM_TIMEOUT_MS      1000    // 等待DMA超时时间
+
+/**
+ * @brief 单张图片的解码统计
+ */
+typedef struct {
+    uint16_t width;                 // 原始宽度
+    uint16_t height;                // 原始高度
+    uint16_t out_width;             // 缩放后宽度
+    uint16_t out_height;            // 缩放后高度
+    uint8_t scale;                  // 缩放比例 1/(2^scale)
+    uint32_t stripes;               // 提交的MCU行条带数
+    uint32_t read_calls;            // SD读取次数
+    uint32_t bytes_read;            // 读取字节数
+    uint32_t total_us;              // 总耗时 (打开文件到最后一个条带传输完成)
+    uint32_t wait_us;               // 等待DMA释放条带缓冲区的时间
+    size_t peak_ram;                // 解码期间内部RAM峰值占用 (含缓冲区和文件系统开销)
+} jpeg_stream_stats_t;
+
+/**
+ * @brief 从文件解码JPEG并居中显示, 超出屏幕时按1/2、1/4、1/8缩小
+ * @note 需要先初始化ST7789; 图片小于屏幕时周围填充黑色
+ * @param path 文件路径
+ * @param stats 返回的统计数据, 可以为NULL
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 文件不存在, ESP_ERR_NOT_SUPPORTED 图片格式或尺寸不支持,
+ *         ESP_ERR_NO_MEM 内存不足, 其他值表示错误
+ */
+esp_err_t jpeg_stream_show(const char *path, jpeg_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JPEG_STREAM_H
@@ -1,10 +1,99 @@
 #include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <inttypes.h>
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "i2c_master.h"
+#include "pca9557.h"
+#include "st7789.h"
+#include "sd_card.h"
+#include "jpeg_stream.h"
 
+static const char *TAG = "MAIN";
+
+#define SLIDE_INTERVAL_MS           3000    // 每张图片显示时间
+#define SLIDE_PATH_MAX              300     // 文件路径最大长度
+
+/**
+ * @brief 判断文件名是否为JPEG
+ */
+static bool is_jpeg_file(const char *name)
+{
+    const char *ext = strrchr(name, '.');
+    return ext != NULL && (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0);
+}
+
+/**
+ * @brief 依次显示SD卡根目录下的所有JPEG图片
+ * @return 显示的图片数
+ */
+static int show_all_jpegs(void)
+{
+    DIR *dir = opendir(SD_CARD_MOUNT_POINT);
+    if (dir == NULL) {
+        ESP_LOGE(TAG, "打开目录失败: %s", SD_CARD_MOUNT_POINT);
+        return 0;
+    }
+
+    int shown = 0;
+    struct dirent *entry;
+    char path[SLIDE_PATH_MAX];
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_type != DT_REG || !is_jpeg_file(entry->d_name)) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", SD_CARD_MOUNT_POINT, entry->d_name);
+
+        jpeg_stream_stats_t stats;
+        esp_err_t ret = jpeg_stream_show(path, &stats);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "%s 显示失败: %s", entry->d_name, esp_err_to_name(ret));
+            continue;
+        }
+        ESP_LOGI(TAG, "%s: %ux%u -> %ux%u (1/%d), %" PRIu32 ".%03" PRIu32 "ms, 等待DMA %" PRIu32 ".%03" PRIu32 "ms, 峰值RAM %zu字节",
+                 entry->d_name, stats.width, stats.height, stats.out_width, stats.out_height, 1 << stats.scale,
+                 stats.total_us / 1000, stats.total_us % 1000, stats.wait_us / 1000, stats.wait_us % 1000,
+                 stats.peak_ram);
+        ESP_LOGI(TAG, "    SD读取%" PRIu32 "次共%" PRIu32 "字节, %" PRIu32 "个MCU行条带",
+                 stats.read_calls, stats.bytes_read, stats.stripes);
+        shown++;
+        vTaskDelay(pdMS_TO_TICKS(SLIDE_INTERVAL_MS));
+    }
+    closedir(dir);
+    return shown;
+}
 
 void app_main(void){
+    // 初始化I2C主机
+    esp_err_t ret = i2c_master_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2C主机初始化失败: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    // 拉低LCD片选, 关闭功放, 摄像头掉电
+    pca9557_init();
+    pca9557_update_outputs(PCA9557_LCD_CS | PCA9557_PA_EN | PCA9557_DVP_PWDN, PCA9557_DVP_PWDN);
+    pca9557_set_io_direction(PCA9557_LCD_CS | PCA9557_PA_EN | PCA9557_DVP_PWDN, PCA9557_IO_OUTPUT);
+
+    ret = st7789_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "LCD初始化失败: %s", esp_err_to_name(ret));
+        return;
+    }
 
+    ret = sd_card_mount();
+    if (ret != ESP_OK) {
+        return;
+    }
 
+    while (1) {
+        if (show_all_jpegs() == 0) {
+            ESP_LOGW(TAG, "SD卡根目录下没有可显示的JPEG图片");
+            vTaskDelay(pdMS_TO_TICKS(SLIDE_INTERVAL_MS));
+        }
+    }
 }
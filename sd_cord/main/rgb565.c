@@ -0,0 +1,572 @@
+/*
+ * RGB565像素内核实现
+ * 填充、复制、混合、颜色转换、字节交换和2:1缩小;
+ * 填充、复制、字节交换和缩小在ESP32-S3上使用PIE 128位向量指令, 混合和颜色转换是标量实现;
+ * 不依赖驱动, host_test目录下用主机编译器测试标量路径
+ */
+
+#include "rgb565.h"
+#include <string.h>
+#include <inttypes.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "esp_cpu.h"
+
+static const char *TAG = "RGB565";
+
+#if RGB565_USE_PIE
+// rgb565_pie.S: 地址必须16字节对齐, 长度以块为单位
+extern void rgb565_fill_pie(uint16_t *dst, const uint16_t *color, size_t blocks16);
+extern void rgb565_copy_pie(uint16_t *dst, const uint16_t *src, size_t blocks16);
+extern void rgb565_swap_pie(uint16_t *dst, const uint16_t *src, size_t blocks32);
+extern void rgb565_downsample_2x_pie(uint16_t *dst, const uint16_t *src, size_t blocks16);
+
+#define RGB565_PIE_ALIGN            16
+#define RGB565_PIE_MISALIGN(p)      ((uintptr_t)(p) & (RGB565_PIE_ALIGN - 1))
+#endif
+
+// 把RGB565展开到32位, 为每个分量留出乘法进位空间: 0000 0GGG GGG0 0000 RRRR R000 000B BBBB
+#define RGB565_SPREAD_MASK          0x07E0F81FUL
+
+static inline uint16_t rgb565_bswap(uint16_t v)
+{
+    return (uint16_t)((v >> 8) | (v << 8));
+}
+
+/**
+ * @brief 混合一个像素 (CPU字节序), alpha5取值0~32
+ */
+static inline uint16_t rgb565_blend_pixel(uint16_t fg, uint16_t bg, uint32_t alpha5)
+{
+    uint32_t f = (fg | ((uint32_t)fg << 16)) & RGB565_SPREAD_MASK;
+    uint32_t b = (bg | ((uint32_t)bg << 16)) & RGB565_SPREAD_MASK;
+    uint32_t r = ((((f - b) * alpha5) >> 5) + b) & RGB565_SPREAD_MASK;
+    return (uint16_t)(r | (r >> 16));
+}
+
+/**
+ * @brief 8位透明度量化到0~32
+ */
+static inline uint32_t rgb565_alpha5(uint8_t alpha)
+{
+    return ((uint32_t)alpha + 4) >> 3;
+}
+
+// ==================== 标量参考实现 ====================
+
+void rgb565_fill_ref(uint16_t *dst, uint16_t color, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = color;
+    }
+}
+
+void rgb565_copy_ref(uint16_t *dst, const uint16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = src[i];
+    }
+}
+
+void rgb565_blit_ref(uint16_t *dst, int dst_stride, const uint16_t *src, int src_stride, int w, int h)
+{
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            dst[y * dst_stride + x] = src[y * src_stride + x];
+        }
+    }
+}
+
+void rgb565_blend_ref(uint16_t *dst, const uint16_t *src, uint8_t alpha, size_t n)
+{
+    uint32_t a5 = rgb565_alpha5(alpha);
+    for (size_t i = 0; i < n; i++) {
+        uint16_t px = rgb565_blend_pixel(rgb565_bswap(src[i]), rgb565_bswap(dst[i]), a5);
+        dst[i] = rgb565_bswap(px);
+    }
+}
+
+void rgb565_blend_alpha8_ref(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint16_t px = rgb565_blend_pixel(rgb565_bswap(src[i]), rgb565_bswap(dst[i]), rgb565_alpha5(alpha[i]));
+        dst[i] = rgb565_bswap(px);
+    }
+}
+
+void rgb888_to_rgb565_ref(uint16_t *dst, const uint8_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = RGB565(src[3 * i], src[3 * i + 1], src[3 * i + 2]);
+    }
+}
+
+void rgb565_swap_bytes_ref(uint16_t *dst, const uint16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = rgb565_bswap(src[i]);
+    }
+}
+
+void rgb565_downsample_2x_ref(uint16_t *dst, const uint16_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = src[2 * i];
+    }
+}
+
+// ==================== 加速实现 ====================
+
+/**
+ * @brief 用同一颜色填充n个像素
+ */
+void rgb565_fill(uint16_t *dst, uint16_t color, size_t n)
+{
+#if RGB565_USE_PIE
+    // 标量写到16字节对齐, 中间整块用向量存储
+    while (n > 0 && RGB565_PIE_MISALIGN(dst)) {
+        *dst++ = color;
+        n--;
+    }
+    size_t blocks = n / 8;
+    if (blocks > 0) {
+        rgb565_fill_pie(dst, &color, blocks);
+        dst += blocks * 8;
+        n -= blocks * 8;
+    }
+    while (n--) {
+        *dst++ = color;
+    }
+#else
+    // 一次写两个像素
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        *dst++ = color;
+        n--;
+    }
+    uint32_t *dst32 = (uint32_t *)dst;
+    uint32_t color2 = color | ((uint32_t)color << 16);
+    for (size_t i = 0; i < n / 2; i++) {
+        dst32[i] = color2;
+    }
+    if (n & 1) {
+        dst[n - 1] = color;
+    }
+#endif
+}
+
+/**
+ * @brief 复制n个像素
+ */
+void rgb565_copy(uint16_t *dst, const uint16_t *src, size_t n)
+{
+#if RGB565_USE_PIE
+    // 源和目标对齐方式相同时才能走向量路径
+    if (RGB565_PIE_MISALIGN(dst) == RGB565_PIE_MISALIGN(src)) {
+        while (n > 0 && RGB565_PIE_MISALIGN(dst)) {
+            *dst++ = *src++;
+            n--;
+        }
+        size_t blocks = n / 8;
+        if (blocks > 0) {
+            rgb565_copy_pie(dst, src, blocks);
+            dst += blocks * 8;
+            src += blocks * 8;
+            n -= blocks * 8;
+        }
+    }
+#endif
+    memcpy(dst, src, n * sizeof(uint16_t));
+}
+
+/**
+ * @brief 矩形块复制
+ */
+void rgb565_blit(uint16_t *dst, int dst_stride, const uint16_t *src, int src_stride, int w, int h)
+{
+    // 行连续时合并成一次复制
+    if (dst_stride == w && src_stride == w) {
+        rgb565_copy(dst, src, (size_t)w * h);
+        return;
+    }
+    for (int y = 0; y < h; y++) {
+        rgb565_copy(dst, src, w);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
+
+/**
+ * @brief 固定透明度混合
+ * @note 没有向量实现: 逐分量乘法需要16位以上的中间结果, 这里只处理端点
+ */
+void rgb565_blend(uint16_t *dst, const uint16_t *src, uint8_t alpha, size_t n)
+{
+    // 端点直接退化为复制或不变
+    if (alpha == 0) {
+        return;
+    }
+    if (rgb565_alpha5(alpha) == 32) {
+        rgb565_copy(dst, src, n);
+        return;
+    }
+    rgb565_blend_ref(dst, src, alpha, n);
+}
+
+/**
+ * @brief 逐像素透明度混合
+ */
+void rgb565_blend_alpha8(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint32_t a5 = rgb565_alpha5(alpha[i]);
+        // 图标和文字大部分像素是全透明或全不透明
+        if (a5 == 0) {
+            continue;
+        }
+        if (a5 == 32) {
+            dst[i] = src[i];
+            continue;
+        }
+        dst[i] = rgb565_bswap(rgb565_blend_pixel(rgb565_bswap(src[i]), rgb565_bswap(dst[i]), a5));
+    }
+}
+
+/**
+ * @brief RGB888转RGB565
+ * @note 没有向量实现: 3字节一组的源数据在128位寄存器里不能按像素对齐, 这里一次写两个像素
+ */
+void rgb888_to_rgb565(uint16_t *dst, const uint8_t *src, size_t n)
+{
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        *dst++ = RGB565(src[0], src[1], src[2]);
+        src += 3;
+        n--;
+    }
+    // 小端: 低16位是前一个像素
+    uint32_t *dst32 = (uint32_t *)dst;
+    for (size_t i = 0; i < n / 2; i++) {
+        const uint8_t *p = src + 6 * i;
+        dst32[i] = RGB565(p[0], p[1], p[2]) | ((uint32_t)RGB565(p[3], p[4], p[5]) << 16);
+    }
+    if (n & 1) {
+        const uint8_t *p = src + 3 * (n - 1);
+        dst[n - 1] = RGB565(p[0], p[1], p[2]);
+    }
+}
+
+/**
+ * @brief 交换每个像素的高低字节
+ */
+void rgb565_swap_bytes(uint16_t *dst, const uint16_t *src, size_t n)
+{
+#if RGB565_USE_PIE
+    if (RGB565_PIE_MISALIGN(dst) == RGB565_PIE_MISALIGN(src)) {
+        while (n > 0 && RGB565_PIE_MISALIGN(dst)) {
+            *dst++ = rgb565_bswap(*src++);
+            n--;
+        }
+        size_t blocks = n / 16;
+        if (blocks > 0) {
+            rgb565_swap_pie(dst, src, blocks);
+            dst += blocks * 16;
+            src += blocks * 16;
+            n -= blocks * 16;
+        }
+    }
+#else
+    // 一次交换两个像素
+    if (((uintptr_t)dst & 2) == 0 && ((uintptr_t)src & 2) == 0) {
+        uint32_t *dst32 = (uint32_t *)dst;
+        const uint32_t *src32 = (const uint32_t *)src;
+        for (size_t i = 0; i < n / 2; i++) {
+            uint32_t v = src32[i];
+            dst32[i] = ((v >> 8) & 0x00FF00FFUL) | ((v << 8) & 0xFF00FF00UL);
+        }
+        dst += n & ~(size_t)1;
+        src += n & ~(size_t)1;
+        n &= 1;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = rgb565_bswap(src[i]);
+    }
+}
+
+/**
+ * @brief 2:1水平抽点缩小
+ */
+void rgb565_downsample_2x(uint16_t *dst, const uint16_t *src, size_t n)
+{
+#if RGB565_USE_PIE
+    while (n > 0 && RGB565_PIE_MISALIGN(dst)) {
+        *dst++ = *src;
+        src += 2;
+        n--;
+    }
+    // 每块读32字节写16字节, 原地处理时写指针不会超过读指针
+    size_t blocks = n / 8;
+    if (blocks > 0 && RGB565_PIE_MISALIGN(src) == 0) {
+        rgb565_downsample_2x_pie(dst, src, blocks);
+        dst += blocks * 8;
+        src += blocks * 16;
+        n -= blocks * 8;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = src[2 * i];
+    }
+}
+
+// ==================== 自检与基准测试 ====================
+
+/**
+ * @brief 一次内核调用的参数, 各内核只用自己需要的字段
+ */
+typedef struct {
+    uint16_t *dst;
+    const uint16_t *src;
+    const uint8_t *bytes;           // RGB888源数据或逐像素透明度
+    uint16_t color;
+    uint8_t alpha;
+    size_t n;                       // 输出像素数
+} rgb565_kernel_args_t;
+
+/**
+ * @brief 内核表项: 同一组参数分别调用参考实现和加速实现
+ */
+typedef struct {
+    const char *name;
+    int src_scale;                  // 每个输出像素读取的源像素数
+    void (*run)(const rgb565_kernel_args_t *a, int fast);
+} rgb565_kernel_t;
+
+static void rgb565_run_fill(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb565_fill(a->dst, a->color, a->n) : rgb565_fill_ref(a->dst, a->color, a->n);
+}
+
+static void rgb565_run_copy(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb565_copy(a->dst, a->src, a->n) : rgb565_copy_ref(a->dst, a->src, a->n);
+}
+
+// 4行, 行间距和宽度不同, 走逐行复制
+static void rgb565_run_blit(const rgb565_kernel_args_t *a, int fast)
+{
+    int w = (int)(a->n / 4);
+    fast ? rgb565_blit(a->dst, w + 2, a->src, w + 1, w, 4) : rgb565_blit_ref(a->dst, w + 2, a->src, w + 1, w, 4);
+}
+
+static void rgb565_run_blend(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb565_blend(a->dst, a->src, a->alpha, a->n) : rgb565_blend_ref(a->dst, a->src, a->alpha, a->n);
+}
+
+static void rgb565_run_blend_alpha8(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb565_blend_alpha8(a->dst, a->src, a->bytes, a->n) : rgb565_blend_alpha8_ref(a->dst, a->src, a->bytes, a->n);
+}
+
+static void rgb565_run_rgb888(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb888_to_rgb565(a->dst, a->bytes, a->n) : rgb888_to_rgb565_ref(a->dst, a->bytes, a->n);
+}
+
+static void rgb565_run_swap_bytes(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb565_swap_bytes(a->dst, a->src, a->n) : rgb565_swap_bytes_ref(a->dst, a->src, a->n);
+}
+
+static void rgb565_run_downsample_2x(const rgb565_kernel_args_t *a, int fast)
+{
+    fast ? rgb565_downsample_2x(a->dst, a->src, a->n) : rgb565_downsample_2x_ref(a->dst, a->src, a->n);
+}
+
+// 自检比较全部内核; 标量内核的快速版本也和参考实现逐位比较
+static const rgb565_kernel_t rgb565_kernels[] = {
+    {"fill", 1, rgb565_run_fill},
+    {"copy", 1, rgb565_run_copy},
+    {"blit", 1, rgb565_run_blit},
+    {"blend", 1, rgb565_run_blend},
+    {"blend_alpha8", 1, rgb565_run_blend_alpha8},
+    {"rgb888_to_rgb565", 1, rgb565_run_rgb888},
+    {"swap_bytes", 1, rgb565_run_swap_bytes},
+    {"downsample_2x", 2, rgb565_run_downsample_2x},
+};
+#define RGB565_KERNEL_NUM           (sizeof(rgb565_kernels) / sizeof(rgb565_kernels[0]))
+
+// 基准测试只包括有PIE实现的内核
+static const char *rgb565_bench_names[] = {"fill", "copy", "swap_bytes", "downsample_2x"};
+#define RGB565_BENCH_KERNEL_NUM     (sizeof(rgb565_bench_names) / sizeof(rgb565_bench_names[0]))
+
+static const rgb565_kernel_t *rgb565_find_kernel(const char *name)
+{
+    for (size_t i = 0; i < RGB565_KERNEL_NUM; i++) {
+        if (strcmp(rgb565_kernels[i].name, name) == 0) {
+            return &rgb565_kernels[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t rgb565_bench_ticks(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+/**
+ * @brief 确定性伪随机数 (xorshift32), 每次测试数据一致
+ */
+static uint32_t rgb565_test_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void rgb565_test_fill_random(uint8_t *buf, size_t len, uint32_t *state)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)rgb565_test_rand(state);
+    }
+}
+
+/**
+ * @brief 自检
+ */
+esp_err_t rgb565_self_test(void)
+{
+    // 多留16像素用于制造不同的对齐偏移
+    size_t buf_pixels = RGB565_TEST_PIXELS + 16;
+    uint16_t *src = heap_caps_malloc(buf_pixels * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    uint16_t *out_ref = heap_caps_malloc(buf_pixels * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    uint16_t *out_fast = heap_caps_malloc(buf_pixels * sizeof(uint16_t), MALLOC_CAP_DEFAULT);
+    uint8_t *bytes = heap_caps_malloc(buf_pixels * 3, MALLOC_CAP_DEFAULT);
+    if (src == NULL || out_ref == NULL || out_fast == NULL || bytes == NULL) {
+        heap_caps_free(src);
+        heap_caps_free(out_ref);
+        heap_caps_free(out_fast);
+        heap_caps_free(bytes);
+        return ESP_ERR_NO_MEM;
+    }
+
+    static const size_t lengths[] = {0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, RGB565_TEST_PIXELS};
+    static const size_t offsets[] = {0, 1, 3, 8};
+    uint32_t seed = 0x12345678;
+    int failures = 0;
+
+    for (size_t ki = 0; ki < RGB565_KERNEL_NUM; ki++) {
+        const rgb565_kernel_t *kernel = &rgb565_kernels[ki];
+        for (size_t li = 0; li < sizeof(lengths) / sizeof(lengths[0]); li++) {
+            for (size_t di = 0; di < sizeof(offsets) / sizeof(offsets[0]); di++) {
+                for (size_t si = 0; si < sizeof(offsets) / sizeof(offsets[0]); si++) {
+                    size_t n = lengths[li];
+                    size_t d_off = offsets[di];
+                    size_t s_off = offsets[si];
+                    // 缩小内核读取2n个源像素
+                    if (s_off + kernel->src_scale * n > buf_pixels) {
+                        n = (buf_pixels - s_off) / kernel->src_scale;
+                    }
+
+                    rgb565_test_fill_random((uint8_t *)src, buf_pixels * sizeof(uint16_t), &seed);
+                    rgb565_test_fill_random((uint8_t *)out_ref, buf_pixels * sizeof(uint16_t), &seed);
+                    rgb565_test_fill_random(bytes, buf_pixels * 3, &seed);
+                    memcpy(out_fast, out_ref, buf_pixels * sizeof(uint16_t));
+
+                    rgb565_kernel_args_t args = {
+                        .dst = out_ref + d_off,
+                        .src = src + s_off,
+                        .bytes = bytes + s_off,
+                        .color = (uint16_t)rgb565_test_rand(&seed),
+                        .alpha = (uint8_t)rgb565_test_rand(&seed),
+                        .n = n,
+                    };
+                    kernel->run(&args, 0);
+                    args.dst = out_fast + d_off;
+                    kernel->run(&args, 1);
+
+                    // 整个缓冲区比较, 同时检查越界写
+                    if (memcmp(out_ref, out_fast, buf_pixels * sizeof(uint16_t)) != 0) {
+                        ESP_LOGE(TAG, "%s不一致: n=%zu, dst偏移=%zu, src偏移=%zu", kernel->name, n, d_off, s_off);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+
+    heap_caps_free(src);
+    heap_caps_free(out_ref);
+    heap_caps_free(out_fast);
+    heap_caps_free(bytes);
+
+    if (failures > 0) {
+        ESP_LOGE(TAG, "RGB565内核自检失败: %d 项不一致", failures);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "RGB565内核自检通过 (%s路径)", RGB565_USE_PIE ? "PIE" : "标量");
+    return ESP_OK;
+}
+
+/**
+ * @brief 基准测试
+ */
+esp_err_t rgb565_benchmark(void)
+{
+    size_t n = RGB565_TEST_PIXELS;
+    uint16_t *dst = heap_caps_aligned_alloc(16, n * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    uint16_t *src = heap_caps_aligned_alloc(16, n * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+    uint8_t *bytes = heap_caps_aligned_alloc(16, n * 3, MALLOC_CAP_INTERNAL);
+    if (dst == NULL || src == NULL || bytes == NULL) {
+        heap_caps_free(dst);
+        heap_caps_free(src);
+        heap_caps_free(bytes);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t seed = 0x87654321;
+    rgb565_test_fill_random((uint8_t *)src, n * sizeof(uint16_t), &seed);
+    rgb565_test_fill_random(bytes, n * 3, &seed);
+
+    ESP_LOGI(TAG, "RGB565内核基准测试: %zu 像素 x %d 次, 单位: 周期/像素 x100", n, RGB565_BENCH_ROUNDS);
+
+    for (size_t bi = 0; bi < RGB565_BENCH_KERNEL_NUM; bi++) {
+        const rgb565_kernel_t *kernel = rgb565_find_kernel(rgb565_bench_names[bi]);
+        if (kernel == NULL) {
+            ESP_LOGW(TAG, "没有名为%s的内核", rgb565_bench_names[bi]);
+            continue;
+        }
+        // 缩小内核按输出像素计
+        rgb565_kernel_args_t args = {
+            .dst = dst,
+            .src = src,
+            .bytes = bytes,
+            .color = 0x1234,
+            .alpha = 100,
+            .n = n / kernel->src_scale,
+        };
+        uint32_t ticks[2] = {0, 0};
+        for (int fast = 0; fast < 2; fast++) {
+            uint32_t start = rgb565_bench_ticks();
+            for (int r = 0; r < RGB565_BENCH_ROUNDS; r++) {
+                kernel->run(&args, fast);
+            }
+            ticks[fast] = rgb565_bench_ticks() - start;
+        }
+
+        uint64_t total = (uint64_t)args.n * RGB565_BENCH_ROUNDS;
+        uint64_t fast_ticks = ticks[1] ? ticks[1] : 1;
+        ESP_LOGI(TAG, "  %-18s 参考=%5" PRIu32 "  加速=%5" PRIu32 "  加速比=%" PRIu32 "%%",
+                 kernel->name, (uint32_t)(ticks[0] * 100ULL / total),
+                 (uint32_t)(ticks[1] * 100ULL / total), (uint32_t)(ticks[0] * 100ULL / fast_ticks));
+    }
+
+    heap_caps_free(dst);
+    heap_caps_free(src);
+    heap_caps_free(bytes);
+    return ESP_OK;
+}
@@ -0,0 +1,71 @@
+/*
+ * SD卡实现
+ * SDMMC 1线模式挂载FAT文件系统
+ */
+
+#include "sd_card.h"
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+#include "driver/sdmmc_host.h"
+#include "esp_log.h"
+
+static const char *TAG = "SD_CARD";
+
+static sdmmc_card_t *card = NULL;
+
+/**
+ * @brief 挂载SD卡
+ */
+esp_err_t sd_card_mount(void)
+{
+    if (card != NULL) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "挂载SD卡...");
+
+    esp_vfs_fat_sdmmc_mount_config_t mount_config = {
+        .format_if_mount_failed = false,
+        .max_files = SD_CARD_MAX_FILES,
+        .allocation_unit_size = 16 * 1024,
+    };
+
+    sdmmc_host_t host = SDMMC_HOST_DEFAULT();
+    sdmmc_slot_config_t slot_config = SDMMC_SLOT_CONFIG_DEFAULT();
+    slot_config.width = 1;
+    slot_config.clk = SD_CARD_PIN_CLK;
+    slot_config.cmd = SD_CARD_PIN_CMD;
+    slot_config.d0 = SD_CARD_PIN_D0;
+    slot_config.flags |= SDMMC_SLOT_FLAG_INTERNAL_PULLUP;
+
+    esp_err_t ret = esp_vfs_fat_sdmmc_mount(SD_CARD_MOUNT_POINT, &host, &slot_config, &mount_config, &card);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SD卡挂载失败: %s", esp_err_to_name(ret));
+        card = NULL;
+        return ret;
+    }
+
+    sdmmc_card_print_info(stdout, card);
+    ESP_LOGI(TAG, "SD卡已挂载到 %s", SD_CARD_MOUNT_POINT);
+    return ESP_OK;
+}
+
+/**
+ * @brief 卸载SD卡
+ */
+void sd_card_unmount(void)
+{
+    if (card != NULL) {
+        esp_vfs_fat_sdcard_unmount(SD_CARD_MOUNT_POINT, card);
+        card = NULL;
+        ESP_LOGI(TAG, "SD卡已卸载");
+    }
+}
+
+/**
+ * @brief SD卡是否已挂载
+ */
+bool sd_card_is_mounted(void)
+{
+    return card != NULL;
+}
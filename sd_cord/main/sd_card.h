@@ -0,0 +1,44 @@
+/*
+ * SD卡头文件
+ * SDMMC 1线模式挂载FAT文件系统
+ */
+
+#ifndef SD_CARD_H
+#define SD_CARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SD卡配置参数
+#define SD_CARD_MOUNT_POINT         "/sdcard"   // 挂载点
+#define SD_CARD_PIN_CLK             47          // CLK引脚
+#define SD_CARD_PIN_CMD             48          // CMD引脚
+#define SD_CARD_PIN_D0              21          // D0引脚
+#define SD_CARD_MAX_FILES           5           // 同时打开的最大文件数
+
+/**
+ * @brief 挂载SD卡
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t sd_card_mount(void);
+
+/**
+ * @brief 卸载SD卡
+ */
+void sd_card_unmount(void);
+
+/**
+ * @brief SD卡是否已挂载
+ */
+bool sd_card_is_mounted(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SD_CARD_H
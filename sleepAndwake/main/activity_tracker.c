@@ -0,0 +1,381 @@
+/*
+ * 活动跟踪实现
+ * 报告活动只在临界区内更新时间戳, 跟踪任务在下一档策略到期时醒来重新计算空闲时间, 不需要每次活动都唤醒它;
+ * 任务决定睡眠后到睡眠管理执行之间如果又有活动, 由跟踪器的睡眠前钩子取消这次睡眠
+ */
+
+#include "activity_tracker.h"
+#include "sleep_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "ACTIVITY";
+
+// 跟踪任务的通知位
+#define ACTIVITY_NOTIFY_IDLE        (1UL << 0)  // 所有来源都结束使用
+#define ACTIVITY_NOTIFY_SLEEP_DONE  (1UL << 1)  // 请求的睡眠已完成或被取消
+
+static activity_policy_t policies[ACTIVITY_TRACKER_MAX_POLICIES];
+static int policy_count = 0;
+static activity_wake_source_t wake_sources[ACTIVITY_SRC_MAX];
+
+static portMUX_TYPE activity_lock = portMUX_INITIALIZER_UNLOCKED;  // 保护时间戳、使用状态和统计
+static int64_t last_activity_us = 0;    // 最后一次活动的时间
+static uint32_t busy_mask = 0;          // 正在使用的来源
+static int last_source = -1;
+static activity_tracker_stats_t stats;
+
+static TaskHandle_t tracker_task_handle = NULL;
+static volatile bool sleep_pending = false;     // 跟踪任务请求的睡眠还没有执行
+static int64_t decided_activity_us = 0;         // 决定睡眠时的最后活动时间
+static esp_sleep_wakeup_cause_t boot_cause = ESP_SLEEP_WAKEUP_UNDEFINED;  // 启动时的唤醒原因
+
+static const char *source_names[ACTIVITY_SRC_MAX] = {
+    [ACTIVITY_SRC_KEY] = "按键",
+    [ACTIVITY_SRC_TOUCH] = "触摸",
+    [ACTIVITY_SRC_UART] = "串口",
+    [ACTIVITY_SRC_IMU] = "IMU",
+};
+
+/**
+ * @brief 在临界区内记录一次活动
+ */
+static inline void activity_tracker_mark_locked(activity_source_t src, int64_t now)
+{
+    last_activity_us = now;
+    last_source = src;
+    stats.reports[src]++;
+}
+
+/**
+ * @brief 唤醒原因对应的来源
+ * @return 来源, 不是任何来源的唤醒原因 (如定时器) 时返回-1
+ */
+static int activity_tracker_cause_source(esp_sleep_wakeup_cause_t cause)
+{
+    if (cause == ESP_SLEEP_WAKEUP_UNDEFINED) {
+        return -1;
+    }
+    for (int src = 0; src < ACTIVITY_SRC_MAX; src++) {
+        if (wake_sources[src].arm != NULL && wake_sources[src].cause == cause) {
+            return src;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 配置策略的唤醒源, 之前配置的唤醒源全部清除
+ * @return 配置成功的唤醒源数量
+ */
+static int activity_tracker_arm(const activity_policy_t *policy)
+{
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+
+    int armed = 0;
+    for (int src = 0; src < ACTIVITY_SRC_MAX; src++) {
+        if (!(policy->wake_sources & ACTIVITY_SRC_BIT(src)) || wake_sources[src].arm == NULL) {
+            continue;
+        }
+        esp_err_t ret = wake_sources[src].arm(policy->depth, wake_sources[src].arg);
+        if (ret == ESP_OK) {
+            armed++;
+        } else if (ret != ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGW(TAG, "配置%s唤醒失败: %s", source_names[src], esp_err_to_name(ret));
+        }
+    }
+    return armed;
+}
+
+/**
+ * @brief 配置所有已注册来源的轻度睡眠唤醒, 供自动轻度睡眠使用
+ * @note 自动轻度睡眠由电源管理在空闲时进入, 不经过策略, 任何来源的活动都要能唤醒;
+ *       按策略睡眠时清除了其他唤醒源, 之后要重新配置
+ */
+static void activity_tracker_arm_auto(void)
+{
+    for (int src = 0; src < ACTIVITY_SRC_MAX; src++) {
+        if (wake_sources[src].arm == NULL) {
+            continue;
+        }
+        esp_err_t ret = wake_sources[src].arm(ACTIVITY_SLEEP_LIGHT, wake_sources[src].arg);
+        if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGW(TAG, "配置%s唤醒失败: %s", source_names[src], esp_err_to_name(ret));
+        }
+    }
+}
+
+/**
+ * @brief 请求睡眠并等待睡眠管理执行完 (深度睡眠成功时不会返回)
+ */
+static void activity_tracker_sleep(int level, uint32_t idle_ms, int64_t activity_us)
+{
+    const activity_policy_t *policy = &policies[level];
+
+    // 轻度睡眠在下一档到期时定时醒来, 继续睡更深的一档
+    uint32_t timer_ms = 0;
+    if (policy->depth == ACTIVITY_SLEEP_LIGHT && level + 1 < policy_count && policies[level + 1].idle_ms > idle_ms) {
+        timer_ms = policies[level + 1].idle_ms - idle_ms;
+    }
+
+    ESP_LOGI(TAG, "空闲%" PRIu32 "ms, 进入%s睡眠 (策略%d, 定时唤醒%" PRIu32 "ms)",
+             idle_ms, policy->depth == ACTIVITY_SLEEP_DEEP ? "深度" : "轻度", level, timer_ms);
+
+    portENTER_CRITICAL(&activity_lock);
+    decided_activity_us = activity_us;
+    if (policy->depth == ACTIVITY_SLEEP_DEEP) {
+        stats.deep_sleeps++;
+    } else {
+        stats.light_sleeps++;
+    }
+    portEXIT_CRITICAL(&activity_lock);
+
+    sleep_pending = true;
+    esp_err_t ret = (policy->depth == ACTIVITY_SLEEP_DEEP) ? sleep_manager_request_deep(timer_ms)
+                                                           : sleep_manager_request(timer_ms);
+    if (ret != ESP_OK) {
+        sleep_pending = false;
+        ESP_LOGE(TAG, "请求睡眠失败: %s", esp_err_to_name(ret));
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        return;
+    }
+
+    uint32_t bits = 0;
+    do {
+        xTaskNotifyWait(0, ACTIVITY_NOTIFY_SLEEP_DONE, &bits, portMAX_DELAY);
+    } while (!(bits & ACTIVITY_NOTIFY_SLEEP_DONE));
+}
+
+/**
+ * @brief 跟踪任务: 等到下一档策略到期, 选出已经到期且有可用唤醒源的最深一档睡眠
+ * @param pvParameters 任务参数
+ */
+static void activity_tracker_task(void *pvParameters)
+{
+    while (1) {
+        portENTER_CRITICAL(&activity_lock);
+        int64_t activity_us = last_activity_us;
+        uint32_t busy = busy_mask;
+        portEXIT_CRITICAL(&activity_lock);
+
+        if (busy) {
+            // 使用结束时会收到通知, 空闲时间从那时开始计算
+            xTaskNotifyWait(0, ACTIVITY_NOTIFY_IDLE, NULL, portMAX_DELAY);
+            continue;
+        }
+
+        uint32_t idle_ms = (uint32_t)((esp_timer_get_time() - activity_us) / 1000);
+        int reached = -1;
+        while (reached + 1 < policy_count && idle_ms >= policies[reached + 1].idle_ms) {
+            reached++;
+        }
+
+        int level = reached;
+        while (level >= 0 && activity_tracker_arm(&policies[level]) == 0) {
+            ESP_LOGW(TAG, "策略%d没有可用的唤醒源, 跳过", level);
+            level--;
+        }
+
+        if (level >= 0) {
+            activity_tracker_sleep(level, idle_ms, activity_us);
+        }
+        if (reached >= 0) {
+            activity_tracker_arm_auto();
+        }
+        if (level >= 0) {
+            continue;
+        }
+
+        // 等到下一档到期; 期间的活动推迟了截止时间, 醒来后重新计算
+        TickType_t wait = portMAX_DELAY;
+        if (reached + 1 < policy_count) {
+            wait = pdMS_TO_TICKS(policies[reached + 1].idle_ms - idle_ms);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+        xTaskNotifyWait(0, ACTIVITY_NOTIFY_IDLE, NULL, wait);
+    }
+}
+
+/**
+ * @brief 睡眠前钩子: 决定睡眠之后有新的活动或来源开始使用时取消
+ * @note 其他模块请求的睡眠 (如唤醒延迟测试) 不受影响
+ */
+static esp_err_t activity_tracker_sleep_prepare(void *arg)
+{
+    if (!sleep_pending) {
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL(&activity_lock);
+    bool active = (last_activity_us != decided_activity_us) || busy_mask != 0;
+    if (active) {
+        stats.vetoed++;
+    }
+    portEXIT_CRITICAL(&activity_lock);
+
+    if (active) {
+        sleep_pending = false;
+        xTaskNotify(tracker_task_handle, ACTIVITY_NOTIFY_SLEEP_DONE, eSetBits);
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 唤醒后钩子: 由某个来源唤醒时计为这个来源的一次活动
+ * @note 其他钩子取消睡眠时也会调用, 这时没有真正睡眠, 不看唤醒原因
+ */
+static esp_err_t activity_tracker_sleep_resume(void *arg)
+{
+    if (sleep_manager_get_state() == SLEEP_STATE_RESUMING) {
+        int src = activity_tracker_cause_source(esp_sleep_get_wakeup_cause());
+        if (src >= 0) {
+            int64_t now = esp_timer_get_time();
+            portENTER_CRITICAL(&activity_lock);
+            activity_tracker_mark_locked(src, now);
+            portEXIT_CRITICAL(&activity_lock);
+        }
+    }
+
+    if (sleep_pending) {
+        sleep_pending = false;
+        xTaskNotify(tracker_task_handle, ACTIVITY_NOTIFY_SLEEP_DONE, eSetBits);
+    }
+    return ESP_OK;
+}
+
+esp_err_t activity_tracker_init(const activity_policy_t *policy_list, int count)
+{
+    if (tracker_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (policy_list == NULL || count <= 0 || count > ACTIVITY_TRACKER_MAX_POLICIES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < count; i++) {
+        // 按空闲时间递增; 深度睡眠唤醒即复位, 之后不能再有更深的一档
+        if ((i > 0 && policy_list[i].idle_ms <= policy_list[i - 1].idle_ms) ||
+            (i + 1 < count && policy_list[i].depth == ACTIVITY_SLEEP_DEEP)) {
+            ESP_LOGE(TAG, "策略%d无效", i);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    memcpy(policies, policy_list, sizeof(activity_policy_t) * count);
+    policy_count = count;
+    memset(&stats, 0, sizeof(stats));
+    last_activity_us = esp_timer_get_time();
+    last_source = -1;
+    busy_mask = 0;
+    boot_cause = esp_sleep_get_wakeup_cause();
+
+    // 最后注册: 睡眠前钩子按相反顺序调用, 跟踪器最先检查, 取消时还没有暂停任何驱动
+    const sleep_hook_t hook = {
+        .name = "activity", .prepare = activity_tracker_sleep_prepare,
+        .resume = activity_tracker_sleep_resume, .arg = NULL,
+    };
+    esp_err_t ret = sleep_manager_register_hook(&hook);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "注册睡眠钩子失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (xTaskCreate(activity_tracker_task, "activity", ACTIVITY_TRACKER_TASK_STACK, NULL,
+                    ACTIVITY_TRACKER_TASK_PRIO, &tracker_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "创建跟踪任务失败");
+        return ESP_FAIL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "策略%d: 空闲%" PRIu32 "ms后%s睡眠, 唤醒源0x%02" PRIx32, i, policies[i].idle_ms,
+                 policies[i].depth == ACTIVITY_SLEEP_DEEP ? "深度" : "轻度", policies[i].wake_sources);
+    }
+    return ESP_OK;
+}
+
+esp_err_t activity_tracker_register_wake_source(activity_source_t src, const activity_wake_source_t *wake)
+{
+    if (src >= ACTIVITY_SRC_MAX || wake == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&activity_lock);
+    wake_sources[src] = *wake;
+    // 深度睡眠唤醒复位后, 启动本身就是这个来源的活动
+    if (boot_cause != ESP_SLEEP_WAKEUP_UNDEFINED && wake->cause == boot_cause) {
+        last_source = src;
+        stats.reports[src]++;
+        boot_cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    }
+    portEXIT_CRITICAL(&activity_lock);
+
+    // 注册后马上可以唤醒自动轻度睡眠
+    esp_err_t ret = (wake->arm != NULL) ? wake->arm(ACTIVITY_SLEEP_LIGHT, wake->arg) : ESP_ERR_NOT_SUPPORTED;
+    if (ret != ESP_OK && ret != ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGW(TAG, "配置%s唤醒失败: %s", source_names[src], esp_err_to_name(ret));
+    }
+    return ESP_OK;
+}
+
+void activity_tracker_report(activity_source_t src)
+{
+    if (src >= ACTIVITY_SRC_MAX) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&activity_lock);
+    activity_tracker_mark_locked(src, now);
+    portEXIT_CRITICAL(&activity_lock);
+}
+
+void activity_tracker_set_busy(activity_source_t src, bool busy)
+{
+    if (src >= ACTIVITY_SRC_MAX) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&activity_lock);
+    uint32_t before = busy_mask;
+    if (busy) {
+        busy_mask |= ACTIVITY_SRC_BIT(src);
+    } else {
+        busy_mask &= ~ACTIVITY_SRC_BIT(src);
+    }
+    if (busy && !(before & ACTIVITY_SRC_BIT(src))) {
+        activity_tracker_mark_locked(src, now);
+    } else {
+        last_activity_us = now;
+    }
+    bool idle = (before != 0 && busy_mask == 0);
+    portEXIT_CRITICAL(&activity_lock);
+
+    if (idle && tracker_task_handle != NULL) {
+        xTaskNotify(tracker_task_handle, ACTIVITY_NOTIFY_IDLE, eSetBits);
+    }
+}
+
+esp_err_t activity_tracker_get_stats(activity_tracker_stats_t *out)
+{
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&activity_lock);
+    *out = stats;
+    out->busy_mask = busy_mask;
+    out->idle_ms = (busy_mask != 0) ? 0 : (uint32_t)((now - last_activity_us) / 1000);
+    out->last_source = last_source;
+    portEXIT_CRITICAL(&activity_lock);
+    return ESP_OK;
+}
+
+const char *activity_tracker_source_name(activity_source_t src)
+{
+    return (src < ACTIVITY_SRC_MAX) ? source_names[src] : "?";
+}
@@ -0,0 +1,138 @@
+/*
+ * 活动跟踪头文件
+ * 按键、触摸、串口接收和IMU运动都向跟踪器报告活动, 跟踪器只维护一个空闲截止时间:
+ * 最后一次活动之后空闲多久进入哪一档睡眠由策略表决定, 进入睡眠前按策略配置对应的唤醒源;
+ * 有输入源正在使用 (按键按住、手指在触摸通道上) 时不会睡眠
+ */
+
+#ifndef ACTIVITY_TRACKER_H
+#define ACTIVITY_TRACKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_sleep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 活动跟踪配置
+#define ACTIVITY_TRACKER_MAX_POLICIES   4       // 最多的策略数
+#define ACTIVITY_TRACKER_TASK_STACK     3072    // 跟踪任务栈大小
+#define ACTIVITY_TRACKER_TASK_PRIO      4       // 低于睡眠管理任务, 只负责决定何时睡眠
+
+/**
+ * @brief 活动来源
+ */
+typedef enum {
+    ACTIVITY_SRC_KEY,                   // 按键 (XL9555按键和GPIO0唤醒按钮)
+    ACTIVITY_SRC_TOUCH,                 // 触摸
+    ACTIVITY_SRC_UART,                  // 串口接收
+    ACTIVITY_SRC_IMU,                   // IMU运动 (QMI8658运动检测)
+    ACTIVITY_SRC_MAX,
+} activity_source_t;
+
+#define ACTIVITY_SRC_BIT(src)   (1UL << (src))
+
+/**
+ * @brief 睡眠深度
+ */
+typedef enum {
+    ACTIVITY_SLEEP_LIGHT,               // 通过睡眠管理进入轻度睡眠, 唤醒后继续运行
+    ACTIVITY_SLEEP_DEEP,                // 深度睡眠, 唤醒即复位
+} activity_sleep_t;
+
+/**
+ * @brief 睡眠策略: 空闲idle_ms之后进入depth, 只用wake_sources中的来源唤醒
+ * @note 策略按idle_ms从小到大排列; 轻度睡眠时如果还有更深的策略, 会定时在那一档到期时醒来并继续睡更深
+ */
+typedef struct {
+    uint32_t idle_ms;                   // 最后一次活动之后的空闲时间
+    activity_sleep_t depth;             // 睡眠深度
+    uint32_t wake_sources;              // 唤醒源, ACTIVITY_SRC_BIT的组合
+} activity_policy_t;
+
+/**
+ * @brief 配置唤醒源的函数
+ * @param depth 即将进入的睡眠深度
+ * @param arg 注册时的参数
+ * @return ESP_OK 已配置, ESP_ERR_NOT_SUPPORTED 这个深度下不能作为唤醒源, 其他值表示配置失败
+ */
+typedef esp_err_t (*activity_arm_fn_t)(activity_sleep_t depth, void *arg);
+
+/**
+ * @brief 来源的唤醒配置
+ */
+typedef struct {
+    activity_arm_fn_t arm;              // 配置唤醒源, 为NULL时这个来源不能唤醒
+    void *arg;                          // 参数
+    esp_sleep_wakeup_cause_t cause;     // 由这个来源唤醒时的唤醒原因, 唤醒本身计为一次活动
+} activity_wake_source_t;
+
+/**
+ * @brief 统计
+ */
+typedef struct {
+    uint32_t reports[ACTIVITY_SRC_MAX]; // 各来源报告的活动次数 (包括由它唤醒)
+    uint32_t busy_mask;                 // 正在使用的来源
+    uint32_t idle_ms;                   // 当前空闲时间
+    uint32_t light_sleeps;              // 请求轻度睡眠的次数
+    uint32_t deep_sleeps;               // 请求深度睡眠的次数
+    uint32_t vetoed;                    // 决定睡眠后又有活动而取消的次数
+    int last_source;                    // 最近一次活动的来源, -1表示启动后还没有活动
+} activity_tracker_stats_t;
+
+/**
+ * @brief 初始化活动跟踪并创建跟踪任务
+ * @note 需要先初始化睡眠管理, 并在其他驱动之后调用: 跟踪器注册的睡眠前钩子最先执行,
+ *       决定睡眠之后有新的活动时在暂停任何驱动之前取消; 启动 (包括深度睡眠唤醒复位) 计为一次活动
+ * @param policies 策略表, 内容会被复制
+ * @param count 策略数, 最多ACTIVITY_TRACKER_MAX_POLICIES
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 策略无效, ESP_ERR_INVALID_STATE 已初始化, ESP_FAIL 创建任务失败
+ */
+esp_err_t activity_tracker_init(const activity_policy_t *policies, int count);
+
+/**
+ * @brief 注册来源的唤醒配置
+ * @note 进入睡眠前对策略中的每个来源调用arm; 一档策略没有任何可用的唤醒源时跳过这一档
+ *       注册时和每次按策略睡眠之后还会按轻度睡眠调用arm, 自动轻度睡眠期间这个来源也能唤醒
+ * @param src 来源
+ * @param wake 唤醒配置, 内容会被复制
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t activity_tracker_register_wake_source(activity_source_t src, const activity_wake_source_t *wake);
+
+/**
+ * @brief 报告一次活动, 把空闲截止时间推迟到现在
+ * @note 只更新时间戳, 不唤醒跟踪任务, 高频调用 (每个串口字节) 也没有额外开销;
+ *       只能在任务中调用
+ * @param src 来源
+ */
+void activity_tracker_report(activity_source_t src);
+
+/**
+ * @brief 设置来源是否正在使用
+ * @note 正在使用期间不会睡眠, 结束时计为一次活动, 空闲时间从结束时开始计算
+ * @param src 来源
+ * @param busy true 开始使用 (如按键按下), false 结束使用
+ */
+void activity_tracker_set_busy(activity_source_t src, bool busy);
+
+/**
+ * @brief 获取统计
+ * @param stats 返回的统计
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t activity_tracker_get_stats(activity_tracker_stats_t *stats);
+
+/**
+ * @brief 来源的中文名称
+ */
+const char *activity_tracker_source_name(activity_source_t src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACTIVITY_TRACKER_H
@@ -16,70 +16,380 @@
 #include "esp_sleep.h"
 #include "esp_timer.h"
 #include "driver/gpio.h"
+#include "driver/uart.h"
+#include "sleep_manager.h"
+#include "i2c_master.h"
+#include "xl9555.h"
+#include "qmi8658.h"
+#include "touch_sensor.h"
+#include "power_manager.h"
+#include "wake_bench.h"
+#include "activity_tracker.h"
 
 static const char *TAG = "SLEEP_WAKEUP";
 
 // 定义GPIO引脚
 #define WAKEUP_GPIO_NUM    GPIO_NUM_0    // 唤醒按钮连接到GPIO0
-#define SLEEP_DELAY_MS     10000         // 10秒后进入睡眠
-
-// 全局定时器句柄
-static esp_timer_handle_t sleep_timer = NULL;
-
-// 睡眠定时器回调函数
-static void sleep_timer_callback(void* arg)
-{   
-    ESP_LOGI(TAG, "定时器触发，准备进入轻度睡眠模式...");
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    // 停止定时器
-    if (sleep_timer != NULL) {
-        esp_timer_stop(sleep_timer);
-    }
-    
-    // 进入轻度睡眠模式
-    esp_light_sleep_start();
-    
-    // 从睡眠中唤醒后继续执行
-    ESP_LOGI(TAG, "从轻度睡眠中唤醒！");
-    
-    // 检查唤醒原因
-    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-    switch(wakeup_reason)
-    {
-        case ESP_SLEEP_WAKEUP_GPIO:
-            ESP_LOGI(TAG, "唤醒原因: GPIO唤醒 (按钮按下)");
-            break;
-        case ESP_SLEEP_WAKEUP_TIMER:
-            ESP_LOGI(TAG, "唤醒原因: 定时器唤醒");
-            break;
-        case ESP_SLEEP_WAKEUP_UNDEFINED:
-            ESP_LOGI(TAG, "唤醒原因: 未定义");
-            break;
-        case ESP_SLEEP_WAKEUP_EXT0:
-            ESP_LOGI(TAG, "唤醒原因: EXT0唤醒 (GPIO0按钮)");
-            break;
-        case ESP_SLEEP_WAKEUP_EXT1:
-            ESP_LOGI(TAG, "唤醒原因: EXT1唤醒");
-            break;
-        default:
-            ESP_LOGI(TAG, "唤醒原因: 其他原因 (%d)", wakeup_reason);
-            break;
+#define IDLE_LIGHT_MS      10000         // 没有任何输入10秒后进入轻度睡眠
+#define TOUCH_RESEED_MS    60000         // 睡眠超过60秒且不是触摸唤醒时重新初始化触摸基准值
+#define POWER_REPORT_MS    5000          // 打印电源统计的周期
+#define KEY_POLL_MS        50            // 按键轮询周期 (XL9555的中断引脚没有接到ESP32)
+#define TOUCH_WAKE_PAD     TOUCH_PAD_NUM6    // 睡眠时用于唤醒的触摸通道 (硬件只支持一个)
+#define UART_RX_BUF_SIZE   256           // 控制台串口接收缓冲区
+#define UART_WAKE_EDGES    3             // 串口唤醒需要的RX边沿数, 唤醒用的字符会丢失
+
+// 1: 轻度睡眠之后继续空闲到IDLE_DEEP_MS时进入深度睡眠, 驱动把热状态保存在RTC内存, 唤醒复位后快速恢复
+#define DEMO_DEEP_SLEEP    0
+#define IDLE_DEEP_MS       60000         // 没有任何输入60秒后进入深度睡眠 (只能由触摸唤醒)
+
+// 1: 不运行睡眠演示, 改为测量唤醒延迟 (CPU恢复、中断、任务运行、首次I2C)
+#define DEMO_WAKE_BENCH    0
+// 测试模式: WAKE_BENCH_AWAKE / WAKE_BENCH_LIGHT_SLEEP / WAKE_BENCH_DEEP_SLEEP
+#define DEMO_BENCH_MODE    WAKE_BENCH_LIGHT_SLEEP
+// 唤醒源: WAKE_BENCH_SRC_TIMER / WAKE_BENCH_SRC_EXT0 / WAKE_BENCH_SRC_TOUCH (深度睡眠不能用GPIO0按钮)
+#define DEMO_BENCH_SOURCE  WAKE_BENCH_SRC_TIMER
+
+// 空闲睡眠策略: 轻度睡眠可以由按键、触摸、串口和IMU运动唤醒; 深度睡眠时GPIO0是启动模式引脚, 串口不能唤醒,
+// 只剩触摸和IMU运动 (IMU需要在menuconfig中设置INT1引脚, 否则跳过)
+static const activity_policy_t idle_policies[] = {
+    { .idle_ms = IDLE_LIGHT_MS, .depth = ACTIVITY_SLEEP_LIGHT,
+      .wake_sources = ACTIVITY_SRC_BIT(ACTIVITY_SRC_KEY) | ACTIVITY_SRC_BIT(ACTIVITY_SRC_TOUCH) | ACTIVITY_SRC_BIT(ACTIVITY_SRC_UART) |
+                      ACTIVITY_SRC_BIT(ACTIVITY_SRC_IMU) },
+#if DEMO_DEEP_SLEEP
+    { .idle_ms = IDLE_DEEP_MS, .depth = ACTIVITY_SLEEP_DEEP,
+      .wake_sources = ACTIVITY_SRC_BIT(ACTIVITY_SRC_TOUCH) | ACTIVITY_SRC_BIT(ACTIVITY_SRC_IMU) },
+#endif
+};
+
+// 驱动是否初始化成功, 决定哪些输入源向活动跟踪报告
+static bool keys_ready = false;
+static bool touch_ready = false;
+static bool imu_ready = false;
+
+// 触摸驱动进入睡眠的时间, 唤醒时判断是否需要重新初始化基准值
+static int64_t touch_suspend_at = 0;
+
+// I2C总线钩子: 等待进行中的传输结束并锁住总线
+static esp_err_t i2c_sleep_prepare(void *arg)
+{
+    return i2c_master_suspend();
+}
+
+static esp_err_t i2c_sleep_resume(void *arg)
+{
+    return i2c_master_resume();
+}
+
+static esp_err_t i2c_sleep_save(void *arg)
+{
+    return i2c_master_save_state();
+}
+
+// XL9555钩子: 记录按钮状态, 唤醒后用影子寄存器恢复
+static esp_err_t xl9555_sleep_prepare(void *arg)
+{
+    return xl9555_suspend();
+}
+
+static esp_err_t xl9555_sleep_resume(void *arg)
+{
+    return xl9555_resume();
+}
+
+static esp_err_t xl9555_sleep_save(void *arg)
+{
+    return xl9555_save_state();
+}
+
+// 触摸钩子: 由触摸唤醒时手指还在通道上, 不能重新初始化基准值
+static esp_err_t touch_sleep_prepare(void *arg)
+{
+    touch_suspend_at = esp_timer_get_time();
+    return touch_sensor_suspend();
+}
+
+static esp_err_t touch_sleep_resume(void *arg)
+{
+    bool long_sleep = (esp_timer_get_time() - touch_suspend_at) > (int64_t)TOUCH_RESEED_MS * 1000;
+    bool reseed = long_sleep && esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TOUCHPAD;
+    return touch_sensor_resume(reseed);
+}
+
+static esp_err_t touch_sleep_save(void *arg)
+{
+    return touch_sensor_save_state();
+}
+
+// 控制台串口钩子: 睡眠前等待日志发送完, 否则睡眠期间串口时钟停止会输出乱码
+static esp_err_t console_sleep_prepare(void *arg)
+{
+    fflush(stdout);
+#if CONFIG_ESP_CONSOLE_UART
+    return uart_wait_tx_idle_polling(CONFIG_ESP_CONSOLE_UART_NUM);
+#else
+    return ESP_OK;
+#endif
+}
+
+// 唤醒回调: 所有驱动恢复后调用
+static void wake_callback(const sleep_wake_info_t *info, void *arg)
+{
+    if (info->slowest_hook >= 0) {
+        ESP_LOGI(TAG, "最慢的唤醒钩子: %s (%" PRIu32 "us)",
+                 sleep_manager_hook_name(info->slowest_hook), info->slowest_hook_us);
     }
     
     // 检查GPIO0当前状态
     int gpio_level = gpio_get_level(WAKEUP_GPIO_NUM);
     ESP_LOGI(TAG, "GPIO%d 当前状态: %s", WAKEUP_GPIO_NUM, gpio_level == 0 ? "低电平(按钮按下)" : "高电平(按钮释放)");
     
-    // 重新设置定时器，10秒后再次进入睡眠
-    esp_timer_start_once(sleep_timer, SLEEP_DELAY_MS * 1000);
+    // 比较睡眠前后的按钮状态
+    bool before[4], now[4];
+    if (xl9555_get_suspend_keys(before) == ESP_OK && xl9555_keys_read_all(now) == ESP_OK) {
+        for (int i = 0; i < 4; i++) {
+            if (before[i] != now[i]) {
+                ESP_LOGI(TAG, "KEY%d 睡眠期间%s", i, now[i] ? "按下" : "释放");
+            }
+        }
+    }
     
-    ESP_LOGI(TAG, "已重新设置定时器，%d秒后将再次进入睡眠模式", SLEEP_DELAY_MS / 1000);
+    sleep_manager_stats_t stats;
+    sleep_manager_get_stats(&stats);
+    ESP_LOGI(TAG, "第%" PRIu32 "次睡眠, 唤醒到就绪: 最短%" PRIu32 "us, 平均%" PRIu32 "us, 最长%" PRIu32 "us",
+             stats.sleep_count, stats.resume_min_us, stats.resume_avg_us, stats.resume_max_us);
+    
+    activity_tracker_stats_t activity;
+    activity_tracker_get_stats(&activity);
+    if (activity.last_source >= 0) {
+        ESP_LOGI(TAG, "最近的活动: %s, 空闲%" PRIu32 "ms", activity_tracker_source_name(activity.last_source), activity.idle_ms);
+    }
+}
+
+// 注册钩子, 先注册总线再注册依赖它的设备
+static void register_sleep_hooks(void)
+{
+    const sleep_hook_t console_hook = {
+        .name = "console", .prepare = console_sleep_prepare, .resume = NULL, .arg = NULL,
+    };
+    sleep_manager_register_hook(&console_hook);
+    
+    if (i2c_master_init() == ESP_OK) {
+        const sleep_hook_t i2c_hook = {
+            .name = "i2c", .prepare = i2c_sleep_prepare, .resume = i2c_sleep_resume, .arg = NULL,
+            .save = i2c_sleep_save,
+        };
+        sleep_manager_register_hook(&i2c_hook);
+        
+        if (xl9555_init() == ESP_OK && xl9555_keys_init() == ESP_OK) {
+            const sleep_hook_t xl9555_hook = {
+                .name = "xl9555", .prepare = xl9555_sleep_prepare, .resume = xl9555_sleep_resume, .arg = NULL,
+                .save = xl9555_sleep_save,
+            };
+            sleep_manager_register_hook(&xl9555_hook);
+            keys_ready = true;
+        } else {
+            ESP_LOGW(TAG, "XL9555初始化失败, 不注册睡眠钩子");
+        }
+        
+        // QMI8658睡眠期间自己检测运动, 不需要睡眠钩子; 查询时总线已暂停会等到唤醒
+        imu_ready = (qmi8658_init() == ESP_OK);
+    } else {
+        ESP_LOGW(TAG, "I2C初始化失败, 不注册睡眠钩子");
+    }
+    
+    if (touch_sensor_init() == ESP_OK) {
+        const sleep_hook_t touch_hook = {
+            .name = "touch", .prepare = touch_sleep_prepare, .resume = touch_sleep_resume, .arg = NULL,
+            .save = touch_sleep_save,
+        };
+        sleep_manager_register_hook(&touch_hook);
+        touch_ready = true;
+    } else {
+        ESP_LOGW(TAG, "触摸初始化失败, 不注册睡眠钩子");
+    }
+}
+
+// 按键唤醒: 只有GPIO0按钮能唤醒, 深度睡眠时按着它复位会进入下载模式
+static esp_err_t key_arm_wakeup(activity_sleep_t depth, void *arg)
+{
+    if (depth == ACTIVITY_SLEEP_DEEP) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    return esp_sleep_enable_ext0_wakeup(WAKEUP_GPIO_NUM, 0);
+}
+
+// 触摸唤醒: 睡眠通道的阈值是相对硬件基准值的增量, 按驱动阈值相对驱动基准值的比例换算到当前硬件基准值
+static esp_err_t touch_arm_wakeup(activity_sleep_t depth, void *arg)
+{
+    uint32_t baseline = touch_sensor_get_baseline(TOUCH_WAKE_PAD);
+    uint32_t threshold = touch_sensor_get_threshold(TOUCH_WAKE_PAD);
+    uint32_t benchmark = 0;
+    if (baseline == 0 || threshold <= baseline ||
+        touch_pad_read_benchmark(TOUCH_WAKE_PAD, &benchmark) != ESP_OK || benchmark == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint32_t delta = (uint32_t)((uint64_t)benchmark * (threshold - baseline) / baseline);
+    
+    esp_err_t ret = touch_pad_sleep_channel_enable(TOUCH_WAKE_PAD, true);
+    if (ret == ESP_OK) {
+        ret = touch_pad_sleep_set_threshold(TOUCH_WAKE_PAD, delta > 0 ? delta : 1);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_sleep_enable_touchpad_wakeup();
+    }
+    return ret;
+}
+
+// IMU唤醒: INT1作为EXT1唤醒源, 轻度和深度睡眠都可以; INT1未连接时返回ESP_ERR_NOT_SUPPORTED
+static esp_err_t imu_arm_wakeup(activity_sleep_t depth, void *arg)
+{
+    return qmi8658_enable_wakeup();
+}
+
+// 串口唤醒: 只支持轻度睡眠
+static esp_err_t uart_arm_wakeup(activity_sleep_t depth, void *arg)
+{
+    if (depth == ACTIVITY_SLEEP_DEEP) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    esp_err_t ret = uart_set_wakeup_threshold(CONFIG_ESP_CONSOLE_UART_NUM, UART_WAKE_EDGES);
+    if (ret == ESP_OK) {
+        ret = esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM);
+    }
+    return ret;
+}
+
+// 按键轮询任务: 状态变化计为活动, 按住期间不睡眠
+static void key_poll_task(void *arg)
+{
+    bool last_pressed = false;
+    bool keys[4] = {false};
+    while (1) {
+        bool pressed = (gpio_get_level(WAKEUP_GPIO_NUM) == 0);
+        if (keys_ready && xl9555_keys_read_all(keys) == ESP_OK) {
+            for (int i = 0; i < 4; i++) {
+                pressed = pressed || keys[i];
+            }
+        }
+        if (pressed != last_pressed) {
+            activity_tracker_set_busy(ACTIVITY_SRC_KEY, pressed);
+            last_pressed = pressed;
+        }
+        vTaskDelay(pdMS_TO_TICKS(KEY_POLL_MS));
+    }
+}
+
+// IMU运动查询任务: 每次运动计为一次活动 (INT1连接时只读引脚电平, 不访问I2C)
+static void imu_poll_task(void *arg)
+{
+    while (1) {
+        bool moved = false;
+        if (qmi8658_poll_motion(&moved) == ESP_OK && moved) {
+            activity_tracker_report(ACTIVITY_SRC_IMU);
+        }
+        vTaskDelay(pdMS_TO_TICKS(QMI8658_MOTION_POLL_MS));
+    }
+}
+
+// 触摸回调: 手指在通道上期间不睡眠
+static void touch_activity_callback(uint32_t touched_mask, uint32_t changed_mask)
+{
+    activity_tracker_set_busy(ACTIVITY_SRC_TOUCH, touched_mask != 0);
+}
+
+#if CONFIG_ESP_CONSOLE_UART
+// 控制台串口接收任务: 只在收到数据时被驱动的事件队列唤醒
+static void uart_rx_task(void *arg)
+{
+    QueueHandle_t queue = (QueueHandle_t)arg;
+    uart_event_t event;
+    uint8_t buf[64];
+    while (1) {
+        if (xQueueReceive(queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (event.type == UART_DATA) {
+            while (uart_read_bytes(CONFIG_ESP_CONSOLE_UART_NUM, buf, sizeof(buf), 0) > 0) {
+            }
+            activity_tracker_report(ACTIVITY_SRC_UART);
+        } else if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+            uart_flush_input(CONFIG_ESP_CONSOLE_UART_NUM);
+            activity_tracker_report(ACTIVITY_SRC_UART);
+        }
+    }
+}
+#endif
+
+// 启动活动跟踪: 所有输入源报告活动, 空闲到期后按策略睡眠; 必须在注册驱动钩子之后
+static void start_activity_tracking(void)
+{
+    if (activity_tracker_init(idle_policies, sizeof(idle_policies) / sizeof(idle_policies[0])) != ESP_OK) {
+        ESP_LOGE(TAG, "活动跟踪初始化失败, 不会自动睡眠");
+        return;
+    }
+    
+    const activity_wake_source_t key_wake = {
+        .arm = key_arm_wakeup, .arg = NULL, .cause = ESP_SLEEP_WAKEUP_EXT0,
+    };
+    activity_tracker_register_wake_source(ACTIVITY_SRC_KEY, &key_wake);
+    xTaskCreate(key_poll_task, "key_poll", 3072, NULL, 3, NULL);
+    
+    if (touch_ready) {
+        const activity_wake_source_t touch_wake = {
+            .arm = touch_arm_wakeup, .arg = NULL, .cause = ESP_SLEEP_WAKEUP_TOUCHPAD,
+        };
+        activity_tracker_register_wake_source(ACTIVITY_SRC_TOUCH, &touch_wake);
+        touch_sensor_set_interrupt_callback(touch_activity_callback);
+        touch_sensor_enable_interrupt();
+        touch_sensor_start_task();
+    }
+    
+    if (imu_ready) {
+        const activity_wake_source_t imu_wake = {
+            .arm = imu_arm_wakeup, .arg = NULL, .cause = ESP_SLEEP_WAKEUP_EXT1,
+        };
+        activity_tracker_register_wake_source(ACTIVITY_SRC_IMU, &imu_wake);
+        xTaskCreate(imu_poll_task, "imu_poll", 3072, NULL, 3, NULL);
+    }
+    
+#if CONFIG_ESP_CONSOLE_UART
+    QueueHandle_t uart_queue = NULL;
+    esp_err_t ret = uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, UART_RX_BUF_SIZE, 0, 8, &uart_queue, 0);
+    if (ret == ESP_OK) {
+        const activity_wake_source_t uart_wake = {
+            .arm = uart_arm_wakeup, .arg = NULL, .cause = ESP_SLEEP_WAKEUP_UART,
+        };
+        activity_tracker_register_wake_source(ACTIVITY_SRC_UART, &uart_wake);
+        xTaskCreate(uart_rx_task, "uart_rx", 3072, uart_queue, 3, NULL);
+    } else {
+        ESP_LOGW(TAG, "安装控制台串口驱动失败: %s, 串口输入不计为活动", esp_err_to_name(ret));
+    }
+#endif
 }
 
 void app_main(void)
 {
+#if DEMO_WAKE_BENCH
+    // 深度睡眠测试的每次唤醒都从这里继续, 必须在任何初始化之前
+    wake_bench_result_t bench_result;
+    esp_err_t bench_ret = wake_bench_resume(&bench_result);
+    if (bench_ret != ESP_ERR_NOT_FOUND) {
+        if (bench_ret != ESP_OK) {
+            ESP_LOGE(TAG, "深度睡眠测试提前结束: %s", esp_err_to_name(bench_ret));
+        }
+        wake_bench_print(&bench_result);
+        while (1) {
+            vTaskDelay(portMAX_DELAY);
+        }
+    }
+#endif
+    
     ESP_LOGI(TAG, "系统启动，开始休眠唤醒功能演示");
     
+    // 动态调频和自动轻度睡眠: 驱动只在传输或处理事件时持有PM锁, 其余时间降到最低频率或睡眠;
+    // 活动跟踪注册的唤醒源 (按键、触摸、串口) 同时用于自动轻度睡眠, 空闲更久时按策略睡眠
+    power_manager_init(NULL);
+    
     // 配置GPIO0为输入，启用内部上拉电阻
     gpio_config_t io_conf = {
         .pin_bit_mask = (1ULL << WAKEUP_GPIO_NUM),
@@ -92,22 +402,37 @@ void app_main(void)
     
     ESP_LOGI(TAG, "GPIO%d 已配置为输入模式，启用内部上拉电阻", WAKEUP_GPIO_NUM);
     
-    // 配置GPIO唤醒源
-    // 当GPIO0接地（按钮按下）时唤醒
-    esp_sleep_enable_ext0_wakeup(WAKEUP_GPIO_NUM, 0);
-    ESP_LOGI(TAG, "已启用GPIO%d作为唤醒源，低电平触发", WAKEUP_GPIO_NUM);
+    // 启动睡眠管理并注册驱动钩子
+    ESP_ERROR_CHECK(sleep_manager_init());
+    register_sleep_hooks();
     
-    // 创建定时器，10秒后进入睡眠
-    esp_timer_create_args_t timer_args = {
-        .callback = &sleep_timer_callback,
-        .arg = NULL,
-        .name = "sleep_timer"
-    };
-    esp_timer_create(&timer_args, &sleep_timer);
-    esp_timer_start_once(sleep_timer, SLEEP_DELAY_MS * 1000);
+    // 深度睡眠唤醒时驱动从RTC内存恢复, 跳过引脚检查、芯片配置和基准值建立
+    ESP_LOGI(TAG, "启动到就绪: %" PRId64 "ms (%s)", esp_timer_get_time() / 1000,
+             i2c_master_is_warm_boot() ? "深度睡眠热启动" : "冷启动");
+    
+#if DEMO_WAKE_BENCH
+    // 驱动都已初始化并注册了钩子, 测试期间由测试自己请求睡眠
+    wake_bench_config_t bench_config = WAKE_BENCH_DEFAULT_CONFIG(DEMO_BENCH_MODE, DEMO_BENCH_SOURCE);
+    esp_err_t ret = wake_bench_run(&bench_config, &bench_result);
+    if (ret == ESP_OK) {
+        wake_bench_print(&bench_result);
+    } else {
+        ESP_LOGE(TAG, "唤醒延迟测试失败: %s", esp_err_to_name(ret));
+    }
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(POWER_REPORT_MS));
+        power_manager_report();
+    }
+#endif
+    
+    sleep_manager_set_wake_callback(wake_callback, NULL);
+    
+    // 唤醒源由活动跟踪在每次睡眠前按策略配置
+    start_activity_tracking();
     
-    ESP_LOGI(TAG, "定时器已启动，%d秒后将自动进入轻度睡眠模式", SLEEP_DELAY_MS / 1000);
-    ESP_LOGI(TAG, "按下GPIO%d按钮可以立即唤醒系统", WAKEUP_GPIO_NUM);
+    ESP_LOGI(TAG, "没有任何输入%d秒后将自动进入轻度睡眠模式", IDLE_LIGHT_MS / 1000);
+    ESP_LOGI(TAG, "按下GPIO%d按钮、触摸T%d或串口输入可以唤醒系统%s", WAKEUP_GPIO_NUM, TOUCH_WAKE_PAD,
+             (imu_ready && QMI8658_INT_CONNECTED) ? ", 晃动开发板也可以" : "");
     
     // 主循环
     while (1) {
@@ -115,6 +440,7 @@ void app_main(void)
         // int button_state = gpio_get_level(WAKEUP_GPIO_NUM);
         // ESP_LOGI(TAG, "系统运行中... GPIO%d状态: %s", WAKEUP_GPIO_NUM, 
         //          button_state == 0 ? "低电平(按钮按下)" : "高电平(按钮释放)");
-        vTaskDelay(pdMS_TO_TICKS(1000)); // 每1秒打印一次状态
+        vTaskDelay(pdMS_TO_TICKS(POWER_REPORT_MS));
+        power_manager_report();
     }
 }
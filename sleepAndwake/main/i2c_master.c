@@ -0,0 +1,386 @@
+/*
+ * SPDX-FileCopyrightText: 2010-2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "i2c_master.h"
+#include "driver/i2c.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "power_manager.h"
+
+static const char *TAG = "I2C_MASTER";
+
+// 总线锁: 每次传输持有, 睡眠期间由睡眠前钩子持有
+static SemaphoreHandle_t bus_lock = NULL;
+
+// PM锁: 只在传输期间持有, 传输中不降频也不进入自动轻度睡眠
+static power_lock_handle_t pm_lock = NULL;
+
+// 热状态: 深度睡眠前保存到RTC内存, 唤醒复位后跳过引脚检查和扫描
+#define I2C_RTC_MAGIC   0x49324331      // "I2C1"
+typedef struct {
+    uint32_t magic;
+    uint8_t scl_io;                     // 保存时的引脚, 与当前配置不同时不使用
+    uint8_t sda_io;
+    bool pins_ok;                       // 引脚检查通过
+    bool scan_valid;                    // 扫描结果有效
+    uint32_t scan_map[4];               // 扫描到的设备地址位图
+    int scan_count;
+} i2c_rtc_state_t;
+static RTC_DATA_ATTR i2c_rtc_state_t rtc_state;
+
+static bool warm_boot = false;          // 本次启动是否从RTC内存恢复
+static bool pins_ok = false;
+static bool scan_valid = false;
+static uint32_t scan_map[4];
+static int scan_count = 0;
+
+/**
+ * @brief RTC内存中的热状态是否可用: 只有深度睡眠唤醒时有效, 而且引脚配置没有变化
+ */
+static bool i2c_master_rtc_valid(void)
+{
+    return esp_reset_reason() == ESP_RST_DEEPSLEEP && rtc_state.magic == I2C_RTC_MAGIC &&
+           rtc_state.scl_io == I2C_MASTER_SCL_IO && rtc_state.sda_io == I2C_MASTER_SDA_IO;
+}
+
+/**
+ * @brief 执行一次传输, 持有总线锁
+ */
+static esp_err_t i2c_master_transfer(i2c_cmd_handle_t cmd, TickType_t timeout)
+{
+    if (bus_lock != NULL) {
+        xSemaphoreTake(bus_lock, portMAX_DELAY);
+    }
+    power_manager_lock_acquire(pm_lock);
+    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, timeout);
+    power_manager_lock_release(pm_lock);
+    if (bus_lock != NULL) {
+        xSemaphoreGive(bus_lock);
+    }
+    return ret;
+}
+
+/**
+ * @brief 检查I2C引脚连接状态
+ */
+esp_err_t i2c_check_connection(void)
+{
+    ESP_LOGI(TAG, "检查I2C引脚连接状态...");
+    
+    // 配置SCL和SDA为输入模式
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << I2C_MASTER_SCL_IO) | (1ULL << I2C_MASTER_SDA_IO),
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&io_conf);
+    
+    // 等待一段时间让信号稳定
+    vTaskDelay(100 / portTICK_PERIOD_MS);
+    
+    // 读取引脚状态
+    int scl_level = gpio_get_level(I2C_MASTER_SCL_IO);
+    int sda_level = gpio_get_level(I2C_MASTER_SDA_IO);
+    
+    ESP_LOGI(TAG, "SCL引脚(GPIO %d)电平: %d", I2C_MASTER_SCL_IO, scl_level);
+    ESP_LOGI(TAG, "SDA引脚(GPIO %d)电平: %d", I2C_MASTER_SDA_IO, sda_level);
+    
+    // 检查引脚是否被拉高（正常情况）
+    if (scl_level == 0 || sda_level == 0) {
+        ESP_LOGW(TAG, "警告: I2C引脚可能连接异常或短路!");
+        ESP_LOGW(TAG, "正常情况: SCL和SDA都应该被上拉电阻拉高(电平=1)");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ESP_LOGI(TAG, "I2C引脚连接状态正常");
+    return ESP_OK;
+}
+
+/**
+ * @brief I2C主机初始化
+ */
+esp_err_t i2c_master_init(void)
+{
+    // 深度睡眠唤醒时使用睡眠前的检查和扫描结果; 其他复位时RTC内存里的是旧数据, 清除
+    warm_boot = i2c_master_rtc_valid();
+    if (warm_boot) {
+        pins_ok = rtc_state.pins_ok;
+        scan_valid = rtc_state.scan_valid;
+        for (int i = 0; i < 4; i++) {
+            scan_map[i] = rtc_state.scan_map[i];
+        }
+        scan_count = rtc_state.scan_count;
+    } else {
+        rtc_state.magic = 0;
+    }
+    
+    // 首先检查引脚连接状态 (上次检查通过时跳过, 省去100ms等待)
+    if (warm_boot && pins_ok) {
+        ESP_LOGI(TAG, "深度睡眠唤醒, 跳过引脚检查");
+    } else {
+        esp_err_t check_result = i2c_check_connection();
+        pins_ok = (check_result == ESP_OK);
+        if (check_result != ESP_OK) {
+            ESP_LOGW(TAG, "I2C引脚检查失败，但继续初始化...");
+        }
+    }
+    
+    int i2c_master_port = I2C_MASTER_NUM;
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_MASTER_SDA_IO,
+        .scl_io_num = I2C_MASTER_SCL_IO,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+    };
+    
+    esp_err_t err = i2c_param_config(i2c_master_port, &conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "I2C参数配置失败: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    err = i2c_driver_install(i2c_master_port, conf.mode,
+                            I2C_MASTER_RX_BUF_DISABLE,
+                            I2C_MASTER_TX_BUF_DISABLE, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "I2C驱动安装失败: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    if (bus_lock == NULL) {
+        bus_lock = xSemaphoreCreateMutex();
+        if (bus_lock == NULL) {
+            ESP_LOGE(TAG, "创建I2C总线锁失败");
+            i2c_driver_delete(i2c_master_port);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    // 没有PM锁时照常传输, 只是不统计
+    if (pm_lock == NULL && power_manager_lock_create(ESP_PM_APB_FREQ_MAX, "i2c", &pm_lock) != ESP_OK) {
+        ESP_LOGW(TAG, "创建I2C PM锁失败");
+    }
+    
+    ESP_LOGI(TAG, "I2C主机初始化成功");
+    ESP_LOGI(TAG, "SCL引脚: %d, SDA引脚: %d", I2C_MASTER_SCL_IO, I2C_MASTER_SDA_IO);
+    ESP_LOGI(TAG, "I2C频率: %d Hz", I2C_MASTER_FREQ_HZ);
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief 测试I2C总线是否正常工作
+ */
+esp_err_t i2c_test_bus(void)
+{
+    ESP_LOGI(TAG, "测试I2C总线功能...");
+    
+    // 尝试发送一个通用的I2C命令来测试总线
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, 0x00, true);  // 通用调用地址
+    i2c_master_stop(cmd);
+    
+    esp_err_t ret = i2c_master_transfer(cmd, 100 / portTICK_PERIOD_MS);
+    i2c_cmd_link_delete(cmd);
+    
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "I2C总线测试成功 - 总线工作正常");
+        return ESP_OK;
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGW(TAG, "I2C总线测试超时 - 可能没有设备响应，但总线正常");
+        return ESP_OK;
+    } else {
+        ESP_LOGE(TAG, "I2C总线测试失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+}
+
+/**
+ * @brief I2C写数据到从设备
+ */
+esp_err_t i2c_master_write_slave(uint8_t slave_addr, uint8_t *data, size_t size)
+{
+    if (data == NULL || size == 0) {
+        ESP_LOGE(TAG, "无效的参数: data=%p, size=%zu", data, size);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (slave_addr << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write(cmd, data, size, true);
+    i2c_master_stop(cmd);
+    
+    esp_err_t ret = i2c_master_transfer(cmd, I2C_MASTER_TIMEOUT_MS / portTICK_PERIOD_MS);
+    i2c_cmd_link_delete(cmd);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2C写数据失败: %s", esp_err_to_name(ret));
+    }
+    
+    return ret;
+}
+
+/**
+ * @brief 从I2C从设备读取数据
+ */
+esp_err_t i2c_master_read_slave(uint8_t slave_addr, uint8_t *data, size_t size)
+{
+    if (data == NULL || size == 0) {
+        ESP_LOGE(TAG, "无效的参数: data=%p, size=%zu", data, size);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (slave_addr << 1) | I2C_MASTER_READ, true);
+    if (size > 1) {
+        i2c_master_read(cmd, data, size - 1, I2C_MASTER_ACK);
+    }
+    i2c_master_read_byte(cmd, data + size - 1, I2C_MASTER_NACK);
+    i2c_master_stop(cmd);
+    
+    esp_err_t ret = i2c_master_transfer(cmd, I2C_MASTER_TIMEOUT_MS / portTICK_PERIOD_MS);
+    i2c_cmd_link_delete(cmd);
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "I2C读数据失败: %s", esp_err_to_name(ret));
+    }
+    
+    return ret;
+}
+
+/**
+ * @brief 扫描I2C设备并返回发现的设备数量
+ */
+int i2c_scan_devices(void)
+{
+    // 深度睡眠期间总线上的设备不会变化, 直接使用睡眠前的结果
+    if (warm_boot && scan_valid) {
+        ESP_LOGI(TAG, "深度睡眠唤醒, 使用睡眠前的扫描结果: %d 个设备", scan_count);
+        return scan_count;
+    }
+    
+    ESP_LOGI(TAG, "开始扫描I2C设备...");
+    int device_count = 0;
+    uint32_t found[4] = {0};
+    
+    for (int i = 1; i < 128; i++) {
+        i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (i << 1) | I2C_MASTER_WRITE, true);
+        i2c_master_stop(cmd);
+        
+        esp_err_t ret = i2c_master_transfer(cmd, 50 / portTICK_PERIOD_MS);
+        i2c_cmd_link_delete(cmd);
+        
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "发现I2C设备，地址: 0x%02X", i);
+            found[i / 32] |= 1UL << (i % 32);
+            device_count++;
+        }
+    }
+    
+    for (int i = 0; i < 4; i++) {
+        scan_map[i] = found[i];
+    }
+    scan_count = device_count;
+    scan_valid = true;
+    
+    ESP_LOGI(TAG, "I2C设备扫描完成，共发现 %d 个设备", device_count);
+    return device_count;
+}
+
+/**
+ * @brief 最近一次扫描是否发现了设备
+ */
+bool i2c_master_device_found(uint8_t addr)
+{
+    if (!scan_valid || addr >= 128) {
+        return false;
+    }
+    return (scan_map[addr / 32] & (1UL << (addr % 32))) != 0;
+}
+
+/**
+ * @brief 深度睡眠前保存热状态
+ */
+esp_err_t i2c_master_save_state(void)
+{
+    if (bus_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    rtc_state.scl_io = I2C_MASTER_SCL_IO;
+    rtc_state.sda_io = I2C_MASTER_SDA_IO;
+    rtc_state.pins_ok = pins_ok;
+    rtc_state.scan_valid = scan_valid;
+    for (int i = 0; i < 4; i++) {
+        rtc_state.scan_map[i] = scan_map[i];
+    }
+    rtc_state.scan_count = scan_count;
+    rtc_state.magic = I2C_RTC_MAGIC;
+    return ESP_OK;
+}
+
+/**
+ * @brief 本次启动是否从深度睡眠前保存的状态恢复
+ */
+bool i2c_master_is_warm_boot(void)
+{
+    return warm_boot;
+}
+
+/**
+ * @brief 睡眠前暂停I2C总线
+ */
+esp_err_t i2c_master_suspend(void)
+{
+    if (bus_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xSemaphoreTake(bus_lock, I2C_MASTER_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+        ESP_LOGW(TAG, "I2C总线忙, 不能进入睡眠");
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 唤醒后恢复I2C总线
+ */
+esp_err_t i2c_master_resume(void)
+{
+    if (bus_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreGive(bus_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 释放I2C驱动
+ */
+esp_err_t i2c_master_deinit(void)
+{
+    esp_err_t ret = i2c_driver_delete(I2C_MASTER_NUM);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "I2C驱动已释放");
+    } else {
+        ESP_LOGE(TAG, "I2C驱动释放失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+} 
\ No newline at end of file
@@ -0,0 +1,274 @@
+/*
+ * QMI8658 姿态传感器驱动实现 (只用于运动检测)
+ *
+ * 运动检测期间陀螺仪关闭, 加速度计低功耗128Hz运行, 芯片自己比较阈值, CPU不读样本;
+ * 每次运动INT1翻转一次电平, STATUS1的运动标志置位 (读后清除)
+ */
+
+#include "qmi8658.h"
+#include "i2c_master.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "driver/rtc_io.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "QMI8658";
+
+#define QMI8658_CHIP_ID             0x05    // WHO_AM_I的值
+
+// CTRL9命令, 用STATUSINT的bit7握手 (CTRL8 bit7=1)
+#define QMI8658_CMD_ACK             0x00
+#define QMI8658_CMD_WRITE_WOM       0x08    // 用CAL1_L/CAL1_H写入运动唤醒设置
+#define QMI8658_CMD_DONE            0x80    // STATUSINT中的命令完成位
+#define QMI8658_CMD_POLLS           100     // 等待命令完成的最多读取次数 (100kHz下约20ms)
+
+#define QMI8658_CTRL1_ADDR_AI       0x40    // 地址自动增加
+#define QMI8658_CTRL1_INT1_EN       0x08
+#define QMI8658_WOM_CTRL2           0x1C    // ACC 4g 低功耗128Hz
+#define QMI8658_WOM_CAL1_H          0x04    // bit7:6=00 使用INT1, 初始低电平; bit5:0 开启后忽略的样本数
+#define QMI8658_STATUS1_WOM         0x04    // STATUS1中的运动标志
+
+static bool initialized = false;
+#if QMI8658_INT_CONNECTED
+static bool wakeup_enabled = false;     // 开启过EXT1唤醒, 电平翻转后要重新配置
+static int last_level = -1;             // 上次看到的INT1电平
+#endif
+
+// 内部函数声明
+static esp_err_t qmi8658_write_register(uint8_t reg, uint8_t data);
+static esp_err_t qmi8658_read_register(uint8_t reg, uint8_t *data);
+static esp_err_t qmi8658_ctrl9_command(uint8_t cmd);
+#if QMI8658_INT_CONNECTED
+static esp_err_t qmi8658_arm_ext1(int level);
+#endif
+
+/**
+ * @brief QMI8658初始化
+ */
+esp_err_t qmi8658_init(void)
+{
+    ESP_LOGI(TAG, "初始化QMI8658...");
+
+    esp_err_t ret = qmi8658_check_presence();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "QMI8658芯片未找到, 不检测运动");
+        return ret;
+    }
+
+    qmi8658_write_register(QMI8658_REG_RESET, 0xB0);
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    // 先关闭传感器再改配置: CTRL9命令用STATUSINT握手, 写入阈值后只开加速度计
+    ret = qmi8658_write_register(QMI8658_REG_CTRL1, QMI8658_CTRL1_ADDR_AI);
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CTRL8, 0x80);
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CTRL7, 0x00);
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CTRL2, QMI8658_WOM_CTRL2);
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CAL1_L, QMI8658_WOM_THRESHOLD_MG);  // 1mg/LSB
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CAL1_H, QMI8658_WOM_CAL1_H);
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_ctrl9_command(QMI8658_CMD_WRITE_WOM);
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CTRL1, QMI8658_CTRL1_ADDR_AI | QMI8658_CTRL1_INT1_EN);
+    }
+    if (ret == ESP_OK) {
+        ret = qmi8658_write_register(QMI8658_REG_CTRL7, 0x01);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "配置运动检测失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+#if QMI8658_INT_CONNECTED
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << QMI8658_INT_IO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    gpio_config(&io_conf);
+    last_level = gpio_get_level(QMI8658_INT_IO);
+#endif
+
+    initialized = true;
+    ESP_LOGI(TAG, "QMI8658运动检测已开启: 阈值%dmg, INT1: %s", QMI8658_WOM_THRESHOLD_MG,
+             QMI8658_INT_CONNECTED ? "已连接" : "未连接 (查询)");
+    return ESP_OK;
+}
+
+/**
+ * @brief 检查芯片是否存在
+ */
+esp_err_t qmi8658_check_presence(void)
+{
+    uint8_t id = 0;
+    esp_err_t ret = qmi8658_read_register(QMI8658_REG_WHO_AM_I, &id);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (id != QMI8658_CHIP_ID) {
+        ESP_LOGW(TAG, "芯片ID不对: 0x%02X", id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 检查上次调用以来是否有运动
+ */
+esp_err_t qmi8658_poll_motion(bool *moved)
+{
+    if (moved == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *moved = false;
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#if QMI8658_INT_CONNECTED
+    int level = gpio_get_level(QMI8658_INT_IO);
+    if (level != last_level) {
+        last_level = level;
+        *moved = true;
+        if (wakeup_enabled) {
+            return qmi8658_arm_ext1(level);
+        }
+    }
+    return ESP_OK;
+#else
+    uint8_t status = 0;
+    esp_err_t ret = qmi8658_read_register(QMI8658_REG_STATUS1, &status);
+    if (ret == ESP_OK) {
+        *moved = (status & QMI8658_STATUS1_WOM) != 0;
+    }
+    return ret;
+#endif
+}
+
+/**
+ * @brief 把INT1配置为EXT1唤醒源
+ */
+esp_err_t qmi8658_enable_wakeup(void)
+{
+#if !QMI8658_INT_CONNECTED
+    return ESP_ERR_NOT_SUPPORTED;   // INT1未连接, 在menuconfig中设置引脚
+#else
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!rtc_gpio_is_valid_gpio(QMI8658_INT_IO)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // 用当前电平: 上次查询之后的翻转由唤醒报告, 不会丢
+    esp_err_t ret = qmi8658_arm_ext1(gpio_get_level(QMI8658_INT_IO));
+    if (ret == ESP_OK) {
+        wakeup_enabled = true;
+    }
+    return ret;
+#endif
+}
+
+/**
+ * @brief 本次唤醒是否由运动触发
+ */
+bool qmi8658_motion_woke(void)
+{
+#if !QMI8658_INT_CONNECTED
+    return false;
+#else
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_EXT1) {
+        return false;
+    }
+    return (esp_sleep_get_ext1_wakeup_status() & (1ULL << QMI8658_INT_IO)) != 0;
+#endif
+}
+
+#if QMI8658_INT_CONNECTED
+/**
+ * @brief INT1每次运动翻转, 按给定电平的反向唤醒
+ */
+static esp_err_t qmi8658_arm_ext1(int level)
+{
+    return esp_sleep_enable_ext1_wakeup(1ULL << QMI8658_INT_IO,
+                                        level ? ESP_EXT1_WAKEUP_ANY_LOW : ESP_EXT1_WAKEUP_ANY_HIGH);
+}
+#endif
+
+/**
+ * @brief 执行CTRL9命令: 写命令后等命令完成位置位, 再写ACK等它清零
+ */
+static esp_err_t qmi8658_ctrl9_command(uint8_t cmd)
+{
+    uint8_t status = 0;
+    esp_err_t ret = qmi8658_write_register(QMI8658_REG_CTRL9, cmd);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    int i;
+    for (i = 0; i < QMI8658_CMD_POLLS; i++) {
+        ret = qmi8658_read_register(QMI8658_REG_STATUSINT, &status);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (status & QMI8658_CMD_DONE) {
+            break;
+        }
+    }
+    if (i == QMI8658_CMD_POLLS) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    ret = qmi8658_write_register(QMI8658_REG_CTRL9, QMI8658_CMD_ACK);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (i = 0; i < QMI8658_CMD_POLLS; i++) {
+        ret = qmi8658_read_register(QMI8658_REG_STATUSINT, &status);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (!(status & QMI8658_CMD_DONE)) {
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+/**
+ * @brief 写寄存器
+ */
+static esp_err_t qmi8658_write_register(uint8_t reg, uint8_t data)
+{
+    uint8_t write_data[2] = {reg, data};
+    return i2c_master_write_slave(QMI8658_I2C_ADDR, write_data, 2);
+}
+
+/**
+ * @brief 读寄存器
+ */
+static esp_err_t qmi8658_read_register(uint8_t reg, uint8_t *data)
+{
+    // 先写入寄存器地址
+    esp_err_t ret = i2c_master_write_slave(QMI8658_I2C_ADDR, &reg, 1);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 然后读取数据
+    return i2c_master_read_slave(QMI8658_I2C_ADDR, data, 1);
+}
@@ -0,0 +1,88 @@
+/*
+ * QMI8658 姿态传感器驱动头文件 (只用于运动检测)
+ *
+ * 从task_test的esp32_s3_szp.c移植运动唤醒 (WoM) 部分: 只开低功耗加速度计, 超过阈值时INT1翻转;
+ * 芯片地址: 0x6A (7位地址)
+ */
+
+#ifndef QMI8658_H
+#define QMI8658_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// QMI8658芯片地址
+#define QMI8658_I2C_ADDR            0x6A
+
+// QMI8658寄存器地址 (只列出用到的)
+#define QMI8658_REG_WHO_AM_I        0x00
+#define QMI8658_REG_CTRL1           0x02
+#define QMI8658_REG_CTRL2           0x03
+#define QMI8658_REG_CTRL7           0x08
+#define QMI8658_REG_CTRL8           0x09
+#define QMI8658_REG_CTRL9           0x0A
+#define QMI8658_REG_CAL1_L          0x0B
+#define QMI8658_REG_CAL1_H          0x0C
+#define QMI8658_REG_STATUSINT       0x2D
+#define QMI8658_REG_STATUS1         0x2F
+#define QMI8658_REG_RESET           0x60
+
+// 运动检测配置
+#define QMI8658_WOM_THRESHOLD_MG    100     // 运动阈值 (mg)
+#define QMI8658_MOTION_POLL_MS      200     // 运动查询周期, INT1未连接时每次读一次STATUS1
+
+// INT1引脚 (menuconfig设置), 默认-1表示未连接: 只能查询运动标志, 不能作为唤醒源
+#if defined(CONFIG_QMI8658_INT_GPIO) && CONFIG_QMI8658_INT_GPIO >= 0
+#define QMI8658_INT_CONNECTED       1
+#define QMI8658_INT_IO              CONFIG_QMI8658_INT_GPIO
+#else
+#define QMI8658_INT_CONNECTED       0
+#define QMI8658_INT_IO              (-1)
+#endif
+
+/**
+ * @brief QMI8658初始化: 检查芯片、复位并进入运动检测模式
+ * @note 需要先初始化I2C总线; 深度睡眠期间芯片一直供电, 唤醒复位后重新配置
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 芯片不存在, 其他值表示配置失败
+ */
+esp_err_t qmi8658_init(void);
+
+/**
+ * @brief 检查芯片是否存在
+ * @return ESP_OK 存在, ESP_ERR_NOT_FOUND 芯片ID不对, 其他值表示I2C通信失败
+ */
+esp_err_t qmi8658_check_presence(void);
+
+/**
+ * @brief 检查上次调用以来是否有运动
+ * @note INT1连接时只读引脚电平 (每次运动翻转一次), 不访问I2C; 未连接时读STATUS1的运动标志 (读后清除);
+ *       开启过唤醒时, 发现翻转后按新的电平重新配置EXT1, 否则电平触发的唤醒会立即再次唤醒
+ * @param moved 是否有运动
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化, 其他值表示I2C通信失败
+ */
+esp_err_t qmi8658_poll_motion(bool *moved);
+
+/**
+ * @brief 把INT1配置为EXT1唤醒源, 按当前电平的反向唤醒
+ * @note 轻度和深度睡眠都可以用; INT1必须是RTC GPIO (GPIO0 ~ GPIO21)
+ * @return ESP_OK 成功, ESP_ERR_NOT_SUPPORTED INT1未连接或不是RTC GPIO, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t qmi8658_enable_wakeup(void);
+
+/**
+ * @brief 本次唤醒是否由运动触发
+ * @return true 由INT1的EXT1唤醒, false 其他原因或INT1未连接
+ */
+bool qmi8658_motion_woke(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // QMI8658_H
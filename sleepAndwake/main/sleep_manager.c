@@ -0,0 +1,402 @@
+/*
+ * 睡眠管理实现
+ * 状态机: ACTIVE -> PREPARING -> SLEEPING -> RESUMING -> ACTIVE; 睡眠前钩子失败时从PREPARING
+ * 恢复已经暂停的驱动后直接回到ACTIVE. 深度睡眠在PREPARING之后调用保存钩子, 从SLEEPING复位. 唤醒到就绪期间不打印日志, 统计和日志都在所有驱动恢复之后
+ */
+
+#include "sleep_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+
+static const char *TAG = "SLEEP_MGR";
+
+static sleep_hook_t hooks[SLEEP_MANAGER_MAX_HOOKS];
+static int hook_count = 0;
+static portMUX_TYPE hook_lock = portMUX_INITIALIZER_UNLOCKED;   // 保护钩子表和统计
+
+static TaskHandle_t manager_task_handle = NULL;
+static uint32_t requested_ms = 0;       // 最近一次请求的睡眠时间
+static bool requested_deep = false;     // 最近一次请求是否为深度睡眠
+static sleep_state_t state = SLEEP_STATE_ACTIVE;
+static sleep_wake_callback_t wake_callback = NULL;
+static void *wake_callback_arg = NULL;
+
+static sleep_manager_stats_t stats;
+static uint64_t resume_total_us = 0;
+
+/**
+ * @brief 切换状态
+ */
+static inline void sleep_manager_set_state(sleep_state_t new_state)
+{
+    __atomic_store_n(&state, new_state, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 按注册顺序恢复 [first, count) 范围内的钩子
+ * @param info 不为NULL时记录最慢的钩子
+ */
+static void sleep_manager_resume_hooks(const sleep_hook_t *list, int first, int count, sleep_wake_info_t *info)
+{
+    for (int i = first; i < count; i++) {
+        if (list[i].resume == NULL) {
+            continue;
+        }
+        int64_t start = esp_timer_get_time();
+        esp_err_t ret = list[i].resume(list[i].arg);
+        uint32_t cost = (uint32_t)(esp_timer_get_time() - start);
+        if (info != NULL && (info->slowest_hook < 0 || cost > info->slowest_hook_us)) {
+            info->slowest_hook = i;
+            info->slowest_hook_us = cost;
+        }
+        if (ret != ESP_OK) {
+            // 唤醒路径上不能放弃, 记录后继续恢复其他驱动
+            ESP_LOGW(TAG, "%s 恢复失败: %s", list[i].name, esp_err_to_name(ret));
+        }
+    }
+}
+
+/**
+ * @brief 复制钩子表, 执行期间注册新钩子不影响本次睡眠
+ * @return 钩子数
+ */
+static int sleep_manager_copy_hooks(sleep_hook_t *list)
+{
+    portENTER_CRITICAL(&hook_lock);
+    int count = hook_count;
+    for (int i = 0; i < count; i++) {
+        list[i] = hooks[i];
+    }
+    portEXIT_CRITICAL(&hook_lock);
+    return count;
+}
+
+/**
+ * @brief 按相反顺序调用睡眠前钩子: 先停设备, 最后停总线
+ * @return ESP_OK 全部成功, 否则已经恢复暂停过的驱动并回到ACTIVE
+ */
+static esp_err_t sleep_manager_prepare_hooks(const sleep_hook_t *list, int count)
+{
+    sleep_manager_set_state(SLEEP_STATE_PREPARING);
+    for (int i = count - 1; i >= 0; i--) {
+        if (list[i].prepare == NULL) {
+            continue;
+        }
+        esp_err_t ret = list[i].prepare(list[i].arg);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "%s 拒绝睡眠: %s", list[i].name, esp_err_to_name(ret));
+            sleep_manager_resume_hooks(list, i + 1, count, NULL);
+            sleep_manager_set_state(SLEEP_STATE_ACTIVE);
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 执行一次睡眠
+ * @param rejected 返回是否在钩子都执行过之后被esp_light_sleep_start拒绝
+ * @return ESP_OK 睡眠完成, 其他值表示睡眠前钩子失败或esp_light_sleep_start失败, 驱动都已恢复
+ */
+static esp_err_t sleep_manager_enter(sleep_wake_info_t *info, bool *rejected)
+{
+    sleep_hook_t list[SLEEP_MANAGER_MAX_HOOKS];
+    int count = sleep_manager_copy_hooks(list);
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = sleep_manager_prepare_hooks(list, count);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    info->prepare_us = (uint32_t)(esp_timer_get_time() - start);
+
+    if (info->requested_ms > 0) {
+        esp_sleep_enable_timer_wakeup((uint64_t)info->requested_ms * 1000);
+    } else {
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    }
+
+    sleep_manager_set_state(SLEEP_STATE_SLEEPING);
+    int64_t sleep_at = esp_timer_get_time();
+    ret = esp_light_sleep_start();
+    int64_t wake_at = esp_timer_get_time();
+
+    sleep_manager_set_state(SLEEP_STATE_RESUMING);
+    info->cause = (ret == ESP_OK) ? esp_sleep_get_wakeup_cause() : ESP_SLEEP_WAKEUP_UNDEFINED;
+    sleep_manager_resume_hooks(list, 0, count, info);
+    int64_t ready_at = esp_timer_get_time();
+    sleep_manager_set_state(SLEEP_STATE_ACTIVE);
+
+    info->slept_us = (uint32_t)(wake_at - sleep_at);
+    info->wake_time_us = wake_at;
+    info->resume_us = (uint32_t)(ready_at - wake_at);
+    if (ret != ESP_OK) {
+        // 没有睡着 (如ESP_ERR_SLEEP_REJECT: 准备期间有唤醒源触发), 不计入睡眠次数和唤醒时间
+        ESP_LOGW(TAG, "进入轻度睡眠失败: %s", esp_err_to_name(ret));
+        *rejected = true;
+    }
+    return ret;
+}
+
+/**
+ * @brief 按相反顺序调用保存钩子
+ */
+static esp_err_t sleep_manager_save_hooks(const sleep_hook_t *list, int count)
+{
+    esp_err_t result = ESP_OK;
+    for (int i = count - 1; i >= 0; i--) {
+        if (list[i].save == NULL) {
+            continue;
+        }
+        esp_err_t ret = list[i].save(list[i].arg);
+        if (ret != ESP_OK) {
+            // 保存失败只是下次冷启动, 不影响睡眠
+            ESP_LOGW(TAG, "%s 保存状态失败: %s", list[i].name, esp_err_to_name(ret));
+            if (result == ESP_OK) {
+                result = ret;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 进入深度睡眠, 成功时不返回
+ * @return 睡眠前钩子失败的错误码
+ */
+static esp_err_t sleep_manager_enter_deep(uint32_t duration_ms)
+{
+    sleep_hook_t list[SLEEP_MANAGER_MAX_HOOKS];
+    int count = sleep_manager_copy_hooks(list);
+    esp_err_t ret = sleep_manager_prepare_hooks(list, count);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 设备都已停止, 这时保存的状态就是睡眠期间的状态
+    sleep_manager_save_hooks(list, count);
+
+    if (duration_ms > 0) {
+        esp_sleep_enable_timer_wakeup((uint64_t)duration_ms * 1000);
+    } else {
+        esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    }
+    sleep_manager_set_state(SLEEP_STATE_SLEEPING);
+    esp_deep_sleep_start();
+    return ESP_OK;
+}
+
+/**
+ * @brief 记录一次睡眠
+ * @param ret sleep_manager_enter的返回值
+ * @param rejected 是否被esp_light_sleep_start拒绝
+ */
+static void sleep_manager_record(const sleep_wake_info_t *info, esp_err_t ret, bool rejected)
+{
+    portENTER_CRITICAL(&hook_lock);
+    if (rejected) {
+        stats.reject_count++;
+    } else if (ret != ESP_OK) {
+        stats.abort_count++;
+    } else {
+        if (stats.sleep_count == 0 || info->resume_us < stats.resume_min_us) {
+            stats.resume_min_us = info->resume_us;
+        }
+        if (info->resume_us > stats.resume_max_us) {
+            stats.resume_max_us = info->resume_us;
+        }
+        stats.sleep_count++;
+        stats.total_slept_us += info->slept_us;
+        resume_total_us += info->resume_us;
+        stats.resume_avg_us = (uint32_t)(resume_total_us / stats.sleep_count);
+        stats.last = *info;
+    }
+    portEXIT_CRITICAL(&hook_lock);
+}
+
+/**
+ * @brief 管理任务: 等待睡眠请求并执行
+ */
+static void sleep_manager_task(void *pvParameters)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (__atomic_load_n(&requested_deep, __ATOMIC_RELAXED)) {
+            // 只有睡眠前钩子拒绝时才会返回
+            sleep_manager_enter_deep(__atomic_load_n(&requested_ms, __ATOMIC_RELAXED));
+            sleep_manager_record(NULL, ESP_FAIL, false);
+            continue;
+        }
+
+        sleep_wake_info_t info = {
+            .requested_ms = __atomic_load_n(&requested_ms, __ATOMIC_RELAXED),
+            .slowest_hook = -1,
+        };
+        bool rejected = false;
+        esp_err_t ret = sleep_manager_enter(&info, &rejected);
+        sleep_manager_record(&info, ret, rejected);
+        if (ret != ESP_OK) {
+            continue;
+        }
+
+        // 所有驱动已经恢复, 现在才打印日志和通知应用
+        ESP_LOGI(TAG, "唤醒: %s, 睡眠%" PRIu32 "ms, 睡眠前%" PRIu32 "us, 唤醒到就绪%" PRIu32 "us",
+                 sleep_manager_cause_name(info.cause), info.slept_us / 1000, info.prepare_us, info.resume_us);
+        if (wake_callback != NULL) {
+            wake_callback(&info, wake_callback_arg);
+        }
+    }
+}
+
+/**
+ * @brief 初始化睡眠管理并创建管理任务
+ */
+esp_err_t sleep_manager_init(void)
+{
+    if (manager_task_handle != NULL) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(sleep_manager_task, "sleep_mgr", SLEEP_MANAGER_TASK_STACK, NULL,
+                    SLEEP_MANAGER_TASK_PRIO, &manager_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "创建睡眠管理任务失败");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "睡眠管理已启动");
+    return ESP_OK;
+}
+
+/**
+ * @brief 注册驱动钩子
+ */
+esp_err_t sleep_manager_register_hook(const sleep_hook_t *hook)
+{
+    if (hook == NULL || hook->name == NULL || (hook->prepare == NULL && hook->resume == NULL && hook->save == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&hook_lock);
+    if (hook_count >= SLEEP_MANAGER_MAX_HOOKS) {
+        portEXIT_CRITICAL(&hook_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    hooks[hook_count++] = *hook;
+    portEXIT_CRITICAL(&hook_lock);
+
+    ESP_LOGI(TAG, "注册睡眠钩子: %s", hook->name);
+    return ESP_OK;
+}
+
+/**
+ * @brief 请求进入轻度睡眠
+ */
+esp_err_t sleep_manager_request(uint32_t duration_ms)
+{
+    if (manager_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    __atomic_store_n(&requested_ms, duration_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&requested_deep, false, __ATOMIC_RELAXED);
+    xTaskNotifyGive(manager_task_handle);
+    return ESP_OK;
+}
+
+/**
+ * @brief 请求进入深度睡眠
+ */
+esp_err_t sleep_manager_request_deep(uint32_t duration_ms)
+{
+    if (manager_task_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    __atomic_store_n(&requested_ms, duration_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&requested_deep, true, __ATOMIC_RELAXED);
+    xTaskNotifyGive(manager_task_handle);
+    return ESP_OK;
+}
+
+/**
+ * @brief 调用所有保存钩子
+ */
+esp_err_t sleep_manager_save_state(void)
+{
+    sleep_hook_t list[SLEEP_MANAGER_MAX_HOOKS];
+    int count = sleep_manager_copy_hooks(list);
+
+    return sleep_manager_save_hooks(list, count);
+}
+
+/**
+ * @brief 设置唤醒回调
+ */
+void sleep_manager_set_wake_callback(sleep_wake_callback_t callback, void *arg)
+{
+    wake_callback_arg = arg;
+    wake_callback = callback;
+}
+
+/**
+ * @brief 获取当前状态
+ */
+sleep_state_t sleep_manager_get_state(void)
+{
+    return __atomic_load_n(&state, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 获取睡眠统计
+ */
+esp_err_t sleep_manager_get_stats(sleep_manager_stats_t *out)
+{
+    if (out == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&hook_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&hook_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取钩子名称
+ */
+const char *sleep_manager_hook_name(int index)
+{
+    if (index < 0 || index >= hook_count) {
+        return "?";
+    }
+    return hooks[index].name;
+}
+
+/**
+ * @brief 唤醒原因的中文名称
+ */
+const char *sleep_manager_cause_name(esp_sleep_wakeup_cause_t cause)
+{
+    switch (cause) {
+    case ESP_SLEEP_WAKEUP_EXT0:
+        return "EXT0唤醒";
+    case ESP_SLEEP_WAKEUP_EXT1:
+        return "EXT1唤醒";
+    case ESP_SLEEP_WAKEUP_TIMER:
+        return "定时器唤醒";
+    case ESP_SLEEP_WAKEUP_TOUCHPAD:
+        return "触摸唤醒";
+    case ESP_SLEEP_WAKEUP_GPIO:
+        return "GPIO唤醒";
+    case ESP_SLEEP_WAKEUP_UART:
+        return "串口唤醒";
+    case ESP_SLEEP_WAKEUP_UNDEFINED:
+        return "未定义";
+    default:
+        return "其他原因";
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * 睡眠管理头文件
+ * 由单独的任务执行睡眠: 任何任务或定时器回调只提交睡眠请求, 管理任务按注册的相反顺序调用各驱动的
+ * 睡眠前钩子 (保存状态、停止传输), 进入轻度睡眠, 唤醒后按注册顺序调用唤醒后钩子恢复状态,
+ * 然后报告唤醒原因、睡眠时长和唤醒到就绪的时间; 深度睡眠前还会调用保存钩子, 把驱动的热状态写入RTC内存,
+ * 唤醒复位后驱动初始化时据此跳过慢速步骤
+ */
+
+#ifndef SLEEP_MANAGER_H
+#define SLEEP_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_sleep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 睡眠管理配置
+#define SLEEP_MANAGER_MAX_HOOKS     8       // 最多注册的钩子数
+#define SLEEP_MANAGER_TASK_STACK    4096    // 管理任务栈大小
+#define SLEEP_MANAGER_TASK_PRIO     (configMAX_PRIORITIES - 2)  // 高优先级, 唤醒后先恢复驱动再让其他任务运行
+
+/**
+ * @brief 睡眠管理状态
+ */
+typedef enum {
+    SLEEP_STATE_ACTIVE,         // 正常运行
+    SLEEP_STATE_PREPARING,      // 正在调用睡眠前钩子
+    SLEEP_STATE_SLEEPING,       // 轻度睡眠中
+    SLEEP_STATE_RESUMING,       // 正在调用唤醒后钩子
+} sleep_state_t;
+
+/**
+ * @brief 钩子函数
+ * @param arg 注册时的参数
+ * @return ESP_OK 成功; 睡眠前钩子返回错误时取消本次睡眠, 已经执行过的钩子会被恢复
+ */
+typedef esp_err_t (*sleep_hook_fn_t)(void *arg);
+
+/**
+ * @brief 驱动钩子
+ * @note 按注册顺序恢复, 按相反顺序暂停: 先注册底层 (如I2C总线), 再注册依赖它的设备 (如XL9555)
+ */
+typedef struct {
+    const char *name;           // 名称, 用于日志和统计
+    sleep_hook_fn_t prepare;    // 睡眠前调用, 可以为NULL
+    sleep_hook_fn_t resume;     // 唤醒后调用, 可以为NULL
+    void *arg;                  // 钩子参数
+    sleep_hook_fn_t save;       // 深度睡眠前在prepare之后调用, 保存热状态到RTC内存 (总线已暂停, 不能再传输), 可以为NULL
+} sleep_hook_t;
+
+/**
+ * @brief 一次睡眠的结果
+ */
+typedef struct {
+    esp_sleep_wakeup_cause_t cause;     // 唤醒原因
+    uint32_t requested_ms;              // 请求的睡眠时间, 0表示只由唤醒源唤醒
+    uint32_t slept_us;                  // 实际睡眠时间
+    int64_t wake_time_us;               // CPU恢复运行的时间 (esp_light_sleep_start返回时的esp_timer_get_time)
+    uint32_t prepare_us;                // 睡眠前钩子总耗时
+    uint32_t resume_us;                 // 唤醒到就绪的时间 (所有唤醒后钩子完成)
+    int slowest_hook;                   // 唤醒后最慢的钩子编号, -1表示没有钩子
+    uint32_t slowest_hook_us;           // 最慢钩子的耗时
+} sleep_wake_info_t;
+
+/**
+ * @brief 唤醒回调, 在管理任务中所有驱动恢复之后调用
+ */
+typedef void (*sleep_wake_callback_t)(const sleep_wake_info_t *info, void *arg);
+
+/**
+ * @brief 睡眠统计
+ */
+typedef struct {
+    uint32_t sleep_count;               // 成功睡眠次数
+    uint32_t abort_count;               // 睡眠前钩子失败而取消的次数
+    uint32_t reject_count;              // 钩子执行后esp_light_sleep_start失败 (如ESP_ERR_SLEEP_REJECT) 的次数
+    uint64_t total_slept_us;            // 累计睡眠时间
+    uint32_t resume_min_us;             // 唤醒到就绪的最短时间
+    uint32_t resume_max_us;             // 唤醒到就绪的最长时间
+    uint32_t resume_avg_us;             // 唤醒到就绪的平均时间
+    sleep_wake_info_t last;             // 最近一次睡眠
+} sleep_manager_stats_t;
+
+/**
+ * @brief 初始化睡眠管理并创建管理任务
+ * @return ESP_OK 成功, ESP_FAIL 创建任务失败
+ */
+esp_err_t sleep_manager_init(void);
+
+/**
+ * @brief 注册驱动钩子
+ * @note 需要在请求睡眠之前注册; hook中的内容会被复制
+ * @param hook 钩子
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效, ESP_ERR_NO_MEM 钩子已满
+ */
+esp_err_t sleep_manager_register_hook(const sleep_hook_t *hook);
+
+/**
+ * @brief 请求进入轻度睡眠, 不阻塞, 可以在定时器回调中调用
+ * @param duration_ms 定时唤醒时间, 0表示只由已配置的唤醒源唤醒
+ * @return ESP_OK 已提交, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t sleep_manager_request(uint32_t duration_ms);
+
+/**
+ * @brief 请求进入深度睡眠, 不阻塞
+ * @note 管理任务按相反顺序调用睡眠前钩子和保存钩子后进入深度睡眠, 唤醒即复位, 不会返回;
+ *       睡眠前钩子失败时取消, 与轻度睡眠相同
+ * @param duration_ms 定时唤醒时间, 0表示只由已配置的唤醒源唤醒
+ * @return ESP_OK 已提交, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t sleep_manager_request_deep(uint32_t duration_ms);
+
+/**
+ * @brief 按相反顺序调用所有保存钩子
+ * @note 自己调用esp_deep_sleep_start的代码 (如唤醒延迟测试) 在睡眠前调用
+ * @return ESP_OK 全部成功, 否则返回第一个失败的错误码 (其余钩子照常调用)
+ */
+esp_err_t sleep_manager_save_state(void);
+
+/**
+ * @brief 设置唤醒回调
+ * @param callback 回调函数
+ * @param arg 回调参数
+ */
+void sleep_manager_set_wake_callback(sleep_wake_callback_t callback, void *arg);
+
+/**
+ * @brief 获取当前状态
+ */
+sleep_state_t sleep_manager_get_state(void);
+
+/**
+ * @brief 获取睡眠统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t sleep_manager_get_stats(sleep_manager_stats_t *stats);
+
+/**
+ * @brief 获取钩子名称, 用于打印最慢的钩子
+ * @param index 钩子编号
+ * @return 名称, 编号无效时返回"?"
+ */
+const char *sleep_manager_hook_name(int index);
+
+/**
+ * @brief 唤醒原因的中文名称
+ */
+const char *sleep_manager_cause_name(esp_sleep_wakeup_cause_t cause);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SLEEP_MANAGER_H
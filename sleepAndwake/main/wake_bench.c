@@ -0,0 +1,736 @@
+/*
+ * 唤醒延迟测试实现
+ * 每个样本记录各阶段的时间点, 减去参考点后保存在RTC内存中 (深度睡眠复位后继续累计), 测试结束时
+ * 排序得到分布. 时间点都在esp_timer时基上; 深度睡眠复位后esp_timer从0开始, 定时器唤醒的预定时刻
+ * 用gettimeofday (RTC时基, 睡眠期间继续计时) 换算
+ */
+
+#include "wake_bench.h"
+#include "sleep_manager.h"
+#include "power_manager.h"
+#include "i2c_master.h"
+#include "xl9555.h"
+#include "touch_sensor.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/rtc_io.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <inttypes.h>
+
+static const char *TAG = "WAKE_BENCH";
+
+#define WAKE_BENCH_MAGIC        0x57414B45      // "WAKE", RTC内存中的测试状态有效
+#define WAKE_BENCH_NA           UINT32_MAX      // 该阶段在本样本中没有记录
+#define WAKE_BENCH_POLL_MS      10              // 等待按钮或触摸释放的轮询间隔
+
+/**
+ * @brief 测试状态, 深度睡眠期间保存在RTC慢速内存
+ */
+typedef struct {
+    uint32_t magic;
+    wake_bench_config_t config;
+    uint32_t count;                     // 有效样本数
+    uint32_t timeouts;                  // 丢弃的样本数
+    int64_t expected_us;                // 深度睡眠定时器唤醒的预定时刻 (gettimeofday)
+    uint32_t samples[WAKE_BENCH_STAGE_MAX][WAKE_BENCH_MAX_SAMPLES];
+} wake_bench_state_t;
+
+static RTC_DATA_ATTR wake_bench_state_t bench_state;
+
+static TaskHandle_t bench_task = NULL;
+static QueueHandle_t wake_queue = NULL;         // 唤醒回调把睡眠结果交给测试任务
+static esp_timer_handle_t bench_timer = NULL;
+static power_lock_handle_t bench_lock = NULL;
+static bool hook_registered = false;
+static volatile int64_t isr_time = 0;           // 中断或定时器回调的时间
+static volatile bool running = false;
+
+/**
+ * @brief 模式名称
+ */
+static const char *wake_bench_mode_name(wake_bench_mode_t mode)
+{
+    switch (mode) {
+    case WAKE_BENCH_AWAKE:
+        return "清醒";
+    case WAKE_BENCH_LIGHT_SLEEP:
+        return "轻度睡眠";
+    case WAKE_BENCH_DEEP_SLEEP:
+        return "深度睡眠";
+    default:
+        return "?";
+    }
+}
+
+/**
+ * @brief 唤醒源名称
+ */
+static const char *wake_bench_source_name(wake_bench_source_t source)
+{
+    switch (source) {
+    case WAKE_BENCH_SRC_TIMER:
+        return "定时器";
+    case WAKE_BENCH_SRC_EXT0:
+        return "按钮";
+    case WAKE_BENCH_SRC_TOUCH:
+        return "触摸";
+    default:
+        return "?";
+    }
+}
+
+/**
+ * @brief 阶段名称
+ */
+static const char *wake_bench_stage_name(wake_bench_stage_t stage)
+{
+    static const char *names[WAKE_BENCH_STAGE_MAX] = {
+        [WAKE_BENCH_STAGE_WAKE] = "CPU恢复",
+        [WAKE_BENCH_STAGE_ISR] = "中断",
+        [WAKE_BENCH_STAGE_TASK] = "任务运行",
+        [WAKE_BENCH_STAGE_I2C] = "首次I2C",
+    };
+    return names[stage];
+}
+
+/**
+ * @brief RTC时基的当前时间, 深度睡眠期间继续计时
+ */
+static int64_t wake_bench_wall_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/**
+ * @brief 保存一个样本
+ * @param stamps 各阶段的时间点, 小于0表示没有记录或是参考点
+ * @param ref 参考点; 早于参考点的阶段 (如轻度睡眠中中断在esp_light_sleep_start返回前执行) 记为0
+ */
+static void wake_bench_record(const int64_t stamps[WAKE_BENCH_STAGE_MAX], int64_t ref)
+{
+    uint32_t index = bench_state.count;
+    if (index >= WAKE_BENCH_MAX_SAMPLES) {
+        return;
+    }
+    for (int s = 0; s < WAKE_BENCH_STAGE_MAX; s++) {
+        uint32_t value = WAKE_BENCH_NA;
+        if (stamps[s] >= 0) {
+            int64_t delta = stamps[s] - ref;
+            value = delta < 0 ? 0 : (delta >= WAKE_BENCH_NA ? WAKE_BENCH_NA - 1 : (uint32_t)delta);
+        }
+        bench_state.samples[s][index] = value;
+    }
+    bench_state.count++;
+}
+
+/**
+ * @brief 第一次I2C传输: 读XL9555输入寄存器
+ * @return 完成时间, I2C不可用时返回-1
+ */
+static int64_t wake_bench_first_i2c(void)
+{
+    bool pressed;
+    if (xl9555_key_read(XL9555_KEY0_PIN, &pressed) != ESP_OK) {
+        return -1;
+    }
+    return esp_timer_get_time();
+}
+
+/**
+ * @brief 按钮电平中断: 记录时间后关闭中断, 按钮释放后再打开
+ */
+static void IRAM_ATTR wake_bench_gpio_isr(void *arg)
+{
+    isr_time = esp_timer_get_time();
+    gpio_intr_disable((gpio_num_t)(intptr_t)arg);
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(bench_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief 清醒模式的定时器回调
+ */
+static void wake_bench_timer_callback(void *arg)
+{
+    isr_time = esp_timer_get_time();
+    xTaskNotifyGive(bench_task);
+}
+
+/**
+ * @brief 唤醒后钩子: 注册在最后, 定时器唤醒时所有驱动恢复后通知测试任务
+ */
+static esp_err_t wake_bench_resume_hook(void *arg)
+{
+    if (running && bench_state.config.source == WAKE_BENCH_SRC_TIMER) {
+        xTaskNotifyGive(bench_task);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 睡眠管理的唤醒回调, 把睡眠结果交给测试任务
+ */
+static void wake_bench_wake_callback(const sleep_wake_info_t *info, void *arg)
+{
+    xQueueOverwrite(wake_queue, info);
+}
+
+/**
+ * @brief 配置触摸唤醒
+ * @note 睡眠通道的阈值是相对外设硬件基准值的增量; 按驱动快照中阈值相对基准值的比例
+ *       换算到当前硬件基准值上, 两者都要已经建立
+ */
+static esp_err_t wake_bench_arm_touch(touch_pad_t pad)
+{
+    uint32_t baseline = touch_sensor_get_baseline(pad);
+    uint32_t threshold = touch_sensor_get_threshold(pad);
+    uint32_t benchmark = 0;
+    if (baseline == 0 || threshold <= baseline ||
+        touch_pad_read_benchmark(pad, &benchmark) != ESP_OK || benchmark == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    uint32_t delta = (uint32_t)((uint64_t)benchmark * (threshold - baseline) / baseline);
+
+    esp_err_t ret = touch_pad_sleep_channel_enable(pad, true);
+    if (ret == ESP_OK) {
+        ret = touch_pad_sleep_set_threshold(pad, delta > 0 ? delta : 1);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_sleep_enable_touchpad_wakeup();
+    }
+    return ret;
+}
+
+/**
+ * @brief 等待按钮或触摸释放, 否则下一个样本会立即触发
+ */
+static void wake_bench_wait_release(const wake_bench_config_t *cfg)
+{
+    TickType_t start = xTaskGetTickCount();
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(WAKE_BENCH_TIMEOUT_MS)) {
+        bool held = false;
+        if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+            held = gpio_get_level(cfg->gpio) == 0;
+        } else if (cfg->source == WAKE_BENCH_SRC_TOUCH) {
+            held = touch_sensor_is_touched(cfg->touch_pad);
+        }
+        if (!held) {
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(WAKE_BENCH_POLL_MS));
+    }
+    ESP_LOGW(TAG, "等待释放超时");
+}
+
+/**
+ * @brief 清醒模式的一个样本
+ * @return ESP_OK 已记录, ESP_ERR_TIMEOUT 超时
+ */
+static esp_err_t wake_bench_awake_sample(const wake_bench_config_t *cfg)
+{
+    int64_t stamps[WAKE_BENCH_STAGE_MAX] = { -1, -1, -1, -1 };
+    int64_t ref;
+    TickType_t timeout = pdMS_TO_TICKS(WAKE_BENCH_TIMEOUT_MS);
+
+    ulTaskNotifyTake(pdTRUE, 0);
+    if (cfg->source == WAKE_BENCH_SRC_TOUCH) {
+        // 触摸没有可测量的触发时刻, 以检测到触摸的扫描中断为参考
+        touch_sensor_snapshot_t snap;
+        touch_sensor_get_snapshot(&snap);
+        do {
+            if (touch_sensor_wait_change(&snap, timeout) != ESP_OK) {
+                return ESP_ERR_TIMEOUT;
+            }
+        } while (!(snap.touched_mask & (1UL << cfg->touch_pad)));
+        stamps[WAKE_BENCH_STAGE_TASK] = esp_timer_get_time();
+        ref = snap.timestamp_us;
+    } else {
+        if (cfg->source == WAKE_BENCH_SRC_TIMER) {
+            ref = esp_timer_get_time() + (int64_t)cfg->timer_ms * 1000;
+            esp_timer_start_once(bench_timer, (uint64_t)cfg->timer_ms * 1000);
+        } else {
+            gpio_intr_enable(cfg->gpio);
+            ref = esp_timer_get_time();
+            if (cfg->trigger_gpio >= 0) {
+                gpio_set_level((gpio_num_t)cfg->trigger_gpio, 0);
+            }
+        }
+        if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+            gpio_intr_disable(cfg->gpio);
+            return ESP_ERR_TIMEOUT;
+        }
+        stamps[WAKE_BENCH_STAGE_TASK] = esp_timer_get_time();
+        stamps[WAKE_BENCH_STAGE_ISR] = isr_time;
+        if (cfg->source == WAKE_BENCH_SRC_EXT0 && cfg->trigger_gpio < 0) {
+            // 手动按按钮时以中断为参考
+            ref = isr_time;
+            stamps[WAKE_BENCH_STAGE_ISR] = -1;
+        }
+    }
+    stamps[WAKE_BENCH_STAGE_I2C] = wake_bench_first_i2c();
+
+    if (cfg->source == WAKE_BENCH_SRC_EXT0 && cfg->trigger_gpio >= 0) {
+        gpio_set_level((gpio_num_t)cfg->trigger_gpio, 1);
+    }
+    wake_bench_record(stamps, ref);
+    return ESP_OK;
+}
+
+/**
+ * @brief 轻度睡眠模式的一个样本
+ * @note 按钮在轻度睡眠中用GPIO唤醒: EXT0会把引脚切换到RTC IO, 唤醒后数字GPIO中断就收不到电平了
+ * @return ESP_OK 已记录, ESP_ERR_TIMEOUT 超时, ESP_ERR_INVALID_RESPONSE 唤醒原因不符
+ */
+static esp_err_t wake_bench_light_sample(const wake_bench_config_t *cfg)
+{
+    int64_t stamps[WAKE_BENCH_STAGE_MAX] = { -1, -1, -1, -1 };
+    TickType_t timeout = pdMS_TO_TICKS(cfg->timer_ms + WAKE_BENCH_TIMEOUT_MS);
+    esp_sleep_wakeup_cause_t expected = ESP_SLEEP_WAKEUP_TIMER;
+    touch_sensor_snapshot_t snap;
+
+    // 只保留本次测试的唤醒源; 按钮和触摸同时用定时器兜底, 定时器唤醒算作超时
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    xQueueReset(wake_queue);
+    ulTaskNotifyTake(pdTRUE, 0);
+    uint32_t duration_ms = WAKE_BENCH_TIMEOUT_MS;
+    if (cfg->source == WAKE_BENCH_SRC_TIMER) {
+        duration_ms = cfg->timer_ms;
+    } else if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+        expected = ESP_SLEEP_WAKEUP_GPIO;
+        gpio_wakeup_enable(cfg->gpio, GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+        gpio_intr_enable(cfg->gpio);
+    } else {
+        expected = ESP_SLEEP_WAKEUP_TOUCHPAD;
+        esp_err_t ret = wake_bench_arm_touch(cfg->touch_pad);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        touch_sensor_get_snapshot(&snap);
+    }
+    sleep_manager_request(duration_ms);
+
+    // 等待唤醒后第一次运行: 定时器由最后一个唤醒后钩子通知, 按钮由中断通知, 触摸由触摸驱动通知
+    if (cfg->source == WAKE_BENCH_SRC_TOUCH) {
+        esp_err_t ret;
+        do {
+            ret = touch_sensor_wait_change(&snap, timeout);
+        } while (ret == ESP_OK && !(snap.touched_mask & (1UL << cfg->touch_pad)));
+        if (ret == ESP_OK) {
+            stamps[WAKE_BENCH_STAGE_TASK] = esp_timer_get_time();
+            stamps[WAKE_BENCH_STAGE_ISR] = snap.timestamp_us;
+        }
+    } else if (ulTaskNotifyTake(pdTRUE, timeout) > 0) {
+        stamps[WAKE_BENCH_STAGE_TASK] = esp_timer_get_time();
+        if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+            stamps[WAKE_BENCH_STAGE_ISR] = isr_time;
+        }
+    }
+    if (stamps[WAKE_BENCH_STAGE_TASK] >= 0) {
+        stamps[WAKE_BENCH_STAGE_I2C] = wake_bench_first_i2c();
+    }
+
+    // 唤醒回调在所有钩子之后才运行, 从这里得到CPU恢复运行的时间和唤醒原因
+    sleep_wake_info_t info;
+    BaseType_t got = xQueueReceive(wake_queue, &info, timeout);
+    if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+        gpio_intr_disable(cfg->gpio);
+        gpio_wakeup_disable(cfg->gpio);
+    }
+    if (got != pdTRUE || stamps[WAKE_BENCH_STAGE_TASK] < 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (info.cause != expected) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    int64_t ref = info.wake_time_us;
+    if (cfg->source == WAKE_BENCH_SRC_TIMER) {
+        // 预定时刻从进入睡眠算起, 包含esp_light_sleep_start内部准备睡眠的时间
+        ref = info.wake_time_us - info.slept_us + (int64_t)cfg->timer_ms * 1000;
+        stamps[WAKE_BENCH_STAGE_WAKE] = info.wake_time_us;
+    }
+    wake_bench_record(stamps, ref);
+    return ESP_OK;
+}
+
+/**
+ * @brief 配置唤醒源后进入深度睡眠, 成功时不返回
+ * @return ESP_ERR_INVALID_STATE 触摸唤醒配置失败, 没有进入睡眠
+ */
+static esp_err_t wake_bench_deep_sleep(void)
+{
+    const wake_bench_config_t *cfg = &bench_state.config;
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+        // 深度睡眠中数字GPIO断电, 上拉要用RTC IO的
+        rtc_gpio_pullup_en(cfg->gpio);
+        rtc_gpio_pulldown_dis(cfg->gpio);
+        esp_sleep_enable_ext0_wakeup(cfg->gpio, 0);
+    } else if (cfg->source == WAKE_BENCH_SRC_TOUCH) {
+        // 没有触摸唤醒时只剩超时定时器, 每个样本都会被当作超时, 不如直接结束测试
+        esp_err_t ret = wake_bench_arm_touch(cfg->touch_pad);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "配置触摸唤醒失败: %s", esp_err_to_name(ret));
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    uint32_t duration_ms = (cfg->source == WAKE_BENCH_SRC_TIMER) ? cfg->timer_ms : WAKE_BENCH_TIMEOUT_MS;
+    esp_sleep_enable_timer_wakeup((uint64_t)duration_ms * 1000);
+
+    // 驱动的热状态写入RTC内存, 唤醒后第一次I2C不用再做引脚检查
+    sleep_manager_save_state();
+
+    // 等日志发完再记录预定时刻, 深度睡眠前的准备时间不计入延迟
+    fflush(stdout);
+    vTaskDelay(pdMS_TO_TICKS(WAKE_BENCH_DEEP_SETTLE_MS));
+    bench_state.expected_us = wake_bench_wall_us() + (int64_t)duration_ms * 1000;
+    esp_deep_sleep_start();
+    return ESP_OK;
+}
+
+/**
+ * @brief 比较函数, 用于排序
+ */
+static int wake_bench_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief 统计结果并结束测试
+ */
+static void wake_bench_finish(wake_bench_result_t *result)
+{
+    const wake_bench_config_t *cfg = &bench_state.config;
+    static uint32_t sorted[WAKE_BENCH_MAX_SAMPLES];
+
+    *result = (wake_bench_result_t){
+        .mode = cfg->mode,
+        .source = cfg->source,
+        .samples = bench_state.count,
+        .timeouts = bench_state.timeouts,
+        .absolute = cfg->source == WAKE_BENCH_SRC_TIMER ||
+                    (cfg->mode == WAKE_BENCH_AWAKE && cfg->source == WAKE_BENCH_SRC_EXT0 && cfg->trigger_gpio >= 0),
+    };
+    for (int s = 0; s < WAKE_BENCH_STAGE_MAX; s++) {
+        uint32_t n = 0;
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < bench_state.count; i++) {
+            if (bench_state.samples[s][i] != WAKE_BENCH_NA) {
+                sorted[n++] = bench_state.samples[s][i];
+                sum += bench_state.samples[s][i];
+            }
+        }
+        if (n == 0) {
+            continue;
+        }
+        qsort(sorted, n, sizeof(sorted[0]), wake_bench_compare);
+        result->stages[s] = (wake_bench_dist_t){
+            .count = n,
+            .min_us = sorted[0],
+            .p50_us = sorted[(n - 1) * 50 / 100],
+            .p90_us = sorted[(n - 1) * 90 / 100],
+            .p99_us = sorted[(n - 1) * 99 / 100],
+            .max_us = sorted[n - 1],
+            .avg_us = (uint32_t)(sum / n),
+        };
+    }
+    bench_state.magic = 0;
+}
+
+/**
+ * @brief 检查配置
+ */
+static esp_err_t wake_bench_check_config(const wake_bench_config_t *cfg)
+{
+    if (cfg->mode >= WAKE_BENCH_MODE_MAX || cfg->source >= WAKE_BENCH_SRC_MAX ||
+        cfg->samples == 0 || cfg->samples > WAKE_BENCH_MAX_SAMPLES || cfg->timer_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cfg->source == WAKE_BENCH_SRC_TOUCH && !(TOUCH_PAD_MASK & (1UL << cfg->touch_pad))) {
+        ESP_LOGE(TAG, "触摸通道T%d未启用", cfg->touch_pad);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cfg->source == WAKE_BENCH_SRC_EXT0 && cfg->mode == WAKE_BENCH_DEEP_SLEEP) {
+        if (cfg->gpio == GPIO_NUM_0) {
+            // 深度睡眠唤醒是一次复位, 按着GPIO0复位会进入下载模式
+            ESP_LOGE(TAG, "GPIO0是启动模式引脚, 不能用于深度睡眠唤醒");
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        if (!rtc_gpio_is_valid_gpio(cfg->gpio)) {
+            ESP_LOGE(TAG, "GPIO%d不是RTC IO, 不能用于EXT0唤醒", cfg->gpio);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 准备清醒和轻度睡眠测试需要的资源
+ */
+static esp_err_t wake_bench_setup(const wake_bench_config_t *cfg)
+{
+    bench_task = xTaskGetCurrentTaskHandle();
+    if (wake_queue == NULL) {
+        wake_queue = xQueueCreate(1, sizeof(sleep_wake_info_t));
+        if (wake_queue == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (bench_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = wake_bench_timer_callback,
+            .arg = NULL,
+            .name = "wake_bench",
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &bench_timer);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    if (bench_lock == NULL) {
+        // 没有PM锁时照常测试, 只是清醒模式下可能被自动轻度睡眠打断
+        power_manager_lock_create(ESP_PM_NO_LIGHT_SLEEP, "wake_bench", &bench_lock);
+    }
+    if (!hook_registered) {
+        const sleep_hook_t hook = {
+            .name = "wake_bench", .prepare = NULL, .resume = wake_bench_resume_hook, .arg = NULL,
+        };
+        esp_err_t ret = sleep_manager_register_hook(&hook);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        hook_registered = true;
+    }
+
+    if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+        gpio_config_t io_conf = {
+            .pin_bit_mask = (1ULL << cfg->gpio),
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_ENABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_LOW_LEVEL,
+        };
+        gpio_config(&io_conf);
+        gpio_intr_disable(cfg->gpio);
+        esp_err_t ret = gpio_install_isr_service(0);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+            return ret;
+        }
+        ret = gpio_isr_handler_add(cfg->gpio, wake_bench_gpio_isr, (void *)(intptr_t)cfg->gpio);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (cfg->trigger_gpio >= 0 && cfg->mode == WAKE_BENCH_AWAKE) {
+            gpio_config_t trigger_conf = {
+                .pin_bit_mask = (1ULL << cfg->trigger_gpio),
+                .mode = GPIO_MODE_OUTPUT,
+                .pull_up_en = GPIO_PULLUP_DISABLE,
+                .pull_down_en = GPIO_PULLDOWN_DISABLE,
+                .intr_type = GPIO_INTR_DISABLE,
+            };
+            gpio_set_level((gpio_num_t)cfg->trigger_gpio, 1);
+            gpio_config(&trigger_conf);
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 运行测试
+ */
+esp_err_t wake_bench_run(const wake_bench_config_t *config, wake_bench_result_t *result)
+{
+    if (config == NULL || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = wake_bench_check_config(config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    bench_state = (wake_bench_state_t){
+        .magic = WAKE_BENCH_MAGIC,
+        .config = *config,
+    };
+    const wake_bench_config_t *cfg = &bench_state.config;
+    ESP_LOGI(TAG, "开始测试: %s + %s, %" PRIu32 "个样本",
+             wake_bench_mode_name(cfg->mode), wake_bench_source_name(cfg->source), cfg->samples);
+
+    if (cfg->mode == WAKE_BENCH_DEEP_SLEEP) {
+        // 后续样本在每次复位后由wake_bench_resume记录
+        ret = wake_bench_deep_sleep();
+        bench_state.magic = 0;
+        return ret;
+    }
+
+    ret = wake_bench_setup(cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "准备测试失败: %s", esp_err_to_name(ret));
+        bench_state.magic = 0;
+        return ret;
+    }
+
+    // 高于睡眠管理任务, 唤醒后中断一通知就能运行, 任务阶段只包含调度延迟
+    UBaseType_t old_prio = uxTaskPriorityGet(NULL);
+    vTaskPrioritySet(NULL, SLEEP_MANAGER_TASK_PRIO + 1);
+    if (cfg->mode == WAKE_BENCH_LIGHT_SLEEP) {
+        sleep_manager_set_wake_callback(wake_bench_wake_callback, NULL);
+    } else {
+        power_manager_lock_acquire(bench_lock);
+    }
+    running = true;
+
+    while (bench_state.count + bench_state.timeouts < cfg->samples) {
+        if (cfg->mode == WAKE_BENCH_LIGHT_SLEEP) {
+            ret = wake_bench_light_sample(cfg);
+        } else {
+            ret = wake_bench_awake_sample(cfg);
+        }
+        if (ret == ESP_ERR_INVALID_STATE) {
+            // 触摸基准值还没有建立, 无法配置唤醒阈值
+            ESP_LOGE(TAG, "触摸通道T%d没有基准值", cfg->touch_pad);
+            break;
+        }
+        if (ret != ESP_OK) {
+            bench_state.timeouts++;
+            ESP_LOGW(TAG, "样本%" PRIu32 "丢弃: %s", bench_state.count + bench_state.timeouts,
+                     esp_err_to_name(ret));
+        }
+        wake_bench_wait_release(cfg);
+    }
+
+    running = false;
+    if (cfg->mode == WAKE_BENCH_LIGHT_SLEEP) {
+        sleep_manager_set_wake_callback(NULL, NULL);
+    } else {
+        power_manager_lock_release(bench_lock);
+    }
+    vTaskPrioritySet(NULL, old_prio);
+    if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+        gpio_isr_handler_remove(cfg->gpio);
+        gpio_set_intr_type(cfg->gpio, GPIO_INTR_DISABLE);
+    }
+
+    wake_bench_finish(result);
+    return ret == ESP_ERR_INVALID_STATE ? ret : ESP_OK;
+}
+
+/**
+ * @brief 深度睡眠测试: 记录本次唤醒
+ */
+esp_err_t wake_bench_resume(wake_bench_result_t *result)
+{
+    // 第一件事记录时间: 这就是复位后第一次任务运行
+    int64_t task_at = esp_timer_get_time();
+    if (result == NULL || bench_state.magic != WAKE_BENCH_MAGIC || esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        bench_state.magic = 0;
+        return ESP_ERR_NOT_FOUND;
+    }
+    int64_t wall = wake_bench_wall_us();
+    const wake_bench_config_t *cfg = &bench_state.config;
+
+    int64_t stamps[WAKE_BENCH_STAGE_MAX] = { -1, -1, task_at, -1 };
+    if (i2c_master_init() == ESP_OK) {
+        stamps[WAKE_BENCH_STAGE_I2C] = wake_bench_first_i2c();
+    }
+
+    // 复位时esp_timer为0; 定时器唤醒用RTC时基把预定时刻换算到esp_timer时基
+    esp_sleep_wakeup_cause_t expected = ESP_SLEEP_WAKEUP_TIMER;
+    int64_t ref = 0;
+    if (cfg->source == WAKE_BENCH_SRC_TIMER) {
+        ref = bench_state.expected_us - (wall - task_at);
+        stamps[WAKE_BENCH_STAGE_WAKE] = 0;
+    } else {
+        expected = (cfg->source == WAKE_BENCH_SRC_EXT0) ? ESP_SLEEP_WAKEUP_EXT0 : ESP_SLEEP_WAKEUP_TOUCHPAD;
+    }
+    if (esp_sleep_get_wakeup_cause() == expected) {
+        wake_bench_record(stamps, ref);
+    } else {
+        bench_state.timeouts++;
+    }
+
+    ESP_LOGI(TAG, "深度睡眠样本 %" PRIu32 "/%" PRIu32 ", 丢弃%" PRIu32,
+             bench_state.count, cfg->samples, bench_state.timeouts);
+    if (bench_state.count + bench_state.timeouts >= cfg->samples) {
+        wake_bench_finish(result);
+        return ESP_OK;
+    }
+
+    // 触摸外设在复位后要重新初始化, 并等第一次扫描发布基准值后才能得到唤醒阈值;
+    // 按钮要等释放, 否则会立即再次唤醒
+    if (cfg->source == WAKE_BENCH_SRC_TOUCH) {
+        touch_sensor_snapshot_t snap;
+        esp_err_t ret = touch_sensor_init();
+        if (ret == ESP_OK) {
+            touch_sensor_get_snapshot(&snap);
+            ret = touch_sensor_wait_scan(&snap, pdMS_TO_TICKS(WAKE_BENCH_TOUCH_SCAN_MS));
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "触摸驱动没有就绪: %s", esp_err_to_name(ret));
+            wake_bench_finish(result);
+            return ESP_ERR_INVALID_STATE;
+        }
+    } else if (cfg->source == WAKE_BENCH_SRC_EXT0) {
+        gpio_config_t io_conf = {
+            .pin_bit_mask = (1ULL << cfg->gpio),
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_ENABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_DISABLE,
+        };
+        gpio_config(&io_conf);
+    }
+    wake_bench_wait_release(cfg);
+    esp_err_t ret = wake_bench_deep_sleep();
+
+    // 没能进入睡眠: 用已有的样本结束测试
+    wake_bench_finish(result);
+    return ret;
+}
+
+/**
+ * @brief 打印测试结果
+ */
+void wake_bench_print(const wake_bench_result_t *result)
+{
+    if (result == NULL) {
+        return;
+    }
+
+    const char *ref_name = "中断";
+    if (result->absolute) {
+        ref_name = "触发时刻";
+    } else if (result->mode != WAKE_BENCH_AWAKE) {
+        ref_name = "CPU恢复";
+    }
+    ESP_LOGI(TAG, "%s + %s: 有效%" PRIu32 "个, 丢弃%" PRIu32 "个, 参考点: %s",
+             wake_bench_mode_name(result->mode), wake_bench_source_name(result->source),
+             result->samples, result->timeouts, ref_name);
+    ESP_LOGI(TAG, "  %-10s %8s %8s %8s %8s %8s %8s (us)", "阶段", "最短", "p50", "p90", "p99", "最长", "平均");
+    for (int s = 0; s < WAKE_BENCH_STAGE_MAX; s++) {
+        const wake_bench_dist_t *d = &result->stages[s];
+        if (d->count == 0) {
+            ESP_LOGI(TAG, "  %-10s %8s", wake_bench_stage_name(s), "-");
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-10s %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32,
+                 wake_bench_stage_name(s), d->min_us, d->p50_us, d->p90_us, d->p99_us, d->max_us, d->avg_us);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * 唤醒延迟测试头文件
+ * 在清醒、轻度睡眠和深度睡眠三种模式下用定时器、EXT0按钮或触摸唤醒, 记录每次唤醒的各个阶段:
+ * CPU恢复运行、唤醒源中断、第一次任务运行、第一次I2C传输完成, 统计每个阶段的延迟分布,
+ * 用来判断每种响应要求能承受多深的睡眠
+ */
+
+#ifndef WAKE_BENCH_H
+#define WAKE_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "driver/touch_pad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 测试配置
+#define WAKE_BENCH_MAX_SAMPLES      64      // 每次测试最多的样本数 (深度睡眠时保存在RTC内存)
+#define WAKE_BENCH_TIMER_MS         200     // 定时器唤醒的默认睡眠时间
+#define WAKE_BENCH_TIMEOUT_MS       30000   // 等待按钮或触摸的超时, 超时的样本不计入统计
+#define WAKE_BENCH_DEEP_SETTLE_MS   20      // 深度睡眠前等待日志发完的时间
+#define WAKE_BENCH_TOUCH_SCAN_MS    500     // 深度睡眠唤醒后等待第一次触摸扫描的超时
+
+/**
+ * @brief 测试模式
+ */
+typedef enum {
+    WAKE_BENCH_AWAKE,                   // 不睡眠, 作为基准
+    WAKE_BENCH_LIGHT_SLEEP,             // 通过睡眠管理进入轻度睡眠
+    WAKE_BENCH_DEEP_SLEEP,              // 深度睡眠, 每个样本都会复位一次
+    WAKE_BENCH_MODE_MAX,
+} wake_bench_mode_t;
+
+/**
+ * @brief 唤醒源
+ */
+typedef enum {
+    WAKE_BENCH_SRC_TIMER,               // 定时器, 有确定的预定时刻, 延迟是绝对值
+    WAKE_BENCH_SRC_EXT0,                // 按钮 (低电平): 深度睡眠用EXT0, 轻度睡眠用GPIO唤醒
+    WAKE_BENCH_SRC_TOUCH,               // 触摸
+    WAKE_BENCH_SRC_MAX,
+} wake_bench_source_t;
+
+/**
+ * @brief 记录的阶段
+ */
+typedef enum {
+    WAKE_BENCH_STAGE_WAKE,              // CPU恢复运行 (轻度睡眠: esp_light_sleep_start返回; 深度睡眠: 复位)
+    WAKE_BENCH_STAGE_ISR,               // 唤醒源的中断 (GPIO电平中断、触摸扫描中断或esp_timer回调)
+    WAKE_BENCH_STAGE_TASK,              // 测试任务第一次运行
+    WAKE_BENCH_STAGE_I2C,               // 第一次I2C传输 (读XL9555输入寄存器) 完成
+    WAKE_BENCH_STAGE_MAX,
+} wake_bench_stage_t;
+
+/**
+ * @brief 测试配置
+ */
+typedef struct {
+    wake_bench_mode_t mode;             // 测试模式
+    wake_bench_source_t source;         // 唤醒源
+    uint32_t samples;                   // 样本数, 最多WAKE_BENCH_MAX_SAMPLES
+    uint32_t timer_ms;                  // 定时器唤醒的睡眠时间
+    gpio_num_t gpio;                    // EXT0按钮引脚
+    int trigger_gpio;                   // 清醒模式下用跳线连到gpio的输出引脚, 由测试自己拉低; -1表示手动按按钮
+    touch_pad_t touch_pad;              // 触摸唤醒的通道
+} wake_bench_config_t;
+
+/**
+ * @brief 默认配置
+ */
+#define WAKE_BENCH_DEFAULT_CONFIG(bench_mode, bench_source) { \
+    .mode = (bench_mode),                                   \
+    .source = (bench_source),                               \
+    .samples = 32,                                          \
+    .timer_ms = WAKE_BENCH_TIMER_MS,                        \
+    .gpio = GPIO_NUM_0,                                     \
+    .trigger_gpio = -1,                                     \
+    .touch_pad = TOUCH_PAD_NUM6,                            \
+}
+
+/**
+ * @brief 单个阶段的延迟分布 (微秒)
+ */
+typedef struct {
+    uint32_t count;                     // 有效样本数, 0表示这个阶段在该模式下不适用
+    uint32_t min_us;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t avg_us;
+} wake_bench_dist_t;
+
+/**
+ * @brief 测试结果
+ * @note 参考点: 定时器为预定的唤醒时刻, 清醒模式下有trigger_gpio时为拉低的时刻, 都是绝对延迟;
+ *       按钮和触摸没有可测量的触发时刻, 睡眠模式下以CPU恢复运行为参考, 清醒模式下以中断为参考,
+ *       作为参考点的阶段不统计
+ */
+typedef struct {
+    wake_bench_mode_t mode;
+    wake_bench_source_t source;
+    uint32_t samples;                   // 有效样本数
+    uint32_t timeouts;                  // 超时或唤醒原因不符而丢弃的样本数
+    bool absolute;                      // 延迟是否相对触发时刻
+    wake_bench_dist_t stages[WAKE_BENCH_STAGE_MAX];
+} wake_bench_result_t;
+
+/**
+ * @brief 运行测试, 阻塞直到完成
+ * @note 需要先初始化睡眠管理 (轻度睡眠)、I2C和XL9555 (I2C阶段)、触摸驱动 (触摸唤醒);
+ *       测试期间调用任务的优先级高于睡眠管理任务, 中断到任务的时间只包含调度延迟;
+ *       深度睡眠模式不会返回, 每次唤醒后在app_main开头调用wake_bench_resume继续;
+ *       测试会替换唤醒源配置和睡眠管理的唤醒回调, 结束后不恢复
+ * @param config 配置
+ * @param result 返回的结果
+ * @return ESP_OK 完成, ESP_ERR_INVALID_ARG 配置无效, ESP_ERR_NOT_SUPPORTED 不支持的组合
+ *         (深度睡眠不能用GPIO0唤醒: 复位时会被当作启动模式引脚采样),
+ *         ESP_ERR_INVALID_STATE 触摸通道还没有基准值, 无法配置唤醒阈值
+ */
+esp_err_t wake_bench_run(const wake_bench_config_t *config, wake_bench_result_t *result);
+
+/**
+ * @brief 深度睡眠测试: 在app_main开头调用, 记录本次唤醒后继续睡眠或返回结果
+ * @note 第一次I2C传输包括I2C初始化; 还没有完成时不会返回
+ * @param result 返回的结果
+ * @return ESP_OK 测试完成, ESP_ERR_NOT_FOUND 没有进行中的深度睡眠测试 (正常启动),
+ *         ESP_ERR_INVALID_STATE 触摸唤醒无法重新配置, 测试提前结束, result为已有样本的结果
+ */
+esp_err_t wake_bench_resume(wake_bench_result_t *result);
+
+/**
+ * @brief 打印测试结果
+ */
+void wake_bench_print(const wake_bench_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WAKE_BENCH_H
@@ -0,0 +1,15 @@
+/*
+ * 主机测试用的esp_cpu.h: 主机上没有周期计数器, 用单调时钟的纳秒数代替,
+ * 基准测试打印的"周期"在主机上是纳秒
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
@@ -0,0 +1,15 @@
+/*
+ * 主机测试用的esp_err.h, 只包含rgb565.c用到的部分
+ */
+#pragma once
+
+typedef int esp_err_t;
+
+#define ESP_OK                      0
+#define ESP_FAIL                    -1
+#define ESP_ERR_NO_MEM              0x101
+
+static inline const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : code == ESP_ERR_NO_MEM ? "ESP_ERR_NO_MEM" : "ESP_FAIL";
+}
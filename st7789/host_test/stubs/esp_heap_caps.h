@@ -0,0 +1,28 @@
+/*
+ * 主机测试用的esp_heap_caps.h: 忽略内存类型, 直接用C库分配
+ */
+#pragma once
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_DEFAULT          (1 << 12)
+#define MALLOC_CAP_INTERNAL         (1 << 11)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    void *p = NULL;
+    (void)caps;
+    return posix_memalign(&p, alignment, size) == 0 ? p : NULL;
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
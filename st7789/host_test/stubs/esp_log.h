@@ -0,0 +1,10 @@
+/*
+ * 主机测试用的esp_log.h: 日志直接打印到标准输出
+ */
+#pragma once
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...)     printf("E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)     printf("W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)     printf("I (%s) " fmt "\n", tag, ##__VA_ARGS__)
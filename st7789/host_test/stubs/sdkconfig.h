@@ -0,0 +1,6 @@
+/*
+ * 主机测试用的sdkconfig.h: 不是ESP32-S3, rgb565.c只编译标量路径
+ */
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX     1
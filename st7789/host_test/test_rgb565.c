@@ -0,0 +1,66 @@
+/*
+ * RGB565像素内核主机测试
+ * 检查几个已知的颜色值, 再运行rgb565_self_test逐位比较每个内核和参考实现, 最后打印基准测试
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "rgb565.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+// LCD字节序: 内存中高字节在前
+static void test_known_colors(void)
+{
+    CHECK(RGB565(0, 0, 0) == 0x0000);
+    CHECK(RGB565(0xFF, 0xFF, 0xFF) == 0xFFFF);
+    CHECK(RGB565(0xFF, 0, 0) == 0x00F8);
+    CHECK(RGB565(0, 0xFF, 0) == 0xE007);
+    CHECK(RGB565(0, 0, 0xFF) == 0x1F00);
+
+    const uint8_t rgb[] = {0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF};
+    uint16_t out[3];
+    rgb888_to_rgb565(out, rgb, 3);
+    CHECK(out[0] == 0x00F8 && out[1] == 0xE007 && out[2] == 0x1F00);
+
+    uint16_t px[2] = {0x1234, 0xABCD};
+    rgb565_swap_bytes(px, px, 2);
+    CHECK(px[0] == 0x3412 && px[1] == 0xCDAB);
+}
+
+// 透明度端点: 0不变, 255等于复制
+static void test_blend_endpoints(void)
+{
+    uint16_t bg[5] = {1, 2, 3, 4, 5};
+    const uint16_t fg[5] = {0xF800, 0x07E0, 0x001F, 0xFFFF, 0x1234};
+    uint16_t out[5];
+
+    memcpy(out, bg, sizeof(out));
+    rgb565_blend(out, fg, 0, 5);
+    CHECK(memcmp(out, bg, sizeof(out)) == 0);
+    rgb565_blend(out, fg, 255, 5);
+    CHECK(memcmp(out, fg, sizeof(out)) == 0);
+}
+
+int main(void)
+{
+    test_known_colors();
+    test_blend_endpoints();
+    CHECK(rgb565_self_test() == ESP_OK);
+    CHECK(rgb565_benchmark() == ESP_OK);
+
+    if (failures > 0) {
+        printf("%d 项失败\n", failures);
+        return 1;
+    }
+    printf("全部通过\n");
+    return 0;
+}
@@ -0,0 +1,602 @@
+/*
+ * 摄像头预览实现
+ * 帧源 (DVP驱动或合成任务) 把帧写进缓冲区池, 预览任务取出一帧后在原地缩小/裁剪,
+ * 再把同一块缓冲区分块交给ST7789 DMA, 传输完成后缓冲区还给帧源继续采集
+ */
+
+#include "cam_preview.h"
+#include "st7789.h"
+#include "rgb565.h"
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#if CAM_PREVIEW_USE_DVP
+#include "esp_camera.h"
+#include "driver/i2c.h"
+#include "i2c_master.h"
+#include "pca9557.h"
+#endif
+
+static const char *TAG = "CAM_PREVIEW";
+
+/**
+ * @brief 一帧: 帧源缓冲区和采集完成时间
+ */
+typedef struct {
+    uint16_t *buf;                  // 帧缓冲区 (DMA可访问)
+    int64_t capture_us;             // 采集完成时间 (esp_timer时间)
+    void *handle;                   // 帧源私有数据 (DVP为camera_fb_t, 合成帧源为缓冲区序号)
+} cam_frame_t;
+
+/**
+ * @brief 帧源接口
+ */
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(const cam_preview_config_t *config);
+    esp_err_t (*get)(cam_frame_t *frame, uint32_t timeout_ms);
+    void (*put)(cam_frame_t *frame);
+    void (*deinit)(void);
+} cam_source_t;
+
+static cam_preview_config_t preview_cfg;
+static const cam_source_t *source = NULL;
+static volatile bool running = false;
+static SemaphoreHandle_t exit_sem = NULL;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static cam_preview_stats_t preview_stats;
+static uint64_t latency_sum_us = 0;
+static uint32_t window_frames = 0;
+static int64_t window_start_us = 0;
+
+// ==================== 合成帧源 ====================
+
+static uint16_t *synth_bufs[CAM_PREVIEW_FB_NUM];
+static int64_t synth_capture_us[CAM_PREVIEW_FB_NUM];
+static QueueHandle_t synth_free = NULL;
+static QueueHandle_t synth_ready = NULL;
+static SemaphoreHandle_t synth_exit = NULL;
+static volatile bool synth_running = false;
+
+/**
+ * @brief 生成一帧测试图案: 滚动彩条加一个移动的白色方块
+ */
+static void cam_synth_render(uint16_t *buf, int w, int h, uint32_t frame)
+{
+    static const uint16_t colors[] = {0x00F8, 0xE007, 0x1F00, 0xE0FF, 0x1FF8};
+    const int color_num = sizeof(colors) / sizeof(colors[0]);
+
+    for (int x = 0; x < w; x++) {
+        buf[x] = colors[((x + frame * 4) / 32) % color_num];
+    }
+    for (int y = 1; y < h; y++) {
+        rgb565_copy(&buf[y * w], buf, w);
+    }
+
+    int box = h / 4;
+    if (box < 1 || box >= w) {
+        return;
+    }
+    int bx = (int)(frame * 3 % (uint32_t)(w - box));
+    int by = (int)(frame * 2 % (uint32_t)(h - box));
+    for (int y = by; y < by + box; y++) {
+        rgb565_fill(&buf[y * w + bx], 0xFFFF, box);
+    }
+}
+
+/**
+ * @brief 合成帧源任务: 像DVP的DMA一样在另一个核心上不断填充空闲缓冲区
+ */
+static void cam_synth_task(void *arg)
+{
+    int w = preview_cfg.frame_width;
+    int h = preview_cfg.frame_height;
+    uint32_t frame = 0;
+#if CAM_PREVIEW_SYNTH_FPS > 0
+    TickType_t last_wake = xTaskGetTickCount();
+#endif
+
+    while (synth_running) {
+        int index;
+        if (xQueueReceive(synth_free, &index, 0) != pdTRUE) {
+            // 缓冲区都在预览任务手里
+            portENTER_CRITICAL(&stats_lock);
+            preview_stats.source_stalls++;
+            portEXIT_CRITICAL(&stats_lock);
+            if (xQueueReceive(synth_free, &index, pdMS_TO_TICKS(CAM_PREVIEW_TIMEOUT_MS)) != pdTRUE) {
+                continue;
+            }
+        }
+
+        cam_synth_render(synth_bufs[index], w, h, frame++);
+        synth_capture_us[index] = esp_timer_get_time();
+        xQueueSend(synth_ready, &index, portMAX_DELAY);
+
+#if CAM_PREVIEW_SYNTH_FPS > 0
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000 / CAM_PREVIEW_SYNTH_FPS));
+#endif
+    }
+
+    xSemaphoreGive(synth_exit);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 释放合成帧源
+ */
+static void cam_synth_free(void)
+{
+    for (int i = 0; i < CAM_PREVIEW_FB_NUM; i++) {
+        heap_caps_free(synth_bufs[i]);
+        synth_bufs[i] = NULL;
+    }
+    if (synth_free != NULL) {
+        vQueueDelete(synth_free);
+        synth_free = NULL;
+    }
+    if (synth_ready != NULL) {
+        vQueueDelete(synth_ready);
+        synth_ready = NULL;
+    }
+    if (synth_exit != NULL) {
+        vSemaphoreDelete(synth_exit);
+        synth_exit = NULL;
+    }
+}
+
+static esp_err_t cam_synth_init(const cam_preview_config_t *config)
+{
+    size_t frame_bytes = (size_t)config->frame_width * config->frame_height * sizeof(uint16_t);
+
+    synth_free = xQueueCreate(CAM_PREVIEW_FB_NUM, sizeof(int));
+    synth_ready = xQueueCreate(CAM_PREVIEW_FB_NUM, sizeof(int));
+    synth_exit = xSemaphoreCreateBinary();
+    if (synth_free == NULL || synth_ready == NULL || synth_exit == NULL) {
+        cam_synth_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 16字节对齐, 缩小和字节交换可以走PIE路径
+    for (int i = 0; i < CAM_PREVIEW_FB_NUM; i++) {
+        synth_bufs[i] = heap_caps_aligned_alloc(16, frame_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (synth_bufs[i] == NULL) {
+            ESP_LOGE(TAG, "分配帧缓冲区%d失败 (%zu字节)", i, frame_bytes);
+            cam_synth_free();
+            return ESP_ERR_NO_MEM;
+        }
+        xQueueSend(synth_free, &i, 0);
+    }
+    preview_stats.buf_bytes = frame_bytes * CAM_PREVIEW_FB_NUM;
+
+    synth_running = true;
+    if (xTaskCreatePinnedToCore(cam_synth_task, "cam_synth", CAM_PREVIEW_TASK_STACK, NULL,
+                                CAM_PREVIEW_TASK_PRIO - 1, NULL, !CAM_PREVIEW_TASK_CORE) != pdPASS) {
+        synth_running = false;
+        cam_synth_free();
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t cam_synth_get(cam_frame_t *frame, uint32_t timeout_ms)
+{
+    int index;
+    if (xQueueReceive(synth_ready, &index, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    frame->buf = synth_bufs[index];
+    frame->capture_us = synth_capture_us[index];
+    frame->handle = (void *)(intptr_t)index;
+    return ESP_OK;
+}
+
+static void cam_synth_put(cam_frame_t *frame)
+{
+    int index = (int)(intptr_t)frame->handle;
+    xQueueSend(synth_free, &index, 0);
+}
+
+static void cam_synth_deinit(void)
+{
+    synth_running = false;
+    xSemaphoreTake(synth_exit, pdMS_TO_TICKS(CAM_PREVIEW_TIMEOUT_MS * 2));
+    cam_synth_free();
+}
+
+static const cam_source_t cam_source_synthetic = {
+    .name = "合成",
+    .init = cam_synth_init,
+    .get = cam_synth_get,
+    .put = cam_synth_put,
+    .deinit = cam_synth_deinit,
+};
+
+// ==================== DVP帧源 ====================
+
+#if CAM_PREVIEW_USE_DVP
+
+/**
+ * @brief 源帧尺寸对应的esp32-camera帧大小
+ */
+static const struct {
+    uint16_t width;
+    uint16_t height;
+    framesize_t size;
+} cam_dvp_sizes[] = {
+    {160, 120, FRAMESIZE_QQVGA},
+    {240, 176, FRAMESIZE_HQVGA},
+    {320, 240, FRAMESIZE_QVGA},
+    {640, 480, FRAMESIZE_VGA},
+};
+
+static esp_err_t cam_dvp_init(const cam_preview_config_t *config)
+{
+    framesize_t size = FRAMESIZE_INVALID;
+    for (size_t i = 0; i < sizeof(cam_dvp_sizes) / sizeof(cam_dvp_sizes[0]); i++) {
+        if (cam_dvp_sizes[i].width == config->frame_width && cam_dvp_sizes[i].height == config->frame_height) {
+            size = cam_dvp_sizes[i].size;
+        }
+    }
+    if (size == FRAMESIZE_INVALID) {
+        ESP_LOGE(TAG, "DVP不支持的帧尺寸: %ux%u", config->frame_width, config->frame_height);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // PCA9557 IO2为摄像头掉电控制, 拉低后上电
+    esp_err_t ret = pca9557_update_outputs(PCA9557_DVP_PWDN, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    size_t frame_bytes = (size_t)config->frame_width * config->frame_height * sizeof(uint16_t);
+    camera_config_t cam_config = {
+        .pin_pwdn = -1,
+        .pin_reset = -1,
+        .pin_xclk = CAM_PIN_XCLK,
+        .pin_sccb_sda = -1,                 // 使用已经初始化的I2C主机
+        .pin_sccb_scl = -1,
+        .sccb_i2c_port = I2C_MASTER_NUM,
+        .pin_d7 = CAM_PIN_D7,
+        .pin_d6 = CAM_PIN_D6,
+        .pin_d5 = CAM_PIN_D5,
+        .pin_d4 = CAM_PIN_D4,
+        .pin_d3 = CAM_PIN_D3,
+        .pin_d2 = CAM_PIN_D2,
+        .pin_d1 = CAM_PIN_D1,
+        .pin_d0 = CAM_PIN_D0,
+        .pin_vsync = CAM_PIN_VSYNC,
+        .pin_href = CAM_PIN_HREF,
+        .pin_pclk = CAM_PIN_PCLK,
+        .xclk_freq_hz = CAM_XCLK_FREQ_HZ,
+        .ledc_timer = LEDC_TIMER_0,
+        .ledc_channel = LEDC_CHANNEL_0,
+        .pixel_format = PIXFORMAT_RGB565,
+        .frame_size = size,
+        .jpeg_quality = 12,
+        .fb_count = CAM_PREVIEW_FB_NUM,
+        // QVGA及以下放内部RAM, SPI可以直接DMA; VGA只能放PSRAM, 由SPI驱动经内部RAM中转
+        .fb_location = (size == FRAMESIZE_VGA) ? CAMERA_FB_IN_PSRAM : CAMERA_FB_IN_DRAM,
+        .grab_mode = CAMERA_GRAB_LATEST,
+    };
+    ret = esp_camera_init(&cam_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "摄像头初始化失败: %s", esp_err_to_name(ret));
+        pca9557_update_outputs(PCA9557_DVP_PWDN, PCA9557_DVP_PWDN);
+        return ret;
+    }
+    preview_stats.buf_bytes = frame_bytes * CAM_PREVIEW_FB_NUM;
+    return ESP_OK;
+}
+
+static esp_err_t cam_dvp_get(cam_frame_t *frame, uint32_t timeout_ms)
+{
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (fb == NULL) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (fb->len < (size_t)preview_cfg.frame_width * preview_cfg.frame_height * sizeof(uint16_t)) {
+        esp_camera_fb_return(fb);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    frame->buf = (uint16_t *)fb->buf;
+    frame->capture_us = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+    frame->handle = fb;
+    return ESP_OK;
+}
+
+static void cam_dvp_put(cam_frame_t *frame)
+{
+    esp_camera_fb_return((camera_fb_t *)frame->handle);
+}
+
+static void cam_dvp_deinit(void)
+{
+    esp_camera_deinit();
+    pca9557_update_outputs(PCA9557_DVP_PWDN, PCA9557_DVP_PWDN);
+}
+
+static const cam_source_t cam_source_dvp = {
+    .name = "DVP",
+    .init = cam_dvp_init,
+    .get = cam_dvp_get,
+    .put = cam_dvp_put,
+    .deinit = cam_dvp_deinit,
+};
+
+#endif // CAM_PREVIEW_USE_DVP
+
+// ==================== 预览任务 ====================
+
+/**
+ * @brief 原地缩小/裁剪/字节交换, 返回紧凑存放的输出窗口
+ */
+static const uint16_t *cam_preview_process(uint16_t *buf)
+{
+    int scale = preview_cfg.downsample ? 2 : 1;
+    int fw = preview_cfg.frame_width;
+    int ow = preview_cfg.out_width;
+    int oh = preview_cfg.out_height;
+    uint16_t *out = buf;
+
+    if (scale == 1 && ow == fw) {
+        // 整行输出: 只需要偏移起始行, 不移动像素
+        out = buf + preview_cfg.crop_y * fw;
+    } else {
+        // 输出行总是在对应源行之前, 从上到下处理不会覆盖未读取的数据
+        for (int y = 0; y < oh; y++) {
+            uint16_t *dst = buf + y * ow;
+            const uint16_t *src = buf + (preview_cfg.crop_y + y) * scale * fw + preview_cfg.crop_x * scale;
+            if (scale == 2) {
+                rgb565_downsample_2x(dst, src, ow);
+            } else {
+                memmove(dst, src, ow * sizeof(uint16_t));
+            }
+        }
+    }
+
+    if (preview_cfg.swap_bytes) {
+        rgb565_swap_bytes(out, out, (size_t)ow * oh);
+    }
+    return out;
+}
+
+/**
+ * @brief 把输出窗口分块提交DMA并等待传输完成
+ */
+static esp_err_t cam_preview_flush(const uint16_t *out)
+{
+    int ow = preview_cfg.out_width;
+    int oh = preview_cfg.out_height;
+    int x0 = (LCD_H_RES - ow) / 2;
+    int y0 = (LCD_V_RES - oh) / 2;
+    // 每次传输不超过SPI总线的max_transfer_sz
+    int chunk = LCD_H_RES * LCD_MAX_TRANSFER_LINES / ow;
+
+    esp_err_t ret = st7789_frame_begin(CAM_PREVIEW_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    for (int y = 0; y < oh && ret == ESP_OK; y += chunk) {
+        int lines = (y + chunk > oh) ? (oh - y) : chunk;
+        ret = st7789_draw_bitmap(x0, y0 + y, x0 + ow, y0 + y + lines, out + y * ow);
+    }
+    st7789_frame_end();
+    esp_err_t wait_ret = st7789_wait_flush_done(CAM_PREVIEW_TIMEOUT_MS);
+    return (ret != ESP_OK) ? ret : wait_ret;
+}
+
+/**
+ * @brief 预览任务: 取帧 -> 原地处理 -> DMA -> 还给帧源
+ */
+static void cam_preview_task(void *arg)
+{
+    while (running) {
+        int64_t t0 = esp_timer_get_time();
+        cam_frame_t frame;
+        esp_err_t ret = source->get(&frame, CAM_PREVIEW_TIMEOUT_MS);
+        if (ret != ESP_OK) {
+            if (running) {
+                ESP_LOGW(TAG, "获取帧失败: %s", esp_err_to_name(ret));
+            }
+            continue;
+        }
+
+        int64_t t1 = esp_timer_get_time();
+        const uint16_t *out = cam_preview_process(frame.buf);
+        int64_t t2 = esp_timer_get_time();
+        ret = cam_preview_flush(out);
+        int64_t t3 = esp_timer_get_time();
+        source->put(&frame);
+
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "显示失败: %s", esp_err_to_name(ret));
+            continue;
+        }
+
+        uint32_t latency = (uint32_t)(t3 - frame.capture_us);
+        portENTER_CRITICAL(&stats_lock);
+        preview_stats.frames++;
+        preview_stats.latency_us = latency;
+        if (latency > preview_stats.max_latency_us) {
+            preview_stats.max_latency_us = latency;
+        }
+        latency_sum_us += latency;
+        preview_stats.avg_latency_us = (uint32_t)(latency_sum_us / preview_stats.frames);
+        preview_stats.wait_us = (uint32_t)(t1 - t0);
+        preview_stats.process_us = (uint32_t)(t2 - t1);
+        preview_stats.flush_us = (uint32_t)(t3 - t2);
+        window_frames++;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+
+    xSemaphoreGive(exit_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 输出窗口小于屏幕时先清屏
+ */
+static esp_err_t cam_preview_clear(void)
+{
+    uint16_t *buf = heap_caps_malloc(LCD_H_RES * LCD_MAX_TRANSFER_LINES * sizeof(uint16_t),
+                                     MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    rgb565_fill(buf, 0x0000, LCD_H_RES * LCD_MAX_TRANSFER_LINES);
+    esp_err_t ret = ESP_OK;
+    for (int y = 0; y < LCD_V_RES && ret == ESP_OK; y += LCD_MAX_TRANSFER_LINES) {
+        int lines = (y + LCD_MAX_TRANSFER_LINES > LCD_V_RES) ? (LCD_V_RES - y) : LCD_MAX_TRANSFER_LINES;
+        ret = st7789_draw_bitmap(0, y, LCD_H_RES, y + lines, buf);
+    }
+    esp_err_t wait_ret = st7789_wait_flush_done(CAM_PREVIEW_TIMEOUT_MS);
+    heap_caps_free(buf);
+    return (ret != ESP_OK) ? ret : wait_ret;
+}
+
+/**
+ * @brief 检查缩小/裁剪窗口
+ */
+static esp_err_t cam_preview_check_config(const cam_preview_config_t *config)
+{
+    int scale = config->downsample ? 2 : 1;
+    if (config->frame_width == 0 || config->frame_height == 0 ||
+        config->out_width == 0 || config->out_height == 0 ||
+        config->out_width > LCD_H_RES || config->out_height > LCD_V_RES ||
+        (config->crop_x + config->out_width) * scale > config->frame_width ||
+        (config->crop_y + config->out_height) * scale > config->frame_height) {
+        ESP_LOGE(TAG, "无效的预览窗口: 源%ux%u, 缩小%d, 裁剪(%u,%u), 输出%ux%u",
+                 config->frame_width, config->frame_height, scale, config->crop_x, config->crop_y,
+                 config->out_width, config->out_height);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 启动预览任务
+ */
+esp_err_t cam_preview_start(const cam_preview_config_t *config)
+{
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (running) {
+        ESP_LOGE(TAG, "预览已经启动");
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = cam_preview_check_config(config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (config->source == CAM_PREVIEW_SOURCE_DVP) {
+#if CAM_PREVIEW_USE_DVP
+        source = &cam_source_dvp;
+#else
+        ESP_LOGE(TAG, "未编译DVP帧源, 请设置CAM_PREVIEW_USE_DVP");
+        return ESP_ERR_NOT_SUPPORTED;
+#endif
+    } else {
+        source = &cam_source_synthetic;
+    }
+
+    preview_cfg = *config;
+    preview_stats = (cam_preview_stats_t){0};
+    latency_sum_us = 0;
+    window_frames = 0;
+    window_start_us = esp_timer_get_time();
+
+    exit_sem = xSemaphoreCreateBinary();
+    if (exit_sem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (config->out_width < LCD_H_RES || config->out_height < LCD_V_RES) {
+        ret = cam_preview_clear();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "清屏失败: %s", esp_err_to_name(ret));
+            vSemaphoreDelete(exit_sem);
+            exit_sem = NULL;
+            return ret;
+        }
+    }
+
+    ret = source->init(config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "%s帧源初始化失败: %s", source->name, esp_err_to_name(ret));
+        vSemaphoreDelete(exit_sem);
+        exit_sem = NULL;
+        return ret;
+    }
+
+    running = true;
+    if (xTaskCreatePinnedToCore(cam_preview_task, "cam_preview", CAM_PREVIEW_TASK_STACK, NULL,
+                                CAM_PREVIEW_TASK_PRIO, NULL, CAM_PREVIEW_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "创建预览任务失败");
+        running = false;
+        source->deinit();
+        vSemaphoreDelete(exit_sem);
+        exit_sem = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "预览已启动: %s帧源 %ux%u, %s, 输出%ux%u, %d个帧缓冲区 (%zu字节)",
+             source->name, config->frame_width, config->frame_height, config->downsample ? "2:1缩小" : "不缩小",
+             config->out_width, config->out_height, CAM_PREVIEW_FB_NUM, preview_stats.buf_bytes);
+    return ESP_OK;
+}
+
+/**
+ * @brief 停止预览
+ */
+esp_err_t cam_preview_stop(void)
+{
+    if (!running) {
+        return ESP_OK;
+    }
+    running = false;
+
+    if (xSemaphoreTake(exit_sem, pdMS_TO_TICKS(CAM_PREVIEW_TIMEOUT_MS * 2)) != pdTRUE) {
+        ESP_LOGE(TAG, "等待预览任务退出超时");
+        return ESP_ERR_TIMEOUT;
+    }
+    source->deinit();
+    vSemaphoreDelete(exit_sem);
+    exit_sem = NULL;
+    ESP_LOGI(TAG, "预览已停止");
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取预览统计
+ */
+esp_err_t cam_preview_get_stats(cam_preview_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&stats_lock);
+    *stats = preview_stats;
+    uint32_t frames = window_frames;
+    int64_t elapsed = now - window_start_us;
+    window_frames = 0;
+    window_start_us = now;
+    portEXIT_CRITICAL(&stats_lock);
+
+    if (elapsed > 0) {
+        stats->fps_x10 = (uint32_t)((uint64_t)frames * 10000000ULL / elapsed);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,127 @@
+/*
+ * 摄像头预览头文件
+ * DVP摄像头采集到帧缓冲区池, 在原地用PIE缩小/裁剪后, 同一块缓冲区直接交给ST7789做DMA传输,
+ * 采集、处理和显示之间没有像素复制; 没有摄像头时可以用合成帧源测量流水线性能
+ */
+
+#ifndef CAM_PREVIEW_H
+#define CAM_PREVIEW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 1: 编译DVP摄像头帧源 (需要先执行 idf.py add-dependency "espressif/esp32-camera"), 0: 只有合成帧源
+#define CAM_PREVIEW_USE_DVP         0
+
+// 预览配置
+#define CAM_PREVIEW_FB_NUM          2       // 帧缓冲区数量 (DVP帧源时为驱动的fb_count)
+#define CAM_PREVIEW_TASK_STACK      4096    // 预览任务栈大小
+#define CAM_PREVIEW_TASK_PRIO       5       // 预览任务优先级
+#define CAM_PREVIEW_TASK_CORE       1       // 预览任务核心 (合成帧源任务在另一个核心)
+#define CAM_PREVIEW_TIMEOUT_MS      1000    // 等待帧/DMA超时时间
+#define CAM_PREVIEW_SYNTH_FPS       0       // 合成帧源帧率, 0表示不限速 (测量流水线极限)
+
+// DVP引脚 (立创实战派ESP32-S3, GC0308; SCCB与I2C主机共用SDA 1 / SCL 2)
+#define CAM_PIN_XCLK                5
+#define CAM_PIN_PCLK                7
+#define CAM_PIN_VSYNC               3
+#define CAM_PIN_HREF                46
+#define CAM_PIN_D0                  16
+#define CAM_PIN_D1                  18
+#define CAM_PIN_D2                  8
+#define CAM_PIN_D3                  17
+#define CAM_PIN_D4                  15
+#define CAM_PIN_D5                  6
+#define CAM_PIN_D6                  4
+#define CAM_PIN_D7                  9
+#define CAM_XCLK_FREQ_HZ            24000000
+
+/**
+ * @brief 帧源
+ */
+typedef enum {
+    CAM_PREVIEW_SOURCE_SYNTHETIC,       // 合成帧源: 另一个核心上的任务按摄像头的方式填充缓冲区池
+    CAM_PREVIEW_SOURCE_DVP,             // DVP摄像头 (需要CAM_PREVIEW_USE_DVP)
+} cam_preview_source_t;
+
+/**
+ * @brief 预览配置
+ * @note 输出窗口在屏幕上居中; 缩小和裁剪都在帧缓冲区中原地完成, 不需要额外的缓冲区
+ */
+typedef struct {
+    cam_preview_source_t source;        // 帧源
+    uint16_t frame_width;               // 源帧宽度 (DVP支持160x120、240x176、320x240、640x480)
+    uint16_t frame_height;              // 源帧高度
+    bool downsample;                    // 2:1抽点缩小
+    bool swap_bytes;                    // 源像素为CPU字节序时原地交换为LCD字节序
+    uint16_t crop_x;                    // 裁剪窗口左上角 (缩小后的坐标, 8的倍数时缩小走向量路径)
+    uint16_t crop_y;
+    uint16_t out_width;                 // 输出窗口尺寸, 不超过屏幕
+    uint16_t out_height;
+} cam_preview_config_t;
+
+/**
+ * @brief 默认配置: 合成QVGA帧, 不缩小不裁剪, 整屏显示 (完全零拷贝)
+ */
+#define CAM_PREVIEW_DEFAULT_CONFIG() {          \
+    .source = CAM_PREVIEW_SOURCE_SYNTHETIC,     \
+    .frame_width = 320,                         \
+    .frame_height = 240,                        \
+    .downsample = false,                        \
+    .swap_bytes = false,                        \
+    .crop_x = 0,                                \
+    .crop_y = 0,                                \
+    .out_width = 320,                           \
+    .out_height = 240,                          \
+}
+
+/**
+ * @brief 预览统计
+ * @note 累计值从cam_preview_start开始; fps是上一次调用cam_preview_get_stats以来的平均值
+ */
+typedef struct {
+    uint32_t frames;                    // 已显示的帧数
+    uint32_t fps_x10;                   // 显示帧率 x10
+    uint32_t latency_us;                // 上一帧端到端延迟: 采集完成 -> 最后一行传输完成
+    uint32_t avg_latency_us;            // 平均端到端延迟
+    uint32_t max_latency_us;            // 最大端到端延迟
+    uint32_t wait_us;                   // 上一帧等待新帧的时间
+    uint32_t process_us;                // 上一帧原地缩小/裁剪/字节交换的时间
+    uint32_t flush_us;                  // 上一帧DMA传输的时间
+    uint32_t source_stalls;             // 合成帧源因缓冲区全部被占用而等待的次数
+    size_t buf_bytes;                   // 帧缓冲区总大小
+} cam_preview_stats_t;
+
+/**
+ * @brief 启动预览任务
+ * @note 需要先初始化ST7789; 预览期间不要使用其他方式绘制屏幕
+ * @param config 配置
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 配置无效, ESP_ERR_NOT_SUPPORTED 未编译DVP帧源,
+ *         ESP_ERR_NO_MEM 内存不足, 其他值表示错误
+ */
+esp_err_t cam_preview_start(const cam_preview_config_t *config);
+
+/**
+ * @brief 停止预览并释放帧缓冲区, DVP帧源时摄像头重新掉电
+ * @return ESP_OK 成功, ESP_ERR_TIMEOUT 任务未能按时退出
+ */
+esp_err_t cam_preview_stop(void);
+
+/**
+ * @brief 获取预览统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t cam_preview_get_stats(cam_preview_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAM_PREVIEW_H
@@ -0,0 +1,526 @@
+/*
+ * 字体图集实现
+ * 构建时由tools/font_atlas.py生成4bpp RLE字体图集并烧录到"font"分区,
+ * 运行时通过esp_partition_mmap直接读取, 解码后的字形保存在LRU缓存中
+ */
+
+#include "font_atlas.h"
+#include "rgb565.h"
+#include <string.h>
+#include <inttypes.h>
+#include "esp_partition.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "FONT_ATLAS";
+
+_Static_assert(sizeof(font_atlas_header_t) == 36, "图集文件头必须为36字节");
+_Static_assert(sizeof(font_atlas_glyph_t) == 16, "字形表项必须为16字节");
+_Static_assert(sizeof(font_atlas_kern_t) == 8, "字距表项必须为8字节");
+_Static_assert((FONT_CACHE_HASH_SIZE & (FONT_CACHE_HASH_SIZE - 1)) == 0, "哈希桶数必须是2的幂");
+
+#define FONT_CACHE_NONE             (-1)
+#define FONT_FALLBACK_CHAR          '?'
+
+/**
+ * @brief 缓存槽: 解码后的字形 + LRU链表和哈希链
+ */
+typedef struct {
+    uint32_t codepoint;
+    int16_t lru_prev;               // 更近使用的槽
+    int16_t lru_next;               // 更早使用的槽
+    int16_t hash_next;              // 同一哈希桶中的下一个槽
+    font_glyph_t glyph;
+    uint8_t alpha[FONT_GLYPH_MAX_W * FONT_GLYPH_MAX_H];
+} font_cache_slot_t;
+
+// 分区映射
+static esp_partition_mmap_handle_t map_handle;
+static const uint8_t *atlas = NULL;
+static const font_atlas_header_t *header = NULL;
+static const font_atlas_glyph_t *glyph_table = NULL;
+static const font_atlas_kern_t *kern_table = NULL;
+
+// LRU缓存
+static font_cache_slot_t *cache_slots = NULL;
+static int16_t hash_heads[FONT_CACHE_HASH_SIZE];
+static int16_t lru_head = FONT_CACHE_NONE;  // 最近使用
+static int16_t lru_tail = FONT_CACHE_NONE;  // 最久未使用
+static int cache_used = 0;
+static font_cache_stats_t cache_stats;
+
+// 文字颜色行, 作为逐像素混合的前景
+static uint16_t color_row[FONT_GLYPH_MAX_W];
+
+/**
+ * @brief 检查[offset, offset + size)是否在[0, end)内, size用64位传入, 计数乘表项大小不会溢出
+ */
+static bool font_atlas_range_ok(uint32_t offset, uint64_t size, uint32_t end)
+{
+    return offset <= end && size <= (uint64_t)(end - offset);
+}
+
+/**
+ * @brief 校验一个字形表项: 位图在位图区内, 码点严格递增 (二分查找的前提)
+ */
+static bool font_atlas_glyph_ok(const font_atlas_glyph_t *entry, const font_atlas_glyph_t *prev)
+{
+    if (prev != NULL && entry->codepoint <= prev->codepoint) {
+        return false;
+    }
+    return font_atlas_range_ok(entry->bitmap_offset, entry->bitmap_size, header->total_size - header->bitmap_offset);
+}
+
+/**
+ * @brief 校验图集文件头、各区段范围和每个字形表项
+ * @note 解码时直接按表项读取映射的分区, 所以损坏或截断的图集必须在这里全部拦下
+ */
+static esp_err_t font_atlas_validate(size_t partition_size)
+{
+    if (header->magic != FONT_ATLAS_MAGIC || header->version != FONT_ATLAS_VERSION || header->bpp != 4) {
+        ESP_LOGE(TAG, "图集无效: magic=0x%08" PRIX32 ", version=%u, bpp=%u",
+                 header->magic, header->version, header->bpp);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header->total_size > partition_size ||
+        header->glyph_table_offset < sizeof(font_atlas_header_t) || (header->glyph_table_offset & 3) != 0 ||
+        (header->kern_table_offset & 1) != 0 ||
+        !font_atlas_range_ok(header->glyph_table_offset, (uint64_t)header->glyph_count * sizeof(font_atlas_glyph_t),
+                             header->kern_table_offset) ||
+        !font_atlas_range_ok(header->kern_table_offset, (uint64_t)header->kern_count * sizeof(font_atlas_kern_t),
+                             header->bitmap_offset) ||
+        header->bitmap_offset > header->total_size) {
+        ESP_LOGE(TAG, "图集区段越界: 总大小=%" PRIu32 ", 分区大小=%zu", header->total_size, partition_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const font_atlas_glyph_t *table = (const font_atlas_glyph_t *)(atlas + header->glyph_table_offset);
+    for (uint32_t i = 0; i < header->glyph_count; i++) {
+        if (!font_atlas_glyph_ok(&table[i], (i > 0) ? &table[i - 1] : NULL)) {
+            ESP_LOGE(TAG, "字形%" PRIu32 "无效: 码点U+%04" PRIX32 ", 位图偏移%" PRIu32 ", %u字节",
+                     i, table[i].codepoint, table[i].bitmap_offset, table[i].bitmap_size);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 映射字体分区并校验图集
+ */
+esp_err_t font_atlas_init(void)
+{
+    ESP_LOGI(TAG, "加载字体图集...");
+
+    font_atlas_deinit();
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           FONT_ATLAS_PARTITION_SUBTYPE,
+                                                           FONT_ATLAS_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "未找到字体分区 \"%s\"", FONT_ATLAS_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *ptr;
+    esp_err_t ret = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &map_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "映射字体分区失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    atlas = ptr;
+    header = (const font_atlas_header_t *)atlas;
+
+    ret = font_atlas_validate(part->size);
+    if (ret != ESP_OK) {
+        font_atlas_deinit();
+        return ret;
+    }
+    glyph_table = (const font_atlas_glyph_t *)(atlas + header->glyph_table_offset);
+    kern_table = (const font_atlas_kern_t *)(atlas + header->kern_table_offset);
+
+    cache_slots = heap_caps_malloc(sizeof(font_cache_slot_t) * FONT_CACHE_SLOTS, MALLOC_CAP_INTERNAL);
+    if (cache_slots == NULL) {
+        ESP_LOGE(TAG, "分配字形缓存失败");
+        font_atlas_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    memset(hash_heads, 0xFF, sizeof(hash_heads));
+    lru_head = lru_tail = FONT_CACHE_NONE;
+    cache_used = 0;
+    cache_stats = (font_cache_stats_t){0};
+    cache_stats.cache_bytes = sizeof(font_cache_slot_t) * FONT_CACHE_SLOTS;
+
+    ESP_LOGI(TAG, "字体图集加载成功: %u号字, %" PRIu32 "个字形, %u个字距对, %" PRIu32 "字节",
+             header->font_size, header->glyph_count, header->kern_count, header->total_size);
+    ESP_LOGI(TAG, "字形缓存: %d个槽, %zu字节", FONT_CACHE_SLOTS, cache_stats.cache_bytes);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 取消映射并释放缓存
+ */
+void font_atlas_deinit(void)
+{
+    if (atlas != NULL) {
+        esp_partition_munmap(map_handle);
+        atlas = NULL;
+        header = NULL;
+        glyph_table = NULL;
+        kern_table = NULL;
+    }
+    heap_caps_free(cache_slots);
+    cache_slots = NULL;
+}
+
+/**
+ * @brief 行高
+ */
+int font_atlas_line_height(void)
+{
+    return header ? header->line_height : 0;
+}
+
+/**
+ * @brief 基线以上高度
+ */
+int font_atlas_ascent(void)
+{
+    return header ? header->ascent : 0;
+}
+
+/**
+ * @brief 在字形表中二分查找 (只读flash, 不解码)
+ */
+static const font_atlas_glyph_t *font_atlas_find(uint32_t codepoint)
+{
+    if (header == NULL) {
+        return NULL;
+    }
+    uint32_t lo = 0;
+    uint32_t hi = header->glyph_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint32_t cp = glyph_table[mid].codepoint;
+        if (cp == codepoint) {
+            return &glyph_table[mid];
+        }
+        if (cp < codepoint) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 从LRU链表中摘除
+ */
+static void font_cache_lru_unlink(int16_t slot)
+{
+    font_cache_slot_t *s = &cache_slots[slot];
+    if (s->lru_prev != FONT_CACHE_NONE) {
+        cache_slots[s->lru_prev].lru_next = s->lru_next;
+    } else {
+        lru_head = s->lru_next;
+    }
+    if (s->lru_next != FONT_CACHE_NONE) {
+        cache_slots[s->lru_next].lru_prev = s->lru_prev;
+    } else {
+        lru_tail = s->lru_prev;
+    }
+}
+
+/**
+ * @brief 插入到LRU链表头部 (最近使用)
+ */
+static void font_cache_lru_push_front(int16_t slot)
+{
+    font_cache_slot_t *s = &cache_slots[slot];
+    s->lru_prev = FONT_CACHE_NONE;
+    s->lru_next = lru_head;
+    if (lru_head != FONT_CACHE_NONE) {
+        cache_slots[lru_head].lru_prev = slot;
+    }
+    lru_head = slot;
+    if (lru_tail == FONT_CACHE_NONE) {
+        lru_tail = slot;
+    }
+}
+
+/**
+ * @brief 从哈希链中摘除
+ */
+static void font_cache_hash_remove(int16_t slot)
+{
+    int16_t *link = &hash_heads[cache_slots[slot].codepoint & (FONT_CACHE_HASH_SIZE - 1)];
+    while (*link != FONT_CACHE_NONE) {
+        if (*link == slot) {
+            *link = cache_slots[slot].hash_next;
+            return;
+        }
+        link = &cache_slots[*link].hash_next;
+    }
+}
+
+/**
+ * @brief RLE解码到缓存槽, 超出FONT_GLYPH_MAX_W/H的部分被裁掉
+ */
+static void font_cache_decode(font_cache_slot_t *slot, const font_atlas_glyph_t *entry)
+{
+    const uint8_t *rle = atlas + header->bitmap_offset + entry->bitmap_offset;
+    int src_w = entry->width;
+    int dst_w = (src_w > FONT_GLYPH_MAX_W) ? FONT_GLYPH_MAX_W : src_w;
+    int dst_h = (entry->height > FONT_GLYPH_MAX_H) ? FONT_GLYPH_MAX_H : entry->height;
+    int total = dst_h * src_w;
+    int pos = 0;
+
+    for (uint16_t i = 0; i < entry->bitmap_size && pos < total; i++) {
+        uint8_t alpha = (rle[i] >> 4) * 17;
+        int run = (rle[i] & 0x0F) + 1;
+        while (run-- > 0 && pos < total) {
+            int x = pos % src_w;
+            if (x < dst_w) {
+                slot->alpha[(pos / src_w) * dst_w + x] = alpha;
+            }
+            pos++;
+        }
+    }
+
+    slot->glyph.alpha = slot->alpha;
+    slot->glyph.width = dst_w;
+    slot->glyph.height = dst_h;
+    slot->glyph.x_offset = entry->x_offset;
+    slot->glyph.y_offset = entry->y_offset;
+    slot->glyph.advance = entry->advance;
+}
+
+/**
+ * @brief 获取字形
+ */
+esp_err_t font_atlas_get_glyph(uint32_t codepoint, font_glyph_t *glyph)
+{
+    if (glyph == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cache_slots == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 查缓存
+    int16_t *bucket = &hash_heads[codepoint & (FONT_CACHE_HASH_SIZE - 1)];
+    for (int16_t slot = *bucket; slot != FONT_CACHE_NONE; slot = cache_slots[slot].hash_next) {
+        if (cache_slots[slot].codepoint == codepoint) {
+            if (slot != lru_head) {
+                font_cache_lru_unlink(slot);
+                font_cache_lru_push_front(slot);
+            }
+            cache_stats.hits++;
+            *glyph = cache_slots[slot].glyph;
+            return ESP_OK;
+        }
+    }
+
+    const font_atlas_glyph_t *entry = font_atlas_find(codepoint);
+    if (entry == NULL) {
+        cache_stats.missing_glyphs++;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 取空闲槽, 没有则淘汰最久未使用的
+    int16_t slot;
+    if (cache_used < FONT_CACHE_SLOTS) {
+        slot = cache_used++;
+    } else {
+        slot = lru_tail;
+        font_cache_lru_unlink(slot);
+        font_cache_hash_remove(slot);
+        cache_stats.evictions++;
+    }
+
+    font_cache_slot_t *s = &cache_slots[slot];
+    font_cache_decode(s, entry);
+    s->codepoint = codepoint;
+    s->hash_next = *bucket;
+    *bucket = slot;
+    font_cache_lru_push_front(slot);
+
+    cache_stats.misses++;
+    *glyph = s->glyph;
+    return ESP_OK;
+}
+
+/**
+ * @brief 查询字距调整
+ */
+int font_atlas_get_kerning(uint32_t left, uint32_t right)
+{
+    if (header == NULL || header->kern_count == 0 || left > 0xFFFF || right > 0xFFFF) {
+        return 0;
+    }
+    uint32_t key = (left << 16) | right;
+    uint32_t lo = 0;
+    uint32_t hi = header->kern_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint32_t k = ((uint32_t)kern_table[mid].left << 16) | kern_table[mid].right;
+        if (k == key) {
+            return kern_table[mid].adjust;
+        }
+        if (k < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 解码一个UTF-8字符, 非法序列返回U+FFFD
+ */
+static uint32_t font_utf8_next(const char **text)
+{
+    const uint8_t *p = (const uint8_t *)*text;
+    uint32_t cp;
+    int extra;
+
+    if (p[0] < 0x80) {
+        cp = p[0];
+        extra = 0;
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        cp = p[0] & 0x1F;
+        extra = 1;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        cp = p[0] & 0x0F;
+        extra = 2;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        cp = p[0] & 0x07;
+        extra = 3;
+    } else {
+        *text += 1;
+        return 0xFFFD;
+    }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            *text += i;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *text += extra + 1;
+    return cp;
+}
+
+/**
+ * @brief 查找字形表项, 不存在时使用替代字符
+ */
+static const font_atlas_glyph_t *font_atlas_find_or_fallback(uint32_t *codepoint)
+{
+    const font_atlas_glyph_t *entry = font_atlas_find(*codepoint);
+    if (entry == NULL) {
+        cache_stats.missing_glyphs++;
+        *codepoint = FONT_FALLBACK_CHAR;
+        entry = font_atlas_find(*codepoint);
+    }
+    return entry;
+}
+
+/**
+ * @brief 在条带缓冲区中绘制UTF-8文本
+ */
+int font_draw_text(uint16_t *buf, int buf_w, int buf_y, int buf_h,
+                   int x, int baseline, const char *text, uint16_t color)
+{
+    if (buf == NULL || text == NULL || header == NULL) {
+        return 0;
+    }
+
+    rgb565_fill(color_row, color, FONT_GLYPH_MAX_W);
+
+    int pen = x;
+    uint32_t prev = 0;
+    while (*text != '\0') {
+        uint32_t cp = font_utf8_next(&text);
+        const font_atlas_glyph_t *entry = font_atlas_find_or_fallback(&cp);
+        if (entry == NULL) {
+            prev = 0;
+            continue;
+        }
+        if (prev != 0) {
+            pen += font_atlas_get_kerning(prev, cp);
+        }
+        prev = cp;
+
+        // 字形和本条带没有交集时只前进笔位置, 不解码
+        int gx = pen + entry->x_offset;
+        int gy = baseline - entry->y_offset;
+        pen += entry->advance;
+        int row0 = (gy > buf_y) ? gy : buf_y;
+        int row1 = (gy + entry->height < buf_y + buf_h) ? gy + entry->height : buf_y + buf_h;
+        if (row0 >= row1 || gx >= buf_w || gx + entry->width <= 0) {
+            continue;
+        }
+
+        font_glyph_t glyph;
+        if (font_atlas_get_glyph(cp, &glyph) != ESP_OK) {
+            continue;
+        }
+        row1 = (row1 > gy + glyph.height) ? gy + glyph.height : row1;
+        int col0 = (gx > 0) ? gx : 0;
+        int col1 = (gx + glyph.width < buf_w) ? gx + glyph.width : buf_w;
+        if (col0 >= col1) {
+            continue;
+        }
+
+        for (int row = row0; row < row1; row++) {
+            rgb565_blend_alpha8(&buf[(row - buf_y) * buf_w + col0], color_row,
+                                &glyph.alpha[(row - gy) * glyph.width + (col0 - gx)], col1 - col0);
+        }
+    }
+
+    return pen - x;
+}
+
+/**
+ * @brief 计算UTF-8文本宽度
+ */
+int font_measure_text(const char *text)
+{
+    if (text == NULL || header == NULL) {
+        return 0;
+    }
+
+    int width = 0;
+    uint32_t prev = 0;
+    while (*text != '\0') {
+        uint32_t cp = font_utf8_next(&text);
+        const font_atlas_glyph_t *entry = font_atlas_find_or_fallback(&cp);
+        if (entry == NULL) {
+            prev = 0;
+            continue;
+        }
+        if (prev != 0) {
+            width += font_atlas_get_kerning(prev, cp);
+        }
+        width += entry->advance;
+        prev = cp;
+    }
+    return width;
+}
+
+/**
+ * @brief 获取字形缓存统计
+ */
+esp_err_t font_atlas_get_cache_stats(font_cache_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = cache_stats;
+    stats->cached = cache_used;
+    return ESP_OK;
+}
@@ -0,0 +1,174 @@
+/*
+ * 字体图集头文件
+ * 构建时由tools/font_atlas.py生成4bpp RLE字体图集并烧录到"font"分区,
+ * 运行时通过esp_partition_mmap直接读取, 解码后的字形保存在LRU缓存中
+ */
+
+#ifndef FONT_ATLAS_H
+#define FONT_ATLAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 字体分区
+#define FONT_ATLAS_PARTITION_LABEL  "font"                  // 分区名
+#define FONT_ATLAS_PARTITION_SUBTYPE 0x40                   // 自定义数据分区子类型
+
+// 图集格式 (与tools/font_atlas.py一致)
+#define FONT_ATLAS_MAGIC            0x41544E46              // 'FNTA'
+#define FONT_ATLAS_VERSION          1
+
+// 字形缓存配置
+#define FONT_CACHE_SLOTS            64                      // 缓存字形数
+#define FONT_GLYPH_MAX_W            24                      // 单个字形最大宽度 (像素)
+#define FONT_GLYPH_MAX_H            24                      // 单个字形最大高度 (像素)
+#define FONT_CACHE_HASH_SIZE        128                     // 哈希桶数 (2的幂)
+
+/**
+ * @brief 图集文件头 (36字节)
+ */
+typedef struct {
+    uint32_t magic;                 // FONT_ATLAS_MAGIC
+    uint16_t version;               // FONT_ATLAS_VERSION
+    uint8_t font_size;              // 字号 (像素)
+    uint8_t bpp;                    // 每像素位数 (4)
+    int16_t ascent;                 // 基线以上高度
+    int16_t descent;                // 基线以下高度
+    uint16_t line_height;           // 行高
+    uint16_t kern_count;            // 字距对数量
+    uint32_t glyph_count;           // 字形数量
+    uint32_t glyph_table_offset;    // 字形表偏移
+    uint32_t kern_table_offset;     // 字距表偏移
+    uint32_t bitmap_offset;         // 位图数据偏移
+    uint32_t total_size;            // 图集总大小
+} font_atlas_header_t;
+
+/**
+ * @brief 字形表项 (16字节), 按码点升序排列
+ */
+typedef struct {
+    uint32_t codepoint;             // Unicode码点
+    uint32_t bitmap_offset;         // 位图在位图区中的偏移
+    uint16_t bitmap_size;           // RLE压缩后的字节数
+    uint8_t width;                  // 位图宽度
+    uint8_t height;                 // 位图高度
+    int8_t x_offset;                // 位图左边相对笔位置的偏移
+    int8_t y_offset;                // 位图顶部在基线以上的高度
+    uint8_t advance;                // 笔位置前进量
+    uint8_t reserved;
+} font_atlas_glyph_t;
+
+/**
+ * @brief 字距表项 (8字节), 按(left, right)升序排列
+ */
+typedef struct {
+    uint16_t left;                  // 左字符码点
+    uint16_t right;                 // 右字符码点
+    int16_t adjust;                 // 字距调整 (像素)
+    uint16_t reserved;
+} font_atlas_kern_t;
+
+/**
+ * @brief 解码后的字形 (8位透明度)
+ */
+typedef struct {
+    const uint8_t *alpha;           // width * height个透明度值, 0~255
+    uint8_t width;
+    uint8_t height;
+    int8_t x_offset;
+    int8_t y_offset;
+    uint8_t advance;
+} font_glyph_t;
+
+/**
+ * @brief 字形缓存统计
+ */
+typedef struct {
+    uint32_t hits;                  // 缓存命中次数
+    uint32_t misses;                // 缓存未命中次数 (即解码次数)
+    uint32_t evictions;             // 淘汰次数
+    uint32_t missing_glyphs;        // 图集中不存在的字符次数
+    uint32_t cached;                // 当前缓存的字形数
+    size_t cache_bytes;             // 缓存占用内存
+} font_cache_stats_t;
+
+/**
+ * @brief 映射字体分区并校验图集
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 分区不存在, ESP_ERR_INVALID_VERSION 图集无效, 其他值表示错误
+ */
+esp_err_t font_atlas_init(void);
+
+/**
+ * @brief 取消映射并释放缓存
+ */
+void font_atlas_deinit(void);
+
+/**
+ * @brief 行高 (像素)
+ */
+int font_atlas_line_height(void);
+
+/**
+ * @brief 基线以上高度 (像素)
+ */
+int font_atlas_ascent(void);
+
+/**
+ * @brief 获取字形 (优先从缓存中取, 未命中时解码并放入缓存)
+ * @note 返回的alpha指针在下一次font_atlas_get_glyph调用前有效
+ * @param codepoint Unicode码点
+ * @param glyph 返回的字形
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 图集中没有该字符
+ */
+esp_err_t font_atlas_get_glyph(uint32_t codepoint, font_glyph_t *glyph);
+
+/**
+ * @brief 查询字距调整
+ * @param left 左字符码点
+ * @param right 右字符码点
+ * @return 调整量 (像素), 没有字距对时为0
+ */
+int font_atlas_get_kerning(uint32_t left, uint32_t right);
+
+/**
+ * @brief 在条带缓冲区中绘制UTF-8文本
+ * @note 只绘制落在[buf_y, buf_y + buf_h)行范围内的部分, 可以在每个条带的渲染回调中直接调用;
+ *       多个条带重复绘制同一文本时字形只解码一次
+ * @param buf RGB565缓冲区 (LCD字节序)
+ * @param buf_w 缓冲区宽度 (像素)
+ * @param buf_y 缓冲区第一行对应的屏幕行
+ * @param buf_h 缓冲区行数
+ * @param x 文本起点x (屏幕坐标)
+ * @param baseline 基线y (屏幕坐标)
+ * @param text UTF-8文本
+ * @param color 文字颜色 (LCD字节序)
+ * @return 文本宽度 (像素)
+ */
+int font_draw_text(uint16_t *buf, int buf_w, int buf_y, int buf_h,
+                   int x, int baseline, const char *text, uint16_t color);
+
+/**
+ * @brief 计算UTF-8文本宽度 (含字距调整)
+ * @param text UTF-8文本
+ * @return 宽度 (像素)
+ */
+int font_measure_text(const char *text);
+
+/**
+ * @brief 获取字形缓存统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t font_atlas_get_cache_stats(font_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FONT_ATLAS_H
@@ -12,17 +12,170 @@
 #include "esp_chip_info.h"
 #include "esp_flash.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 #include "i2c_master.h"
 #include "pca9557.h"
+#include "st7789.h"
+#include "lcd_stripe.h"
+#include "rgb565.h"
+#include "font_atlas.h"
+#include "lcd_pipeline.h"
+#include "img_asset.h"
+#include "lcd_console.h"
+#include "lcd_governor.h"
+#include "cam_preview.h"
+#include "power_manager.h"
 
 
 static const char *TAG = "MAIN";
 
+// 统计信息打印间隔
+#define STATS_INTERVAL_US           (5 * 1000 * 1000)
+
+// 1: 双核流水线 (lcd_pipeline), 0: 单任务条带渲染 (lcd_stripe)
+#define DEMO_DUAL_CORE              1
+
+// 1: 双核流水线启用自适应帧率调节, 彩条动画和静止交替
+#define DEMO_GOVERNOR               1
+#define DEMO_PHASE_US               (3 * 1000 * 1000)
+
+// 1: 摄像头预览 (默认为合成帧源, 测量采集->显示流水线), 0: 彩条动画
+#define DEMO_CAMERA                 0
+
+// 1: 竖屏滚动日志控制台 (需要字体图集), 0: 彩条动画
+#define DEMO_LOG_CONSOLE            0
+
+// 演示用调色板 (RGB565, 高字节在前)
+static const uint16_t demo_colors[] = {0x00F8, 0xE007, 0x1F00, 0xFFFF, 0x0000};
+#define DEMO_COLOR_NUM              (sizeof(demo_colors) / sizeof(demo_colors[0]))
+#define DEMO_BAR_WIDTH              32      // 彩条宽度 (像素)
+#define DEMO_TEXT_X                 16      // 文字起点x
+#define DEMO_TEXT_Y                 40      // 第一行文字基线y
+
+// 演示文字, 字体图集构建时会扫描本文件收集其中的字符
+static const char *demo_text[] = {
+    "立创实战派 ESP32-S3",
+    "字体图集: 4bpp RLE + LRU缓存",
+    "字距: AVA To 温度 23.5°C",
+};
+#define DEMO_TEXT_NUM               (sizeof(demo_text) / sizeof(demo_text[0]))
+
+static bool font_ready = false;
+static const img_asset_t *demo_image = NULL;
+#define DEMO_IMAGE_MARGIN           8       // 图片距右下角的边距
+static uint32_t demo_offset = 0;
+
+/**
+ * @brief 演示场景: 向右滚动的竖直彩条
+ */
+static void demo_render_bars(uint16_t *buf, int y_start, int lines, void *user_ctx)
+{
+    uint32_t offset = *(uint32_t *)user_ctx;
+
+    // 条带内各行相同, 先渲染第一行再复制
+    for (int x = 0; x < LCD_H_RES; x++) {
+        buf[x] = demo_colors[((x + offset) / DEMO_BAR_WIDTH) % DEMO_COLOR_NUM];
+    }
+    for (int y = 1; y < lines; y++) {
+        rgb565_copy(&buf[y * LCD_H_RES], buf, LCD_H_RES);
+    }
+
+    // 文字叠加: 每个条带只绘制落在本条带内的部分
+    if (font_ready) {
+        int line_height = font_atlas_line_height();
+        for (size_t i = 0; i < DEMO_TEXT_NUM; i++) {
+            font_draw_text(buf, LCD_H_RES, y_start, lines, DEMO_TEXT_X, DEMO_TEXT_Y + i * line_height,
+                           demo_text[i], 0xFFFF);
+        }
+    }
+
+    // 图片资源: 从flash按行解码到条带, 放在右下角
+    if (demo_image != NULL) {
+        img_asset_draw(demo_image, buf, LCD_H_RES, y_start, lines,
+                       LCD_H_RES - demo_image->width - DEMO_IMAGE_MARGIN,
+                       LCD_V_RES - demo_image->height - DEMO_IMAGE_MARGIN);
+    }
+}
+
+/**
+ * @brief 每帧开始前推进彩条滚动位置
+ */
+static void demo_next_frame(uint32_t frame, void *user_ctx)
+{
+#if DEMO_DUAL_CORE && DEMO_GOVERNOR
+    // 动画和静止交替, 静止期间没有脏区域, 帧率逐步降低
+    if ((esp_timer_get_time() / DEMO_PHASE_US) % 2 != 0) {
+        return;
+    }
+    *(uint32_t *)user_ctx += 2;
+    lcd_governor_mark_dirty(0, LCD_V_RES);
+#else
+    *(uint32_t *)user_ctx = frame * 2;
+#endif
+}
+
+/**
+ * @brief 打印帧同步、渲染和字形缓存统计
+ */
+static void demo_log_stats(void)
+{
+    st7789_frame_stats_t stats;
+    st7789_get_frame_stats(&stats);
+    ESP_LOGI(TAG, "帧数=%" PRIu32 ", 错过刷新=%" PRIu32 ", 帧间隔=%" PRIu32 "us(平均%" PRIu32 "us, 最大%" PRIu32 "us), 单帧耗时=%" PRIu32 "us(最大%" PRIu32 "us), TE周期=%" PRIu32 "us",
+             stats.frames, stats.missed_deadlines, stats.last_frame_us,
+             stats.avg_frame_us, stats.max_frame_us, stats.last_busy_us, stats.max_busy_us, stats.te_period_us);
+    ESP_LOGI(TAG, "片选: 切换%" PRIu32 "次, I2C写入 上一帧%" PRIu32 "次, 单帧最多%" PRIu32 "次, 共%" PRIu32 "次",
+             stats.cs_toggles, stats.last_frame_i2c_writes, stats.max_frame_i2c_writes, stats.i2c_writes);
+#if DEMO_DUAL_CORE
+    lcd_pipeline_stats_t pipe_stats;
+    lcd_pipeline_get_stats(&pipe_stats);
+    ESP_LOGI(TAG, "流水线: %" PRIu32 ".%" PRIu32 "fps, 帧延迟%" PRIu32 "us(平均%" PRIu32 "us, 最大%" PRIu32 "us), 反压%" PRIu32 "次, 刷新空等%" PRIu32 "次",
+             pipe_stats.fps_x10 / 10, pipe_stats.fps_x10 % 10, pipe_stats.latency_us, pipe_stats.avg_latency_us,
+             pipe_stats.max_latency_us, pipe_stats.render_stalls, pipe_stats.flush_starved);
+    ESP_LOGI(TAG, "核心占用: 渲染(核心%d) %d%%, 刷新(核心%d) %d%%, 缓冲区%zu字节",
+             pipe_stats.render_core, pipe_stats.render_load, pipe_stats.flush_core, pipe_stats.flush_load,
+             pipe_stats.buf_bytes);
+#if DEMO_GOVERNOR
+    lcd_governor_stats_t gov_stats;
+    lcd_governor_get_stats(&gov_stats);
+    ESP_LOGI(TAG, "帧率调节: 目标%" PRIu32 "fps, 实际%" PRIu32 ".%" PRIu32 "fps, 渲染%" PRIu32 "帧, 跳过%" PRIu32 "帧, 开销%" PRIu32 "us, 脏区域%d%%, PM锁%d%%",
+             gov_stats.target_fps, gov_stats.measured_fps_x10 / 10, gov_stats.measured_fps_x10 % 10,
+             gov_stats.rendered_frames, gov_stats.skipped_frames, gov_stats.cost_us,
+             gov_stats.damage_pct, gov_stats.pm_lock_pct);
+#endif
+    power_manager_report();
+#else
+    lcd_stripe_stats_t stripe_stats;
+    lcd_stripe_get_stats(&stripe_stats);
+    ESP_LOGI(TAG, "条带%d行, 缓冲区%zu字节, 内部RAM最低剩余%zu字节, 渲染%" PRIu32 "us/帧, 总计%" PRIu32 "us/帧",
+             stripe_stats.stripe_lines, stripe_stats.internal_buf_bytes, stripe_stats.internal_min_free,
+             stripe_stats.render_us, stripe_stats.frame_us);
+#endif
+    if (font_ready) {
+        font_cache_stats_t font_stats;
+        font_atlas_get_cache_stats(&font_stats);
+        ESP_LOGI(TAG, "字形缓存: 命中%" PRIu32 ", 未命中%" PRIu32 ", 淘汰%" PRIu32 ", 缺字%" PRIu32 ", 已缓存%" PRIu32 "/%d",
+                 font_stats.hits, font_stats.misses, font_stats.evictions, font_stats.missing_glyphs,
+                 font_stats.cached, FONT_CACHE_SLOTS);
+    }
+}
+
 void app_main(void)
 {
+    // 像素内核自检: 加速实现必须和参考实现逐位一致
+    esp_err_t ret = rgb565_self_test();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "RGB565内核自检失败: %s", esp_err_to_name(ret));
+        return;
+    }
+    rgb565_benchmark();
+
+    // 动态调频和自动轻度睡眠: 空闲时降到80MHz, 帧率调节只在帧渲染和传输期间持有最高频率锁
+    power_manager_init(NULL);
+
     // 初始化I2C主机
-    esp_err_t ret = i2c_master_init();
+    ret = i2c_master_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "I2C主机初始化失败: %s", esp_err_to_name(ret));
         return;
@@ -31,6 +184,111 @@ void app_main(void)
     // 初始化PCA9557PW IO扩展芯片
     pca9557_init();
 
+    // IO0-IO2设为输出: 拉低LCD片选, 关闭功放, 摄像头掉电 (三根控制线合并成一次写入)
+    pca9557_update_outputs(PCA9557_LCD_CS | PCA9557_PA_EN | PCA9557_DVP_PWDN, PCA9557_DVP_PWDN);
+    pca9557_set_io_direction(PCA9557_LCD_CS | PCA9557_PA_EN | PCA9557_DVP_PWDN, PCA9557_IO_OUTPUT);
+
     // 等待一段时间让屏幕稳定
     vTaskDelay(1000 / portTICK_PERIOD_MS);
+
+    ret = st7789_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "LCD初始化失败: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    // TE引脚未连接时退化为不限速模式
+    if (st7789_te_enable(true) != ESP_OK) {
+        ESP_LOGW(TAG, "TE帧同步不可用, 渲染不受刷新率限制");
+    }
+
+    // 字体图集: "font"分区为空时只显示彩条
+    ret = font_atlas_init();
+    if (ret == ESP_OK) {
+        font_ready = true;
+    } else {
+        ESP_LOGW(TAG, "字体图集不可用, 不显示文字: %s", esp_err_to_name(ret));
+    }
+
+    // 图片资源: 先和未压缩对照比较解码+传输耗时, 再显示第一张图片
+    ret = img_asset_init();
+    if (ret == ESP_OK && img_asset_count() > 0) {
+        img_asset_benchmark();
+        demo_image = img_asset_get(0);
+    } else {
+        ESP_LOGW(TAG, "图片资源不可用, 不显示图片");
+    }
+
+#if DEMO_CAMERA
+    // 摄像头预览: 帧缓冲区原地处理后直接DMA到屏幕
+    cam_preview_config_t cam_cfg = CAM_PREVIEW_DEFAULT_CONFIG();
+    if (cam_preview_start(&cam_cfg) == ESP_OK) {
+        while (1) {
+            vTaskDelay(pdMS_TO_TICKS(STATS_INTERVAL_US / 1000));
+            cam_preview_stats_t cam_stats;
+            cam_preview_get_stats(&cam_stats);
+            ESP_LOGI(TAG, "预览: %" PRIu32 ".%" PRIu32 "fps, 延迟%" PRIu32 "us(平均%" PRIu32 "us, 最大%" PRIu32 "us), 等待%" PRIu32 "us, 处理%" PRIu32 "us, 传输%" PRIu32 "us, 帧源等待%" PRIu32 "次",
+                     cam_stats.fps_x10 / 10, cam_stats.fps_x10 % 10, cam_stats.latency_us, cam_stats.avg_latency_us,
+                     cam_stats.max_latency_us, cam_stats.wait_us, cam_stats.process_us, cam_stats.flush_us,
+                     cam_stats.source_stalls);
+        }
+    }
+    ESP_LOGW(TAG, "摄像头预览不可用, 显示彩条");
+#endif
+
+#if DEMO_LOG_CONSOLE
+    // 日志控制台: ESP_LOG输出同时滚动显示在屏幕上
+    if (font_ready && lcd_console_start(true) == ESP_OK) {
+        while (1) {
+            vTaskDelay(pdMS_TO_TICKS(STATS_INTERVAL_US / 1000));
+            lcd_console_stats_t console_stats;
+            lcd_console_get_stats(&console_stats);
+            ESP_LOGI(TAG, "控制台: %" PRIu32 "行, 丢弃%" PRIu32 "行, 单行%" PRIu32 "us(最大%" PRIu32 "us)",
+                     console_stats.lines, console_stats.dropped, console_stats.last_line_us,
+                     console_stats.max_line_us);
+        }
+    }
+    ESP_LOGW(TAG, "日志控制台不可用, 显示彩条");
+#endif
+
+#if DEMO_DUAL_CORE
+    // 双核流水线: 核心1渲染, 核心0送SPI
+    lcd_pipeline_config_t pipe_cfg = LCD_PIPELINE_DEFAULT_CONFIG(demo_render_bars, &demo_offset);
+    pipe_cfg.frame_cb = demo_next_frame;
+    pipe_cfg.governor = DEMO_GOVERNOR;
+    ret = lcd_pipeline_start(&pipe_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "显示流水线启动失败: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(STATS_INTERVAL_US / 1000));
+        demo_log_stats();
+    }
+#else
+    // 条带渲染: 两块小DMA缓冲区代替150KB整帧缓冲
+    ret = lcd_stripe_init(NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "条带渲染器初始化失败: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    int64_t last_report = esp_timer_get_time();
+    uint32_t frame = 0;
+
+    while (1) {
+        demo_next_frame(frame++, &demo_offset);
+        lcd_stripe_render_frame(demo_render_bars, &demo_offset);
+
+        int64_t now = esp_timer_get_time();
+        if (now - last_report >= STATS_INTERVAL_US) {
+            demo_log_stats();
+            last_report = now;
+        }
+
+        // 让出CPU给空闲任务
+        vTaskDelay(1);
+    }
+#endif
 }
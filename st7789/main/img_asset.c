@@ -0,0 +1,441 @@
+/*
+ * 图片资源实现
+ * 构建时由tools/img_pack.py把PNG打包成压缩图片资源包并烧录到"img"分区,
+ * 运行时通过esp_partition_mmap直接读取, 按行解码到条带缓冲区, 不需要整图缓冲
+ */
+
+#include "img_asset.h"
+#include "rgb565.h"
+#include "st7789.h"
+#include "lcd_stripe.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_partition.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "IMG_ASSET";
+
+_Static_assert(sizeof(img_asset_pack_header_t) == 16, "资源包文件头必须为16字节");
+_Static_assert(sizeof(img_asset_t) == 52, "资源表项必须为52字节");
+
+static const char *img_format_names[] = {"RAW565", "RLE565", "PAL8"};
+#define IMG_ASSET_FORMAT_NUM        (sizeof(img_format_names) / sizeof(img_format_names[0]))
+
+// 分区映射
+static esp_partition_mmap_handle_t map_handle;
+static const uint8_t *pack = NULL;
+static const uint8_t *pack_end = NULL;
+static const img_asset_t *asset_table = NULL;
+static int asset_count = 0;
+
+// 行解码缓冲区 (裁剪或带透明度时使用), 对齐以便走PIE路径
+static uint16_t row_buf[IMG_ASSET_MAX_WIDTH] __attribute__((aligned(16)));
+static uint8_t alpha_buf[IMG_ASSET_MAX_WIDTH] __attribute__((aligned(16)));
+
+/**
+ * @brief 检查[offset, offset + size)是否在资源包内且按4字节对齐
+ */
+static bool img_asset_range_ok(uint32_t offset, uint32_t size)
+{
+    return (offset & 3) == 0 && offset <= (uint32_t)(pack_end - pack) && size <= (uint32_t)(pack_end - pack) - offset;
+}
+
+/**
+ * @brief 校验一个资源表项
+ */
+static bool img_asset_entry_ok(const img_asset_t *img)
+{
+    if (img->width == 0 || img->width > IMG_ASSET_MAX_WIDTH || img->height == 0 ||
+        img->format >= IMG_ASSET_FORMAT_NUM || img->name[IMG_ASSET_NAME_LEN - 1] != '\0') {
+        return false;
+    }
+    uint32_t rows_bytes = img->height * sizeof(uint32_t);
+    if (img->format == IMG_ASSET_FMT_RAW565) {
+        if (img->rows_offset != 0 || !img_asset_range_ok(img->data_offset, img->width * img->height * 2)) {
+            return false;
+        }
+    } else if (img->rows_offset == 0 || !img_asset_range_ok(img->rows_offset, rows_bytes) ||
+               !img_asset_range_ok(img->data_offset, 0)) {
+        return false;
+    }
+    if (img->format == IMG_ASSET_FMT_PAL8 &&
+        (img->palette_count == 0 || img->palette_count > 256 ||
+         !img_asset_range_ok(img->palette_offset, img->palette_count * sizeof(uint16_t)))) {
+        return false;
+    }
+    if (img->flags & IMG_ASSET_FLAG_ALPHA) {
+        if (img->alpha_rows_offset == 0) {
+            return img_asset_range_ok(img->alpha_offset, img->width * img->height);
+        }
+        return img_asset_range_ok(img->alpha_rows_offset, rows_bytes) && img_asset_range_ok(img->alpha_offset, 0);
+    }
+    return true;
+}
+
+/**
+ * @brief 映射图片分区并校验资源包
+ */
+esp_err_t img_asset_init(void)
+{
+    ESP_LOGI(TAG, "加载图片资源...");
+
+    img_asset_deinit();
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           IMG_ASSET_PARTITION_SUBTYPE,
+                                                           IMG_ASSET_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGE(TAG, "未找到图片分区 \"%s\"", IMG_ASSET_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void *ptr;
+    esp_err_t ret = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &map_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "映射图片分区失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    pack = ptr;
+
+    const img_asset_pack_header_t *header = (const img_asset_pack_header_t *)pack;
+    if (header->magic != IMG_ASSET_MAGIC || header->version != IMG_ASSET_VERSION) {
+        ESP_LOGE(TAG, "资源包无效: magic=0x%08" PRIX32 ", version=%u", header->magic, header->version);
+        img_asset_deinit();
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header->total_size > part->size) {
+        ESP_LOGE(TAG, "资源包大小%" PRIu32 "超出分区大小%" PRIu32, header->total_size, (uint32_t)part->size);
+        img_asset_deinit();
+        return ESP_ERR_INVALID_SIZE;
+    }
+    pack_end = pack + header->total_size;
+
+    if (!img_asset_range_ok(header->table_offset, header->count * sizeof(img_asset_t))) {
+        ESP_LOGE(TAG, "资源表越界");
+        img_asset_deinit();
+        return ESP_ERR_INVALID_SIZE;
+    }
+    asset_table = (const img_asset_t *)(pack + header->table_offset);
+    for (int i = 0; i < header->count; i++) {
+        if (!img_asset_entry_ok(&asset_table[i])) {
+            ESP_LOGE(TAG, "资源%d无效", i);
+            img_asset_deinit();
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    asset_count = header->count;
+
+    ESP_LOGI(TAG, "图片资源加载成功: %d个资源, %" PRIu32 "字节", asset_count, header->total_size);
+    for (int i = 0; i < asset_count; i++) {
+        const img_asset_t *img = &asset_table[i];
+        ESP_LOGI(TAG, "  %-15s %3ux%-3u %-6s%s %" PRIu32 "字节", img->name, img->width, img->height,
+                 img_format_names[img->format], (img->flags & IMG_ASSET_FLAG_ALPHA) ? "+A" : "  ",
+                 img->data_size + img->alpha_size);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 取消映射
+ */
+void img_asset_deinit(void)
+{
+    if (pack != NULL) {
+        esp_partition_munmap(map_handle);
+        pack = NULL;
+        pack_end = NULL;
+        asset_table = NULL;
+        asset_count = 0;
+    }
+}
+
+/**
+ * @brief 资源数量
+ */
+int img_asset_count(void)
+{
+    return asset_count;
+}
+
+/**
+ * @brief 按序号获取资源
+ */
+const img_asset_t *img_asset_get(int index)
+{
+    if (index < 0 || index >= asset_count) {
+        return NULL;
+    }
+    return &asset_table[index];
+}
+
+/**
+ * @brief 按名字查找资源
+ */
+const img_asset_t *img_asset_find(const char *name)
+{
+    if (name == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < asset_count; i++) {
+        if (strncmp(asset_table[i].name, name, IMG_ASSET_NAME_LEN) == 0) {
+            return &asset_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 取得第iy行压缩数据的起始地址
+ */
+static const uint8_t *img_asset_row(uint32_t rows_offset, uint32_t data_offset, int iy)
+{
+    const uint32_t *rows = (const uint32_t *)(pack + rows_offset);
+    return pack + data_offset + rows[iy];
+}
+
+/**
+ * @brief 解码一行像素
+ * @return 该行像素; RAW格式直接返回flash中的数据, 其他格式解码到out; 数据损坏时为NULL
+ */
+static const uint16_t *img_asset_decode_pixels(const img_asset_t *img, int iy, uint16_t *out)
+{
+    if (img->format == IMG_ASSET_FMT_RAW565) {
+        return (const uint16_t *)(pack + img->data_offset) + iy * img->width;
+    }
+
+    const uint8_t *src = img_asset_row(img->rows_offset, img->data_offset, iy);
+    const uint16_t *palette = (const uint16_t *)(pack + img->palette_offset);
+    bool pal8 = (img->format == IMG_ASSET_FMT_PAL8);
+    int elem = pal8 ? 1 : 2;
+    int x = 0;
+
+    while (x < img->width) {
+        if (src >= pack_end) {
+            return NULL;
+        }
+        uint8_t c = *src++;
+        int n = (c & 0x7F) + 1;
+        int bytes = (c & 0x80) ? elem : n * elem;
+        if (x + n > img->width || bytes > pack_end - src) {
+            return NULL;
+        }
+
+        if (pal8) {
+            if (c & 0x80) {
+                if (src[0] >= img->palette_count) {
+                    return NULL;
+                }
+                rgb565_fill(&out[x], palette[src[0]], n);
+            } else {
+                for (int i = 0; i < n; i++) {
+                    if (src[i] >= img->palette_count) {
+                        return NULL;
+                    }
+                    out[x + i] = palette[src[i]];
+                }
+            }
+        } else {
+            // 像素在压缩流中不一定2字节对齐, 按字节读取
+            if (c & 0x80) {
+                rgb565_fill(&out[x], (uint16_t)(src[0] | (src[1] << 8)), n);
+            } else {
+                memcpy(&out[x], src, n * 2);
+            }
+        }
+        src += bytes;
+        x += n;
+    }
+    return out;
+}
+
+/**
+ * @brief 解码一行透明度
+ * @return 该行透明度; 未压缩时直接返回flash中的数据; 数据损坏时为NULL
+ */
+static const uint8_t *img_asset_decode_alpha(const img_asset_t *img, int iy, uint8_t *out)
+{
+    if (img->alpha_rows_offset == 0) {
+        return pack + img->alpha_offset + iy * img->width;
+    }
+
+    const uint8_t *src = img_asset_row(img->alpha_rows_offset, img->alpha_offset, iy);
+    int x = 0;
+    while (x < img->width) {
+        if (src >= pack_end) {
+            return NULL;
+        }
+        uint8_t c = *src++;
+        int n = (c & 0x7F) + 1;
+        int bytes = (c & 0x80) ? 1 : n;
+        if (x + n > img->width || bytes > pack_end - src) {
+            return NULL;
+        }
+        if (c & 0x80) {
+            memset(&out[x], src[0], n);
+        } else {
+            memcpy(&out[x], src, n);
+        }
+        src += bytes;
+        x += n;
+    }
+    return out;
+}
+
+/**
+ * @brief 把图片绘制到条带缓冲区
+ */
+esp_err_t img_asset_draw(const img_asset_t *img, uint16_t *buf, int buf_w, int buf_y, int buf_h, int x, int y)
+{
+    if (img == NULL || buf == NULL || pack == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int row0 = (y > buf_y) ? y : buf_y;
+    int row1 = (y + img->height < buf_y + buf_h) ? y + img->height : buf_y + buf_h;
+    int col0 = (x > 0) ? x : 0;
+    int col1 = (x + img->width < buf_w) ? x + img->width : buf_w;
+    if (row0 >= row1 || col0 >= col1) {
+        return ESP_OK;
+    }
+
+    bool has_alpha = (img->flags & IMG_ASSET_FLAG_ALPHA) != 0;
+    // 不透明且整行可见时直接解码到条带缓冲区, 省掉一次复制
+    bool direct = !has_alpha && col0 == x && col1 == x + img->width;
+    int skip = col0 - x;
+    int n = col1 - col0;
+
+    for (int row = row0; row < row1; row++) {
+        int iy = row - y;
+        uint16_t *dst = &buf[(row - buf_y) * buf_w];
+        const uint16_t *pixels = img_asset_decode_pixels(img, iy, direct ? &dst[x] : row_buf);
+        if (pixels == NULL) {
+            ESP_LOGE(TAG, "资源\"%s\"第%d行数据损坏", img->name, iy);
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        if (has_alpha) {
+            const uint8_t *alpha = img_asset_decode_alpha(img, iy, alpha_buf);
+            if (alpha == NULL) {
+                ESP_LOGE(TAG, "资源\"%s\"第%d行透明度数据损坏", img->name, iy);
+                return ESP_ERR_INVALID_SIZE;
+            }
+            rgb565_blend_alpha8(&dst[col0], &pixels[skip], &alpha[skip], n);
+        } else if (pixels != &dst[x]) {
+            rgb565_copy(&dst[col0], &pixels[skip], n);
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 基准测试渲染回调: 黑色背景 + 左上角的图片
+ */
+static void img_asset_bench_render(uint16_t *buf, int y_start, int lines, void *user_ctx)
+{
+    rgb565_fill(buf, 0x0000, LCD_H_RES * lines);
+    img_asset_draw(user_ctx, buf, LCD_H_RES, y_start, lines, 0, 0);
+}
+
+/**
+ * @brief 测量一个资源的每帧解码耗时和解码+传输耗时
+ */
+static esp_err_t img_asset_bench_one(const img_asset_t *img, uint16_t *stripe_buf,
+                                     uint32_t *decode_us, uint32_t *frame_us)
+{
+    // 只解码: 所有条带渲染到同一个缓冲区
+    int64_t t0 = esp_timer_get_time();
+    for (int r = 0; r < IMG_ASSET_BENCH_ROUNDS; r++) {
+        for (int y = 0; y < LCD_V_RES; y += LCD_STRIPE_DEFAULT_LINES) {
+            int lines = (y + LCD_STRIPE_DEFAULT_LINES > LCD_V_RES) ? (LCD_V_RES - y) : LCD_STRIPE_DEFAULT_LINES;
+            img_asset_bench_render(stripe_buf, y, lines, (void *)img);
+        }
+    }
+    *decode_us = (uint32_t)((esp_timer_get_time() - t0) / IMG_ASSET_BENCH_ROUNDS);
+
+    // 解码+传输
+    t0 = esp_timer_get_time();
+    for (int r = 0; r < IMG_ASSET_BENCH_ROUNDS; r++) {
+        esp_err_t ret = lcd_stripe_render_frame(img_asset_bench_render, (void *)img);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    esp_err_t ret = st7789_wait_flush_done(LCD_STRIPE_TIMEOUT_MS);
+    *frame_us = (uint32_t)((esp_timer_get_time() - t0) / IMG_ASSET_BENCH_ROUNDS);
+    return ret;
+}
+
+/**
+ * @brief 基准测试: 比较压缩资源与未压缩对照的解码和解码+传输耗时
+ */
+esp_err_t img_asset_benchmark(void)
+{
+    if (pack == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint16_t *stripe_buf = heap_caps_malloc(LCD_H_RES * LCD_STRIPE_DEFAULT_LINES * sizeof(uint16_t),
+                                            MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (stripe_buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = lcd_stripe_init(NULL);
+    if (ret != ESP_OK) {
+        heap_caps_free(stripe_buf);
+        return ret;
+    }
+
+    // TE帧同步会把传输耗时钳在刷新周期上, 测试期间关闭
+    bool te_was_enabled = st7789_te_is_enabled();
+    if (te_was_enabled) {
+        st7789_te_enable(false);
+    }
+
+    ESP_LOGI(TAG, "图片解码基准测试 (%d帧平均, 每帧含%dx%d背景填充):", IMG_ASSET_BENCH_ROUNDS, LCD_H_RES, LCD_V_RES);
+    size_t suffix_len = strlen(IMG_ASSET_RAW_SUFFIX);
+
+    for (int i = 0; i < asset_count && ret == ESP_OK; i++) {
+        const img_asset_t *img = &asset_table[i];
+        size_t name_len = strlen(img->name);
+        if (name_len >= suffix_len && strcmp(img->name + name_len - suffix_len, IMG_ASSET_RAW_SUFFIX) == 0) {
+            continue;
+        }
+
+        uint32_t decode_us, frame_us;
+        ret = img_asset_bench_one(img, stripe_buf, &decode_us, &frame_us);
+        if (ret != ESP_OK) {
+            break;
+        }
+        uint32_t size = img->data_size + img->alpha_size;
+        ESP_LOGI(TAG, "  %-15s %-6s %7" PRIu32 "字节, 解码%6" PRIu32 "us/帧, 解码+传输%6" PRIu32 "us/帧",
+                 img->name, img_format_names[img->format], size, decode_us, frame_us);
+
+        // 查找未压缩对照
+        char raw_name[IMG_ASSET_NAME_LEN + 8];
+        snprintf(raw_name, sizeof(raw_name), "%s%s", img->name, IMG_ASSET_RAW_SUFFIX);
+        const img_asset_t *raw = img_asset_find(raw_name);
+        if (raw == NULL) {
+            continue;
+        }
+        uint32_t raw_decode_us, raw_frame_us;
+        ret = img_asset_bench_one(raw, stripe_buf, &raw_decode_us, &raw_frame_us);
+        if (ret != ESP_OK) {
+            break;
+        }
+        uint32_t raw_size = raw->data_size + raw->alpha_size;
+        ESP_LOGI(TAG, "  %-15s %-6s %7" PRIu32 "字节, 解码%6" PRIu32 "us/帧, 解码+传输%6" PRIu32 "us/帧",
+                 raw->name, img_format_names[raw->format], raw_size, raw_decode_us, raw_frame_us);
+        ESP_LOGI(TAG, "  -> 大小为RAW的%" PRIu32 "%%, 解码+传输耗时为RAW的%" PRIu32 "%%",
+                 raw_size ? size * 100 / raw_size : 0, raw_frame_us ? frame_us * 100 / raw_frame_us : 0);
+    }
+
+    if (te_was_enabled) {
+        st7789_te_enable(true);
+    }
+    lcd_stripe_deinit();
+    heap_caps_free(stripe_buf);
+    return ret;
+}
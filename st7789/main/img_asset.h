@@ -0,0 +1,134 @@
+/*
+ * 图片资源头文件
+ * 构建时由tools/img_pack.py把PNG打包成压缩图片资源包并烧录到"img"分区,
+ * 运行时通过esp_partition_mmap直接读取, 按行解码到条带缓冲区, 不需要整图缓冲
+ */
+
+#ifndef IMG_ASSET_H
+#define IMG_ASSET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 图片分区
+#define IMG_ASSET_PARTITION_LABEL   "img"                   // 分区名
+#define IMG_ASSET_PARTITION_SUBTYPE 0x41                    // 自定义数据分区子类型
+
+// 资源包格式 (与tools/img_pack.py一致)
+#define IMG_ASSET_MAGIC             0x50474D49              // 'IMGP'
+#define IMG_ASSET_VERSION           1
+#define IMG_ASSET_NAME_LEN          16                      // 资源名长度 (含结尾0)
+#define IMG_ASSET_MAX_WIDTH         320                     // 图片最大宽度 (行解码缓冲区大小)
+#define IMG_ASSET_FLAG_ALPHA        0x01                    // 带8位透明度平面
+#define IMG_ASSET_RAW_SUFFIX        ".raw"                  // 基准测试用的未压缩对照资源后缀
+
+// 基准测试配置
+#define IMG_ASSET_BENCH_ROUNDS      10                      // 每个资源重复帧数
+
+/**
+ * @brief 像素数据格式
+ *
+ * RLE和调色板格式每行独立编码 (PackBits): 控制字节c最高位为1时, 下一个元素重复(c & 0x7F) + 1次;
+ * 最高位为0时, 后面跟c + 1个原样元素。RLE565的元素是2字节像素 (LCD字节序),
+ * PAL8的元素是1字节调色板索引, 透明度平面的元素是1字节透明度。
+ */
+typedef enum {
+    IMG_ASSET_FMT_RAW565 = 0,       // 未压缩RGB565
+    IMG_ASSET_FMT_RLE565 = 1,       // RLE压缩RGB565
+    IMG_ASSET_FMT_PAL8 = 2,         // 最多256色调色板 + RLE压缩索引
+} img_asset_format_t;
+
+/**
+ * @brief 资源包文件头 (16字节)
+ */
+typedef struct {
+    uint32_t magic;                 // IMG_ASSET_MAGIC
+    uint16_t version;               // IMG_ASSET_VERSION
+    uint16_t count;                 // 资源数量
+    uint32_t table_offset;          // 资源表偏移
+    uint32_t total_size;            // 资源包总大小
+} img_asset_pack_header_t;
+
+/**
+ * @brief 资源表项 (52字节), 所有偏移相对资源包起始, 4字节对齐
+ * @note 行偏移表为height个uint32_t, 值相对对应数据区; 为0表示该平面未压缩, 按行等长存放
+ */
+typedef struct {
+    char name[IMG_ASSET_NAME_LEN];  // 资源名 (文件名去掉扩展名)
+    uint16_t width;                 // 宽度
+    uint16_t height;                // 高度
+    uint8_t format;                 // img_asset_format_t
+    uint8_t flags;                  // IMG_ASSET_FLAG_*
+    uint16_t palette_count;         // 调色板颜色数
+    uint32_t palette_offset;        // 调色板 (uint16_t, LCD字节序)
+    uint32_t rows_offset;           // 像素数据行偏移表
+    uint32_t data_offset;           // 像素数据
+    uint32_t data_size;             // 像素数据大小 (含调色板和行偏移表)
+    uint32_t alpha_rows_offset;     // 透明度平面行偏移表
+    uint32_t alpha_offset;          // 透明度平面
+    uint32_t alpha_size;            // 透明度平面大小 (含行偏移表)
+} img_asset_t;
+
+/**
+ * @brief 映射图片分区并校验资源包
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND 分区不存在, ESP_ERR_INVALID_VERSION 资源包无效, 其他值表示错误
+ */
+esp_err_t img_asset_init(void);
+
+/**
+ * @brief 取消映射
+ */
+void img_asset_deinit(void);
+
+/**
+ * @brief 资源数量
+ */
+int img_asset_count(void);
+
+/**
+ * @brief 按序号获取资源
+ * @param index 序号
+ * @return 资源表项 (指向flash映射区), 序号无效时为NULL
+ */
+const img_asset_t *img_asset_get(int index);
+
+/**
+ * @brief 按名字查找资源
+ * @param name 资源名
+ * @return 资源表项, 不存在时为NULL
+ */
+const img_asset_t *img_asset_find(const char *name);
+
+/**
+ * @brief 把图片绘制到条带缓冲区
+ * @note 只解码落在[buf_y, buf_y + buf_h)行范围内的行, 可以在每个条带的渲染回调中直接调用;
+ *       带透明度平面的图片与缓冲区原有内容混合。使用内部行缓冲区, 只能在一个任务中调用
+ * @param img 资源
+ * @param buf RGB565缓冲区 (LCD字节序)
+ * @param buf_w 缓冲区宽度 (像素)
+ * @param buf_y 缓冲区第一行对应的屏幕行
+ * @param buf_h 缓冲区行数
+ * @param x 图片左上角x (屏幕坐标)
+ * @param y 图片左上角y (屏幕坐标)
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效, ESP_ERR_INVALID_SIZE 数据损坏
+ */
+esp_err_t img_asset_draw(const img_asset_t *img, uint16_t *buf, int buf_w, int buf_y, int buf_h, int x, int y);
+
+/**
+ * @brief 基准测试: 每个资源 (及其".raw"未压缩对照) 的解码耗时和解码+传输耗时
+ * @note 需要先初始化ST7789; 内部使用lcd_stripe渲染, 不能在显示流水线运行时调用
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 资源包未加载, 其他值表示错误
+ */
+esp_err_t img_asset_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMG_ASSET_H
@@ -0,0 +1,469 @@
+/*
+ * LCD滚动控制台实现
+ * 滚动区按行高划分为rows个行槽, 新行写入下一个行槽后把滚动起始地址移到最旧的一行,
+ * 屏幕上从上到下始终是从旧到新的rows行文字
+ */
+
+#include "lcd_console.h"
+#include "st7789.h"
+#include "font_atlas.h"
+#include "rgb565.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "LCD_CONSOLE";
+
+// 颜色 (LCD字节序)
+#define CONSOLE_COLOR_BG            RGB565(0, 0, 0)
+#define CONSOLE_COLOR_TEXT          RGB565(200, 200, 200)
+#define CONSOLE_COLOR_ERROR         RGB565(255, 64, 64)
+#define CONSOLE_COLOR_WARN          RGB565(255, 200, 0)
+#define CONSOLE_COLOR_INFO          RGB565(64, 220, 64)
+
+/**
+ * @brief 队列中的一行文字, 空字符串为退出通知
+ */
+typedef struct {
+    char text[LCD_CONSOLE_LINE_MAX];
+} lcd_console_line_t;
+
+static TaskHandle_t console_task = NULL;
+static QueueHandle_t line_queue = NULL;
+static SemaphoreHandle_t exit_sem = NULL;
+static uint16_t *line_buf = NULL;
+static vprintf_like_t prev_vprintf = NULL;
+static bool logs_mirrored = false;
+
+// 格式化和拆行用共享缓冲区, 持有format_mutex时使用: 日志钩子在任意任务中运行,
+// 不能在每个打日志的任务栈上再放近300字节
+static SemaphoreHandle_t format_mutex = NULL;
+static char format_buf[LCD_CONSOLE_LINE_MAX * 2];
+static lcd_console_line_t split_line;
+
+// 停止时先关闭入口, 再等正在钩子或print中的任务离开, 之后才释放队列
+static bool console_open = false;
+static uint32_t active_users = 0;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static lcd_console_stats_t console_stats;
+
+/**
+ * @brief 截掉末尾不完整的UTF-8字符
+ */
+static size_t lcd_console_trim_utf8(const char *text, size_t len)
+{
+    for (size_t back = 1; back <= 4 && back <= len; back++) {
+        uint8_t c = (uint8_t)text[len - back];
+        if ((c & 0xC0) == 0x80) {
+            continue;
+        }
+        size_t need = (c < 0x80) ? 1 : ((c & 0xE0) == 0xC0) ? 2 : ((c & 0xF0) == 0xE0) ? 3 : 4;
+        return (need > back) ? len - back : len;
+    }
+    return len;
+}
+
+/**
+ * @brief 把一行放入队列, 队列满时丢弃
+ */
+static esp_err_t lcd_console_push(lcd_console_line_t *line, size_t len)
+{
+    len = lcd_console_trim_utf8(line->text, len);
+    if (len == 0) {
+        return ESP_OK;
+    }
+    line->text[len] = '\0';
+    if (xQueueSend(line_queue, line, 0) != pdTRUE) {
+        portENTER_CRITICAL(&stats_lock);
+        console_stats.dropped++;
+        portEXIT_CRITICAL(&stats_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 按换行拆分文本, 去掉ANSI颜色控制序列后放入队列
+ * @note 需要持有format_mutex
+ */
+static esp_err_t lcd_console_enqueue(const char *text)
+{
+    lcd_console_line_t *line = &split_line;
+    size_t len = 0;
+    esp_err_t ret = ESP_OK;
+
+    for (const char *p = text; ; p++) {
+        if (*p == '\033' && p[1] == '[') {
+            // ESC [ 参数 结束字节(0x40~0x7E)
+            p += 2;
+            while (*p != '\0' && (*p < 0x40 || *p > 0x7E)) {
+                p++;
+            }
+            if (*p == '\0') {
+                break;
+            }
+            continue;
+        }
+        if (*p == '\n' || *p == '\0') {
+            esp_err_t r = lcd_console_push(line, len);
+            if (r != ESP_OK) {
+                ret = r;
+            }
+            len = 0;
+            if (*p == '\0') {
+                break;
+            }
+            continue;
+        }
+        if (*p != '\r' && len < LCD_CONSOLE_LINE_MAX - 1) {
+            line->text[len++] = *p;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief 登记一个队列使用者
+ * @return true 控制台打开, 用完后调用lcd_console_leave; false 控制台未启动或正在停止
+ */
+static bool lcd_console_enter(void)
+{
+    __atomic_add_fetch(&active_users, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&console_open, __ATOMIC_SEQ_CST)) {
+        return true;
+    }
+    __atomic_sub_fetch(&active_users, 1, __ATOMIC_SEQ_CST);
+    return false;
+}
+
+/**
+ * @brief 注销队列使用者
+ */
+static void lcd_console_leave(void)
+{
+    __atomic_sub_fetch(&active_users, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief 在共享缓冲区中格式化后放入队列
+ * @param wait 等待共享缓冲区的时间, 超时丢弃这一条
+ */
+static esp_err_t lcd_console_format(TickType_t wait, const char *fmt, va_list args)
+{
+    if (xSemaphoreTake(format_mutex, wait) != pdTRUE) {
+        portENTER_CRITICAL(&stats_lock);
+        console_stats.dropped++;
+        portEXIT_CRITICAL(&stats_lock);
+        return ESP_ERR_TIMEOUT;
+    }
+    vsnprintf(format_buf, sizeof(format_buf), fmt, args);
+    esp_err_t ret = lcd_console_enqueue(format_buf);
+    xSemaphoreGive(format_mutex);
+    return ret;
+}
+
+/**
+ * @brief 日志输出钩子: 先交给原来的输出, 再镜像到控制台
+ */
+static int lcd_console_vprintf(const char *fmt, va_list args)
+{
+    va_list copy;
+    va_copy(copy, args);
+    int ret = (prev_vprintf != NULL) ? prev_vprintf(fmt, copy) : vprintf(fmt, copy);
+    va_end(copy);
+
+    // 控制台任务自己的日志不镜像, 避免递归
+    if (xTaskGetCurrentTaskHandle() != console_task && lcd_console_enter()) {
+        lcd_console_format(pdMS_TO_TICKS(LCD_CONSOLE_FORMAT_WAIT_MS), fmt, args);
+        lcd_console_leave();
+    }
+    return ret;
+}
+
+/**
+ * @brief 根据ESP_LOG级别前缀 ("E (时间) TAG: ...") 选择颜色
+ */
+static uint16_t lcd_console_line_color(const char *text)
+{
+    if (text[1] != ' ' || text[2] != '(') {
+        return CONSOLE_COLOR_TEXT;
+    }
+    switch (text[0]) {
+    case 'E':
+        return CONSOLE_COLOR_ERROR;
+    case 'W':
+        return CONSOLE_COLOR_WARN;
+    case 'I':
+        return CONSOLE_COLOR_INFO;
+    default:
+        return CONSOLE_COLOR_TEXT;
+    }
+}
+
+/**
+ * @brief 只绘制新增的一行, 然后移动滚动起始地址
+ */
+static void lcd_console_draw_line(const char *text)
+{
+    int64_t t0 = esp_timer_get_time();
+    int line_h = console_stats.line_height;
+    int rows = console_stats.rows;
+    int slot = console_stats.lines % rows;
+
+    rgb565_fill(line_buf, CONSOLE_COLOR_BG, LCD_PORTRAIT_H_RES * line_h);
+    font_draw_text(line_buf, LCD_PORTRAIT_H_RES, 0, line_h, LCD_CONSOLE_MARGIN_X, font_atlas_ascent(),
+                   text, lcd_console_line_color(text));
+
+    int y = slot * line_h;
+    esp_err_t ret = st7789_draw_bitmap(0, y, LCD_PORTRAIT_H_RES, y + line_h, line_buf);
+    // 屏幕写满后, 滚动区第一行显示最旧的行槽
+    if (ret == ESP_OK && console_stats.lines + 1 >= (uint32_t)rows) {
+        ret = st7789_scroll_to(((slot + 1) % rows) * line_h);
+    }
+    if (ret == ESP_OK) {
+        ret = st7789_wait_flush_done(LCD_FLUSH_TIMEOUT_MS);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "绘制第%" PRIu32 "行失败: %s", console_stats.lines, esp_err_to_name(ret));
+    }
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    portENTER_CRITICAL(&stats_lock);
+    console_stats.lines++;
+    console_stats.last_line_us = us;
+    if (us > console_stats.max_line_us) {
+        console_stats.max_line_us = us;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+/**
+ * @brief 控制台任务: 从队列取行并绘制
+ */
+static void lcd_console_task(void *arg)
+{
+    lcd_console_line_t line;
+
+    while (1) {
+        if (xQueueReceive(line_queue, &line, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (line.text[0] == '\0') {
+            break;
+        }
+        lcd_console_draw_line(line.text);
+    }
+
+    xSemaphoreGive(exit_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 释放缓冲区和队列
+ */
+static void lcd_console_free(void)
+{
+    heap_caps_free(line_buf);
+    line_buf = NULL;
+    if (line_queue != NULL) {
+        vQueueDelete(line_queue);
+        line_queue = NULL;
+    }
+    if (exit_sem != NULL) {
+        vSemaphoreDelete(exit_sem);
+        exit_sem = NULL;
+    }
+    if (format_mutex != NULL) {
+        vSemaphoreDelete(format_mutex);
+        format_mutex = NULL;
+    }
+}
+
+/**
+ * @brief 竖屏清屏
+ */
+static esp_err_t lcd_console_clear(int line_h)
+{
+    rgb565_fill(line_buf, CONSOLE_COLOR_BG, LCD_PORTRAIT_H_RES * line_h);
+    for (int y = 0; y < LCD_PORTRAIT_V_RES; y += line_h) {
+        int lines = (y + line_h > LCD_PORTRAIT_V_RES) ? (LCD_PORTRAIT_V_RES - y) : line_h;
+        esp_err_t ret = st7789_draw_bitmap(0, y, LCD_PORTRAIT_H_RES, y + lines, line_buf);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return st7789_wait_flush_done(LCD_FLUSH_TIMEOUT_MS);
+}
+
+/**
+ * @brief 切换到竖屏滚动控制台并启动控制台任务
+ */
+esp_err_t lcd_console_start(bool mirror_logs)
+{
+    if (console_task != NULL) {
+        ESP_LOGE(TAG, "控制台已经启动");
+        return ESP_ERR_INVALID_STATE;
+    }
+    int line_h = font_atlas_line_height();
+    if (line_h <= 0) {
+        ESP_LOGE(TAG, "控制台需要先加载字体图集");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    line_buf = heap_caps_malloc(LCD_PORTRAIT_H_RES * line_h * sizeof(uint16_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    line_queue = xQueueCreate(LCD_CONSOLE_QUEUE_DEPTH, sizeof(lcd_console_line_t));
+    exit_sem = xSemaphoreCreateBinary();
+    format_mutex = xSemaphoreCreateMutex();
+    if (line_buf == NULL || line_queue == NULL || exit_sem == NULL || format_mutex == NULL) {
+        ESP_LOGE(TAG, "分配控制台缓冲区失败");
+        lcd_console_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 滚动区取行高的整数倍, 余下的行作为底部固定区
+    int rows = LCD_PORTRAIT_V_RES / line_h;
+    int scroll_lines = rows * line_h;
+    esp_err_t ret = st7789_set_portrait(true);
+    if (ret == ESP_OK) {
+        ret = lcd_console_clear(line_h);
+    }
+    if (ret == ESP_OK) {
+        ret = st7789_scroll_define(0, scroll_lines, LCD_PORTRAIT_V_RES - scroll_lines);
+    }
+    if (ret == ESP_OK) {
+        ret = st7789_scroll_to(0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "设置滚动区域失败: %s", esp_err_to_name(ret));
+        st7789_set_portrait(false);
+        lcd_console_free();
+        return ret;
+    }
+
+    console_stats = (lcd_console_stats_t){
+        .rows = rows,
+        .line_height = line_h,
+        .pixels_per_line = LCD_PORTRAIT_H_RES * line_h,
+    };
+
+    if (xTaskCreate(lcd_console_task, "lcd_console", LCD_CONSOLE_TASK_STACK, NULL,
+                    LCD_CONSOLE_TASK_PRIO, &console_task) != pdPASS) {
+        ESP_LOGE(TAG, "创建控制台任务失败");
+        console_task = NULL;
+        st7789_scroll_disable();
+        st7789_set_portrait(false);
+        lcd_console_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "控制台已启动: %d行 x %d像素, 每行更新传输%" PRIu32 "像素 (整屏%d像素)",
+             rows, line_h, console_stats.pixels_per_line, LCD_H_RES * LCD_V_RES);
+
+    __atomic_store_n(&console_open, true, __ATOMIC_SEQ_CST);
+    if (mirror_logs) {
+        prev_vprintf = esp_log_set_vprintf(lcd_console_vprintf);
+        logs_mirrored = true;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 停止控制台
+ */
+esp_err_t lcd_console_stop(void)
+{
+    if (console_task == NULL) {
+        return ESP_OK;
+    }
+
+    // 先关闭入口再恢复日志输出: 已经取到旧钩子的任务进来时也会直接返回
+    __atomic_store_n(&console_open, false, __ATOMIC_SEQ_CST);
+    if (logs_mirrored) {
+        esp_log_set_vprintf(prev_vprintf);
+        logs_mirrored = false;
+    }
+
+    // 等正在钩子或print中的任务离开, 之后没有任务会再访问队列和共享缓冲区
+    TickType_t start = xTaskGetTickCount();
+    while (__atomic_load_n(&active_users, __ATOMIC_SEQ_CST) != 0) {
+        if (xTaskGetTickCount() - start > pdMS_TO_TICKS(LCD_CONSOLE_TIMEOUT_MS)) {
+            ESP_LOGE(TAG, "等待写入控制台的任务离开超时");
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+
+    lcd_console_line_t stop = {.text = ""};
+    if (xQueueSend(line_queue, &stop, pdMS_TO_TICKS(LCD_CONSOLE_TIMEOUT_MS)) != pdTRUE ||
+        xSemaphoreTake(exit_sem, pdMS_TO_TICKS(LCD_CONSOLE_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGE(TAG, "等待控制台任务退出超时");
+        return ESP_ERR_TIMEOUT;
+    }
+    console_task = NULL;
+
+    st7789_scroll_disable();
+    st7789_set_portrait(false);
+    lcd_console_free();
+    ESP_LOGI(TAG, "控制台已停止");
+    return ESP_OK;
+}
+
+/**
+ * @brief 追加一行文字
+ */
+esp_err_t lcd_console_print(const char *text)
+{
+    if (text == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!lcd_console_enter()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(format_mutex, portMAX_DELAY);
+    esp_err_t ret = lcd_console_enqueue(text);
+    xSemaphoreGive(format_mutex);
+    lcd_console_leave();
+    return ret;
+}
+
+/**
+ * @brief 格式化后追加一行文字
+ */
+esp_err_t lcd_console_printf(const char *fmt, ...)
+{
+    if (fmt == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!lcd_console_enter()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    va_list args;
+    va_start(args, fmt);
+    esp_err_t ret = lcd_console_format(portMAX_DELAY, fmt, args);
+    va_end(args);
+    lcd_console_leave();
+    return ret;
+}
+
+/**
+ * @brief 获取控制台统计
+ */
+esp_err_t lcd_console_get_stats(lcd_console_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    *stats = console_stats;
+    portEXIT_CRITICAL(&stats_lock);
+    return ESP_OK;
+}
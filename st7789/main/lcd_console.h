@@ -0,0 +1,79 @@
+/*
+ * LCD滚动控制台头文件
+ * 竖屏下使用ST7789硬件垂直滚动 (VSCRDEF/VSCSAD), 每新增一行只绘制这一行并移动滚动起始地址,
+ * 可以把ESP_LOG日志实时镜像到屏幕上
+ */
+
+#ifndef LCD_CONSOLE_H
+#define LCD_CONSOLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 控制台配置
+#define LCD_CONSOLE_LINE_MAX        96      // 每行最多字节数 (UTF-8, 超出屏幕宽度的部分被裁掉)
+#define LCD_CONSOLE_QUEUE_DEPTH     32      // 待显示行队列深度
+#define LCD_CONSOLE_TASK_STACK      4096    // 控制台任务栈大小
+#define LCD_CONSOLE_TASK_PRIO       3       // 控制台任务优先级
+#define LCD_CONSOLE_MARGIN_X        2       // 文字左边距 (像素)
+#define LCD_CONSOLE_TIMEOUT_MS      1000    // 等待任务退出超时时间
+#define LCD_CONSOLE_FORMAT_WAIT_MS  20      // 日志钩子等待共享格式化缓冲区的时间, 超时丢弃这一条
+
+/**
+ * @brief 控制台统计
+ */
+typedef struct {
+    uint32_t lines;                 // 已显示行数
+    uint32_t dropped;               // 队列满或等不到共享缓冲区时丢弃的行数
+    int rows;                       // 屏幕可显示行数
+    int line_height;                // 行高 (像素)
+    uint32_t pixels_per_line;       // 每新增一行传输的像素数 (整屏重绘为LCD_H_RES * LCD_V_RES)
+    uint32_t last_line_us;          // 上一行绘制+传输+滚动耗时
+    uint32_t max_line_us;           // 最大单行耗时
+} lcd_console_stats_t;
+
+/**
+ * @brief 切换到竖屏滚动控制台并启动控制台任务
+ * @note 需要先初始化ST7789并加载字体图集; 控制台运行期间不要使用其他方式绘制屏幕
+ * @param mirror_logs 是否把ESP_LOG输出同时镜像到屏幕 (控制台任务自身的日志除外)
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 字体图集未加载或已经启动, 其他值表示错误
+ */
+esp_err_t lcd_console_start(bool mirror_logs);
+
+/**
+ * @brief 停止控制台: 恢复日志输出, 等正在写入的任务离开后退出滚动模式并切回横屏
+ * @return ESP_OK 成功, ESP_ERR_TIMEOUT 写入的任务或控制台任务未能按时退出
+ */
+esp_err_t lcd_console_stop(void);
+
+/**
+ * @brief 追加一行文字 (非阻塞, 放入队列后由控制台任务绘制)
+ * @param text UTF-8文本, 包含换行时拆成多行
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 控制台未启动, ESP_ERR_NO_MEM 队列已满
+ */
+esp_err_t lcd_console_print(const char *text);
+
+/**
+ * @brief 格式化后追加一行文字
+ * @param fmt 格式字符串
+ * @return 同lcd_console_print
+ */
+esp_err_t lcd_console_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief 获取控制台统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t lcd_console_get_stats(lcd_console_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_CONSOLE_H
@@ -0,0 +1,290 @@
+/*
+ * 自适应帧率调节实现
+ * 渲染任务每帧先在lcd_governor_wait_frame中按目标帧率睡眠, 帧回调之后由lcd_governor_begin_frame
+ * 取出累计的脏区域: 没有变化就跳过整帧, 有变化只渲染覆盖脏区域的条带
+ */
+
+#include "lcd_governor.h"
+#include "st7789.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "power_manager.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "LCD_GOVERNOR";
+
+#define GOVERNOR_TICK_US            (portTICK_PERIOD_MS * 1000)
+
+static SemaphoreHandle_t wake_sem = NULL;
+static power_lock_handle_t pm_lock = NULL;
+static int64_t last_frame_us = 0;       // 只在渲染任务中访问
+
+// 脏区域由任意任务标记, 帧结束由刷新任务通知, 都在锁内更新
+static portMUX_TYPE gov_lock = portMUX_INITIALIZER_UNLOCKED;
+static int dirty_start = 0;
+static int dirty_end = 0;
+static uint32_t target_fps = LCD_GOVERNOR_MAX_FPS;
+static uint32_t clean_frames = 0;
+static int inflight = 0;
+static int64_t lock_start_us = 0;
+static lcd_governor_stats_t gov_stats;
+static uint32_t window_frames = 0;
+static uint32_t window_damage_pct = 0;
+static uint32_t window_lock_us = 0;
+static int64_t window_start_us = 0;
+
+/**
+ * @brief 渲染开销允许的最高帧率
+ */
+static uint32_t lcd_governor_max_fps(uint32_t cost_us)
+{
+    uint32_t fps = LCD_GOVERNOR_MAX_FPS;
+    if (cost_us > 0 && 1000000 / cost_us < fps) {
+        fps = 1000000 / cost_us;
+    }
+    return (fps < LCD_GOVERNOR_MIN_FPS) ? LCD_GOVERNOR_MIN_FPS : fps;
+}
+
+/**
+ * @brief 初始化帧率调节
+ */
+esp_err_t lcd_governor_init(void)
+{
+    wake_sem = xSemaphoreCreateBinary();
+    if (wake_sem == NULL) {
+        ESP_LOGE(TAG, "创建信号量失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 锁在停止后保留, 再次启动时复用; 未启用CONFIG_PM_ENABLE时锁只统计持有时间
+    if (pm_lock == NULL) {
+        esp_err_t ret = power_manager_lock_create(ESP_PM_CPU_FREQ_MAX, "lcd_governor", &pm_lock);
+        if (ret != ESP_OK) {
+            vSemaphoreDelete(wake_sem);
+            wake_sem = NULL;
+            return ret;
+        }
+    }
+
+    int64_t now = esp_timer_get_time();
+    last_frame_us = now;
+    portENTER_CRITICAL(&gov_lock);
+    // 第一帧整屏渲染
+    dirty_start = 0;
+    dirty_end = LCD_V_RES;
+    target_fps = LCD_GOVERNOR_MAX_FPS;
+    clean_frames = 0;
+    inflight = 0;
+    gov_stats = (lcd_governor_stats_t){
+        .target_fps = target_fps,
+    };
+    window_frames = 0;
+    window_damage_pct = 0;
+    window_lock_us = 0;
+    window_start_us = now;
+    portEXIT_CRITICAL(&gov_lock);
+
+    ESP_LOGI(TAG, "帧率调节: %d~%dfps", LCD_GOVERNOR_MIN_FPS, LCD_GOVERNOR_MAX_FPS);
+    return ESP_OK;
+}
+
+/**
+ * @brief 释放仍在持有的PM锁和信号量
+ */
+void lcd_governor_deinit(void)
+{
+    while (inflight > 0) {
+        power_manager_lock_release(pm_lock);
+        inflight--;
+    }
+    if (wake_sem != NULL) {
+        vSemaphoreDelete(wake_sem);
+        wake_sem = NULL;
+    }
+}
+
+/**
+ * @brief 标记脏区域
+ */
+void lcd_governor_mark_dirty(int y_start, int y_end)
+{
+    if (y_start < 0) {
+        y_start = 0;
+    }
+    if (y_end > LCD_V_RES) {
+        y_end = LCD_V_RES;
+    }
+    if (y_start >= y_end) {
+        return;
+    }
+
+    portENTER_CRITICAL(&gov_lock);
+    if (dirty_start >= dirty_end) {
+        dirty_start = y_start;
+        dirty_end = y_end;
+    } else {
+        dirty_start = (y_start < dirty_start) ? y_start : dirty_start;
+        dirty_end = (y_end > dirty_end) ? y_end : dirty_end;
+    }
+    bool idle = (target_fps < LCD_GOVERNOR_MAX_FPS);
+    portEXIT_CRITICAL(&gov_lock);
+
+    // 低帧率时不必等到下一个周期
+    if (idle && wake_sem != NULL) {
+        xSemaphoreGive(wake_sem);
+    }
+}
+
+/**
+ * @brief 按目标帧率等待下一帧; 有待渲染的脏区域时只受最高帧率限制
+ */
+void lcd_governor_wait_frame(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    while (1) {
+        portENTER_CRITICAL(&gov_lock);
+        bool dirty = (dirty_start < dirty_end);
+        uint32_t fps = dirty ? LCD_GOVERNOR_MAX_FPS : target_fps;
+        portEXIT_CRITICAL(&gov_lock);
+
+        int64_t deadline = last_frame_us + 1000000 / fps;
+        if (now >= deadline) {
+            break;
+        }
+        TickType_t ticks = (TickType_t)((deadline - now + GOVERNOR_TICK_US - 1) / GOVERNOR_TICK_US);
+        xSemaphoreTake(wake_sem, ticks);
+        now = esp_timer_get_time();
+    }
+    last_frame_us = now;
+}
+
+/**
+ * @brief 取出本帧脏区域并更新目标帧率
+ */
+bool lcd_governor_begin_frame(int *y_start, int *y_end)
+{
+    int64_t now = esp_timer_get_time();
+    bool render;
+
+    portENTER_CRITICAL(&gov_lock);
+    render = (dirty_start < dirty_end);
+    if (render) {
+        *y_start = dirty_start;
+        *y_end = dirty_end;
+        dirty_start = dirty_end = 0;
+        // 画面在变化: 直接升到开销允许的最高帧率
+        clean_frames = 0;
+        target_fps = lcd_governor_max_fps(gov_stats.cost_us);
+        gov_stats.rendered_frames++;
+        window_damage_pct += (uint32_t)(*y_end - *y_start) * 100 / LCD_V_RES;
+        if (inflight++ == 0) {
+            lock_start_us = now;
+        }
+    } else {
+        // 连续静止: 逐级减半
+        gov_stats.skipped_frames++;
+        if (++clean_frames >= LCD_GOVERNOR_IDLE_FRAMES) {
+            clean_frames = 0;
+            target_fps = (target_fps / 2 < LCD_GOVERNOR_MIN_FPS) ? LCD_GOVERNOR_MIN_FPS : target_fps / 2;
+        }
+    }
+    gov_stats.target_fps = target_fps;
+    portEXIT_CRITICAL(&gov_lock);
+
+    if (render) {
+        power_manager_lock_acquire(pm_lock);
+    }
+    return render;
+}
+
+/**
+ * @brief 帧传输完成: 记录开销并释放PM锁
+ */
+void lcd_governor_end_frame(uint32_t cost_us)
+{
+    int64_t now = esp_timer_get_time();
+    bool release = false;
+
+    portENTER_CRITICAL(&gov_lock);
+    if (gov_stats.cost_us == 0) {
+        gov_stats.cost_us = cost_us;
+    } else {
+        gov_stats.cost_us += ((int32_t)cost_us - (int32_t)gov_stats.cost_us) >> LCD_GOVERNOR_COST_SHIFT;
+    }
+    window_frames++;
+    if (inflight > 0) {
+        release = true;
+        if (--inflight == 0) {
+            window_lock_us += (uint32_t)(now - lock_start_us);
+        }
+    }
+    portEXIT_CRITICAL(&gov_lock);
+
+    if (release) {
+        power_manager_lock_release(pm_lock);
+    }
+}
+
+/**
+ * @brief 唤醒正在等待的渲染任务
+ */
+void lcd_governor_wake(void)
+{
+    if (wake_sem != NULL) {
+        xSemaphoreGive(wake_sem);
+    }
+}
+
+/**
+ * @brief 获取当前目标帧率
+ */
+uint32_t lcd_governor_get_target_fps(void)
+{
+    portENTER_CRITICAL(&gov_lock);
+    uint32_t fps = target_fps;
+    portEXIT_CRITICAL(&gov_lock);
+    return fps;
+}
+
+/**
+ * @brief 获取帧率调节统计
+ */
+esp_err_t lcd_governor_get_stats(lcd_governor_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&gov_lock);
+    *stats = gov_stats;
+    uint32_t frames = window_frames;
+    uint32_t damage = window_damage_pct;
+    uint32_t lock_us = window_lock_us;
+    if (inflight > 0) {
+        // 正在持有的部分计入本窗口
+        lock_us += (uint32_t)(now - lock_start_us);
+        lock_start_us = now;
+    }
+    int64_t elapsed = now - window_start_us;
+    window_frames = 0;
+    window_damage_pct = 0;
+    window_lock_us = 0;
+    window_start_us = now;
+    portEXIT_CRITICAL(&gov_lock);
+
+    if (elapsed > 0) {
+        stats->measured_fps_x10 = (uint32_t)((uint64_t)frames * 10000000ULL / elapsed);
+        stats->pm_lock_pct = (uint8_t)((uint64_t)lock_us * 100 / elapsed);
+    }
+    stats->damage_pct = (frames > 0) ? (uint8_t)(damage / frames) : 0;
+
+    power_manager_stats_t pm_stats;
+    power_manager_get_stats(&pm_stats, NULL, 0, false);
+    stats->pm_lock_enabled = pm_stats.pm_enabled;
+    return ESP_OK;
+}
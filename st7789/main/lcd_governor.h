@@ -0,0 +1,100 @@
+/*
+ * 自适应帧率调节头文件
+ * 在双核显示流水线之上按每帧的脏区域和渲染开销调节帧率: 画面不变时跳过渲染并逐步降低帧率,
+ * 出现变化时立即升到渲染开销允许的最高帧率; 只在帧渲染和传输期间持有CPU最高频率PM锁
+ */
+
+#ifndef LCD_GOVERNOR_H
+#define LCD_GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 帧率调节配置
+#define LCD_GOVERNOR_MAX_FPS        50      // 动画时的最高帧率 (受FreeRTOS节拍限制)
+#define LCD_GOVERNOR_MIN_FPS        2       // 静止画面的最低帧率 (帧回调的轮询频率)
+#define LCD_GOVERNOR_IDLE_FRAMES    10      // 连续多少个无变化帧后帧率减半
+#define LCD_GOVERNOR_COST_SHIFT     3       // 渲染开销滑动平均系数 (1/8)
+
+/**
+ * @brief 帧率调节统计
+ * @note 计数从lcd_governor_init开始累计; 实际帧率、脏区域比例和PM锁占比是上一次调用
+ *       lcd_governor_get_stats以来的平均值
+ */
+typedef struct {
+    uint32_t target_fps;            // 当前目标帧率
+    uint32_t measured_fps_x10;      // 实际渲染并传输的帧率 x10
+    uint32_t rendered_frames;       // 有脏区域、实际渲染的帧数
+    uint32_t skipped_frames;        // 无变化、跳过渲染的帧数
+    uint32_t cost_us;               // 渲染+传输开销滑动平均
+    uint8_t damage_pct;             // 渲染帧的平均脏区域占屏幕比例
+    uint8_t pm_lock_pct;            // PM锁持有时间占比
+    bool pm_lock_enabled;           // 是否启用了电源管理 (CONFIG_PM_ENABLE)
+} lcd_governor_stats_t;
+
+/**
+ * @brief 初始化帧率调节, 第一次调用时创建PM锁
+ * @note 由lcd_pipeline_start在配置了governor时调用
+ * @return ESP_OK 成功, ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t lcd_governor_init(void);
+
+/**
+ * @brief 释放仍在持有的PM锁和信号量
+ */
+void lcd_governor_deinit(void);
+
+/**
+ * @brief 标记脏区域, 下一帧只渲染覆盖这些行的条带; 帧率处于低档时立即唤醒渲染任务
+ * @note 只能在任务中调用, 可以在帧回调中调用
+ * @param y_start 起始行
+ * @param y_end 结束行 (不包含)
+ */
+void lcd_governor_mark_dirty(int y_start, int y_end);
+
+/**
+ * @brief 渲染任务等待下一帧的时间点 (流水线内部使用)
+ */
+void lcd_governor_wait_frame(void);
+
+/**
+ * @brief 取出本帧脏区域并更新目标帧率, 需要渲染时获取PM锁 (流水线内部使用)
+ * @param y_start 返回脏区域起始行
+ * @param y_end 返回脏区域结束行 (不包含)
+ * @return true 需要渲染, false 画面无变化
+ */
+bool lcd_governor_begin_frame(int *y_start, int *y_end);
+
+/**
+ * @brief 帧的最后一个条带传输完成, 记录开销并释放PM锁 (流水线内部使用)
+ * @param cost_us 开始渲染到传输完成的时间
+ */
+void lcd_governor_end_frame(uint32_t cost_us);
+
+/**
+ * @brief 唤醒正在等待的渲染任务 (停止流水线时使用)
+ */
+void lcd_governor_wake(void);
+
+/**
+ * @brief 获取当前目标帧率
+ */
+uint32_t lcd_governor_get_target_fps(void);
+
+/**
+ * @brief 获取帧率调节统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t lcd_governor_get_stats(lcd_governor_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_GOVERNOR_H
@@ -0,0 +1,420 @@
+/*
+ * 双核显示流水线实现
+ * 条带缓冲区只在两个队列之间传递指针: free_queue (空闲) -> 渲染任务 -> ready_queue (待传输)
+ * -> 刷新任务 -> DMA完成后回到free_queue, 整个过程没有像素复制
+ */
+
+#include "lcd_pipeline.h"
+#include "st7789.h"
+#include "lcd_governor.h"
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "LCD_PIPELINE";
+
+_Static_assert(LCD_PIPELINE_BUF_NUM >= 2, "流水线至少需要两个条带缓冲区");
+
+/**
+ * @brief 条带描述符, 和缓冲区一一对应, 在队列中以指针传递
+ */
+typedef struct {
+    uint16_t *buf;                  // DMA缓冲区
+    int y_start;                    // 屏幕起始行
+    int lines;                      // 行数
+    int64_t frame_start_us;         // 所属帧开始渲染的时间
+    bool first;                     // 本帧第一个条带
+    bool last;                      // 本帧最后一个条带
+} lcd_pipeline_stripe_t;
+
+static lcd_pipeline_stripe_t stripes[LCD_PIPELINE_BUF_NUM];
+static QueueHandle_t free_queue = NULL;
+static QueueHandle_t ready_queue = NULL;
+static SemaphoreHandle_t exit_sem = NULL;
+static lcd_pipeline_config_t pipe_cfg;
+static volatile bool running = false;
+
+// 统计数据由两个任务在不同核心上更新
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static lcd_pipeline_stats_t pipe_stats;
+static uint64_t latency_sum_us = 0;
+static uint32_t window_frames = 0;
+static uint32_t window_render_us = 0;
+static uint32_t window_flush_us = 0;
+static int64_t window_start_us = 0;
+
+/**
+ * @brief 渲染任务: 取空闲缓冲区 -> 渲染 -> 放入待传输队列
+ */
+static void lcd_pipeline_render_task(void *arg)
+{
+    int stripe_lines = pipe_cfg.stripe_lines;
+    uint32_t frame = 0;
+
+    while (running) {
+        if (pipe_cfg.governor) {
+            lcd_governor_wait_frame();
+            if (!running) {
+                break;
+            }
+        }
+        if (pipe_cfg.frame_cb != NULL) {
+            pipe_cfg.frame_cb(frame, pipe_cfg.user_ctx);
+        }
+
+        // 帧率调节: 画面无变化时跳过整帧, 否则只渲染覆盖脏区域的条带
+        int frame_top = 0;
+        int frame_bottom = LCD_V_RES;
+        if (pipe_cfg.governor && !lcd_governor_begin_frame(&frame_top, &frame_bottom)) {
+            frame++;
+            continue;
+        }
+        frame_top -= frame_top % stripe_lines;
+
+        int64_t frame_start = 0;
+        for (int y = frame_top; y < frame_bottom; y += stripe_lines) {
+            lcd_pipeline_stripe_t *stripe;
+            if (xQueueReceive(free_queue, &stripe, 0) != pdTRUE) {
+                // 反压: 所有缓冲区都在等待传输
+                portENTER_CRITICAL(&stats_lock);
+                pipe_stats.render_stalls++;
+                portEXIT_CRITICAL(&stats_lock);
+                while (xQueueReceive(free_queue, &stripe, pdMS_TO_TICKS(LCD_PIPELINE_TIMEOUT_MS)) != pdTRUE) {
+                    ESP_LOGW(TAG, "等待空闲条带缓冲区超时");
+                }
+            }
+
+            int64_t t0 = esp_timer_get_time();
+            if (y == frame_top) {
+                frame_start = t0;
+            }
+            stripe->y_start = y;
+            stripe->lines = (y + stripe_lines > LCD_V_RES) ? (LCD_V_RES - y) : stripe_lines;
+            stripe->frame_start_us = frame_start;
+            stripe->first = (y == frame_top);
+            stripe->last = (y + stripe->lines >= frame_bottom);
+            pipe_cfg.render_cb(stripe->buf, stripe->y_start, stripe->lines, pipe_cfg.user_ctx);
+            uint32_t busy = (uint32_t)(esp_timer_get_time() - t0);
+
+            portENTER_CRITICAL(&stats_lock);
+            window_render_us += busy;
+            portEXIT_CRITICAL(&stats_lock);
+
+            xQueueSend(ready_queue, &stripe, portMAX_DELAY);
+        }
+        frame++;
+    }
+
+    // NULL通知刷新任务退出
+    lcd_pipeline_stripe_t *stop = NULL;
+    xQueueSend(ready_queue, &stop, portMAX_DELAY);
+    xSemaphoreGive(exit_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 传输完成的条带回到空闲队列, 帧的最后一个条带完成时记录帧延迟
+ */
+static void lcd_pipeline_recycle(lcd_pipeline_stripe_t *stripe)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&stats_lock);
+    pipe_stats.stripes++;
+    if (stripe->last) {
+        uint32_t latency = (uint32_t)(now - stripe->frame_start_us);
+        pipe_stats.frames++;
+        pipe_stats.latency_us = latency;
+        if (latency > pipe_stats.max_latency_us) {
+            pipe_stats.max_latency_us = latency;
+        }
+        latency_sum_us += latency;
+        pipe_stats.avg_latency_us = (uint32_t)(latency_sum_us / pipe_stats.frames);
+        window_frames++;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+
+    if (stripe->last && pipe_cfg.governor) {
+        lcd_governor_end_frame((uint32_t)(now - stripe->frame_start_us));
+    }
+    xQueueSend(free_queue, &stripe, 0);
+}
+
+/**
+ * @brief 刷新任务: 取待传输条带 -> 提交DMA -> 传输完成后回收缓冲区
+ */
+static void lcd_pipeline_flush_task(void *arg)
+{
+    // DMA按提交顺序完成, 用FIFO记录传输中的条带
+    lcd_pipeline_stripe_t *inflight[LCD_PIPELINE_BUF_NUM];
+    int head = 0;
+    int count = 0;
+    bool exiting = false;
+
+    while (!exiting || count > 0) {
+        // 先回收已经完成的传输
+        uint32_t pending = st7789_get_pending_flushes();
+        while (count > (int)pending) {
+            lcd_pipeline_recycle(inflight[head]);
+            head = (head + 1) % LCD_PIPELINE_BUF_NUM;
+            count--;
+        }
+
+        lcd_pipeline_stripe_t *stripe = NULL;
+        bool got = false;
+        if (!exiting) {
+            got = (xQueueReceive(ready_queue, &stripe, 0) == pdTRUE);
+            if (!got && count == 0) {
+                // SPI空闲且没有待传输的条带: 渲染跟不上
+                portENTER_CRITICAL(&stats_lock);
+                pipe_stats.flush_starved++;
+                portEXIT_CRITICAL(&stats_lock);
+                got = (xQueueReceive(ready_queue, &stripe, portMAX_DELAY) == pdTRUE);
+            }
+        }
+
+        if (!got) {
+            // 没有新条带, 等最早的传输完成以便渲染任务拿到缓冲区
+            if (count > 0 && st7789_wait_flush_pending(count - 1, LCD_PIPELINE_TIMEOUT_MS) != ESP_OK) {
+                ESP_LOGE(TAG, "DMA传输超时, %d个条带未完成", count);
+            }
+            continue;
+        }
+        if (stripe == NULL) {
+            exiting = true;
+            continue;
+        }
+
+        if (stripe->first) {
+            // TE模式下在这里等待垂直消隐
+            st7789_frame_begin(LCD_PIPELINE_TIMEOUT_MS);
+        }
+
+        // 出错时条带马上回到空闲队列, 可能被渲染任务重新填写, 之后不能再读它
+        bool last = stripe->last;
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t ret = st7789_draw_bitmap(0, stripe->y_start, LCD_H_RES, stripe->y_start + stripe->lines, stripe->buf);
+        uint32_t busy = (uint32_t)(esp_timer_get_time() - t0);
+
+        portENTER_CRITICAL(&stats_lock);
+        window_flush_us += busy;
+        portEXIT_CRITICAL(&stats_lock);
+
+        if (ret == ESP_OK) {
+            inflight[(head + count) % LCD_PIPELINE_BUF_NUM] = stripe;
+            count++;
+        } else {
+            lcd_pipeline_recycle(stripe);
+        }
+        if (last) {
+            st7789_frame_end();
+        }
+    }
+
+    xSemaphoreGive(exit_sem);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 释放缓冲区和队列
+ */
+static void lcd_pipeline_free(void)
+{
+    for (int i = 0; i < LCD_PIPELINE_BUF_NUM; i++) {
+        heap_caps_free(stripes[i].buf);
+        stripes[i].buf = NULL;
+    }
+    if (free_queue != NULL) {
+        vQueueDelete(free_queue);
+        free_queue = NULL;
+    }
+    if (ready_queue != NULL) {
+        vQueueDelete(ready_queue);
+        ready_queue = NULL;
+    }
+    if (exit_sem != NULL) {
+        vSemaphoreDelete(exit_sem);
+        exit_sem = NULL;
+    }
+}
+
+/**
+ * @brief 分配条带缓冲区并启动渲染任务和刷新任务
+ */
+esp_err_t lcd_pipeline_start(const lcd_pipeline_config_t *config)
+{
+    if (config == NULL || config->render_cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (running) {
+        ESP_LOGE(TAG, "流水线已经启动");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    pipe_cfg = *config;
+    if (pipe_cfg.stripe_lines == 0) {
+        pipe_cfg.stripe_lines = LCD_STRIPE_DEFAULT_LINES;
+    }
+    if (pipe_cfg.stripe_lines < 1 || pipe_cfg.stripe_lines > LCD_MAX_TRANSFER_LINES) {
+        ESP_LOGE(TAG, "无效的条带高度: %d", pipe_cfg.stripe_lines);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pipe_cfg.render_core < 0 || pipe_cfg.render_core >= portNUM_PROCESSORS ||
+        pipe_cfg.flush_core < 0 || pipe_cfg.flush_core >= portNUM_PROCESSORS) {
+        ESP_LOGE(TAG, "无效的核心: 渲染%d, 刷新%d", pipe_cfg.render_core, pipe_cfg.flush_core);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 待传输队列多一个位置放退出通知
+    free_queue = xQueueCreate(LCD_PIPELINE_BUF_NUM, sizeof(lcd_pipeline_stripe_t *));
+    ready_queue = xQueueCreate(LCD_PIPELINE_BUF_NUM + 1, sizeof(lcd_pipeline_stripe_t *));
+    exit_sem = xSemaphoreCreateCounting(2, 0);
+    if (free_queue == NULL || ready_queue == NULL || exit_sem == NULL) {
+        ESP_LOGE(TAG, "创建队列失败");
+        lcd_pipeline_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t stripe_bytes = LCD_H_RES * pipe_cfg.stripe_lines * sizeof(uint16_t);
+    for (int i = 0; i < LCD_PIPELINE_BUF_NUM; i++) {
+        stripes[i].buf = heap_caps_malloc(stripe_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (stripes[i].buf == NULL) {
+            ESP_LOGE(TAG, "分配条带缓冲区%d失败 (%zu字节)", i, stripe_bytes);
+            lcd_pipeline_free();
+            return ESP_ERR_NO_MEM;
+        }
+        lcd_pipeline_stripe_t *stripe = &stripes[i];
+        xQueueSend(free_queue, &stripe, 0);
+    }
+
+    if (pipe_cfg.governor) {
+        esp_err_t ret = lcd_governor_init();
+        if (ret != ESP_OK) {
+            lcd_pipeline_free();
+            return ret;
+        }
+    }
+
+    lcd_pipeline_reset_stats();
+    pipe_stats.render_core = pipe_cfg.render_core;
+    pipe_stats.flush_core = pipe_cfg.flush_core;
+    pipe_stats.buf_bytes = stripe_bytes * LCD_PIPELINE_BUF_NUM;
+
+    running = true;
+    if (xTaskCreatePinnedToCore(lcd_pipeline_flush_task, "lcd_flush", LCD_PIPELINE_STACK_SIZE, NULL,
+                                LCD_PIPELINE_FLUSH_PRIO, NULL, pipe_cfg.flush_core) != pdPASS) {
+        ESP_LOGE(TAG, "创建刷新任务失败");
+        running = false;
+        lcd_pipeline_free();
+        if (pipe_cfg.governor) {
+            lcd_governor_deinit();
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreatePinnedToCore(lcd_pipeline_render_task, "lcd_render", LCD_PIPELINE_STACK_SIZE, NULL,
+                                LCD_PIPELINE_RENDER_PRIO, NULL, pipe_cfg.render_core) != pdPASS) {
+        ESP_LOGE(TAG, "创建渲染任务失败");
+        // 刷新任务收到退出通知后自行退出
+        running = false;
+        lcd_pipeline_stripe_t *stop = NULL;
+        xQueueSend(ready_queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(exit_sem, portMAX_DELAY);
+        lcd_pipeline_free();
+        if (pipe_cfg.governor) {
+            lcd_governor_deinit();
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "流水线已启动: 渲染核心%d, 刷新核心%d, %d个%d行条带缓冲区 (%zu字节)",
+             pipe_cfg.render_core, pipe_cfg.flush_core, LCD_PIPELINE_BUF_NUM, pipe_cfg.stripe_lines,
+             pipe_stats.buf_bytes);
+    return ESP_OK;
+}
+
+/**
+ * @brief 停止流水线并释放缓冲区
+ */
+esp_err_t lcd_pipeline_stop(void)
+{
+    if (!running) {
+        return ESP_OK;
+    }
+    running = false;
+    if (pipe_cfg.governor) {
+        // 渲染任务可能正在低帧率下等待
+        lcd_governor_wake();
+    }
+
+    // 渲染任务和刷新任务各通知一次
+    for (int i = 0; i < 2; i++) {
+        if (xSemaphoreTake(exit_sem, pdMS_TO_TICKS(LCD_PIPELINE_TIMEOUT_MS * 2)) != pdTRUE) {
+            ESP_LOGE(TAG, "等待流水线任务退出超时");
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    lcd_pipeline_free();
+    if (pipe_cfg.governor) {
+        lcd_governor_deinit();
+    }
+    ESP_LOGI(TAG, "流水线已停止");
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取流水线统计
+ */
+esp_err_t lcd_pipeline_get_stats(lcd_pipeline_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&stats_lock);
+    *stats = pipe_stats;
+    uint32_t frames = window_frames;
+    uint32_t render_us = window_render_us;
+    uint32_t flush_us = window_flush_us;
+    int64_t elapsed = now - window_start_us;
+    window_frames = 0;
+    window_render_us = 0;
+    window_flush_us = 0;
+    window_start_us = now;
+    portEXIT_CRITICAL(&stats_lock);
+
+    if (elapsed > 0) {
+        stats->fps_x10 = (uint32_t)((uint64_t)frames * 10000000ULL / elapsed);
+        stats->render_load = (uint8_t)((uint64_t)render_us * 100 / elapsed);
+        stats->flush_load = (uint8_t)((uint64_t)flush_us * 100 / elapsed);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 清零流水线统计
+ */
+void lcd_pipeline_reset_stats(void)
+{
+    portENTER_CRITICAL(&stats_lock);
+    uint8_t render_core = pipe_stats.render_core;
+    uint8_t flush_core = pipe_stats.flush_core;
+    size_t buf_bytes = pipe_stats.buf_bytes;
+    pipe_stats = (lcd_pipeline_stats_t){0};
+    pipe_stats.render_core = render_core;
+    pipe_stats.flush_core = flush_core;
+    pipe_stats.buf_bytes = buf_bytes;
+    latency_sum_us = 0;
+    window_frames = 0;
+    window_render_us = 0;
+    window_flush_us = 0;
+    window_start_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&stats_lock);
+}
@@ -0,0 +1,114 @@
+/*
+ * 双核显示流水线头文件
+ * 渲染任务在一个核心上把条带渲染到DMA缓冲区, 刷新任务在另一个核心上把条带送给SPI,
+ * 两者通过缓冲区指针队列交接, 渲染与传输并行进行
+ */
+
+#ifndef LCD_PIPELINE_H
+#define LCD_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "lcd_stripe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 流水线配置
+#define LCD_PIPELINE_BUF_NUM        3       // 条带缓冲区数量 (>=2)
+#define LCD_PIPELINE_RENDER_CORE    1       // 渲染任务默认核心
+#define LCD_PIPELINE_FLUSH_CORE     0       // 刷新任务默认核心
+#define LCD_PIPELINE_RENDER_PRIO    5       // 渲染任务优先级
+#define LCD_PIPELINE_FLUSH_PRIO     6       // 刷新任务优先级 (高于渲染, 保证SPI不空闲)
+#define LCD_PIPELINE_STACK_SIZE     4096    // 任务栈大小
+#define LCD_PIPELINE_TIMEOUT_MS     1000    // 等待缓冲区/DMA超时时间
+
+/**
+ * @brief 帧回调: 渲染任务在每帧第一个条带之前调用, 用于更新场景状态
+ * @note 启用帧率调节时, 画面无变化的帧也会调用, 场景变化时在这里调用lcd_governor_mark_dirty
+ * @param frame 帧序号
+ * @param user_ctx 用户上下文
+ */
+typedef void (*lcd_pipeline_frame_cb_t)(uint32_t frame, void *user_ctx);
+
+/**
+ * @brief 流水线配置
+ */
+typedef struct {
+    int stripe_lines;                   // 条带高度 (行), 0表示使用LCD_STRIPE_DEFAULT_LINES
+    lcd_stripe_render_cb_t render_cb;   // 条带渲染回调, 在渲染任务中调用
+    lcd_pipeline_frame_cb_t frame_cb;   // 帧回调, 可以为NULL
+    void *user_ctx;                     // 传给回调的用户上下文
+    int render_core;                    // 渲染任务核心
+    int flush_core;                     // 刷新任务核心
+    bool governor;                      // 启用自适应帧率调节 (lcd_governor.h), 需要通过lcd_governor_mark_dirty报告画面变化
+} lcd_pipeline_config_t;
+
+/**
+ * @brief 默认配置
+ */
+#define LCD_PIPELINE_DEFAULT_CONFIG(cb, ctx) {  \
+    .stripe_lines = LCD_STRIPE_DEFAULT_LINES,   \
+    .render_cb = (cb),                          \
+    .frame_cb = NULL,                           \
+    .user_ctx = (ctx),                          \
+    .render_core = LCD_PIPELINE_RENDER_CORE,    \
+    .flush_core = LCD_PIPELINE_FLUSH_CORE,      \
+    .governor = false,                          \
+}
+
+/**
+ * @brief 流水线统计
+ * @note frames/stripes/延迟/反压计数从启动 (或lcd_pipeline_reset_stats) 开始累计;
+ *       fps和核心占用率是上一次调用lcd_pipeline_get_stats以来的平均值
+ */
+typedef struct {
+    uint32_t frames;                    // 已显示完成的帧数
+    uint32_t stripes;                   // 已传输完成的条带数
+    uint32_t latency_us;                // 上一帧延迟: 开始渲染第一个条带 -> 最后一个条带传输完成
+    uint32_t avg_latency_us;            // 平均帧延迟
+    uint32_t max_latency_us;            // 最大帧延迟
+    uint32_t render_stalls;             // 渲染任务等待空闲缓冲区的次数 (传输跟不上)
+    uint32_t flush_starved;             // 刷新任务等待就绪条带的次数 (渲染跟不上)
+    uint32_t fps_x10;                   // 帧率 x10
+    uint8_t render_core;                // 渲染任务所在核心
+    uint8_t flush_core;                 // 刷新任务所在核心
+    uint8_t render_load;                // 渲染任务占用其核心的百分比
+    uint8_t flush_load;                 // 刷新任务占用其核心的百分比
+    size_t buf_bytes;                   // 条带缓冲区总大小
+} lcd_pipeline_stats_t;
+
+/**
+ * @brief 分配条带缓冲区并启动渲染任务和刷新任务
+ * @note 流水线运行期间不要再调用lcd_stripe_render_frame或st7789_draw_bitmap
+ * @param config 配置
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 已经启动, ESP_ERR_NO_MEM 内存不足, 其他值表示错误
+ */
+esp_err_t lcd_pipeline_start(const lcd_pipeline_config_t *config);
+
+/**
+ * @brief 停止流水线: 渲染完当前帧并等待传输完成后退出任务, 释放缓冲区
+ * @return ESP_OK 成功, ESP_ERR_TIMEOUT 任务未能按时退出
+ */
+esp_err_t lcd_pipeline_stop(void);
+
+/**
+ * @brief 获取流水线统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t lcd_pipeline_get_stats(lcd_pipeline_stats_t *stats);
+
+/**
+ * @brief 清零流水线统计
+ */
+void lcd_pipeline_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_PIPELINE_H
@@ -0,0 +1,204 @@
+/*
+ * LCD条带渲染器实现
+ * 按N行条带渲染整屏, 只需要两块内部RAM中的小DMA缓冲区
+ */
+
+#include "lcd_stripe.h"
+#include "st7789.h"
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "LCD_STRIPE";
+
+static uint16_t *stripe_bufs[LCD_STRIPE_BUF_NUM] = {NULL};
+static uint16_t *frame_buf = NULL;
+static lcd_stripe_stats_t stripe_stats;
+
+/**
+ * @brief 记录内部RAM最低剩余
+ */
+static void lcd_stripe_sample_heap(void)
+{
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (stripe_stats.internal_min_free == 0 || free_now < stripe_stats.internal_min_free) {
+        stripe_stats.internal_min_free = free_now;
+    }
+}
+
+/**
+ * @brief 初始化条带渲染器并分配缓冲区
+ */
+esp_err_t lcd_stripe_init(const lcd_stripe_config_t *config)
+{
+    lcd_stripe_config_t cfg = {
+        .stripe_lines = LCD_STRIPE_DEFAULT_LINES,
+        .full_frame = false,
+    };
+    if (config != NULL) {
+        cfg = *config;
+        if (cfg.stripe_lines == 0) {
+            cfg.stripe_lines = LCD_STRIPE_DEFAULT_LINES;
+        }
+    }
+
+    // 条带模式每个条带一次DMA传输, 不能超过SPI总线的最大传输长度
+    if (!cfg.full_frame && (cfg.stripe_lines < 1 || cfg.stripe_lines > LCD_MAX_TRANSFER_LINES)) {
+        ESP_LOGE(TAG, "无效的条带高度: %d", cfg.stripe_lines);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    lcd_stripe_deinit();
+    stripe_stats = (lcd_stripe_stats_t){0};
+
+    if (cfg.full_frame) {
+#if CONFIG_SPIRAM
+        size_t frame_bytes = LCD_H_RES * LCD_V_RES * sizeof(uint16_t);
+        frame_buf = heap_caps_malloc(frame_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_DMA);
+        if (frame_buf == NULL) {
+            ESP_LOGE(TAG, "分配PSRAM整帧缓冲区失败 (%zu字节)", frame_bytes);
+            return ESP_ERR_NO_MEM;
+        }
+        stripe_stats.stripe_lines = LCD_V_RES;
+        stripe_stats.stripes_per_frame = 1;
+        stripe_stats.psram_buf_bytes = frame_bytes;
+        ESP_LOGI(TAG, "整帧模式: PSRAM缓冲区 %zu 字节", frame_bytes);
+        return ESP_OK;
+#else
+        ESP_LOGE(TAG, "整帧模式需要启用PSRAM (CONFIG_SPIRAM)");
+        return ESP_ERR_NOT_SUPPORTED;
+#endif
+    }
+
+    size_t stripe_bytes = LCD_H_RES * cfg.stripe_lines * sizeof(uint16_t);
+    for (int i = 0; i < LCD_STRIPE_BUF_NUM; i++) {
+        stripe_bufs[i] = heap_caps_malloc(stripe_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (stripe_bufs[i] == NULL) {
+            ESP_LOGE(TAG, "分配条带缓冲区%d失败 (%zu字节)", i, stripe_bytes);
+            lcd_stripe_deinit();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    stripe_stats.stripe_lines = cfg.stripe_lines;
+    stripe_stats.stripes_per_frame = (LCD_V_RES + cfg.stripe_lines - 1) / cfg.stripe_lines;
+    stripe_stats.internal_buf_bytes = stripe_bytes * LCD_STRIPE_BUF_NUM;
+    lcd_stripe_sample_heap();
+
+    ESP_LOGI(TAG, "条带模式: %d行/条带, 每帧%d个条带, 内部RAM缓冲区 %zu 字节 (整帧需要 %d 字节)",
+             stripe_stats.stripe_lines, stripe_stats.stripes_per_frame, stripe_stats.internal_buf_bytes,
+             LCD_H_RES * LCD_V_RES * (int)sizeof(uint16_t));
+    return ESP_OK;
+}
+
+/**
+ * @brief 释放条带渲染器的缓冲区
+ */
+void lcd_stripe_deinit(void)
+{
+    // 缓冲区可能仍在DMA传输中
+    st7789_wait_flush_done(LCD_STRIPE_TIMEOUT_MS);
+
+    for (int i = 0; i < LCD_STRIPE_BUF_NUM; i++) {
+        heap_caps_free(stripe_bufs[i]);
+        stripe_bufs[i] = NULL;
+    }
+    heap_caps_free(frame_buf);
+    frame_buf = NULL;
+}
+
+/**
+ * @brief 整帧模式: 渲染到PSRAM帧缓冲后一次提交
+ */
+static esp_err_t lcd_stripe_render_full(lcd_stripe_render_cb_t render_cb, void *user_ctx)
+{
+    esp_err_t ret = st7789_wait_flush_done(LCD_STRIPE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    render_cb(frame_buf, 0, LCD_V_RES, user_ctx);
+    stripe_stats.render_us = (uint32_t)(esp_timer_get_time() - t0);
+
+    ret = st7789_frame_begin(LCD_STRIPE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = st7789_draw_bitmap(0, 0, LCD_H_RES, LCD_V_RES, frame_buf);
+    st7789_frame_end();
+    return ret;
+}
+
+/**
+ * @brief 渲染并显示一整帧
+ */
+esp_err_t lcd_stripe_render_frame(lcd_stripe_render_cb_t render_cb, void *user_ctx)
+{
+    if (render_cb == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (frame_buf == NULL && stripe_bufs[0] == NULL) {
+        ESP_LOGE(TAG, "条带渲染器未初始化");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t frame_start = esp_timer_get_time();
+    esp_err_t ret;
+
+    if (frame_buf != NULL) {
+        ret = lcd_stripe_render_full(render_cb, user_ctx);
+        stripe_stats.frame_us = (uint32_t)(esp_timer_get_time() - frame_start);
+        return ret;
+    }
+
+    uint32_t render_us = 0;
+    int stripe_lines = stripe_stats.stripe_lines;
+
+    for (int i = 0; i < stripe_stats.stripes_per_frame; i++) {
+        uint16_t *buf = stripe_bufs[i % LCD_STRIPE_BUF_NUM];
+        int y = i * stripe_lines;
+        int lines = (y + stripe_lines > LCD_V_RES) ? (LCD_V_RES - y) : stripe_lines;
+
+        // 复用缓冲区前, 它上一次提交的传输必须已经完成
+        ret = st7789_wait_flush_pending(LCD_STRIPE_BUF_NUM - 1, LCD_STRIPE_TIMEOUT_MS);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+
+        int64_t t0 = esp_timer_get_time();
+        render_cb(buf, y, lines, user_ctx);
+        render_us += (uint32_t)(esp_timer_get_time() - t0);
+
+        if (i == 0) {
+            ret = st7789_frame_begin(LCD_STRIPE_TIMEOUT_MS);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+        }
+
+        ret = st7789_draw_bitmap(0, y, LCD_H_RES, y + lines, buf);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    st7789_frame_end();
+
+    lcd_stripe_sample_heap();
+    stripe_stats.render_us = render_us;
+    stripe_stats.frame_us = (uint32_t)(esp_timer_get_time() - frame_start);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取内存与耗时统计
+ */
+esp_err_t lcd_stripe_get_stats(lcd_stripe_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = stripe_stats;
+    return ESP_OK;
+}
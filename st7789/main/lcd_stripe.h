@@ -0,0 +1,86 @@
+/*
+ * LCD条带渲染器头文件
+ * 按N行条带渲染整屏, 只需要两块内部RAM中的小DMA缓冲区
+ */
+
+#ifndef LCD_STRIPE_H
+#define LCD_STRIPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 条带配置
+#define LCD_STRIPE_DEFAULT_LINES    20      // 默认条带高度 (行)
+#define LCD_STRIPE_BUF_NUM          2       // 条带缓冲区数量 (乒乓)
+#define LCD_STRIPE_TIMEOUT_MS       1000    // 等待DMA超时时间
+
+/**
+ * @brief 渲染回调: 把屏幕第y_start行开始的lines行渲染到buf
+ * @param buf 目标缓冲区, LCD_H_RES * lines个RGB565像素 (高字节在前)
+ * @param y_start 本条带在屏幕上的起始行
+ * @param lines 本条带的行数 (最后一个条带可能不足stripe_lines行)
+ * @param user_ctx 用户上下文
+ */
+typedef void (*lcd_stripe_render_cb_t)(uint16_t *buf, int y_start, int lines, void *user_ctx);
+
+/**
+ * @brief 条带渲染器配置
+ */
+typedef struct {
+    int stripe_lines;               // 条带高度 (行), 0表示使用默认值, 最大LCD_MAX_TRANSFER_LINES
+    bool full_frame;                // 使用PSRAM整帧缓冲 (仅CONFIG_SPIRAM时可用)
+} lcd_stripe_config_t;
+
+/**
+ * @brief 内存与耗时统计
+ */
+typedef struct {
+    int stripe_lines;               // 条带高度
+    int stripes_per_frame;          // 每帧条带数
+    size_t internal_buf_bytes;      // 内部RAM中的渲染缓冲区大小
+    size_t psram_buf_bytes;         // PSRAM中的渲染缓冲区大小
+    size_t internal_min_free;       // 渲染期间内部RAM最低剩余 (峰值占用的反面)
+    uint32_t render_us;             // 上一帧渲染耗时 (只计渲染回调)
+    uint32_t frame_us;              // 上一帧总耗时 (渲染+传输)
+} lcd_stripe_stats_t;
+
+/**
+ * @brief 初始化条带渲染器并分配缓冲区
+ * @param config 配置, NULL使用默认配置
+ * @return ESP_OK 成功, ESP_ERR_NOT_SUPPORTED 未启用PSRAM却请求整帧模式, 其他值表示错误
+ */
+esp_err_t lcd_stripe_init(const lcd_stripe_config_t *config);
+
+/**
+ * @brief 释放条带渲染器的缓冲区
+ */
+void lcd_stripe_deinit(void);
+
+/**
+ * @brief 渲染并显示一整帧
+ * @note 条带模式下当前条带的DMA传输与下一条带的渲染并行进行;
+ *       TE帧同步启用时在提交第一个条带前等待垂直消隐
+ * @param render_cb 渲染回调
+ * @param user_ctx 传给回调的用户上下文
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t lcd_stripe_render_frame(lcd_stripe_render_cb_t render_cb, void *user_ctx);
+
+/**
+ * @brief 获取内存与耗时统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t lcd_stripe_get_stats(lcd_stripe_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LCD_STRIPE_H
@@ -8,12 +8,16 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "PCA9557";
 
 // 当前配置状态
 static uint8_t current_config = 0xFF;  // 默认所有IO为输入
 static uint8_t current_output = 0x00;  // 默认所有输出为低电平
+static bool output_valid = false;      // 输出缓存是否与芯片一致 (ESP32软复位后芯片保持原来的输出)
+static SemaphoreHandle_t output_mutex = NULL;
+static pca9557_stats_t io_stats;
 
 /**
  * @brief 写入寄存器
@@ -25,6 +29,7 @@ static esp_err_t pca9557_write_register(uint8_t reg, uint8_t data)
     write_data[1] = data;
     
     esp_err_t ret = i2c_master_write_slave(PCA9557_I2C_ADDR, write_data, 2);
+    io_stats.writes++;
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "写入寄存器0x%02X失败: %s", reg, esp_err_to_name(ret));
         return ret;
@@ -33,6 +38,26 @@ static esp_err_t pca9557_write_register(uint8_t reg, uint8_t data)
     return ESP_OK;
 }
 
+/**
+ * @brief 获取缓存锁: 输出和配置寄存器的读改写都要持有, LCD片选切换也走这里
+ */
+static void pca9557_lock(void)
+{
+    if (output_mutex != NULL) {
+        xSemaphoreTake(output_mutex, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief 释放缓存锁
+ */
+static void pca9557_unlock(void)
+{
+    if (output_mutex != NULL) {
+        xSemaphoreGive(output_mutex);
+    }
+}
+
 /**
  * @brief 读取寄存器
  */
@@ -47,6 +72,7 @@ static esp_err_t pca9557_read_register(uint8_t reg, uint8_t *data)
     
     // 然后读取数据
     ret = i2c_master_read_slave(PCA9557_I2C_ADDR, data, 1);
+    io_stats.reads++;
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "读取寄存器0x%02X失败: %s", reg, esp_err_to_name(ret));
         return ret;
@@ -62,6 +88,10 @@ esp_err_t pca9557_init(void)
 {
     ESP_LOGI(TAG, "初始化PCA9557PW IO扩展芯片...");
     
+    if (output_mutex == NULL) {
+        output_mutex = xSemaphoreCreateMutex();
+    }
+    
     // 检查设备是否存在
     esp_err_t ret = pca9557_check_device();
     if (ret != ESP_OK) {
@@ -75,6 +105,13 @@ esp_err_t pca9557_init(void)
         ESP_LOGE(TAG, "PCA9557PW初始化配置失败");
         return ret;
     }
+
+    // 读回输出寄存器作为输出缓存, 之后电平没有变化的写入都可以省掉
+    pca9557_lock();
+    if (pca9557_read_register(PCA9557_REG_OUTPUT, &current_output) == ESP_OK) {
+        output_valid = true;
+    }
+    pca9557_unlock();
     
     ESP_LOGI(TAG, "PCA9557PW初始化成功");
     ESP_LOGI(TAG, "I2C地址: 0x%02X", PCA9557_I2C_ADDR);
@@ -105,6 +142,7 @@ esp_err_t pca9557_check_device(void)
  */
 esp_err_t pca9557_set_io_direction(uint8_t io_mask, uint8_t direction)
 {
+    pca9557_lock();
     uint8_t new_config = current_config;
     
     if (direction == PCA9557_IO_INPUT) {
@@ -118,31 +156,58 @@ esp_err_t pca9557_set_io_direction(uint8_t io_mask, uint8_t direction)
     esp_err_t ret = pca9557_write_register(PCA9557_REG_CONFIG, new_config);
     if (ret == ESP_OK) {
         current_config = new_config;
+    }
+    pca9557_unlock();
+    
+    if (ret == ESP_OK) {
         ESP_LOGI(TAG, "IO方向设置成功: 掩码=0x%02X, 方向=%s", 
                  io_mask, (direction == PCA9557_IO_INPUT) ? "输入" : "输出");
     }
-    
     return ret;
 }
 
 /**
- * @brief 设置IO输出电平
+ * @brief 一次写入同时修改多个输出IO
  */
-esp_err_t pca9557_set_io_level(uint8_t io_mask, uint8_t level)
+esp_err_t pca9557_update_outputs(uint8_t io_mask, uint8_t levels)
 {
-    uint8_t new_output = current_output;
-    
-    if (level == PCA9557_IO_HIGH) {
-        // 设置为高电平 (1)
-        new_output |= io_mask;
+    pca9557_lock();
+
+    esp_err_t ret = ESP_OK;
+    uint8_t new_output = (current_output & ~io_mask) | (levels & io_mask);
+    if (output_valid && new_output == current_output) {
+        io_stats.skipped_writes++;
     } else {
-        // 设置为低电平 (0)
-        new_output &= ~io_mask;
+        ret = pca9557_write_register(PCA9557_REG_OUTPUT, new_output);
+        if (ret == ESP_OK) {
+            current_output = new_output;
+            output_valid = true;
+        }
     }
-    
-    esp_err_t ret = pca9557_write_register(PCA9557_REG_OUTPUT, new_output);
+
+    pca9557_unlock();
+    return ret;
+}
+
+/**
+ * @brief 获取I2C访问统计
+ */
+esp_err_t pca9557_get_stats(pca9557_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = io_stats;
+    return ESP_OK;
+}
+
+/**
+ * @brief 设置IO输出电平
+ */
+esp_err_t pca9557_set_io_level(uint8_t io_mask, uint8_t level)
+{
+    esp_err_t ret = pca9557_update_outputs(io_mask, (level == PCA9557_IO_HIGH) ? io_mask : 0);
     if (ret == ESP_OK) {
-        current_output = new_output;
         ESP_LOGI(TAG, "IO电平设置成功: 掩码=0x%02X, 电平=%s", 
                  io_mask, (level == PCA9557_IO_HIGH) ? "高" : "低");
     }
@@ -205,14 +270,26 @@ esp_err_t pca9557_read_all_status(uint8_t *input_levels, uint8_t *output_levels,
  */
 esp_err_t pca9557_toggle_io(uint8_t io_mask)
 {
-    uint8_t new_output = current_output ^ io_mask;
+    esp_err_t ret = ESP_OK;
     
-    esp_err_t ret = pca9557_write_register(PCA9557_REG_OUTPUT, new_output);
+    pca9557_lock();
+    // 缓存无效时先读回芯片的输出寄存器, 否则会按错误的电平反转
+    if (!output_valid) {
+        ret = pca9557_read_register(PCA9557_REG_OUTPUT, &current_output);
+        output_valid = (ret == ESP_OK);
+    }
     if (ret == ESP_OK) {
-        current_output = new_output;
-        ESP_LOGI(TAG, "IO电平反转成功: 掩码=0x%02X", io_mask);
+        uint8_t new_output = current_output ^ io_mask;
+        ret = pca9557_write_register(PCA9557_REG_OUTPUT, new_output);
+        if (ret == ESP_OK) {
+            current_output = new_output;
+        }
     }
+    pca9557_unlock();
     
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "IO电平反转成功: 掩码=0x%02X", io_mask);
+    }
     return ret;
 }
 
@@ -223,20 +300,22 @@ esp_err_t pca9557_config_all_outputs(uint8_t levels)
 {
     esp_err_t ret;
     
+    pca9557_lock();
     // 设置所有IO为输出模式
     ret = pca9557_write_register(PCA9557_REG_CONFIG, 0x00);
-    if (ret != ESP_OK) {
-        return ret;
-    }
-    
-    // 设置输出电平
-    ret = pca9557_write_register(PCA9557_REG_OUTPUT, levels);
     if (ret == ESP_OK) {
         current_config = 0x00;  // 所有IO为输出
+        
+        // 设置输出电平; 失败时芯片的输出寄存器状态未知
+        ret = pca9557_write_register(PCA9557_REG_OUTPUT, levels);
         current_output = levels;
-        ESP_LOGI(TAG, "所有IO配置为输出模式成功: 电平=0x%02X", levels);
+        output_valid = (ret == ESP_OK);
     }
+    pca9557_unlock();
     
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "所有IO配置为输出模式成功: 电平=0x%02X", levels);
+    }
     return ret;
 }
 
@@ -245,11 +324,15 @@ esp_err_t pca9557_config_all_outputs(uint8_t levels)
  */
 esp_err_t pca9557_config_all_inputs(void)
 {
+    pca9557_lock();
     esp_err_t ret = pca9557_write_register(PCA9557_REG_CONFIG, 0xFF);
     if (ret == ESP_OK) {
         current_config = 0xFF;  // 所有IO为输入
-        ESP_LOGI(TAG, "所有IO配置为输入模式成功");
     }
+    pca9557_unlock();
     
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "所有IO配置为输入模式成功");
+    }
     return ret;
 } 
\ No newline at end of file
@@ -33,6 +33,11 @@ extern "C" {
 #define PCA9557_IO7                 0x80    // IO7 (位7)
 #define PCA9557_ALL_IO              0xFF    // 所有IO
 
+// 板载功能引脚
+#define PCA9557_LCD_CS              PCA9557_IO0     // LCD片选 (低电平有效)
+#define PCA9557_PA_EN               PCA9557_IO1     // 功放使能
+#define PCA9557_DVP_PWDN            PCA9557_IO2     // 摄像头掉电控制 (高电平掉电)
+
 // IO方向定义
 #define PCA9557_IO_INPUT            1       // 输入模式
 #define PCA9557_IO_OUTPUT           0       // 输出模式
@@ -41,6 +46,15 @@ extern "C" {
 #define PCA9557_IO_LOW              0       // 低电平
 #define PCA9557_IO_HIGH             1       // 高电平
 
+/**
+ * @brief I2C访问统计
+ */
+typedef struct {
+    uint32_t writes;                // 寄存器写入次数 (每次一个I2C事务)
+    uint32_t reads;                 // 寄存器读取次数
+    uint32_t skipped_writes;        // 输出缓存与目标一致而省掉的写入次数
+} pca9557_stats_t;
+
 /**
  * @brief PCA9557PW初始化
  * @return ESP_OK 成功, 其他值表示错误
@@ -69,6 +83,22 @@ esp_err_t pca9557_set_io_direction(uint8_t io_mask, uint8_t direction);
  */
 esp_err_t pca9557_set_io_level(uint8_t io_mask, uint8_t level);
 
+/**
+ * @brief 一次写入同时修改多个输出IO
+ * @note 先和输出寄存器缓存比较, 电平没有变化时不访问I2C; 多个控制线需要同时变化时应合并成一次调用
+ * @param io_mask 要修改的IO掩码 (使用PCA9557_IOx定义)
+ * @param levels 目标电平, 每位对应一个IO, 只有io_mask中的位有效
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t pca9557_update_outputs(uint8_t io_mask, uint8_t levels);
+
+/**
+ * @brief 获取I2C访问统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t pca9557_get_stats(pca9557_stats_t *stats);
+
 /**
  * @brief 读取IO输入电平
  * @param io_mask IO引脚掩码 (使用PCA9557_IOx定义)
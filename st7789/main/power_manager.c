@@ -0,0 +1,305 @@
+/*
+ * 电源管理实现
+ * 每个锁在ESP-IDF的PM锁外面记录嵌套深度和持有时间; 所有锁的状态变化都在同一个自旋锁内累计
+ * 频率档位时间: 有CPU最高频率锁时计入最高频率, 只有APB/禁止睡眠锁时计入忙碌, 没有锁时计入空闲
+ */
+
+#include "power_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+static const char *TAG = "POWER_MGR";
+
+struct power_lock_s {
+    esp_pm_lock_handle_t pm_lock;       // ESP-IDF的锁, 未启用电源管理时为NULL
+    power_lock_stats_t stats;
+    uint32_t depth;                     // 嵌套深度
+    int64_t held_since;                 // 本次持有的开始时间, 用于最长持有时间
+    int64_t counted_since;              // 累计持有时间从这里开始计算 (读取清零后重新开始)
+};
+
+static struct power_lock_s locks[POWER_MANAGER_MAX_LOCKS];
+static int lock_count = 0;
+static portMUX_TYPE pm_spinlock = portMUX_INITIALIZER_UNLOCKED;    // 保护锁表和档位时间
+
+static power_manager_config_t pm_config = POWER_MANAGER_DEFAULT_CONFIG();
+static bool pm_enabled = false;
+static bool light_sleep_enabled = false;
+
+// 档位时间, 在自旋锁内更新
+static int cpu_holders = 0;             // 持有中的CPU最高频率锁数
+static int busy_holders = 0;            // 持有中的其他锁数
+static int64_t mode_since = 0;          // 当前档位的开始时间
+static int64_t window_start = 0;        // 统计开始时间
+static uint64_t max_freq_us = 0;
+static uint64_t busy_us = 0;
+static uint64_t idle_us = 0;
+
+/**
+ * @brief 把上次状态变化以来的时间计入当前档位, 调用时持有自旋锁
+ */
+static void power_manager_account(int64_t now)
+{
+    uint64_t delta = (uint64_t)(now - mode_since);
+    if (cpu_holders > 0) {
+        max_freq_us += delta;
+    } else if (busy_holders > 0) {
+        busy_us += delta;
+    } else {
+        idle_us += delta;
+    }
+    mode_since = now;
+}
+
+/**
+ * @brief 锁类型名称
+ */
+static const char *power_manager_type_name(esp_pm_lock_type_t type)
+{
+    switch (type) {
+    case ESP_PM_CPU_FREQ_MAX:
+        return "CPU_MAX";
+    case ESP_PM_APB_FREQ_MAX:
+        return "APB_MAX";
+    case ESP_PM_NO_LIGHT_SLEEP:
+        return "NO_SLEEP";
+    default:
+        return "?";
+    }
+}
+
+/**
+ * @brief 配置动态调频和自动轻度睡眠
+ */
+esp_err_t power_manager_init(const power_manager_config_t *config)
+{
+    if (config != NULL) {
+        pm_config = *config;
+    }
+
+    bool light_sleep = pm_config.light_sleep;
+#if !CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    if (light_sleep) {
+        // 自动轻度睡眠由空闲任务在tickless模式下进入, 没有打开时esp_pm_configure会失败
+        ESP_LOGW(TAG, "未启用CONFIG_FREERTOS_USE_TICKLESS_IDLE, 只启用动态调频");
+        light_sleep = false;
+    }
+#endif
+
+    esp_pm_config_t cfg = {
+        .max_freq_mhz = pm_config.max_freq_mhz,
+        .min_freq_mhz = pm_config.min_freq_mhz,
+        .light_sleep_enable = light_sleep,
+    };
+    esp_err_t ret = esp_pm_configure(&cfg);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        // 未启用CONFIG_PM_ENABLE时CPU频率固定, 只统计锁
+        ESP_LOGI(TAG, "未启用电源管理, 频率固定, 只统计锁的持有情况");
+        ret = ESP_OK;
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "配置电源管理失败: %s", esp_err_to_name(ret));
+        return ret;
+    } else {
+        pm_enabled = true;
+        light_sleep_enabled = light_sleep;
+        ESP_LOGI(TAG, "动态调频: %d~%dMHz, 自动轻度睡眠: %s",
+                 cfg.min_freq_mhz, cfg.max_freq_mhz, light_sleep ? "开启" : "关闭");
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&pm_spinlock);
+    power_manager_account(now);
+    max_freq_us = 0;
+    busy_us = 0;
+    idle_us = 0;
+    window_start = now;
+    portEXIT_CRITICAL(&pm_spinlock);
+    return ret;
+}
+
+/**
+ * @brief 创建带统计的PM锁
+ */
+esp_err_t power_manager_lock_create(esp_pm_lock_type_t type, const char *name, power_lock_handle_t *handle)
+{
+    if (name == NULL || handle == NULL || type > ESP_PM_NO_LIGHT_SLEEP) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_pm_lock_handle_t pm_lock = NULL;
+    esp_err_t ret = esp_pm_lock_create(type, 0, name, &pm_lock);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        pm_lock = NULL;
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建PM锁%s失败: %s", name, esp_err_to_name(ret));
+        return ret;
+    }
+
+    portENTER_CRITICAL(&pm_spinlock);
+    if (lock_count >= POWER_MANAGER_MAX_LOCKS) {
+        portEXIT_CRITICAL(&pm_spinlock);
+        if (pm_lock != NULL) {
+            esp_pm_lock_delete(pm_lock);
+        }
+        ESP_LOGE(TAG, "PM锁已满, 不能创建%s", name);
+        return ESP_ERR_NO_MEM;
+    }
+    struct power_lock_s *lock = &locks[lock_count++];
+    lock->pm_lock = pm_lock;
+    lock->stats = (power_lock_stats_t){
+        .name = name,
+        .type = type,
+    };
+    lock->depth = 0;
+    portEXIT_CRITICAL(&pm_spinlock);
+
+    *handle = lock;
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取锁
+ */
+void power_manager_lock_acquire(power_lock_handle_t lock)
+{
+    if (lock == NULL) {
+        return;
+    }
+
+    // 先升频再开始计时, 计入的都是真正运行在高频的时间
+    if (lock->pm_lock != NULL) {
+        esp_pm_lock_acquire(lock->pm_lock);
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&pm_spinlock);
+    if (lock->depth++ == 0) {
+        power_manager_account(now);
+        if (lock->stats.type == ESP_PM_CPU_FREQ_MAX) {
+            cpu_holders++;
+        } else {
+            busy_holders++;
+        }
+        lock->held_since = now;
+        lock->counted_since = now;
+        lock->stats.acquire_count++;
+        lock->stats.held = true;
+    }
+    portEXIT_CRITICAL(&pm_spinlock);
+}
+
+/**
+ * @brief 释放锁
+ */
+void power_manager_lock_release(power_lock_handle_t lock)
+{
+    if (lock == NULL) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&pm_spinlock);
+    if (lock->depth > 0 && --lock->depth == 0) {
+        power_manager_account(now);
+        if (lock->stats.type == ESP_PM_CPU_FREQ_MAX) {
+            cpu_holders--;
+        } else {
+            busy_holders--;
+        }
+        uint32_t hold = (uint32_t)(now - lock->held_since);
+        if (hold > lock->stats.max_hold_us) {
+            lock->stats.max_hold_us = hold;
+        }
+        lock->stats.held_us += (uint64_t)(now - lock->counted_since);
+        lock->stats.held = false;
+    }
+    portEXIT_CRITICAL(&pm_spinlock);
+
+    if (lock->pm_lock != NULL) {
+        esp_pm_lock_release(lock->pm_lock);
+    }
+}
+
+/**
+ * @brief 获取统计
+ */
+esp_err_t power_manager_get_stats(power_manager_stats_t *stats, power_lock_stats_t *out, int max_locks, bool reset)
+{
+    if (stats == NULL || (out == NULL && max_locks > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&pm_spinlock);
+    power_manager_account(now);
+    *stats = (power_manager_stats_t){
+        .elapsed_us = (uint64_t)(now - window_start),
+        .max_freq_us = max_freq_us,
+        .busy_us = busy_us,
+        .idle_us = idle_us,
+        .max_freq_mhz = pm_config.max_freq_mhz,
+        .min_freq_mhz = pm_config.min_freq_mhz,
+        .pm_enabled = pm_enabled,
+        .light_sleep = light_sleep_enabled,
+        .lock_count = lock_count,
+    };
+    for (int i = 0; i < lock_count; i++) {
+        struct power_lock_s *lock = &locks[i];
+        if (i < max_locks) {
+            out[i] = lock->stats;
+            if (lock->depth > 0) {
+                // 正在持有的部分计入本次统计
+                out[i].held_us += (uint64_t)(now - lock->counted_since);
+            }
+        }
+        if (reset) {
+            lock->stats.acquire_count = 0;
+            lock->stats.held_us = 0;
+            lock->stats.max_hold_us = 0;
+            lock->counted_since = now;
+        }
+    }
+    if (reset) {
+        max_freq_us = 0;
+        busy_us = 0;
+        idle_us = 0;
+        window_start = now;
+    }
+    portEXIT_CRITICAL(&pm_spinlock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 打印统计
+ */
+void power_manager_report(void)
+{
+    power_manager_stats_t stats;
+    power_lock_stats_t lock_stats[POWER_MANAGER_MAX_LOCKS];
+    power_manager_get_stats(&stats, lock_stats, POWER_MANAGER_MAX_LOCKS, true);
+    if (stats.elapsed_us == 0) {
+        return;
+    }
+
+    uint64_t total = stats.elapsed_us;
+    ESP_LOGI(TAG, "%" PRIu32 "ms内: %dMHz %" PRIu32 "%%, %dMHz不睡眠 %" PRIu32 "%%, %s %" PRIu32 "%%",
+             (uint32_t)(total / 1000),
+             stats.max_freq_mhz, (uint32_t)(stats.max_freq_us * 100 / total),
+             stats.min_freq_mhz, (uint32_t)(stats.busy_us * 100 / total),
+             stats.light_sleep ? "空闲/轻度睡眠" : "空闲", (uint32_t)(stats.idle_us * 100 / total));
+    for (int i = 0; i < stats.lock_count && i < POWER_MANAGER_MAX_LOCKS; i++) {
+        const power_lock_stats_t *lock = &lock_stats[i];
+        ESP_LOGI(TAG, "  %-12s %-8s %6" PRIu32 "次, 累计%" PRIu32 "ms, 最长%" PRIu32 "us%s",
+                 lock->name, power_manager_type_name(lock->type), lock->acquire_count,
+                 (uint32_t)(lock->held_us / 1000), lock->max_hold_us, lock->held ? " (持有中)" : "");
+    }
+#if CONFIG_PM_PROFILING
+    // ESP-IDF自己的统计, 包括其他组件的锁和实际的轻度睡眠时间
+    esp_pm_dump_locks(stdout);
+#endif
+}
@@ -0,0 +1,125 @@
+/*
+ * 电源管理头文件
+ * 配置动态调频 (DFS) 和自动轻度睡眠, 并为各驱动提供带统计的PM锁: 驱动只在传输或计算期间持有锁,
+ * 突发时CPU升到最高频率, 空闲时降到最低频率并由FreeRTOS空闲任务自动进入轻度睡眠;
+ * 统计各频率档位下的时间和每个锁的持有情况
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_pm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 电源管理配置
+#define POWER_MANAGER_MAX_LOCKS     8       // 最多创建的锁数
+#define POWER_MANAGER_MAX_FREQ_MHZ  240     // 持有CPU最高频率锁时的频率
+#define POWER_MANAGER_MIN_FREQ_MHZ  80      // 空闲时的频率 (APB需要80MHz, 不能再低)
+
+/**
+ * @brief 电源管理配置
+ */
+typedef struct {
+    int max_freq_mhz;                   // 最高频率
+    int min_freq_mhz;                   // 最低频率
+    bool light_sleep;                   // 空闲时自动进入轻度睡眠 (需要CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+} power_manager_config_t;
+
+/**
+ * @brief 默认配置: 80~240MHz, 自动轻度睡眠
+ */
+#define POWER_MANAGER_DEFAULT_CONFIG() {            \
+    .max_freq_mhz = POWER_MANAGER_MAX_FREQ_MHZ,     \
+    .min_freq_mhz = POWER_MANAGER_MIN_FREQ_MHZ,     \
+    .light_sleep = true,                            \
+}
+
+/**
+ * @brief 带统计的PM锁句柄
+ */
+typedef struct power_lock_s *power_lock_handle_t;
+
+/**
+ * @brief 单个锁的统计
+ */
+typedef struct {
+    const char *name;                   // 名称
+    esp_pm_lock_type_t type;            // 锁类型
+    uint32_t acquire_count;             // 从未持有到持有的次数
+    uint64_t held_us;                   // 累计持有时间
+    uint32_t max_hold_us;               // 最长一次持有时间
+    bool held;                          // 当前是否持有
+} power_lock_stats_t;
+
+/**
+ * @brief 各频率档位的时间, 按本模块的锁状态统计
+ * @note 其他组件 (如WiFi、驱动内部) 自己持有的锁不在统计内; 需要包括轻度睡眠在内的精确时间时
+ *       打开CONFIG_PM_PROFILING, power_manager_report会同时打印esp_pm_dump_locks的结果
+ */
+typedef struct {
+    uint64_t elapsed_us;                // 统计时长
+    uint64_t max_freq_us;               // 持有CPU最高频率锁, 运行在max_freq_mhz
+    uint64_t busy_us;                   // 只持有APB/禁止睡眠锁, 运行在min_freq_mhz且不能睡眠
+    uint64_t idle_us;                   // 没有锁, 运行在min_freq_mhz或处于自动轻度睡眠
+    int max_freq_mhz;                   // 配置的最高频率
+    int min_freq_mhz;                   // 配置的最低频率
+    bool pm_enabled;                    // 是否启用了电源管理 (CONFIG_PM_ENABLE且配置成功)
+    bool light_sleep;                   // 是否启用了自动轻度睡眠
+    int lock_count;                     // 已创建的锁数
+} power_manager_stats_t;
+
+/**
+ * @brief 配置动态调频和自动轻度睡眠
+ * @note 未启用CONFIG_PM_ENABLE时CPU频率固定, 只统计锁的持有情况, 也返回ESP_OK
+ * @param config 配置, NULL使用默认配置
+ * @return ESP_OK 成功, 其他值表示esp_pm_configure失败
+ */
+esp_err_t power_manager_init(const power_manager_config_t *config);
+
+/**
+ * @brief 创建带统计的PM锁
+ * @note 可以在power_manager_init之前调用, 驱动初始化时各自创建
+ * @param type ESP_PM_CPU_FREQ_MAX (计算), ESP_PM_APB_FREQ_MAX (外设传输) 或 ESP_PM_NO_LIGHT_SLEEP
+ * @param name 名称, 必须是静态字符串
+ * @param handle 返回的句柄
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效, ESP_ERR_NO_MEM 锁已满
+ */
+esp_err_t power_manager_lock_create(esp_pm_lock_type_t type, const char *name, power_lock_handle_t *handle);
+
+/**
+ * @brief 获取锁, 可以嵌套
+ * @note 只能在任务中调用; handle为NULL时什么也不做, 驱动在没有锁时也能正常工作
+ */
+void power_manager_lock_acquire(power_lock_handle_t handle);
+
+/**
+ * @brief 释放锁
+ */
+void power_manager_lock_release(power_lock_handle_t handle);
+
+/**
+ * @brief 获取统计
+ * @param stats 返回各频率档位的时间
+ * @param locks 返回每个锁的统计, 可以为NULL
+ * @param max_locks locks数组长度
+ * @param reset 读取后清零, 下次从现在开始统计
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t power_manager_get_stats(power_manager_stats_t *stats, power_lock_stats_t *locks, int max_locks, bool reset);
+
+/**
+ * @brief 打印上一次报告以来各频率档位的时间占比和每个锁的持有统计
+ */
+void power_manager_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,140 @@
+/*
+ * RGB565像素内核头文件
+ * 填充、复制、混合、颜色转换、字节交换和2:1缩小;
+ * 填充、复制、字节交换和缩小在ESP32-S3上使用PIE 128位向量指令, 其他目标使用32位标量实现;
+ * 混合和颜色转换在所有目标上都是标量实现
+ */
+
+#ifndef RGB565_H
+#define RGB565_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ESP32-S3使用PIE向量指令
+#if CONFIG_IDF_TARGET_ESP32S3
+#define RGB565_USE_PIE              1
+#else
+#define RGB565_USE_PIE              0
+#endif
+
+// 自检与基准测试配置
+#define RGB565_TEST_PIXELS          (320 * 20)  // 测试缓冲区像素数 (一个条带)
+#define RGB565_BENCH_ROUNDS         20          // 基准测试重复次数
+
+/*
+ * 像素字节序约定: 除rgb565_swap_bytes外, 所有内核都按LCD字节序 (高字节在前)
+ * 读写像素, 和送给ST7789的DMA缓冲区一致。
+ */
+
+/**
+ * @brief 由8位RGB分量生成LCD字节序的RGB565像素
+ */
+#define RGB565(r, g, b)             ((uint16_t)((((r) & 0xF8) | ((g) >> 5)) | ((((g) & 0x1C) << 3 | ((b) >> 3)) << 8)))
+
+/**
+ * @brief 用同一颜色填充n个像素
+ * @param dst 目标缓冲区
+ * @param color 颜色 (LCD字节序)
+ * @param n 像素数
+ */
+void rgb565_fill(uint16_t *dst, uint16_t color, size_t n);
+
+/**
+ * @brief 复制n个像素 (源和目标不能重叠)
+ * @param dst 目标缓冲区
+ * @param src 源缓冲区
+ * @param n 像素数
+ */
+void rgb565_copy(uint16_t *dst, const uint16_t *src, size_t n);
+
+/**
+ * @brief 矩形块复制
+ * @param dst 目标左上角
+ * @param dst_stride 目标每行像素数
+ * @param src 源左上角
+ * @param src_stride 源每行像素数
+ * @param w 宽度 (像素)
+ * @param h 高度 (行)
+ */
+void rgb565_blit(uint16_t *dst, int dst_stride, const uint16_t *src, int src_stride, int w, int h);
+
+/**
+ * @brief 固定透明度混合: dst = src * alpha + dst * (1 - alpha)
+ * @note 标量实现, 透明度量化后为0或32时退化为不变或复制
+ * @param dst 背景, 同时也是输出
+ * @param src 前景
+ * @param alpha 透明度 0~255 (内部量化为0~32)
+ * @param n 像素数
+ */
+void rgb565_blend(uint16_t *dst, const uint16_t *src, uint8_t alpha, size_t n);
+
+/**
+ * @brief 逐像素透明度混合: dst[i] = src[i] * alpha[i] + dst[i] * (1 - alpha[i])
+ * @param dst 背景, 同时也是输出
+ * @param src 前景
+ * @param alpha 每个像素的透明度 0~255
+ * @param n 像素数
+ */
+void rgb565_blend_alpha8(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, size_t n);
+
+/**
+ * @brief RGB888转RGB565 (标量实现, 一次写两个像素)
+ * @param dst 目标缓冲区 (LCD字节序)
+ * @param src 源数据, 每像素R、G、B三个字节
+ * @param n 像素数
+ */
+void rgb888_to_rgb565(uint16_t *dst, const uint8_t *src, size_t n);
+
+/**
+ * @brief 交换每个像素的高低字节 (CPU字节序 <-> LCD字节序), dst可以等于src
+ * @param dst 目标缓冲区
+ * @param src 源缓冲区
+ * @param n 像素数
+ */
+void rgb565_swap_bytes(uint16_t *dst, const uint16_t *src, size_t n);
+
+/**
+ * @brief 2:1水平抽点缩小: dst[i] = src[2 * i]
+ * @note 可以原地处理 (dst <= src), 用于把一行就地缩小后紧凑存放
+ * @param dst 目标缓冲区
+ * @param src 源缓冲区, 至少2n个像素
+ * @param n 输出像素数
+ */
+void rgb565_downsample_2x(uint16_t *dst, const uint16_t *src, size_t n);
+
+/*
+ * 标量参考实现: 逐像素计算, 作为自检的基准
+ */
+void rgb565_fill_ref(uint16_t *dst, uint16_t color, size_t n);
+void rgb565_copy_ref(uint16_t *dst, const uint16_t *src, size_t n);
+void rgb565_blit_ref(uint16_t *dst, int dst_stride, const uint16_t *src, int src_stride, int w, int h);
+void rgb565_blend_ref(uint16_t *dst, const uint16_t *src, uint8_t alpha, size_t n);
+void rgb565_blend_alpha8_ref(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, size_t n);
+void rgb888_to_rgb565_ref(uint16_t *dst, const uint8_t *src, size_t n);
+void rgb565_swap_bytes_ref(uint16_t *dst, const uint16_t *src, size_t n);
+void rgb565_downsample_2x_ref(uint16_t *dst, const uint16_t *src, size_t n);
+
+/**
+ * @brief 自检: 用随机数据、不同长度和对齐方式比较每个内核与它的参考实现, 要求逐位相同
+ * @return ESP_OK 全部一致, ESP_FAIL 存在不一致, ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t rgb565_self_test(void);
+
+/**
+ * @brief 基准测试: 打印有加速实现的内核 (填充、复制、字节交换、缩小) 参考实现和加速实现的每像素周期数
+ * @return ESP_OK 成功, ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t rgb565_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RGB565_H
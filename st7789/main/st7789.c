@@ -0,0 +1,560 @@
+/*
+ * ST7789 LCD驱动实现
+ * 320x240 RGB565, SPI接口, 片选由PCA9557 IO0控制
+ */
+
+#include "st7789.h"
+#include "pca9557.h"
+#include <inttypes.h>
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "ST7789";
+
+// 背光有效电平 (背光电路为低电平点亮)
+#define LCD_BL_ON_LEVEL             0
+
+static esp_lcd_panel_io_handle_t io_handle = NULL;
+static esp_lcd_panel_handle_t panel_handle = NULL;
+
+// DMA传输完成计数信号量, 每个完成的颜色传输释放一次
+static SemaphoreHandle_t flush_done_sem = NULL;
+static uint32_t pending_flushes = 0;
+
+// TE帧同步状态
+static SemaphoreHandle_t te_sem = NULL;
+static bool te_enabled = false;
+static volatile uint32_t te_pulse_count = 0;
+static volatile int64_t te_last_us = 0;
+static volatile uint32_t te_period_us = 1000000 / LCD_REFRESH_HZ;
+
+// 片选经PCA9557 (I2C) 控制, 一次拉低后在连续的传输之间保持
+static volatile bool cs_asserted = false;
+
+// 帧统计
+static st7789_frame_stats_t frame_stats;
+static int64_t frame_begin_us = 0;
+static uint32_t frame_begin_pulse = 0;
+static uint32_t frame_begin_i2c_writes = 0;
+
+/**
+ * @brief 颜色数据DMA传输完成回调 (ISR上下文)
+ */
+static bool IRAM_ATTR st7789_on_flush_done(esp_lcd_panel_io_handle_t panel_io,
+                                           esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(flush_done_sem, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+/**
+ * @brief TE引脚上升沿中断 (面板进入垂直消隐)
+ */
+static void IRAM_ATTR st7789_te_isr(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    if (te_last_us != 0) {
+        uint32_t period = (uint32_t)(now - te_last_us);
+        // 1/8滑动平均, 滤除中断延迟抖动
+        te_period_us = te_period_us - (te_period_us >> 3) + (period >> 3);
+    }
+    te_last_us = now;
+    te_pulse_count++;
+
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(te_sem, &need_yield);
+    if (need_yield == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief 回收已完成的DMA传输 (非阻塞)
+ */
+static void st7789_reap_flushes(void)
+{
+    while (pending_flushes > 0 && xSemaphoreTake(flush_done_sem, 0) == pdTRUE) {
+        pending_flushes--;
+    }
+}
+
+/**
+ * @brief PCA9557已经写入的寄存器次数
+ */
+static uint32_t st7789_i2c_writes(void)
+{
+    pca9557_stats_t stats;
+    pca9557_get_stats(&stats);
+    return stats.writes;
+}
+
+/**
+ * @brief 片选未拉低时拉低 (已拉低时不访问I2C)
+ */
+static esp_err_t st7789_ensure_cs(void)
+{
+    return cs_asserted ? ESP_OK : st7789_bus_acquire();
+}
+
+/**
+ * @brief 初始化ST7789
+ */
+esp_err_t st7789_init(void)
+{
+    ESP_LOGI(TAG, "初始化ST7789 LCD...");
+
+    flush_done_sem = xSemaphoreCreateCounting(LCD_TRANS_QUEUE_DEPTH * 2, 0);
+    te_sem = xSemaphoreCreateBinary();
+    if (flush_done_sem == NULL || te_sem == NULL) {
+        ESP_LOGE(TAG, "创建信号量失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 背光先关闭, 避免初始化期间显示花屏
+    gpio_config_t bl_conf = {
+        .pin_bit_mask = (1ULL << LCD_PIN_BL),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&bl_conf);
+    st7789_set_backlight(false);
+
+    // 初始化SPI总线
+    spi_bus_config_t buscfg = {
+        .sclk_io_num = LCD_PIN_SCLK,
+        .mosi_io_num = LCD_PIN_MOSI,
+        .miso_io_num = GPIO_NUM_NC,
+        .quadwp_io_num = GPIO_NUM_NC,
+        .quadhd_io_num = GPIO_NUM_NC,
+        .max_transfer_sz = LCD_H_RES * LCD_MAX_TRANSFER_LINES * sizeof(uint16_t),
+    };
+    esp_err_t ret = spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI总线初始化失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 创建面板IO (片选由PCA9557控制, 这里不使用CS引脚)
+    esp_lcd_panel_io_spi_config_t io_config = {
+        .dc_gpio_num = LCD_PIN_DC,
+        .cs_gpio_num = GPIO_NUM_NC,
+        .pclk_hz = LCD_PIXEL_CLOCK_HZ,
+        .lcd_cmd_bits = LCD_CMD_BITS,
+        .lcd_param_bits = LCD_PARAM_BITS,
+        .spi_mode = 2,
+        .trans_queue_depth = LCD_TRANS_QUEUE_DEPTH,
+        .on_color_trans_done = st7789_on_flush_done,
+        .user_ctx = NULL,
+    };
+    ret = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_HOST, &io_config, &io_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建面板IO失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 创建ST7789面板
+    esp_lcd_panel_dev_config_t panel_config = {
+        .reset_gpio_num = LCD_PIN_RST,
+        .rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB,
+        .bits_per_pixel = LCD_BITS_PER_PIXEL,
+    };
+    ret = esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "创建ST7789面板失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 片选从这里开始一直保持, 直到st7789_bus_release
+    ret = st7789_bus_acquire();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    esp_lcd_panel_reset(panel_handle);
+    esp_lcd_panel_init(panel_handle);
+    esp_lcd_panel_invert_color(panel_handle, true);
+    esp_lcd_panel_swap_xy(panel_handle, true);
+    esp_lcd_panel_mirror(panel_handle, true, false);
+    esp_lcd_panel_disp_on_off(panel_handle, true);
+
+    st7789_set_backlight(true);
+
+    ESP_LOGI(TAG, "ST7789初始化成功");
+    ESP_LOGI(TAG, "分辨率: %dx%d, SPI时钟: %d MHz", LCD_H_RES, LCD_V_RES, LCD_PIXEL_CLOCK_HZ / 1000000);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 将一块RGB565数据通过DMA写入屏幕
+ */
+esp_err_t st7789_draw_bitmap(int x_start, int y_start, int x_end, int y_end, const void *color_data)
+{
+    if (panel_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (color_data == NULL || x_start >= x_end || y_start >= y_end) {
+        ESP_LOGE(TAG, "无效的参数: (%d,%d)-(%d,%d), data=%p", x_start, y_start, x_end, y_end, color_data);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    st7789_reap_flushes();
+
+    esp_err_t ret = st7789_ensure_cs();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = esp_lcd_panel_draw_bitmap(panel_handle, x_start, y_start, x_end, y_end, color_data);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "提交DMA传输失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    pending_flushes++;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief 等待之前提交的所有DMA传输完成
+ */
+esp_err_t st7789_wait_flush_done(uint32_t timeout_ms)
+{
+    return st7789_wait_flush_pending(0, timeout_ms);
+}
+
+/**
+ * @brief 等待直到未完成的DMA传输不超过指定数量
+ */
+esp_err_t st7789_wait_flush_pending(uint32_t max_pending, uint32_t timeout_ms)
+{
+    while (pending_flushes > max_pending) {
+        if (xSemaphoreTake(flush_done_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+            ESP_LOGW(TAG, "等待DMA传输完成超时, 剩余 %" PRIu32 " 个", pending_flushes);
+            return ESP_ERR_TIMEOUT;
+        }
+        pending_flushes--;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 回收已完成的DMA传输并返回仍未完成的数量
+ */
+uint32_t st7789_get_pending_flushes(void)
+{
+    st7789_reap_flushes();
+    return pending_flushes;
+}
+
+/**
+ * @brief 切换横屏/竖屏
+ */
+esp_err_t st7789_set_portrait(bool portrait)
+{
+    if (panel_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 横屏: 交换XY + X镜像 (即旋转90度); 竖屏: 面板原生方向
+    esp_err_t ret = st7789_wait_flush_done(LCD_FLUSH_TIMEOUT_MS);
+    if (ret == ESP_OK) {
+        ret = st7789_ensure_cs();
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = esp_lcd_panel_swap_xy(panel_handle, !portrait);
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_mirror(panel_handle, !portrait, false);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "切换屏幕方向失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "屏幕方向: %s", portrait ? "竖屏" : "横屏");
+    return ESP_OK;
+}
+
+/**
+ * @brief 定义垂直滚动区域
+ */
+esp_err_t st7789_scroll_define(uint16_t top_fixed, uint16_t scroll_lines, uint16_t bottom_fixed)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (top_fixed + scroll_lines + bottom_fixed != LCD_PORTRAIT_V_RES) {
+        ESP_LOGE(TAG, "滚动区域之和必须为%d: %u + %u + %u", LCD_PORTRAIT_V_RES, top_fixed, scroll_lines, bottom_fixed);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t params[6] = {
+        top_fixed >> 8, top_fixed & 0xFF,
+        scroll_lines >> 8, scroll_lines & 0xFF,
+        bottom_fixed >> 8, bottom_fixed & 0xFF,
+    };
+    esp_err_t ret = st7789_ensure_cs();
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_io_tx_param(io_handle, ST7789_CMD_VSCRDEF, params, sizeof(params));
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "设置滚动区域失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief 设置滚动起始地址
+ */
+esp_err_t st7789_scroll_to(uint16_t start_line)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = st7789_ensure_cs();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    uint8_t params[2] = {start_line >> 8, start_line & 0xFF};
+    return esp_lcd_panel_io_tx_param(io_handle, ST7789_CMD_VSCSAD, params, sizeof(params));
+}
+
+/**
+ * @brief 退出滚动模式
+ */
+esp_err_t st7789_scroll_disable(void)
+{
+    esp_err_t ret = st7789_scroll_to(0);
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_io_tx_param(io_handle, ST7789_CMD_NORON, NULL, 0);
+    }
+    return ret;
+}
+
+/**
+ * @brief 拉低片选
+ */
+esp_err_t st7789_bus_acquire(void)
+{
+    esp_err_t ret = pca9557_update_outputs(PCA9557_LCD_CS, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "拉低LCD片选失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    if (!cs_asserted) {
+        cs_asserted = true;
+        frame_stats.cs_toggles++;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 等待传输完成后释放片选
+ */
+esp_err_t st7789_bus_release(void)
+{
+    if (!cs_asserted) {
+        return ESP_OK;
+    }
+    // 片选释放后面板会丢弃未传完的数据
+    esp_err_t ret = st7789_wait_flush_done(LCD_FLUSH_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = pca9557_update_outputs(PCA9557_LCD_CS, PCA9557_LCD_CS);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "释放LCD片选失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    cs_asserted = false;
+    frame_stats.cs_toggles++;
+    return ESP_OK;
+}
+
+/**
+ * @brief 打开或关闭背光
+ */
+esp_err_t st7789_set_backlight(bool on)
+{
+    return gpio_set_level(LCD_PIN_BL, on ? LCD_BL_ON_LEVEL : !LCD_BL_ON_LEVEL);
+}
+
+/**
+ * @brief 启用或禁用TE帧同步模式
+ */
+esp_err_t st7789_te_enable(bool enable)
+{
+    gpio_num_t te_pin = LCD_PIN_TE;
+    if (te_pin == GPIO_NUM_NC) {
+        ESP_LOGW(TAG, "TE引脚未连接, 无法启用帧同步模式");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (enable == te_enabled) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = st7789_ensure_cs();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (enable) {
+        gpio_config_t te_conf = {
+            .pin_bit_mask = (1ULL << te_pin),
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_ENABLE,
+            .intr_type = GPIO_INTR_POSEDGE,
+        };
+        gpio_config(&te_conf);
+
+        // ISR服务可能已被其他驱动安装
+        ret = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+            ESP_LOGE(TAG, "安装GPIO中断服务失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        ret = gpio_isr_handler_add(te_pin, st7789_te_isr, NULL);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "注册TE中断失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+
+        // TEON参数0x00: 仅在垂直消隐期间输出TE
+        uint8_t te_mode = 0x00;
+        ret = esp_lcd_panel_io_tx_param(io_handle, ST7789_CMD_TEON, &te_mode, 1);
+    } else {
+        ret = esp_lcd_panel_io_tx_param(io_handle, ST7789_CMD_TEOFF, NULL, 0);
+        gpio_isr_handler_remove(te_pin);
+        gpio_set_intr_type(te_pin, GPIO_INTR_DISABLE);
+    }
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "发送TE命令失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    te_enabled = enable;
+    te_last_us = 0;
+    frame_begin_us = 0;
+    ESP_LOGI(TAG, "TE帧同步模式已%s (GPIO %d)", enable ? "启用" : "禁用", te_pin);
+    return ESP_OK;
+}
+
+/**
+ * @brief TE帧同步模式是否已启用
+ */
+bool st7789_te_is_enabled(void)
+{
+    return te_enabled;
+}
+
+/**
+ * @brief 开始一帧: 等待下一个TE脉冲
+ */
+esp_err_t st7789_frame_begin(uint32_t timeout_ms)
+{
+    if (te_enabled) {
+        // 上一帧的数据必须在面板扫描到之前全部送出
+        esp_err_t ret = st7789_wait_flush_done(timeout_ms);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+
+        // 丢弃渲染期间已经过去的TE脉冲, 只在新的消隐期开始传输
+        xSemaphoreTake(te_sem, 0);
+        if (xSemaphoreTake(te_sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+            ESP_LOGW(TAG, "等待TE脉冲超时");
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    int64_t now = esp_timer_get_time();
+    uint32_t pulses = te_pulse_count;
+    uint32_t i2c_writes = st7789_i2c_writes();
+
+    if (frame_begin_us != 0) {
+        // 两次frame_begin之间PCA9557的寄存器写入都算在上一帧
+        uint32_t writes = i2c_writes - frame_begin_i2c_writes;
+        frame_stats.last_frame_i2c_writes = writes;
+        frame_stats.i2c_writes += writes;
+        if (writes > frame_stats.max_frame_i2c_writes) {
+            frame_stats.max_frame_i2c_writes = writes;
+        }
+
+        uint32_t frame_us = (uint32_t)(now - frame_begin_us);
+        frame_stats.last_frame_us = frame_us;
+        frame_stats.avg_frame_us = (frame_stats.avg_frame_us == 0) ? frame_us :
+                                   frame_stats.avg_frame_us - (frame_stats.avg_frame_us >> 4) + (frame_us >> 4);
+        if (frame_us > frame_stats.max_frame_us) {
+            frame_stats.max_frame_us = frame_us;
+        }
+
+        // 两帧之间每多经过一个刷新周期, 就有一次面板刷新没有拿到新帧
+        if (te_enabled) {
+            uint32_t elapsed = pulses - frame_begin_pulse;
+            if (elapsed > 1) {
+                frame_stats.missed_deadlines += elapsed - 1;
+            }
+        } else if (frame_us > te_period_us) {
+            frame_stats.missed_deadlines += frame_us / te_period_us - 1 + (frame_us % te_period_us != 0);
+        }
+    }
+
+    frame_begin_us = now;
+    frame_begin_pulse = pulses;
+    frame_begin_i2c_writes = i2c_writes;
+    return ESP_OK;
+}
+
+/**
+ * @brief 结束一帧
+ */
+void st7789_frame_end(void)
+{
+    frame_stats.frames++;
+    if (frame_begin_us != 0) {
+        uint32_t busy_us = (uint32_t)(esp_timer_get_time() - frame_begin_us);
+        frame_stats.last_busy_us = busy_us;
+        if (busy_us > frame_stats.max_busy_us) {
+            frame_stats.max_busy_us = busy_us;
+        }
+    }
+}
+
+/**
+ * @brief 获取帧时间统计
+ */
+esp_err_t st7789_get_frame_stats(st7789_frame_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = frame_stats;
+    stats->te_pulses = te_pulse_count;
+    stats->te_period_us = te_period_us;
+    return ESP_OK;
+}
+
+/**
+ * @brief 清零帧时间统计
+ */
+void st7789_reset_frame_stats(void)
+{
+    uint32_t cs_toggles = frame_stats.cs_toggles;
+    frame_stats = (st7789_frame_stats_t){0};
+    frame_stats.cs_toggles = cs_toggles;
+    frame_begin_us = 0;
+}
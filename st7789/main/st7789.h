@@ -0,0 +1,213 @@
+/*
+ * ST7789 LCD驱动头文件
+ * 320x240 RGB565, SPI接口, 片选由PCA9557 IO0控制
+ */
+
+#ifndef ST7789_H
+#define ST7789_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LCD SPI配置
+#define LCD_HOST                    SPI3_HOST               // SPI主机
+#define LCD_PIXEL_CLOCK_HZ          (80 * 1000 * 1000)      // SPI时钟 80MHz
+#define LCD_CMD_BITS                8                       // 命令位宽
+#define LCD_PARAM_BITS              8                       // 参数位宽
+#define LCD_TRANS_QUEUE_DEPTH       10                      // SPI传输队列深度
+
+// LCD引脚定义
+#define LCD_PIN_MOSI                GPIO_NUM_40             // MOSI引脚
+#define LCD_PIN_SCLK                GPIO_NUM_41             // SCLK引脚
+#define LCD_PIN_DC                  GPIO_NUM_39             // 数据/命令引脚
+#define LCD_PIN_RST                 GPIO_NUM_NC             // 复位引脚 (未连接)
+#define LCD_PIN_BL                  GPIO_NUM_42             // 背光引脚
+#define LCD_PIN_TE                  GPIO_NUM_NC             // TE撕裂效应信号引脚 (未连接时为GPIO_NUM_NC)
+
+// LCD分辨率
+#define LCD_H_RES                   320                     // 水平分辨率
+#define LCD_V_RES                   240                     // 垂直分辨率
+#define LCD_BITS_PER_PIXEL          16                      // RGB565
+
+// 帧同步配置
+#define LCD_REFRESH_HZ              60                      // 面板标称刷新率 (TE未连接时使用)
+#define LCD_MAX_TRANSFER_LINES      40                      // 单次DMA最大传输行数
+#define LCD_FLUSH_TIMEOUT_MS        1000                    // 驱动内部等待DMA超时时间
+
+// 竖屏 (面板原生方向) 分辨率, 硬件垂直滚动沿竖屏的垂直方向进行
+#define LCD_PORTRAIT_H_RES          LCD_V_RES               // 竖屏水平分辨率
+#define LCD_PORTRAIT_V_RES          LCD_H_RES               // 竖屏垂直分辨率 (显存行数)
+
+// ST7789命令
+#define ST7789_CMD_NORON            0x13                    // 普通显示模式 (退出滚动模式)
+#define ST7789_CMD_VSCRDEF          0x33                    // 垂直滚动区域定义
+#define ST7789_CMD_TEOFF            0x34                    // 关闭TE输出
+#define ST7789_CMD_TEON             0x35                    // 开启TE输出
+#define ST7789_CMD_VSCSAD           0x37                    // 垂直滚动起始地址
+
+/**
+ * @brief 帧时间统计
+ */
+typedef struct {
+    uint32_t frames;                // 已提交的帧数
+    uint32_t missed_deadlines;      // 错过的刷新周期数 (渲染+传输超过一个刷新周期)
+    uint32_t te_pulses;             // 收到的TE脉冲数
+    uint32_t last_frame_us;         // 上一帧间隔 (微秒)
+    uint32_t avg_frame_us;          // 平均帧间隔 (微秒, 滑动平均)
+    uint32_t max_frame_us;          // 最大帧间隔 (微秒)
+    uint32_t last_busy_us;          // 上一帧从frame_begin返回到frame_end的耗时 (渲染+提交, 不含等待TE)
+    uint32_t max_busy_us;           // 最大单帧耗时 (微秒)
+    uint32_t te_period_us;          // 实测TE周期 (微秒)
+    uint32_t i2c_writes;            // 各帧期间PCA9557的I2C写入总数
+    uint32_t last_frame_i2c_writes; // 上一帧期间的I2C写入次数 (片选保持时应为0)
+    uint32_t max_frame_i2c_writes;  // 单帧最多I2C写入次数
+    uint32_t cs_toggles;            // 片选拉低/释放次数 (启动以来, 清零统计时保留)
+} st7789_frame_stats_t;
+
+/**
+ * @brief 初始化ST7789 (SPI总线、面板、背光)
+ * @note 调用前需要先初始化I2C和PCA9557, 并把LCD片选配置为输出; 初始化时拉低片选并一直保持
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_init(void);
+
+/**
+ * @brief 将一块RGB565数据通过DMA写入屏幕 (异步)
+ * @param x_start 起始列 (包含)
+ * @param y_start 起始行 (包含)
+ * @param x_end 结束列 (不包含)
+ * @param y_end 结束行 (不包含)
+ * @param color_data 像素数据, 必须位于DMA可访问内存
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_draw_bitmap(int x_start, int y_start, int x_end, int y_end, const void *color_data);
+
+/**
+ * @brief 等待之前提交的所有DMA传输完成
+ * @param timeout_ms 超时时间(毫秒)
+ * @return ESP_OK 完成, ESP_ERR_TIMEOUT 超时
+ */
+esp_err_t st7789_wait_flush_done(uint32_t timeout_ms);
+
+/**
+ * @brief 等待直到未完成的DMA传输不超过指定数量
+ * @note DMA传输按提交顺序完成, 双缓冲时传入1即可保证较早提交的缓冲区已空闲
+ * @param max_pending 允许保留的未完成传输数
+ * @param timeout_ms 超时时间(毫秒)
+ * @return ESP_OK 完成, ESP_ERR_TIMEOUT 超时
+ */
+esp_err_t st7789_wait_flush_pending(uint32_t max_pending, uint32_t timeout_ms);
+
+/**
+ * @brief 回收已完成的DMA传输并返回仍未完成的数量 (非阻塞)
+ * @return 未完成的DMA传输数
+ */
+uint32_t st7789_get_pending_flushes(void);
+
+/**
+ * @brief 切换横屏/竖屏
+ * @note 横屏 (默认) 为LCD_H_RES x LCD_V_RES; 竖屏为面板原生方向LCD_PORTRAIT_H_RES x LCD_PORTRAIT_V_RES,
+ *       硬件垂直滚动只在竖屏下表现为上下滚动。切换后原有显示内容不会重新排列
+ * @param portrait true切换到竖屏, false切换到横屏
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t st7789_set_portrait(bool portrait);
+
+/**
+ * @brief 定义垂直滚动区域 (VSCRDEF) 并进入滚动模式
+ * @note 三个区域按显存行计算, 之和必须等于LCD_PORTRAIT_V_RES
+ * @param top_fixed 顶部固定区行数
+ * @param scroll_lines 滚动区行数
+ * @param bottom_fixed 底部固定区行数
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 区域之和不正确
+ */
+esp_err_t st7789_scroll_define(uint16_t top_fixed, uint16_t scroll_lines, uint16_t bottom_fixed);
+
+/**
+ * @brief 设置滚动起始地址 (VSCSAD): 滚动区第一行显示的显存行
+ * @param start_line 显存行号, 范围[top_fixed, top_fixed + scroll_lines)
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_scroll_to(uint16_t start_line);
+
+/**
+ * @brief 退出滚动模式 (滚动起始地址归零并发送NORON)
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_scroll_disable(void);
+
+/**
+ * @brief 拉低LCD片选 (经PCA9557, 已拉低时不访问I2C)
+ * @note 初始化时已调用; 释放后下一次绘制或发送命令时也会自动拉低
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_bus_acquire(void);
+
+/**
+ * @brief 等待DMA传输完成后释放LCD片选
+ * @note 只在进入睡眠或与其他设备共享总线前调用, 连续刷新期间片选一直保持拉低
+ * @return ESP_OK 成功, ESP_ERR_TIMEOUT 等待传输超时, 其他值表示错误
+ */
+esp_err_t st7789_bus_release(void);
+
+/**
+ * @brief 打开或关闭背光
+ * @param on true 打开, false 关闭
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_set_backlight(bool on);
+
+/**
+ * @brief 启用或禁用TE帧同步模式
+ * @note 启用后面板在每次垂直消隐时输出TE脉冲, 帧提交会与面板扫描同步;
+ *       LCD_PIN_TE未连接时返回ESP_ERR_NOT_SUPPORTED
+ * @param enable true 启用, false 禁用
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t st7789_te_enable(bool enable);
+
+/**
+ * @brief TE帧同步模式是否已启用
+ * @return true 已启用, false 未启用
+ */
+bool st7789_te_is_enabled(void);
+
+/**
+ * @brief 开始一帧: 等待下一个TE脉冲 (即面板进入垂直消隐)
+ * @note 渲染循环每帧调用一次, 在提交本帧DMA传输之前调用, 把渲染速率限制在面板刷新率;
+ *       TE未启用时立即返回, 仅更新统计
+ * @param timeout_ms 超时时间(毫秒)
+ * @return ESP_OK 成功, ESP_ERR_TIMEOUT 超时未收到TE脉冲
+ */
+esp_err_t st7789_frame_begin(uint32_t timeout_ms);
+
+/**
+ * @brief 结束一帧: 帧数加一, 记录本帧从frame_begin返回到现在的耗时
+ * @note 在本帧最后一次st7789_draw_bitmap之后调用; 帧间隔和错过刷新周期的统计在下一次frame_begin中更新
+ */
+void st7789_frame_end(void);
+
+/**
+ * @brief 获取帧时间统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t st7789_get_frame_stats(st7789_frame_stats_t *stats);
+
+/**
+ * @brief 清零帧时间统计
+ */
+void st7789_reset_frame_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ST7789_H
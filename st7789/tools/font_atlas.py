@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+# 字体图集生成工具
+#
+# 从TTF/OTF字体中只栅格化工程实际用到的字符 (ASCII + 源码字符串里出现的中文等),
+# 生成4bpp RLE压缩的字体图集, 烧录到 "font" 分区后由 font_atlas.c 通过 esp_partition_mmap 读取。
+#
+# 用法:
+#   python font_atlas.py --font NotoSansSC-Regular.otf --size 16 --src ../main --out font_atlas.bin
+#
+# 依赖: Pillow (pip install pillow)
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# 与 font_atlas.h 保持一致
+FONT_ATLAS_MAGIC = 0x41544E46  # 'FNTA'
+FONT_ATLAS_VERSION = 1
+HEADER_FMT = '<IHBBhhHHIIIII'  # font_atlas_header_t, 36字节
+GLYPH_FMT = '<IIHBBbbBB'       # font_atlas_glyph_t, 16字节
+KERN_FMT = '<HHhH'             # font_atlas_kern_t, 8字节
+
+# 只对这个范围以内的字符对计算字距 (CJK字体基本不做字距调整, 全部计算太慢)
+KERN_MAX_CODEPOINT = 0x3000
+
+SOURCE_EXTS = ('.c', '.h', '.cpp')
+STRING_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+
+
+def collect_chars(src_paths, extra_chars, charset_files):
+    """收集字符集: 可打印ASCII + 源码字符串中的非ASCII字符 + 额外指定的字符"""
+    chars = set(chr(c) for c in range(0x20, 0x7F))
+
+    for path in src_paths:
+        files = []
+        if os.path.isdir(path):
+            for root, _, names in os.walk(path):
+                files.extend(os.path.join(root, n) for n in names if n.endswith(SOURCE_EXTS))
+        else:
+            files.append(path)
+        for name in files:
+            with open(name, encoding='utf-8', errors='ignore') as f:
+                for literal in STRING_RE.findall(f.read()):
+                    chars.update(ch for ch in literal if ord(ch) > 0x7E)
+
+    chars.update(extra_chars)
+    for name in charset_files:
+        with open(name, encoding='utf-8') as f:
+            chars.update(ch for ch in f.read() if ch.isprintable())
+
+    return sorted(chars, key=ord)
+
+
+def quantize_4bpp(alpha):
+    """8位灰度量化为4位, 解码端用 v * 17 还原"""
+    return min(15, (alpha + 8) // 17)
+
+
+def rle_encode(values):
+    """4bpp RLE: 每个字节高4位为灰度值, 低4位为 (重复次数 - 1), 一次最多16个"""
+    out = bytearray()
+    i = 0
+    while i < len(values):
+        v = values[i]
+        run = 1
+        while i + run < len(values) and values[i + run] == v and run < 16:
+            run += 1
+        out.append((v << 4) | (run - 1))
+        i += run
+    return bytes(out)
+
+
+def rle_decode(data, count):
+    """RLE解码, 用于生成后自检"""
+    out = []
+    for b in data:
+        out.extend([b >> 4] * ((b & 0x0F) + 1))
+    if len(out) != count:
+        raise ValueError('RLE长度不一致: %d != %d' % (len(out), count))
+    return out
+
+
+def rasterize(font_path, size, chars):
+    """用Pillow栅格化每个字符, 返回 (ascent, descent, glyphs, kerns)"""
+    from PIL import Image, ImageDraw, ImageFont
+
+    font = ImageFont.truetype(font_path, size)
+    ascent, descent = font.getmetrics()
+    glyphs = []
+
+    for ch in chars:
+        x0, y0, x1, y1 = font.getbbox(ch, anchor='ls')
+        w, h = max(0, x1 - x0), max(0, y1 - y0)
+        pixels = []
+        if w > 0 and h > 0:
+            img = Image.new('L', (w, h), 0)
+            ImageDraw.Draw(img).text((-x0, -y0), ch, font=font, fill=255, anchor='ls')
+            pixels = [quantize_4bpp(p) for p in img.getdata()]
+        glyphs.append({
+            'codepoint': ord(ch),
+            'width': w,
+            'height': h,
+            'x_offset': x0,
+            'y_offset': -y0,
+            'advance': int(round(font.getlength(ch))),
+            'pixels': pixels,
+        })
+
+    # 字距: 成对排版宽度与单独宽度之和的差
+    kern_chars = [ch for ch in chars if ord(ch) < KERN_MAX_CODEPOINT]
+    widths = {ch: font.getlength(ch) for ch in kern_chars}
+    kerns = []
+    for left in kern_chars:
+        for right in kern_chars:
+            adjust = int(round(font.getlength(left + right) - widths[left] - widths[right]))
+            if adjust != 0:
+                kerns.append((ord(left), ord(right), adjust))
+
+    return ascent, descent, glyphs, kerns
+
+
+def pack_atlas(size, ascent, descent, glyphs, kerns):
+    """按 font_atlas.h 的格式打包"""
+    header_size = struct.calcsize(HEADER_FMT)
+    glyph_size = struct.calcsize(GLYPH_FMT)
+    kern_size = struct.calcsize(KERN_FMT)
+
+    glyphs = sorted(glyphs, key=lambda g: g['codepoint'])
+    kerns = sorted(kerns)
+
+    glyph_table_offset = header_size
+    kern_table_offset = glyph_table_offset + glyph_size * len(glyphs)
+    bitmap_offset = kern_table_offset + kern_size * len(kerns)
+
+    glyph_table = bytearray()
+    bitmaps = bytearray()
+    for g in glyphs:
+        for key, lo, hi in (('width', 0, 255), ('height', 0, 255), ('x_offset', -128, 127),
+                            ('y_offset', -128, 127), ('advance', 0, 255)):
+            if not lo <= g[key] <= hi:
+                raise ValueError('U+%04X 的 %s 超出范围: %d' % (g['codepoint'], key, g[key]))
+        data = rle_encode(g['pixels'])
+        rle_decode(data, g['width'] * g['height'])
+        glyph_table += struct.pack(GLYPH_FMT, g['codepoint'], len(bitmaps), len(data),
+                                   g['width'], g['height'], g['x_offset'], g['y_offset'], g['advance'], 0)
+        bitmaps += data
+
+    kern_table = bytearray()
+    for left, right, adjust in kerns:
+        kern_table += struct.pack(KERN_FMT, left, right, adjust, 0)
+
+    total_size = bitmap_offset + len(bitmaps)
+    header = struct.pack(HEADER_FMT, FONT_ATLAS_MAGIC, FONT_ATLAS_VERSION, size, 4,
+                         ascent, descent, ascent + descent, len(kerns), len(glyphs),
+                         glyph_table_offset, kern_table_offset, bitmap_offset, total_size)
+    return header + glyph_table + kern_table + bitmaps
+
+
+def main():
+    parser = argparse.ArgumentParser(description='生成4bpp RLE字体图集')
+    parser.add_argument('--font', required=True, help='TTF/OTF字体文件')
+    parser.add_argument('--size', type=int, default=16, help='字号 (像素)')
+    parser.add_argument('--src', action='append', default=[], help='扫描字符串字面量的源码文件或目录, 可多次指定')
+    parser.add_argument('--chars', default='', help='额外包含的字符')
+    parser.add_argument('--charset', action='append', default=[], help='额外包含的字符集文本文件')
+    parser.add_argument('--max-size', type=lambda s: int(s, 0), default=0, help='分区大小, 超出时报错')
+    parser.add_argument('--out', required=True, help='输出文件')
+    args = parser.parse_args()
+
+    chars = collect_chars(args.src, args.chars, args.charset)
+    ascent, descent, glyphs, kerns = rasterize(args.font, args.size, chars)
+    atlas = pack_atlas(args.size, ascent, descent, glyphs, kerns)
+
+    if args.max_size and len(atlas) > args.max_size:
+        sys.exit('字体图集 %d 字节, 超出分区大小 %d 字节' % (len(atlas), args.max_size))
+
+    with open(args.out, 'wb') as f:
+        f.write(atlas)
+
+    raw = sum(g['width'] * g['height'] for g in glyphs) // 2
+    cjk = sum(1 for ch in chars if ord(ch) >= 0x2E80)
+    print('字体图集: %d 个字形 (CJK %d 个), %d 个字距对, %d 字节 (未压缩4bpp位图 %d 字节)'
+          % (len(glyphs), cjk, len(kerns), len(atlas), raw))
+
+
+if __name__ == '__main__':
+    main()
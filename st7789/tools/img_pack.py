@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+# 图片资源打包工具
+#
+# 把PNG图片打包成压缩图片资源包, 烧录到 "img" 分区后由 img_asset.c 通过 esp_partition_mmap 读取。
+# 每张图片选择RLE565或PAL8 (不超过256色时) 中较小的格式, 带透明通道的图片额外生成8位透明度平面。
+#
+# 用法:
+#   python img_pack.py --out img_assets.bin ../assets/*.png
+#   python img_pack.py --with-raw --out img_assets.bin ../assets   # 附带未压缩对照, 用于基准测试
+#
+# 依赖: Pillow (pip install pillow)
+
+import argparse
+import os
+import struct
+import sys
+
+# 与 img_asset.h 保持一致
+IMG_ASSET_MAGIC = 0x50474D49  # 'IMGP'
+IMG_ASSET_VERSION = 1
+IMG_ASSET_NAME_LEN = 16
+IMG_ASSET_MAX_WIDTH = 320
+IMG_ASSET_FLAG_ALPHA = 0x01
+IMG_ASSET_RAW_SUFFIX = '.raw'
+HEADER_FMT = '<IHHII'              # img_asset_pack_header_t, 16字节
+ENTRY_FMT = '<16sHHBBHIIIIIII'     # img_asset_t, 52字节
+
+FMT_RAW565 = 0
+FMT_RLE565 = 1
+FMT_PAL8 = 2
+FORMAT_NAMES = {'raw': FMT_RAW565, 'rle': FMT_RLE565, 'pal': FMT_PAL8}
+
+DATA_ALIGN = 16                    # 数据区对齐, 未压缩数据可以直接走PIE复制
+
+
+def rgb565_bytes(r, g, b):
+    """RGB565, LCD字节序 (高字节在前)"""
+    v = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+    return bytes(((v >> 8) & 0xFF, v & 0xFF))
+
+
+def packbits(elems, elem_size):
+    """PackBits编码一行: 控制字节最高位为1表示重复, 为0表示原样, 低7位为 (个数 - 1)"""
+    out = bytearray()
+    i = 0
+    n = len(elems)
+    while i < n:
+        run = 1
+        while i + run < n and run < 128 and elems[i + run] == elems[i]:
+            run += 1
+        if run >= 2:
+            out.append(0x80 | (run - 1))
+            out += elems[i]
+            i += run
+            continue
+        # 原样段: 直到出现长度>=2的重复或满128个
+        start = i
+        while i < n and i - start < 128:
+            if i + 1 < n and elems[i + 1] == elems[i]:
+                break
+            i += 1
+        out.append(i - start - 1)
+        for e in elems[start:i]:
+            out += e
+    return bytes(out)
+
+
+def unpackbits(data, count, elem_size):
+    """PackBits解码, 用于打包后自检"""
+    out = []
+    i = 0
+    while len(out) < count:
+        c = data[i]
+        i += 1
+        n = (c & 0x7F) + 1
+        if c & 0x80:
+            out.extend([data[i:i + elem_size]] * n)
+            i += elem_size
+        else:
+            out.extend(data[i + k * elem_size:i + (k + 1) * elem_size] for k in range(n))
+            i += n * elem_size
+    if len(out) != count or i != len(data):
+        raise ValueError('PackBits长度不一致')
+    return out
+
+
+def encode_rows(rows, elem_size):
+    """逐行PackBits编码, 返回 (行偏移表, 数据)"""
+    offsets = []
+    data = bytearray()
+    for row in rows:
+        offsets.append(len(data))
+        encoded = packbits(row, elem_size)
+        if unpackbits(encoded, len(row), elem_size) != list(row):
+            raise ValueError('PackBits自检失败')
+        data += encoded
+    return struct.pack('<%dI' % len(offsets), *offsets), bytes(data)
+
+
+def load_image(path):
+    """读取图片, 返回 (宽, 高, 像素行, 透明度行或None)"""
+    from PIL import Image
+
+    img = Image.open(path)
+    has_alpha = img.mode in ('RGBA', 'LA', 'PA') or (img.mode == 'P' and 'transparency' in img.info)
+    img = img.convert('RGBA')
+    w, h = img.size
+    if w > IMG_ASSET_MAX_WIDTH:
+        raise ValueError('%s 宽度 %d 超过 %d' % (path, w, IMG_ASSET_MAX_WIDTH))
+
+    data = list(img.getdata())
+    pixel_rows = [[rgb565_bytes(*data[y * w + x][:3]) for x in range(w)] for y in range(h)]
+    alpha_rows = None
+    if has_alpha:
+        alpha_rows = [[bytes((data[y * w + x][3],)) for x in range(w)] for y in range(h)]
+        if all(a == b'\xff' for row in alpha_rows for a in row):
+            alpha_rows = None
+    return w, h, pixel_rows, alpha_rows
+
+
+def encode_image(pixel_rows, fmt):
+    """编码像素数据, 返回 (格式, 调色板, 行偏移表, 数据); 不适用时返回None"""
+    if fmt == FMT_RAW565:
+        return FMT_RAW565, b'', b'', b''.join(b''.join(row) for row in pixel_rows)
+    if fmt == FMT_RLE565:
+        rows, data = encode_rows(pixel_rows, 2)
+        return FMT_RLE565, b'', rows, data
+    colors = sorted(set(p for row in pixel_rows for p in row))
+    if len(colors) > 256:
+        return None
+    index = {c: bytes((i,)) for i, c in enumerate(colors)}
+    rows, data = encode_rows([[index[p] for p in row] for row in pixel_rows], 1)
+    return FMT_PAL8, b''.join(colors), rows, data
+
+
+class Packer:
+    """按4字节 (数据区16字节) 对齐追加数据, 记录偏移"""
+
+    def __init__(self, start):
+        self.blob = bytearray()
+        self.start = start
+
+    def add(self, data, align=4):
+        if not data:
+            return 0
+        while (self.start + len(self.blob)) % align:
+            self.blob.append(0)
+        offset = self.start + len(self.blob)
+        self.blob += data
+        return offset
+
+
+def pack_assets(images, fmt_name, with_raw):
+    """images: [(name, w, h, pixel_rows, alpha_rows)], 返回资源包和每个资源的说明"""
+    entries = []
+    for name, w, h, pixel_rows, alpha_rows in images:
+        if fmt_name == 'auto':
+            candidates = [encode_image(pixel_rows, FMT_RLE565), encode_image(pixel_rows, FMT_PAL8)]
+            candidates = [c for c in candidates if c is not None]
+            encoded = min(candidates, key=lambda c: len(c[1]) + len(c[2]) + len(c[3]))
+        else:
+            encoded = encode_image(pixel_rows, FORMAT_NAMES[fmt_name])
+            if encoded is None:
+                raise ValueError('%s 超过256色, 不能使用调色板格式' % name)
+        alpha = encode_rows(alpha_rows, 1) if alpha_rows else None
+        entries.append((name, w, h, encoded, alpha))
+        if with_raw:
+            raw_alpha = (b'', b''.join(b''.join(row) for row in alpha_rows)) if alpha_rows else None
+            entries.append((name + IMG_ASSET_RAW_SUFFIX, w, h, encode_image(pixel_rows, FMT_RAW565), raw_alpha))
+
+    header_size = struct.calcsize(HEADER_FMT)
+    entry_size = struct.calcsize(ENTRY_FMT)
+    table_offset = header_size
+    packer = Packer(table_offset + entry_size * len(entries))
+    table = bytearray()
+    report = []
+
+    for name, w, h, (fmt, palette, rows, data), alpha in entries:
+        encoded_name = name.encode('utf-8')
+        if len(encoded_name) >= IMG_ASSET_NAME_LEN:
+            raise ValueError('资源名 "%s" 超过 %d 字节' % (name, IMG_ASSET_NAME_LEN - 1))
+        palette_offset = packer.add(palette)
+        rows_offset = packer.add(rows)
+        data_offset = packer.add(data, DATA_ALIGN)
+        data_size = len(palette) + len(rows) + len(data)
+        flags = 0
+        alpha_rows_offset = alpha_offset = alpha_size = 0
+        if alpha:
+            flags |= IMG_ASSET_FLAG_ALPHA
+            alpha_rows_offset = packer.add(alpha[0])
+            alpha_offset = packer.add(alpha[1], DATA_ALIGN)
+            alpha_size = len(alpha[0]) + len(alpha[1])
+        table += struct.pack(ENTRY_FMT, encoded_name, w, h, fmt, flags, len(palette) // 2,
+                             palette_offset, rows_offset, data_offset, data_size,
+                             alpha_rows_offset, alpha_offset, alpha_size)
+        report.append((name, w, h, fmt, data_size + alpha_size, w * h * (3 if alpha else 2)))
+
+    total_size = table_offset + len(table) + len(packer.blob)
+    header = struct.pack(HEADER_FMT, IMG_ASSET_MAGIC, IMG_ASSET_VERSION, len(entries), table_offset, total_size)
+    return header + table + packer.blob, report
+
+
+def collect_files(paths):
+    files = []
+    for path in paths:
+        if os.path.isdir(path):
+            files.extend(os.path.join(path, n) for n in sorted(os.listdir(path)) if n.lower().endswith('.png'))
+        else:
+            files.append(path)
+    return files
+
+
+def main():
+    parser = argparse.ArgumentParser(description='打包压缩图片资源')
+    parser.add_argument('inputs', nargs='+', help='PNG文件或目录')
+    parser.add_argument('--format', choices=('auto', 'rle', 'pal', 'raw'), default='auto', help='像素格式')
+    parser.add_argument('--with-raw', action='store_true', help='为每张图片附带".raw"未压缩对照, 用于基准测试')
+    parser.add_argument('--max-size', type=lambda s: int(s, 0), default=0, help='分区大小, 超出时报错')
+    parser.add_argument('--out', required=True, help='输出文件')
+    args = parser.parse_args()
+
+    images = []
+    for path in collect_files(args.inputs):
+        name = os.path.splitext(os.path.basename(path))[0]
+        images.append((name,) + load_image(path))
+
+    blob, report = pack_assets(images, args.format, args.with_raw)
+    if args.max_size and len(blob) > args.max_size:
+        sys.exit('图片资源包 %d 字节, 超出分区大小 %d 字节' % (len(blob), args.max_size))
+
+    with open(args.out, 'wb') as f:
+        f.write(blob)
+
+    names = {v: k for k, v in FORMAT_NAMES.items()}
+    for name, w, h, fmt, size, raw in report:
+        print('  %-15s %3dx%-3d %-3s %7d 字节 (%d%%)' % (name, w, h, names[fmt], size, size * 100 // raw))
+    print('图片资源包: %d 个资源, %d 字节' % (len(report), len(blob)))
+
+
+if __name__ == '__main__':
+    main()
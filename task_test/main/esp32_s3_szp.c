@@ -1,4 +1,10 @@
 #include "esp32_s3_szp.h"
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "driver/rtc_io.h"
 
 static const char *TAG = "esp32_s3_szp";
 
@@ -25,9 +31,56 @@ esp_err_t bsp_i2c_init(void)
 /*******************************************************************************/
 /***************************  姿态传感器 QMI8658 ↓   ****************************/
 
+#define QMI8658_CHIP_ID     0x05         // WHO_AM_I的值
+#define QMI8658_RTC_MAGIC   0x514D4931   // "QMI1"
+#define QMI8658_CTRL_NUM    (QMI8658_CTRL7 - QMI8658_CTRL1 + 1)
+
+// CTRL9命令, 用STATUSINT的bit7握手 (CTRL8 bit7=1)
+#define QMI8658_CMD_ACK             0x00
+#define QMI8658_CMD_RST_FIFO        0x04
+#define QMI8658_CMD_REQ_FIFO        0x05  // 进入FIFO读模式, 之后连续读FIFO_DATA
+#define QMI8658_CMD_WRITE_WOM       0x08  // 用CAL1_L/CAL1_H写入运动唤醒设置, 阈值为0时关闭
+#define QMI8658_CMD_DONE            0x80  // STATUSINT中的命令完成位
+#define QMI8658_CMD_POLLS           100   // 等待命令完成的最多读取次数 (100kHz下约20ms)
+
+#define QMI8658_CTRL1_INT1_EN       0x08
+#define QMI8658_FIFO_RD_MODE        0x80  // FIFO_CTRL中的读模式位, 读完写0退出
+#define QMI8658_FIFO_STREAM_128     0x0E  // FIFO 128样本, 流模式 (满了丢弃最旧的)
+#define QMI8658_FIFO_MODE_128       0x0D  // FIFO 128样本, FIFO模式 (满了停止写入, 不会打乱顺序)
+#define QMI8658_FIFO_FULL           0x80  // FIFO_STATUS中的满标志
+
+// 运动唤醒: 只开加速度计, 低功耗128Hz, FIFO里保留最近1秒
+#define QMI8658_WOM_CTRL2           0x1C  // ACC 4g 低功耗128Hz
+#define QMI8658_WOM_PERIOD_US       7813
+#define QMI8658_WOM_CAL1_H          0x04  // bit7:6=00 使用INT1, 初始低电平; bit5:0 开启后忽略的样本数
+
+// 深度睡眠期间QMI8658一直供电, 配置不变; 保存配置和零偏, 唤醒复位后校验一致就不用重新初始化
+typedef struct {
+    uint32_t magic;
+    uint8_t ctrl[QMI8658_CTRL_NUM];  // CTRL1 ~ CTRL7
+    int16_t gyr_bias[3];             // 陀螺仪零偏
+    bool bias_valid;
+    bool wom_armed;                  // 睡眠前进入了运动唤醒模式, 唤醒后要取出FIFO并恢复正常配置
+} qmi8658_rtc_state_t;
+
+static RTC_DATA_ATTR qmi8658_rtc_state_t qmi8658_rtc;
+static int16_t gyr_bias[3];          // 陀螺仪零偏, 读数时减去
+static bool gyr_bias_valid = false;
+static bool qmi8658_restored = false;
+static bool wom_armed = false;
+static qmi8658_sample_cb_t sample_cb = NULL;
+static int16_t fifo_buf[QMI8658_FIFO_MAX_SAMPLES * 6];  // FIFO一次全部读出, 每个6轴样本12字节
+static t_sQMI8658_sample fifo_samples[QMI8658_FIFO_MAX_SAMPLES];
+static uint8_t fifo_watermark = 0;   // 0表示没有使用FIFO批量采样
+static int64_t fifo_last_read_us = 0;
+static uint32_t bus_transactions = 0;  // 所有QMI8658寄存器读写次数
+static uint32_t fifo_start_transactions = 0;
+static t_sQMI8658_fifo_stats fifo_stats;
+
 // 读取QMI8658寄存器的值
 esp_err_t qmi8658_register_read(uint8_t reg_addr, uint8_t *data, size_t len)
 {
+    bus_transactions++;
     return i2c_master_write_read_device(BSP_I2C_NUM, QMI8658_SENSOR_ADDR,  &reg_addr, 1, data, len, 1000 / portTICK_PERIOD_MS);
 }
 
@@ -36,16 +89,135 @@ esp_err_t qmi8658_register_write_byte(uint8_t reg_addr, uint8_t data)
 {
     uint8_t write_buf[2] = {reg_addr, data};
 
+    bus_transactions++;
     return i2c_master_write_to_device(BSP_I2C_NUM, QMI8658_SENSOR_ADDR, write_buf, sizeof(write_buf), 1000 / portTICK_PERIOD_MS);
 }
 
+// 深度睡眠唤醒时从RTC内存恢复: 一次连续读取WHO_AM_I到CTRL7, 芯片ID和配置都与保存的一致才有效
+// 芯片被复位过时CTRL1的地址自增位为0, 连续读取得不到正确的配置, 校验也会失败
+static bool qmi8658_restore_state(void)
+{
+    uint8_t regs[QMI8658_CTRL7 + 1];
+
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP || qmi8658_rtc.magic != QMI8658_RTC_MAGIC)
+        return false;
+    if (qmi8658_register_read(QMI8658_WHO_AM_I, regs, sizeof(regs)) != ESP_OK)
+        return false;
+    if (regs[QMI8658_WHO_AM_I] != QMI8658_CHIP_ID || memcmp(&regs[QMI8658_CTRL1], qmi8658_rtc.ctrl, QMI8658_CTRL_NUM) != 0)
+        return false;
+
+    memcpy(gyr_bias, qmi8658_rtc.gyr_bias, sizeof(gyr_bias));
+    gyr_bias_valid = qmi8658_rtc.bias_valid;
+    wom_armed = qmi8658_rtc.wom_armed;
+    return true;
+}
+
+// 正常的6轴采样配置, 初始化和运动唤醒之后都用它
+static void qmi8658_apply_config(void)
+{
+    qmi8658_register_write_byte(QMI8658_CTRL1, 0x40); // CTRL1 设置地址自动增加
+    qmi8658_register_write_byte(QMI8658_CTRL8, 0x80); // CTRL8 CTRL9命令用STATUSINT握手
+    qmi8658_register_write_byte(QMI8658_CTRL7, 0x03); // CTRL7 允许加速度和陀螺仪
+    qmi8658_register_write_byte(QMI8658_CTRL2, 0x95); // CTRL2 设置ACC 4g 250Hz
+    qmi8658_register_write_byte(QMI8658_CTRL3, 0xd5); // CTRL3 设置GRY 512dps 250Hz 
+}
+
+// 执行CTRL9命令: 写命令后等CmdDone置位, 再写ACK等它清零
+static esp_err_t qmi8658_ctrl9_command(uint8_t cmd)
+{
+    uint8_t status = 0;
+    int i;
+
+    if (qmi8658_register_write_byte(QMI8658_CTRL9, cmd) != ESP_OK)
+        return ESP_FAIL;
+    for (i = 0; i < QMI8658_CMD_POLLS; i++)
+    {
+        if (qmi8658_register_read(QMI8658_STATUSINT, &status, 1) != ESP_OK)
+            return ESP_FAIL;
+        if (status & QMI8658_CMD_DONE)
+            break;
+    }
+    if (i == QMI8658_CMD_POLLS)
+        return ESP_ERR_TIMEOUT;
+
+    if (qmi8658_register_write_byte(QMI8658_CTRL9, QMI8658_CMD_ACK) != ESP_OK)
+        return ESP_FAIL;
+    for (i = 0; i < QMI8658_CMD_POLLS; i++)
+    {
+        if (qmi8658_register_read(QMI8658_STATUSINT, &status, 1) != ESP_OK)
+            return ESP_FAIL;
+        if (!(status & QMI8658_CMD_DONE))
+            return ESP_OK;
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+// 读出FIFO中的全部样本, 按时间顺序交给样本回调; 不到min个时只查询一次样本数
+// frame: 每个样本的字节数 (6: 只有加速度计, 12: 6轴); 最新的样本在newest_us, 之前的按period_us往前推
+static esp_err_t qmi8658_fifo_drain(uint8_t frame, uint16_t min, int64_t newest_us, uint32_t period_us, uint8_t flags, uint16_t *count)
+{
+    uint8_t fifo_ctrl = (frame == 6) ? QMI8658_FIFO_STREAM_128 : QMI8658_FIFO_MODE_128;
+    uint8_t cnt[2];  // FIFO_SMPL_CNT, FIFO_STATUS
+    uint16_t n;
+    esp_err_t ret;
+
+    *count = 0;
+    ret = qmi8658_register_read(QMI8658_FIFO_SMPL_CNT, cnt, 2);
+    if (ret != ESP_OK)
+        return ret;
+    n = (uint16_t)((((cnt[1] & 0x03) << 8) | cnt[0]) * 2 / frame);  // 计数单位是2字节
+    if (n > QMI8658_FIFO_MAX_SAMPLES)
+        n = QMI8658_FIFO_MAX_SAMPLES;
+    if (n == 0 || n < min)
+        return ESP_OK;
+    if (cnt[1] & QMI8658_FIFO_FULL)
+        fifo_stats.overflows++;
+
+    ret = qmi8658_ctrl9_command(QMI8658_CMD_REQ_FIFO);
+    if (ret == ESP_OK)
+        ret = qmi8658_register_read(QMI8658_FIFO_DATA, (uint8_t *)fifo_buf, n * frame);  // 读模式下地址不自增, 一直读FIFO_DATA
+    qmi8658_register_write_byte(QMI8658_FIFO_CTRL, fifo_ctrl);  // 写回不带读模式位的配置, 退出读模式
+    if (ret != ESP_OK)
+        return ret;
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        const int16_t *v = &fifo_buf[i * frame / 2];
+        t_sQMI8658_sample *s = &fifo_samples[i];
+        s->time_us = newest_us - (int64_t)(n - 1 - i) * period_us;
+        memcpy(s->acc, v, sizeof(s->acc));
+        memset(s->gyr, 0, sizeof(s->gyr));
+        s->flags = flags;
+        if (frame == 12)
+        {
+            memcpy(s->gyr, v + 3, sizeof(s->gyr));
+            if (gyr_bias_valid)
+                for (int k = 0; k < 3; k++)
+                    s->gyr[k] -= gyr_bias[k];
+            s->flags |= QMI8658_SAMPLE_GYR;
+        }
+    }
+    *count = n;
+    if (sample_cb)
+        sample_cb(fifo_samples, n);
+    return ESP_OK;
+}
+
 // 初始化qmi8658
 void qmi8658_init(void)
 {
     uint8_t id = 0; // 芯片的ID号
 
+    qmi8658_restored = qmi8658_restore_state();
+    if (qmi8658_restored)
+    {
+        ESP_LOGI(TAG, "QMI8658 从深度睡眠恢复, 跳过初始化");
+        return;
+    }
+    qmi8658_rtc.magic = 0;  // 其他复位时RTC内存里是旧数据
+
     qmi8658_register_read(QMI8658_WHO_AM_I, &id ,1); // 读芯片的ID号
-    while (id != 0x05)  // 判断读到的ID号是否是0x05
+    while (id != QMI8658_CHIP_ID)  // 判断读到的ID号是否是0x05
     {
         vTaskDelay(1000 / portTICK_PERIOD_MS);  // 延时1秒
         qmi8658_register_read(QMI8658_WHO_AM_I, &id ,1); // 读取ID号
@@ -54,16 +226,13 @@ void qmi8658_init(void)
 
     qmi8658_register_write_byte(QMI8658_RESET, 0xb0);  // 复位  
     vTaskDelay(10 / portTICK_PERIOD_MS);  // 延时10ms
-    qmi8658_register_write_byte(QMI8658_CTRL1, 0x40); // CTRL1 设置地址自动增加
-    qmi8658_register_write_byte(QMI8658_CTRL7, 0x03); // CTRL7 允许加速度和陀螺仪
-    qmi8658_register_write_byte(QMI8658_CTRL2, 0x95); // CTRL2 设置ACC 4g 250Hz
-    qmi8658_register_write_byte(QMI8658_CTRL3, 0xd5); // CTRL3 设置GRY 512dps 250Hz 
+    qmi8658_apply_config();
 }
 
 // 读取加速度和陀螺仪寄存器值
-void qmi8658_Read_AccAndGry(t_sQMI8658 *p)
+bool qmi8658_Read_AccAndGry(t_sQMI8658 *p)
 {
-    uint8_t status, data_ready=0;
+    uint8_t status = 0, data_ready=0;
     int16_t buf[6];
 
     qmi8658_register_read(QMI8658_STATUS0, &status, 1); // 读状态寄存器 
@@ -78,15 +247,263 @@ void qmi8658_Read_AccAndGry(t_sQMI8658 *p)
         p->gyr_x = buf[3];
         p->gyr_y = buf[4];
         p->gyr_z = buf[5];
+        if (gyr_bias_valid){  // 减去陀螺仪零偏
+            p->gyr_x -= gyr_bias[0];
+            p->gyr_y -= gyr_bias[1];
+            p->gyr_z -= gyr_bias[2];
+        }
     }
+    return (status & 0x03) != 0;
+}
+
+// 校准陀螺仪零偏: 设备静止时取平均值
+esp_err_t qmi8658_calibrate_gyro(uint16_t samples)
+{
+    int32_t sum[3] = {0};
+    int16_t buf[3];
+    uint8_t status;
+    uint16_t count = 0;
+
+    if (samples == 0)
+        return ESP_ERR_INVALID_ARG;
+    while (count < samples)
+    {
+        vTaskDelay(10 / portTICK_PERIOD_MS);  // 250Hz输出, 每次一定有新数据
+        if (qmi8658_register_read(QMI8658_STATUS0, &status, 1) != ESP_OK)
+            return ESP_FAIL;
+        if (!(status & 0x02))  // 陀螺仪数据未就绪
+            continue;
+        if (qmi8658_register_read(QMI8658_GX_L, (uint8_t *)buf, 6) != ESP_OK)
+            return ESP_FAIL;
+        sum[0] += buf[0];
+        sum[1] += buf[1];
+        sum[2] += buf[2];
+        count++;
+    }
+    for (int i = 0; i < 3; i++)
+        gyr_bias[i] = (int16_t)(sum[i] / samples);
+    gyr_bias_valid = true;
+    ESP_LOGI(TAG, "陀螺仪零偏: %d, %d, %d", gyr_bias[0], gyr_bias[1], gyr_bias[2]);
+    return ESP_OK;
+}
+
+// 深度睡眠前保存配置和零偏, 配置从芯片读回, 保证与唤醒后的校验一致
+esp_err_t qmi8658_save_state(void)
+{
+    uint8_t regs[QMI8658_CTRL7 + 1];
+
+    esp_err_t ret = qmi8658_register_read(QMI8658_WHO_AM_I, regs, sizeof(regs));
+    if (ret != ESP_OK)
+        return ret;
+    if (regs[QMI8658_WHO_AM_I] != QMI8658_CHIP_ID)
+        return ESP_ERR_INVALID_STATE;
+
+    memcpy(qmi8658_rtc.ctrl, &regs[QMI8658_CTRL1], QMI8658_CTRL_NUM);
+    memcpy(qmi8658_rtc.gyr_bias, gyr_bias, sizeof(gyr_bias));
+    qmi8658_rtc.bias_valid = gyr_bias_valid;
+    qmi8658_rtc.wom_armed = wom_armed;
+    qmi8658_rtc.magic = QMI8658_RTC_MAGIC;
+    return ESP_OK;
+}
+
+// 本次启动是否从深度睡眠前保存的状态恢复
+bool qmi8658_is_restored(void)
+{
+    return qmi8658_restored;
+}
+
+// 设置样本回调
+void qmi8658_set_sample_callback(qmi8658_sample_cb_t cb)
+{
+    sample_cb = cb;
+}
+
+// 运动唤醒: 关掉陀螺仪, 加速度计低功耗运行, 超过阈值时INT1翻转; FIFO流模式一直保留最近128个样本,
+// 唤醒后取出就是触发前后的数据. 之后调用esp_light_sleep_start或(先qmi8658_save_state)esp_deep_sleep_start
+esp_err_t qmi8658_enable_motion_wake(uint8_t threshold_mg)
+{
+#if !QMI8658_INT_CONNECTED
+    return ESP_ERR_NOT_SUPPORTED;  // INT1未连接, 在menuconfig中设置引脚
+#else
+    esp_err_t ret;
+    int level;
+
+    if (threshold_mg == 0)
+        return ESP_ERR_INVALID_ARG;
+    if (!rtc_gpio_is_valid_gpio(QMI8658_INT_IO))  // EXT1只能用RTC GPIO
+        return ESP_ERR_NOT_SUPPORTED;
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << QMI8658_INT_IO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    gpio_config(&io_conf);
+
+    qmi8658_register_write_byte(QMI8658_CTRL7, 0x00);  // 先关闭传感器再改配置
+    ret = qmi8658_ctrl9_command(QMI8658_CMD_RST_FIFO);
+    if (ret != ESP_OK)
+        return ret;
+    qmi8658_register_write_byte(QMI8658_FIFO_CTRL, QMI8658_FIFO_STREAM_128);
+    qmi8658_register_write_byte(QMI8658_CTRL2, QMI8658_WOM_CTRL2);
+    qmi8658_register_write_byte(QMI8658_CATL1_L, threshold_mg);  // 阈值, 1mg/LSB
+    qmi8658_register_write_byte(QMI8658_CATL1_H, QMI8658_WOM_CAL1_H);
+    ret = qmi8658_ctrl9_command(QMI8658_CMD_WRITE_WOM);
+    if (ret != ESP_OK)
+        return ret;
+    qmi8658_register_write_byte(QMI8658_CTRL1, 0x40 | QMI8658_CTRL1_INT1_EN);
+    qmi8658_register_write_byte(QMI8658_CTRL7, 0x01);  // 只开加速度计
+    wom_armed = true;
+
+    // INT1每次触发翻转电平, 按当前电平的反向唤醒
+    vTaskDelay(10 / portTICK_PERIOD_MS);
+    level = gpio_get_level(QMI8658_INT_IO);
+    ret = esp_sleep_enable_ext1_wakeup(1ULL << QMI8658_INT_IO, level ? ESP_EXT1_WAKEUP_ANY_LOW : ESP_EXT1_WAKEUP_ANY_HIGH);
+    if (ret != ESP_OK)
+        return ret;
+    ESP_LOGI(TAG, "运动唤醒已开启: 阈值%dmg, INT1=%d", threshold_mg, level);
+    return ESP_OK;
+#endif
+}
+
+// 本次唤醒是否由运动触发
+bool qmi8658_motion_woke(void)
+{
+#if !QMI8658_INT_CONNECTED
+    return false;
+#else
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_EXT1)
+        return false;
+    return (esp_sleep_get_ext1_wakeup_status() & (1ULL << QMI8658_INT_IO)) != 0;
+#endif
+}
+
+// 唤醒后取出FIFO: 最新的样本就是现在, 之前的按128Hz往前推; 然后关闭运动唤醒, 恢复6轴采样
+// 深度睡眠唤醒时先qmi8658_init (从RTC内存恢复) 和设置样本回调, 再调用它
+esp_err_t qmi8658_motion_wake_resume(void)
+{
+    uint16_t n = 0;
+    esp_err_t ret;
+
+    if (!wom_armed)
+        return ESP_ERR_INVALID_STATE;
+
+    ret = qmi8658_fifo_drain(6, 1, esp_timer_get_time(), QMI8658_WOM_PERIOD_US, QMI8658_SAMPLE_PRE_TRIG, &n);
+    if (ret != ESP_OK)
+        ESP_LOGW(TAG, "读取运动唤醒前的FIFO失败: %s", esp_err_to_name(ret));
+
+    qmi8658_register_write_byte(QMI8658_CTRL7, 0x00);
+    qmi8658_register_write_byte(QMI8658_CATL1_L, 0);  // 阈值为0关闭运动唤醒
+    qmi8658_register_write_byte(QMI8658_CATL1_H, 0);
+    qmi8658_ctrl9_command(QMI8658_CMD_WRITE_WOM);
+    qmi8658_register_write_byte(QMI8658_FIFO_CTRL, 0x00);  // FIFO旁路
+    qmi8658_apply_config();
+    fifo_watermark = 0;  // 运动唤醒改过FIFO配置, 需要的话重新qmi8658_fifo_start
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT1);
+    wom_armed = false;
+    qmi8658_rtc.wom_armed = false;
+
+    ESP_LOGI(TAG, "运动唤醒: 取出%d个缓存样本", n);
+    return ret;
+}
+
+// 开始FIFO批量采样: FIFO模式保存6轴样本, 到水位后由qmi8658_fifo_read一次读出
+// 逐个读取每个样本要查询STATUS0再读12字节, 250Hz时每秒500次传输; 水位64时每批约8次传输
+esp_err_t qmi8658_fifo_start(uint8_t watermark)
+{
+    esp_err_t ret;
+
+    if (watermark == 0 || watermark > QMI8658_FIFO_MAX_SAMPLES)
+        return ESP_ERR_INVALID_ARG;
+    if (wom_armed)
+        return ESP_ERR_INVALID_STATE;
+
+    qmi8658_register_write_byte(QMI8658_FIFO_CTRL, 0x00);
+    ret = qmi8658_ctrl9_command(QMI8658_CMD_RST_FIFO);
+    if (ret != ESP_OK)
+        return ret;
+    qmi8658_register_write_byte(QMI8658_FIFO_WTM_TH, watermark);
+    qmi8658_register_write_byte(QMI8658_FIFO_CTRL, QMI8658_FIFO_MODE_128);
+
+    memset(&fifo_stats, 0, sizeof(fifo_stats));
+    fifo_stats.period_us = QMI8658_ODR_PERIOD_US;
+    fifo_start_transactions = bus_transactions;
+    fifo_watermark = watermark;
+    fifo_last_read_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "FIFO批量采样: 水位%d个样本", watermark);
+    return ESP_OK;
+}
+
+// 停止FIFO批量采样
+esp_err_t qmi8658_fifo_stop(void)
+{
+    if (fifo_watermark == 0)
+        return ESP_ERR_INVALID_STATE;
+    fifo_watermark = 0;
+    return qmi8658_register_write_byte(QMI8658_FIFO_CTRL, 0x00);
+}
+
+// 到水位时读出一批; 样本时间以读取时刻为最新样本, 采样周期用两次读取之间的时间和样本数估计
+esp_err_t qmi8658_fifo_read(uint16_t *count)
+{
+    uint16_t n = 0;
+    int64_t now = esp_timer_get_time();
+    esp_err_t ret;
+
+    if (count)
+        *count = 0;
+    if (fifo_watermark == 0)
+        return ESP_ERR_INVALID_STATE;
+
+    ret = qmi8658_fifo_drain(12, fifo_watermark, now, fifo_stats.period_us, 0, &n);
+    if (ret != ESP_OK || n == 0)
+        return ret;
+
+    // 每次都读空FIFO, 两次读取之间的样本数就是这段时间产生的, 平滑后作为下一批的采样周期
+    uint32_t measured = (uint32_t)((now - fifo_last_read_us) / n);
+    if (measured > 0)
+        fifo_stats.period_us += ((int32_t)measured - (int32_t)fifo_stats.period_us) / 8;
+    fifo_last_read_us = now;
+    fifo_stats.samples += n;
+    fifo_stats.batches++;
+    if (count)
+        *count = n;
+    return ESP_OK;
+}
+
+// 填满一个水位需要的时间
+uint32_t qmi8658_fifo_interval_ms(void)
+{
+    return (uint32_t)fifo_watermark * fifo_stats.period_us / 1000;
+}
+
+// 启动以来QMI8658寄存器读写的总次数
+uint32_t qmi8658_bus_transactions(void)
+{
+    return bus_transactions;
+}
+
+// 获取FIFO批量采样统计
+void qmi8658_fifo_get_stats(t_sQMI8658_fifo_stats *stats)
+{
+    *stats = fifo_stats;
+    stats->transactions = bus_transactions - fifo_start_transactions;
 }
 
 // 获取XYZ轴的倾角值
 void qmi8658_fetch_angleFromAcc(t_sQMI8658 *p)
+{
+    qmi8658_Read_AccAndGry(p); // 读取加速度和陀螺仪的寄存器值
+    qmi8658_calc_angle(p);
+}
+
+// 根据加速度值计算倾角
+void qmi8658_calc_angle(t_sQMI8658 *p)
 {
     float temp;
 
-    qmi8658_Read_AccAndGry(p); // 读取加速度和陀螺仪的寄存器值
     // 根据寄存器值 计算倾角值 并把弧度转换成角度
     temp = (float)p->acc_x / sqrt( ((float)p->acc_y * (float)p->acc_y + (float)p->acc_z * (float)p->acc_z) );
     p->AngleX = atan(temp)*57.29578f; // 180/π=57.29578
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
 #include "esp_err.h"
 #include "driver/i2c.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "driver/gpio.h"
 #include "math.h"
 
 /******************************************************************************/
@@ -24,6 +27,13 @@ esp_err_t bsp_i2c_init(void);   // 初始化I2C接口
 /*******************************************************************************/
 /***************************  姿态传感器 QMI8658 ↓   ****************************/
 #define  QMI8658_SENSOR_ADDR       0x6A   // QMI8658 I2C地址
+#if defined(CONFIG_QMI8658_INT_GPIO) && CONFIG_QMI8658_INT_GPIO >= 0
+#define  QMI8658_INT_CONNECTED     1
+#define  QMI8658_INT_IO            ((gpio_num_t)CONFIG_QMI8658_INT_GPIO)  // QMI8658 INT1连接的引脚 (menuconfig设置, 深度睡眠唤醒需要RTC GPIO)
+#else
+#define  QMI8658_INT_CONNECTED     0      // INT1未连接 (默认): 不能运动唤醒
+#define  QMI8658_INT_IO            (GPIO_NUM_NC)
+#endif
 
 // QMI8658寄存器地址
 enum qmi8658_reg
@@ -107,8 +117,56 @@ typedef struct{
 	float AngleZ;
 }t_sQMI8658;
 
-void qmi8658_init(void);  // QMI8658初始化
+// FIFO中取出的带时间戳的样本
+typedef struct{
+    int64_t time_us;      // 采样时刻 (esp_timer), 由样本在FIFO中的位置和采样周期推算; 深度睡眠唤醒时触发前的样本为负
+    int16_t acc[3];
+    int16_t gyr[3];
+    uint8_t flags;        // QMI8658_SAMPLE_*
+}t_sQMI8658_sample;
+
+#define QMI8658_SAMPLE_GYR        0x01   // 陀螺仪数据有效 (运动唤醒期间只有加速度计)
+#define QMI8658_SAMPLE_PRE_TRIG   0x02   // 运动唤醒时缓存在FIFO中的样本 (包括触发前和唤醒前)
+
+// 样本回调: 正常采样流和运动唤醒后取出的FIFO样本都从这里交给应用, 按时间顺序
+typedef void (*qmi8658_sample_cb_t)(const t_sQMI8658_sample *samples, uint16_t count);
+
+// FIFO批量采样统计
+typedef struct{
+    uint32_t samples;       // 读出的样本数
+    uint32_t batches;       // 突发读取的次数
+    uint32_t transactions;  // I2C传输次数 (包括查询样本数和CTRL9握手)
+    uint32_t overflows;     // 读取时FIFO已满的次数, 不为0说明读得太慢丢了样本
+    uint32_t period_us;     // 估计的采样周期
+}t_sQMI8658_fifo_stats;
+
+#define QMI8658_CALIB_SAMPLES     100    // 陀螺仪零偏校准的样本数
+#define QMI8658_FIFO_MAX_SAMPLES  128    // FIFO深度
+#define QMI8658_FIFO_WATERMARK    64     // 默认水位: 每次突发读取的样本数, 留一半余量给调度延迟
+#define QMI8658_ODR_PERIOD_US     4000   // 250Hz的标称采样周期, 实际周期在读取FIFO时估计
+#define QMI8658_WOM_THRESHOLD_MG  100    // 运动唤醒的默认阈值 (mg)
+
+void qmi8658_init(void);  // QMI8658初始化 (深度睡眠唤醒且配置没变时跳过等待和重新配置)
 void qmi8658_fetch_angleFromAcc(t_sQMI8658 *p);  // 获取倾角
+bool qmi8658_Read_AccAndGry(t_sQMI8658 *p);  // 逐个样本读取: 查询一次STATUS0, 有新数据时再读12字节, 返回是否读到新样本
+void qmi8658_calc_angle(t_sQMI8658 *p);  // 根据p中已有的加速度值计算倾角
+esp_err_t qmi8658_calibrate_gyro(uint16_t samples);  // 静止时校准陀螺仪零偏, 之后读到的陀螺仪值减去零偏
+esp_err_t qmi8658_save_state(void);  // 深度睡眠前把配置和零偏保存到RTC内存
+bool qmi8658_is_restored(void);  // 本次启动是否从深度睡眠前保存的状态恢复
+void qmi8658_set_sample_callback(qmi8658_sample_cb_t cb);  // 设置样本回调
+esp_err_t qmi8658_enable_motion_wake(uint8_t threshold_mg);  // 进入运动唤醒模式: 只开低功耗加速度计, FIFO循环缓存最近的样本, INT1作为轻度/深度睡眠唤醒源; INT1未连接时返回ESP_ERR_NOT_SUPPORTED
+bool qmi8658_motion_woke(void);  // 本次唤醒是否由运动触发 (INT1未连接时总是false)
+esp_err_t qmi8658_motion_wake_resume(void);  // 唤醒后把FIFO中缓存的样本交给样本回调, 恢复正常的6轴采样
+// 运动唤醒的FIFO是128个样本的流模式 (128Hz约1秒), 唤醒到取出之间还在覆盖最旧的样本: 深度睡眠复位
+// 到调用qmi8658_motion_wake_resume超过约1秒时触发前的样本会丢失, 所以要在app_main中紧跟qmi8658_init调用.
+// 取出的样本和之后的6轴样本流不连续: 中间有重新配置 (约10次I2C写) 和陀螺仪启动的间隔, 两者都用esp_timer时基,
+// 间隔就是最后一个PRE_TRIG样本和qmi8658_fifo_read第一批样本time_us之差 (后者按估计的采样周期往前推, 是近似值)
+esp_err_t qmi8658_fifo_start(uint8_t watermark);  // 开始FIFO批量采样, 不再逐个样本查询STATUS0
+esp_err_t qmi8658_fifo_stop(void);  // 停止FIFO批量采样, 回到逐个样本读取
+esp_err_t qmi8658_fifo_read(uint16_t *count);  // FIFO达到水位时一次读出全部样本, 按时间顺序交给样本回调; 没到水位时只查询一次
+uint32_t qmi8658_fifo_interval_ms(void);  // 按估计的采样周期, 填满一个水位需要的时间
+void qmi8658_fifo_get_stats(t_sQMI8658_fifo_stats *stats);  // 获取FIFO批量采样统计
+uint32_t qmi8658_bus_transactions(void);  // 启动以来QMI8658寄存器读写的总次数, 用来比较逐个读取和FIFO批量读取
 
 /***************************  姿态传感器 QMI8658 ↑  ****************************/
 /*******************************************************************************/
@@ -0,0 +1,97 @@
+//QMI8658 FIFO批量采样: 先逐个查询读取作为对比, 再由两个共享互斥锁的任务按水位读FIFO, 打印每样本传输次数和溢出
+#include "stdio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp32_s3_szp.h"
+
+#define POLL_MS    3000                          // 逐个读取对比的时间
+#define POLL_US    (QMI8658_ODR_PERIOD_US / 2)   // 查询间隔, 小于采样周期才不会漏样本
+
+static const char *TAG = "imu_fifo";
+SemaphoreHandle_t qmi8658_mutex;
+t_sQMI8658 QMI8658;
+static float poll_per_sample = 0;   // 逐个读取时每个样本的传输次数
+
+// 逐个读取: 每次查询STATUS0, 有新样本时再读12字节, 和以前的taskA/taskB一样
+static void qmi8658_poll_baseline(void)
+{
+    uint32_t samples = 0;
+    uint32_t start_tx = qmi8658_bus_transactions();
+    int64_t start = esp_timer_get_time();
+
+    while(esp_timer_get_time() - start < (int64_t)POLL_MS * 1000){
+        if(qmi8658_Read_AccAndGry(&QMI8658))
+            samples++;
+        esp_rom_delay_us(POLL_US);
+    }
+    uint32_t tx = qmi8658_bus_transactions() - start_tx;
+    poll_per_sample = samples ? (float)tx / samples : 0.0f;
+    ESP_LOGI(TAG,"逐个读取: 传输%lu次/秒, 样本%lu个/秒, 每样本传输%.3f次",
+             (unsigned long)(tx * 1000 / POLL_MS), (unsigned long)(samples * 1000 / POLL_MS), poll_per_sample);
+}
+
+// FIFO样本回调: taskA持有互斥锁读FIFO时调用, 用这一批最新的样本更新倾角
+static void qmi8658_on_samples(const t_sQMI8658_sample *samples, uint16_t count)
+{
+    const t_sQMI8658_sample *last = &samples[count - 1];
+
+    QMI8658.acc_x = last->acc[0];
+    QMI8658.acc_y = last->acc[1];
+    QMI8658.acc_z = last->acc[2];
+    QMI8658.gyr_x = last->gyr[0];
+    QMI8658.gyr_y = last->gyr[1];
+    QMI8658.gyr_z = last->gyr[2];
+    qmi8658_calc_angle(&QMI8658);
+}
+
+void taskA(void *param)  // 每填满一个水位读一次FIFO, 一批样本只需要几次传输
+{
+    uint16_t count = 0;
+    while(1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(qmi8658_fifo_interval_ms()));
+        if(xSemaphoreTake(qmi8658_mutex,portMAX_DELAY))
+        {
+            qmi8658_fifo_read(&count);
+            xSemaphoreGive(qmi8658_mutex);
+        }
+        if (count == 0)  // 还没到水位, 稍后再查
+            vTaskDelay(pdMS_TO_TICKS(qmi8658_fifo_interval_ms() / 4 + 1));
+    }
+}
+
+void taskB(void *param)  // 每秒打印倾角和FIFO统计, 和逐个读取对比
+{
+    t_sQMI8658_fifo_stats stats;
+    while(1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        if(xSemaphoreTake(qmi8658_mutex,portMAX_DELAY))
+        {
+            qmi8658_fifo_get_stats(&stats);
+            xSemaphoreGive(qmi8658_mutex);
+            float per_sample = stats.samples ? (float)stats.transactions / stats.samples : 0.0f;
+            ESP_LOGI("taskB","x=%f,y=%f,z=%f",QMI8658.AngleX,QMI8658.AngleY,QMI8658.AngleZ);
+            ESP_LOGI("taskB","样本%lu, 批次%lu, 传输%lu, 每样本传输%.3f次 (逐个读取%.3f次, 减少到1/%.1f), 溢出%lu, 周期%luus",
+                     (unsigned long)stats.samples, (unsigned long)stats.batches, (unsigned long)stats.transactions,
+                     per_sample, poll_per_sample, per_sample > 0 ? poll_per_sample / per_sample : 0.0f,
+                     (unsigned long)stats.overflows, (unsigned long)stats.period_us);
+        }
+    }
+}
+
+void app_main(void){
+    bsp_i2c_init();
+    qmi8658_init();
+    qmi8658_poll_baseline();
+
+    qmi8658_mutex = xSemaphoreCreateMutex();
+    qmi8658_set_sample_callback(qmi8658_on_samples);
+    qmi8658_fifo_start(QMI8658_FIFO_WATERMARK);
+    xTaskCreatePinnedToCore(taskA, "taskA", 3072, NULL, 5, NULL, 1); // FIFO读取任务
+    xTaskCreatePinnedToCore(taskB, "taskB", 3072, NULL, 4, NULL, 1); // 打印任务
+}
@@ -0,0 +1,72 @@
+//QMI8658 深度睡眠: 冷启动校准零偏, 睡眠前开启运动唤醒并保存状态, 唤醒后从RTC内存恢复并取出触发前的样本
+#include "stdio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp32_s3_szp.h"
+
+#define AWAKE_MS   5000    // 每次醒来采样的时间
+#define SLEEP_MS   60000   // 没有运动时最长的深度睡眠时间
+
+static const char *TAG = "imu_sleep";
+t_sQMI8658 QMI8658;
+
+// FIFO样本回调: 用每一批最新的样本更新倾角; 运动唤醒前缓存的样本只有加速度
+static void qmi8658_on_samples(const t_sQMI8658_sample *samples, uint16_t count)
+{
+    const t_sQMI8658_sample *last = &samples[count - 1];
+
+    if(last->flags & QMI8658_SAMPLE_PRE_TRIG)
+        ESP_LOGI(TAG,"触发前后%d个样本, 最早%dms前",count,(int)((esp_timer_get_time() - samples[0].time_us) / 1000));
+    QMI8658.acc_x = last->acc[0];
+    QMI8658.acc_y = last->acc[1];
+    QMI8658.acc_z = last->acc[2];
+    if(last->flags & QMI8658_SAMPLE_GYR){
+        QMI8658.gyr_x = last->gyr[0];
+        QMI8658.gyr_y = last->gyr[1];
+        QMI8658.gyr_z = last->gyr[2];
+    }
+    qmi8658_calc_angle(&QMI8658);
+}
+
+void app_main(void){
+    uint16_t count;
+
+    // 运动唤醒时FIFO还在流模式下覆盖最旧的样本, 只保留最近约1秒: I2C和QMI8658 (从RTC内存恢复,
+    // 一次读取) 之后马上取出, 其他慢的初始化都放到后面
+    bsp_i2c_init();
+    qmi8658_init();    // 深度睡眠唤醒且配置没变时直接从RTC内存恢复
+    qmi8658_set_sample_callback(qmi8658_on_samples);
+
+    // 睡眠前开过运动唤醒时, 不管由什么唤醒都要取出FIFO并恢复6轴采样
+    bool motion = qmi8658_motion_woke();
+    if(qmi8658_motion_wake_resume() == ESP_OK)
+        ESP_LOGI(TAG,"%s唤醒, 复位后%dms取出FIFO",motion ? "运动" : "定时器",(int)(esp_timer_get_time() / 1000));
+
+    if(!qmi8658_is_restored()){
+        // 只在冷启动时校准零偏 (需要静止约1秒), 睡眠前保存到RTC内存, 唤醒后沿用
+        if(qmi8658_calibrate_gyro(QMI8658_CALIB_SAMPLES) != ESP_OK)
+            ESP_LOGW(TAG,"陀螺仪零偏校准失败");
+    }
+    qmi8658_fifo_start(QMI8658_FIFO_WATERMARK);
+
+    int64_t end = esp_timer_get_time() + (int64_t)AWAKE_MS * 1000;
+    while(esp_timer_get_time() < end){
+        vTaskDelay(pdMS_TO_TICKS(qmi8658_fifo_interval_ms()));
+        if(qmi8658_fifo_read(&count) == ESP_OK && count > 0)
+            ESP_LOGI(TAG,"x=%f,y=%f,z=%f",QMI8658.AngleX,QMI8658.AngleY,QMI8658.AngleZ);
+    }
+
+    // 运动或定时器唤醒; 开启运动唤醒之后再保存配置和零偏, 下次唤醒跳过初始化和校准
+    qmi8658_fifo_stop();
+    esp_err_t ret = qmi8658_enable_motion_wake(QMI8658_WOM_THRESHOLD_MG);
+    if(ret != ESP_OK)  // 配置可能只写了一半, 不保存, 唤醒后重新初始化
+        ESP_LOGW(TAG,"开启运动唤醒失败: %s, 只用定时器唤醒",esp_err_to_name(ret));
+    else if(qmi8658_save_state() != ESP_OK)
+        ESP_LOGW(TAG,"保存QMI8658状态失败, 唤醒后重新初始化");
+    ESP_LOGI(TAG,"深度睡眠, 最长%dms",SLEEP_MS);
+    esp_sleep_enable_timer_wakeup((uint64_t)SLEEP_MS * 1000);
+    esp_deep_sleep_start();
+}
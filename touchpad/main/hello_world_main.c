@@ -15,21 +15,60 @@
 #include "esp_log.h"
 
 #include "touch_sensor.h"
+#include "touch_slider.h"
+#include "touch_capture.h"
+#include "power_manager.h"
+
+// 1: T10~T13作为4段滑条 (需要把这些通道加入TOUCH_PAD_MASK)
+#define DEMO_SLIDER 0
+
+// 触摸判定方式: TOUCH_DETECT_ADAPTIVE / TOUCH_DETECT_HARDWARE / TOUCH_DETECT_AB
+#define DEMO_DETECT_MODE TOUCH_DETECT_ADAPTIVE
+#define DEMO_STATS_PERIOD_MS 10000  // 打印对比统计和电源统计的周期
+
+// 1: 以扫描频率把所有通道的原始值/平滑值输出到UART1 (GPIO17), 主机用 tools/touch_capture_decode.py 解码
+#define DEMO_CAPTURE 0
 
 // 触摸中断回调函数
-static void touch_interrupt_handler(bool is_touched)
+static void touch_interrupt_handler(uint32_t touched_mask, uint32_t changed_mask)
 {
-    if (is_touched) {
-        ESP_LOGI("MAIN", "🔴 触摸中断: 检测到触摸!");
-    } else {
-        ESP_LOGI("MAIN", "🟢 触摸中断: 触摸释放!");
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!(changed_mask & (1UL << pad))) {
+            continue;
+        }
+        if (touched_mask & (1UL << pad)) {
+            ESP_LOGI("MAIN", "🔴 触摸中断: T%d 检测到触摸!", pad);
+        } else {
+            ESP_LOGI("MAIN", "🟢 触摸中断: T%d 触摸释放!", pad);
+        }
     }
 }
 
+#if DEMO_SLIDER
+static const touch_pad_t slider_pads[] = {TOUCH_PAD_NUM10, TOUCH_PAD_NUM11, TOUCH_PAD_NUM12, TOUCH_PAD_NUM13};
+
+// 滑条事件回调函数
+static void slider_handler(const touch_slider_event_t *event, void *arg)
+{
+    static const char *names[] = {"按下", "移动", "松开"};
+    ESP_LOGI("MAIN", "滑条%d %s: 位置=%u, 速度=%" PRId32 "/s", event->id, names[event->type],
+             event->position, event->velocity);
+}
+#endif
+
 void app_main(void)
 {
     ESP_LOGI("MAIN", "ESP32-S3 触摸传感器演示程序启动");
     
+    // 动态调频和自动轻度睡眠: 空闲时降到最低频率或睡眠, 只有处理触摸事件时升频;
+    // 按下通道唤醒CPU, 需要逐次扫描时驱动禁止轻度睡眠
+    power_manager_init(NULL);
+    
+    // 选择触摸判定方式
+    touch_sensor_hw_config_t hw_config = TOUCH_SENSOR_HW_DEFAULT_CONFIG();
+    hw_config.mode = DEMO_DETECT_MODE;
+    touch_sensor_set_hw_config(&hw_config);
+    
     // 初始化触摸传感器
     if (touch_sensor_init() != ESP_OK) {
         ESP_LOGE("MAIN", "触摸传感器初始化失败，程序退出");
@@ -47,13 +86,51 @@ void app_main(void)
         ESP_LOGE("MAIN", "触摸检测任务启动失败，程序退出");
         return;
     }
+
+#if DEMO_SLIDER
+    touch_slider_config_t slider_config = {
+        .type = TOUCH_SLIDER_LINEAR,
+        .pads = slider_pads,
+        .pad_num = sizeof(slider_pads) / sizeof(slider_pads[0]),
+        .range = 100,
+    };
+    int slider_id;
+    if (touch_slider_create(&slider_config, slider_handler, NULL, &slider_id) != ESP_OK ||
+        touch_slider_start() != ESP_OK) {
+        ESP_LOGE("MAIN", "滑条启动失败");
+    }
+#endif
+
+#if DEMO_CAPTURE
+    touch_capture_config_t capture_config = TOUCH_CAPTURE_UART_DEFAULT_CONFIG(TOUCH_PAD_MASK);
+    if (touch_capture_start(&capture_config) != ESP_OK) {
+        ESP_LOGE("MAIN", "高速采集启动失败");
+    }
+#endif
     
-    ESP_LOGI("MAIN", "触摸检测任务已创建，开始检测GPIO6触摸状态");
+    ESP_LOGI("MAIN", "触摸检测任务已创建，开始检测触摸通道 0x%04lx", (unsigned long)TOUCH_PAD_MASK);
     ESP_LOGI("MAIN", "触摸中断已启用，状态变化时会触发回调");
     
-    // 主任务循环
+    // 主任务循环: 阻塞等待触摸状态变化, 读取同一次扫描的完整快照
+    touch_sensor_snapshot_t snap;
+    touch_sensor_get_snapshot(&snap);
     while (1) {
-        // 主任务延时
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        if (touch_sensor_wait_change(&snap, pdMS_TO_TICKS(DEMO_STATS_PERIOD_MS)) != ESP_OK) {
+            // 没有触摸变化时定期打印统计
+            power_manager_report();
+            if (DEMO_DETECT_MODE != TOUCH_DETECT_AB) {
+                continue;
+            }
+            touch_sensor_ab_stats_t stats;
+            touch_sensor_get_ab_stats(&stats, false);
+            ESP_LOGI("MAIN", "对比: 软件%" PRIu32 "次, 硬件%" PRIu32 "次, 匹配%" PRIu32 ", 仅软件%" PRIu32 ", 仅硬件%" PRIu32
+                     ", 延迟差%" PRId32 "us (%" PRId32 "~%" PRId32 "), 中断%" PRIu32 "次, 平均%" PRIu32 "周期",
+                     stats.sw_presses, stats.hw_presses, stats.matched, stats.sw_only, stats.hw_only,
+                     stats.latency_avg_us, stats.latency_min_us, stats.latency_max_us,
+                     stats.isr_count, stats.isr_avg_cycles);
+            continue;
+        }
+        ESP_LOGI("MAIN", "快照: 扫描#%" PRIu32 ", 时间=%" PRId64 "us, 触摸=0x%04" PRIx32 ", 变化次数=%" PRIu32,
+                 snap.seq, snap.timestamp_us, snap.touched_mask, snap.change_count);
     }
 }
@@ -0,0 +1,408 @@
+/*
+ * 触摸高速采集实现
+ * 扫描钩子 (中断) 是环形缓冲区唯一的写者, 输出任务是唯一的读者, 头尾下标各自只由一方写, 不需要锁;
+ * 缓冲区满时丢弃新样本并计数, 不会阻塞中断. 输出任务每TOUCH_CAPTURE_FLUSH_MS把缓冲区中的样本
+ * 编码成帧, 攒满一块后一次写到串口或文件
+ */
+
+#include "touch_capture.h"
+#include "touch_sensor.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "power_manager.h"
+#include <stdio.h>
+#include <inttypes.h>
+
+static const char *TAG = "TOUCH_CAPTURE";
+
+#define TOUCH_CAPTURE_BUF_SIZE      512     // 输出块大小
+#define TOUCH_CAPTURE_FRAME_MAX     (4 + 8 + 6 * TOUCH_CAPTURE_MAX_PADS)    // 最长的帧 (样本帧)
+#define TOUCH_CAPTURE_UART_TX_BUF   4096    // 串口发送缓冲区
+
+// 环形缓冲区中的一个样本
+typedef struct {
+    uint32_t time_us;                   // 扫描时间低32位
+    uint16_t seq;                       // 扫描序号低16位, 主机据此发现丢失的扫描
+    uint16_t touched;                   // 触摸状态位图
+    uint32_t raw[TOUCH_CAPTURE_MAX_PADS];
+    uint32_t filtered[TOUCH_CAPTURE_MAX_PADS];
+} touch_capture_sample_t;
+
+static touch_capture_sample_t ring[TOUCH_CAPTURE_RING_LEN];
+static uint32_t ring_head = 0;          // 只由中断写
+static uint32_t ring_tail = 0;          // 只由输出任务写
+static uint32_t captured = 0;           // 只由中断写
+static uint32_t dropped = 0;            // 只由中断写
+static uint32_t bytes_out = 0;          // 只由输出任务写
+static bool capturing = false;          // 中断是否记录样本
+
+static touch_capture_config_t config;
+static touch_pad_t pads[TOUCH_CAPTURE_MAX_PADS];
+static uint8_t pad_count = 0;
+static FILE *capture_file = NULL;
+static TaskHandle_t capture_task_handle = NULL;
+static TaskHandle_t stop_waiter = NULL;
+static portMUX_TYPE capture_lock = portMUX_INITIALIZER_UNLOCKED;   // 保护任务句柄和停止请求
+static bool stop_requested = false;
+static power_lock_handle_t pm_lock = NULL;     // 输出期间持有, 不能进入自动轻度睡眠
+
+/**
+ * @brief 扫描钩子: 把选定通道复制到环形缓冲区, 在触摸中断中调用
+ */
+static void touch_capture_hook(const touch_sensor_snapshot_t *snap, void *arg)
+{
+    if (!__atomic_load_n(&capturing, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    uint32_t head = ring_head;
+    if (head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) >= TOUCH_CAPTURE_RING_LEN) {
+        __atomic_store_n(&dropped, dropped + 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    touch_capture_sample_t *s = &ring[head & (TOUCH_CAPTURE_RING_LEN - 1)];
+    s->time_us = (uint32_t)snap->timestamp_us;
+    s->seq = (uint16_t)snap->seq;
+    s->touched = (uint16_t)snap->touched_mask;
+    for (int i = 0; i < pad_count; i++) {
+        s->raw[i] = snap->pads[pads[i]].raw;
+        s->filtered[i] = snap->pads[pads[i]].filtered;
+    }
+    __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+
+    uint32_t n = captured + 1;
+    __atomic_store_n(&captured, n, __ATOMIC_RELAXED);
+    if (config.sample_limit != 0 && n >= config.sample_limit) {
+        __atomic_store_n(&capturing, false, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief 小端写入多字节字段
+ */
+static uint8_t *touch_capture_put(uint8_t *p, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        *p++ = (uint8_t)(value >> (8 * i));
+    }
+    return p;
+}
+
+/**
+ * @brief 补上帧头和校验
+ * @param frame 帧起始位置, 数据从frame+3开始
+ * @param type 帧类型
+ * @param end 数据末尾
+ * @return 帧长度
+ */
+static size_t touch_capture_seal(uint8_t *frame, uint8_t type, uint8_t *end)
+{
+    uint8_t len = (uint8_t)(end - frame - 3);
+    uint8_t sum = 0;
+
+    frame[0] = TOUCH_CAPTURE_SYNC;
+    frame[1] = type;
+    frame[2] = len;
+    for (uint8_t *p = frame + 1; p < end; p++) {
+        sum += *p;
+    }
+    *end = sum;
+    return (size_t)(end - frame) + 1;
+}
+
+/**
+ * @brief 编码流头
+ */
+static size_t touch_capture_encode_header(uint8_t *frame)
+{
+    uint8_t *p = frame + 3;
+
+    *p++ = TOUCH_CAPTURE_VERSION;
+    p = touch_capture_put(p, TOUCH_MEAS_INTERVAL_CYCLES, 2);
+    *p++ = pad_count;
+    for (int i = 0; i < pad_count; i++) {
+        *p++ = (uint8_t)pads[i];
+    }
+    return touch_capture_seal(frame, TOUCH_CAPTURE_FRAME_HEADER, p);
+}
+
+/**
+ * @brief 编码一个样本, 原始值和平滑值只有22位有效, 各用3字节
+ */
+static size_t touch_capture_encode_sample(uint8_t *frame, const touch_capture_sample_t *s)
+{
+    uint8_t *p = frame + 3;
+
+    p = touch_capture_put(p, s->seq, 2);
+    p = touch_capture_put(p, s->time_us, 4);
+    p = touch_capture_put(p, s->touched, 2);
+    for (int i = 0; i < pad_count; i++) {
+        p = touch_capture_put(p, s->raw[i] > 0xFFFFFF ? 0xFFFFFF : s->raw[i], 3);
+        p = touch_capture_put(p, s->filtered[i] > 0xFFFFFF ? 0xFFFFFF : s->filtered[i], 3);
+    }
+    return touch_capture_seal(frame, TOUCH_CAPTURE_FRAME_SAMPLE, p);
+}
+
+/**
+ * @brief 编码丢弃计数
+ */
+static size_t touch_capture_encode_drop(uint8_t *frame, uint32_t total)
+{
+    uint8_t *p = touch_capture_put(frame + 3, total, 4);
+    return touch_capture_seal(frame, TOUCH_CAPTURE_FRAME_DROP, p);
+}
+
+/**
+ * @brief 写到输出目标
+ */
+static void touch_capture_write(const uint8_t *data, size_t len)
+{
+    if (len == 0) {
+        return;
+    }
+    if (config.sink == TOUCH_CAPTURE_SINK_UART) {
+        uart_write_bytes(config.uart_port, data, len);
+    } else if (fwrite(data, 1, len, capture_file) != len) {
+        ESP_LOGE(TAG, "写文件失败");
+    }
+    bytes_out += len;
+}
+
+/**
+ * @brief 打开输出目标
+ */
+static esp_err_t touch_capture_open_sink(void)
+{
+    if (config.sink == TOUCH_CAPTURE_SINK_FILE) {
+        capture_file = fopen(config.path, "wb");
+        if (capture_file == NULL) {
+            ESP_LOGE(TAG, "打开文件失败: %s", config.path);
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+
+    uart_config_t uart_config = {
+        .baud_rate = config.baud_rate,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    esp_err_t ret = uart_param_config(config.uart_port, &uart_config);
+    if (ret == ESP_OK) {
+        ret = uart_set_pin(config.uart_port, config.tx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    }
+    if (ret == ESP_OK) {
+        // 接收缓冲区必须大于硬件FIFO, 不使用
+        ret = uart_driver_install(config.uart_port, 256, TOUCH_CAPTURE_UART_TX_BUF, 0, NULL, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "配置串口%d失败: %s", config.uart_port, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief 关闭输出目标
+ */
+static void touch_capture_close_sink(void)
+{
+    if (config.sink == TOUCH_CAPTURE_SINK_FILE) {
+        fclose(capture_file);
+        capture_file = NULL;
+    } else {
+        uart_wait_tx_done(config.uart_port, pdMS_TO_TICKS(1000));
+        uart_driver_delete(config.uart_port);
+    }
+}
+
+/**
+ * @brief 输出缓冲区中的所有样本
+ * @param since_header 上一次流头之后输出的样本数
+ * @param reported_drop 上一次输出的丢弃计数
+ */
+static void touch_capture_drain(uint32_t *since_header, uint32_t *reported_drop)
+{
+    uint8_t buf[TOUCH_CAPTURE_BUF_SIZE];
+    size_t len = 0;
+    uint32_t tail = ring_tail;
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    uint32_t drop = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+    if (tail == head && drop == *reported_drop) {
+        return;
+    }
+
+    power_manager_lock_acquire(pm_lock);
+    while (tail != head) {
+        if (len + 2 * TOUCH_CAPTURE_FRAME_MAX > sizeof(buf)) {
+            touch_capture_write(buf, len);
+            len = 0;
+        }
+        if (*since_header >= TOUCH_CAPTURE_HEADER_EVERY) {
+            len += touch_capture_encode_header(buf + len);
+            *since_header = 0;
+        }
+        len += touch_capture_encode_sample(buf + len, &ring[tail & (TOUCH_CAPTURE_RING_LEN - 1)]);
+        (*since_header)++;
+        tail++;
+        // 编码完立刻归还, 中断可以继续写
+        __atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    if (drop != *reported_drop) {
+        if (len + TOUCH_CAPTURE_FRAME_MAX > sizeof(buf)) {
+            touch_capture_write(buf, len);
+            len = 0;
+        }
+        len += touch_capture_encode_drop(buf + len, drop);
+        *reported_drop = drop;
+    }
+    touch_capture_write(buf, len);
+    if (config.sink == TOUCH_CAPTURE_SINK_UART) {
+        // 等发送缓冲区发完再释放锁, 否则自动轻度睡眠会打断发送
+        uart_wait_tx_done(config.uart_port, portMAX_DELAY);
+    }
+    power_manager_lock_release(pm_lock);
+}
+
+/**
+ * @brief 输出任务: 定期把缓冲区中的样本编码输出, 停止或达到样本数后退出
+ */
+static void touch_capture_task(void *pvParameters)
+{
+    uint32_t since_header = TOUCH_CAPTURE_HEADER_EVERY;    // 第一个样本之前先输出流头
+    uint32_t reported_drop = 0;
+
+    while (1) {
+        bool finished = !__atomic_load_n(&capturing, __ATOMIC_RELAXED);
+        touch_capture_drain(&since_header, &reported_drop);
+        if (finished || __atomic_load_n(&stop_requested, __ATOMIC_RELAXED)) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(TOUCH_CAPTURE_FLUSH_MS));
+    }
+
+    // 先取消钩子, 再输出取消之前写入的最后几个样本
+    __atomic_store_n(&capturing, false, __ATOMIC_RELAXED);
+    touch_sensor_set_scan_hook(NULL, NULL);
+    touch_capture_drain(&since_header, &reported_drop);
+    touch_capture_close_sink();
+
+    ESP_LOGI(TAG, "采集结束: %" PRIu32 "个样本, 丢弃%" PRIu32 "个, 输出%" PRIu32 "字节",
+             captured, dropped, bytes_out);
+
+    taskENTER_CRITICAL(&capture_lock);
+    capture_task_handle = NULL;
+    TaskHandle_t waiter = stop_waiter;
+    taskEXIT_CRITICAL(&capture_lock);
+    if (waiter != NULL) {
+        xTaskNotifyGive(waiter);
+    }
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 开始采集
+ */
+esp_err_t touch_capture_start(const touch_capture_config_t *cfg)
+{
+    if (cfg == NULL || cfg->pad_mask == 0 || (cfg->pad_mask & ~TOUCH_PAD_MASK) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cfg->sink == TOUCH_CAPTURE_SINK_FILE && cfg->path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (capture_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    config = *cfg;
+    pad_count = 0;
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!(config.pad_mask & (1UL << pad))) {
+            continue;
+        }
+        if (pad_count >= TOUCH_CAPTURE_MAX_PADS) {
+            ESP_LOGE(TAG, "最多同时采集%d个通道", TOUCH_CAPTURE_MAX_PADS);
+            return ESP_ERR_INVALID_ARG;
+        }
+        pads[pad_count++] = pad;
+    }
+
+    // 没有PM锁时照常输出, 只是不统计
+    if (pm_lock == NULL && power_manager_lock_create(ESP_PM_NO_LIGHT_SLEEP, "touch_capture", &pm_lock) != ESP_OK) {
+        ESP_LOGW(TAG, "创建采集PM锁失败");
+    }
+
+    esp_err_t ret = touch_capture_open_sink();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ring_head = 0;
+    ring_tail = 0;
+    captured = 0;
+    dropped = 0;
+    bytes_out = 0;
+    stop_requested = false;
+    stop_waiter = NULL;
+    capturing = true;
+
+    ret = touch_sensor_set_scan_hook(touch_capture_hook, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "设置扫描钩子失败: %s", esp_err_to_name(ret));
+        capturing = false;
+        touch_capture_close_sink();
+        return ret;
+    }
+
+    if (xTaskCreate(touch_capture_task, "touch_capture", TOUCH_CAPTURE_TASK_STACK, NULL,
+                    TOUCH_CAPTURE_TASK_PRIO, &capture_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "创建采集任务失败");
+        capturing = false;
+        touch_sensor_set_scan_hook(NULL, NULL);
+        touch_capture_close_sink();
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "开始采集: 通道0x%04" PRIx32 ", 输出到%s", config.pad_mask,
+             (config.sink == TOUCH_CAPTURE_SINK_UART) ? "串口" : config.path);
+    return ESP_OK;
+}
+
+/**
+ * @brief 停止采集
+ */
+esp_err_t touch_capture_stop(void)
+{
+    taskENTER_CRITICAL(&capture_lock);
+    if (capture_task_handle == NULL) {
+        taskEXIT_CRITICAL(&capture_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    stop_waiter = xTaskGetCurrentTaskHandle();
+    stop_requested = true;
+    taskEXIT_CRITICAL(&capture_lock);
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取采集统计
+ */
+esp_err_t touch_capture_get_stats(touch_capture_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    stats->captured = __atomic_load_n(&captured, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+    stats->bytes = __atomic_load_n(&bytes_out, __ATOMIC_RELAXED);
+    stats->running = (capture_task_handle != NULL);
+    return ESP_OK;
+}
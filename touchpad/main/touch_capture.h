@@ -0,0 +1,108 @@
+/*
+ * 触摸高速采集头文件
+ * 通过触摸驱动的扫描钩子在每次扫描完成时把选定通道的原始值和平滑值复制到环形缓冲区,
+ * 由低优先级任务编码成紧凑的二进制帧写到串口或文件 (SD卡), 用于离线调整阈值和滤波参数;
+ * 主机端用 tools/touch_capture_decode.py 解码成CSV
+ */
+
+#ifndef TOUCH_CAPTURE_H
+#define TOUCH_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 采集配置
+#define TOUCH_CAPTURE_MAX_PADS      4       // 最多同时采集的通道数
+#define TOUCH_CAPTURE_RING_LEN      256     // 环形缓冲区能存的扫描次数 (2的幂)
+#define TOUCH_CAPTURE_FLUSH_MS      50      // 输出任务的轮询周期
+#define TOUCH_CAPTURE_HEADER_EVERY  256     // 每多少个样本重发一次流头, 主机可以从流中间开始解码
+#define TOUCH_CAPTURE_TASK_STACK    3072    // 输出任务栈大小
+#define TOUCH_CAPTURE_TASK_PRIO     2       // 输出任务优先级, 低于触摸检测任务
+#define TOUCH_CAPTURE_UART_TX_PIN   17      // 默认串口输出引脚
+#define TOUCH_CAPTURE_UART_BAUD     921600  // 默认串口波特率
+
+// 帧格式: 0xA5 | 类型 | 长度 | 数据 | 校验 (类型到数据末尾逐字节求和的低8位), 多字节字段小端
+#define TOUCH_CAPTURE_SYNC          0xA5
+#define TOUCH_CAPTURE_VERSION       1
+#define TOUCH_CAPTURE_FRAME_HEADER  0x01    // 版本, 扫描间隔(u16, RTC慢速时钟周期), 通道数, 通道号...
+#define TOUCH_CAPTURE_FRAME_SAMPLE  0x02    // 序号(u16), 时间us(u32), 触摸位图(u16), 每通道: 原始值(u24) 平滑值(u24)
+#define TOUCH_CAPTURE_FRAME_DROP    0x03    // 累计丢弃的样本数(u32)
+
+/**
+ * @brief 输出目标
+ */
+typedef enum {
+    TOUCH_CAPTURE_SINK_UART,            // 串口, 建议使用单独的串口, 不与日志混在一起
+    TOUCH_CAPTURE_SINK_FILE,            // 文件, 如挂载SD卡后的 "/sdcard/touch.bin"
+} touch_capture_sink_t;
+
+/**
+ * @brief 采集配置
+ */
+typedef struct {
+    uint32_t pad_mask;                  // 采集的通道, 必须在TOUCH_PAD_MASK中
+    touch_capture_sink_t sink;          // 输出目标
+    uart_port_t uart_port;              // 串口号 (SINK_UART)
+    int tx_pin;                         // 串口输出引脚, UART_PIN_NO_CHANGE表示不改 (SINK_UART)
+    int baud_rate;                      // 串口波特率 (SINK_UART)
+    const char *path;                   // 文件路径 (SINK_FILE)
+    uint32_t sample_limit;              // 采集多少次扫描后自动停止, 0表示直到touch_capture_stop
+} touch_capture_config_t;
+
+/**
+ * @brief 默认串口输出配置
+ */
+#define TOUCH_CAPTURE_UART_DEFAULT_CONFIG(mask) {   \
+    .pad_mask = (mask),                             \
+    .sink = TOUCH_CAPTURE_SINK_UART,                \
+    .uart_port = UART_NUM_1,                        \
+    .tx_pin = TOUCH_CAPTURE_UART_TX_PIN,            \
+    .baud_rate = TOUCH_CAPTURE_UART_BAUD,           \
+    .path = NULL,                                   \
+    .sample_limit = 0,                              \
+}
+
+/**
+ * @brief 采集统计
+ */
+typedef struct {
+    uint32_t captured;                  // 写入环形缓冲区的样本数
+    uint32_t dropped;                   // 环形缓冲区满时丢弃的样本数
+    uint32_t bytes;                     // 已输出的字节数
+    bool running;                       // 是否正在采集
+} touch_capture_stats_t;
+
+/**
+ * @brief 开始采集
+ * @note 需要先初始化触摸驱动; 中断中只复制数据, 编码和输出都在低优先级任务中完成,
+ *       不影响触摸检测的时序
+ * @param config 配置
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 配置无效, ESP_ERR_INVALID_STATE 已在采集或触摸驱动未初始化,
+ *         其他值表示打开输出目标失败
+ */
+esp_err_t touch_capture_start(const touch_capture_config_t *config);
+
+/**
+ * @brief 停止采集, 输出缓冲区中剩余的样本后返回
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 没有在采集
+ */
+esp_err_t touch_capture_stop(void);
+
+/**
+ * @brief 获取采集统计
+ * @param stats 返回的统计数据
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t touch_capture_get_stats(touch_capture_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOUCH_CAPTURE_H
@@ -5,75 +5,731 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "power_manager.h"
 #include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
 
 static const char *TAG = "TOUCH_SENSOR";
 
+// 中断类型: 对比模式的软件路径每次扫描完成处理一次, 硬件判定只在状态变化时处理; 测量超时时恢复扫描
+#define TOUCH_INTR_MASK_SW (TOUCH_PAD_INTR_MASK_SCAN_DONE | TOUCH_PAD_INTR_MASK_TIMEOUT)
+#define TOUCH_INTR_MASK_HW (TOUCH_PAD_INTR_MASK_ACTIVE | TOUCH_PAD_INTR_MASK_INACTIVE | TOUCH_PAD_INTR_MASK_TIMEOUT)
+
+// 定点数小数位数
+#define TOUCH_Q                 8
+
+// 单通道内部状态: 对比模式下在扫描完成中断中更新, 自适应模式下由跟踪定时器更新
+typedef struct {
+    uint32_t raw;           // 最近一次扫描的原始值
+    int32_t filtered;       // 平滑值 (Q8)
+    int32_t baseline;       // 基准值 (Q8)
+    int32_t noise;          // 噪声估计 (Q8)
+    uint32_t press_delta;   // 按下阈值相对基准值的增量
+    uint32_t release_delta; // 释放阈值相对基准值的增量
+    bool seeded;            // 基准值是否已初始化
+    uint32_t hw_smooth;     // 硬件平滑值
+    uint32_t hw_benchmark;  // 硬件基准值
+    uint32_t hw_thresh;     // 硬件阈值 (相对硬件基准值的增量)
+} touch_channel_t;
+
+// 对比模式下单个通道的一次按下
+typedef struct {
+    int64_t sw_time;        // 软件检测到按下的时间
+    int64_t hw_time;        // 硬件检测到按下的时间
+    bool sw_seen;
+    bool hw_seen;
+    bool matched;           // 两条路径都已检测到
+} touch_ab_pad_t;
+
 // 全局变量
-static uint32_t touch_value = 0;
-static bool is_touched = false;
+static touch_channel_t channels[TOUCH_PAD_MAX];     // 按通道号索引, 只使用TOUCH_PAD_MASK中的通道
+static uint32_t touched_mask = 0;                   // 触摸状态位图, 只在中断中访问
+static uint32_t change_count = 0;                   // 触摸状态变化次数, 只在中断中写
+static uint32_t reseed_mask = 0;                    // 下一次扫描需要重新初始化基准值的通道
+static uint32_t sw_touched_mask = 0;                // 对比模式下软件路径的触摸状态, 只在中断中访问
+static touch_sensor_hw_config_t hw_config = TOUCH_SENSOR_HW_DEFAULT_CONFIG();
+static power_lock_handle_t pm_lock = NULL;          // 检测任务处理事件期间持有, 回调运行在最高频率
+static power_lock_handle_t scan_pm_lock = NULL;     // 需要每次扫描完成中断时持有, 扫描完成不能唤醒自动轻度睡眠
+static esp_timer_handle_t track_timer = NULL;       // 自适应模式的低频基准值跟踪
+
+// 热状态: 深度睡眠前保存已经稳定的基准值和硬件阈值, 唤醒复位后不用重新建立
+#define TOUCH_RTC_MAGIC         0x54434831          // "TCH1"
+typedef struct {
+    uint32_t magic;
+    uint32_t pad_mask;                              // 保存时的通道, 与当前配置不同时不使用
+    touch_detect_mode_t mode;                       // 保存时的判定方式
+    int32_t baseline[TOUCH_PAD_MAX];                // 软件基准值 (Q8)
+    int32_t noise[TOUCH_PAD_MAX];                   // 噪声估计 (Q8)
+    uint32_t hw_thresh[TOUCH_PAD_MAX];              // 硬件阈值
+} touch_rtc_state_t;
+static RTC_DATA_ATTR touch_rtc_state_t rtc_state;
+static bool restored = false;                       // 本次启动是否从RTC内存恢复
+
+// 对比统计, 中断中更新
+static portMUX_TYPE ab_lock = portMUX_INITIALIZER_UNLOCKED;
+static touch_ab_pad_t ab_pads[TOUCH_PAD_MAX];
+static touch_sensor_ab_stats_t ab_stats;
+static int64_t ab_latency_sum = 0;
+static uint64_t ab_isr_cycles = 0;
+
+// 快照: 中断是唯一的写者, 读者通过顺序号判断是否读到了完整的一次扫描
+static uint32_t snap_seq = 0;                       // 奇数表示正在写
+static touch_sensor_snapshot_t snap_data;
+
+// 等待状态变化或下一次扫描的任务
+typedef struct {
+    SemaphoreHandle_t sem;
+    bool every_scan;        // true: 每次扫描唤醒, false: 只在状态变化时唤醒
+} touch_waiter_t;
+static portMUX_TYPE wait_lock = portMUX_INITIALIZER_UNLOCKED;
+static touch_waiter_t waiters[TOUCH_MAX_WAITERS];
+static uint32_t scan_waiter_count = 0;  // 等待每次扫描的任务数, 为0时中断不进入临界区
+static touch_scan_hook_t scan_hook = NULL;  // 扫描钩子, 在中断中调用
+static void *scan_hook_arg = NULL;
 static TaskHandle_t touch_task_handle = NULL;
-static uint32_t touch_baseline = 0;    // 基准值
-static uint32_t touch_threshold = 0;   // 动态阈值
-static bool is_calibrated = false;     // 是否已校准
+static QueueHandle_t touch_event_queue = NULL;  // 中断 -> 回调任务
+static bool is_initialized = false;     // 是否已初始化
 static touch_interrupt_callback_t interrupt_callback = NULL;  // 中断回调函数
 static bool interrupt_enabled = false;  // 中断是否启用
 
+// 中断事件
+typedef struct {
+    uint32_t intr_mask;     // 中断类型 (TOUCH_PAD_INTR_MASK_*)
+    uint32_t touched_mask;  // 各通道触摸状态位图
+    uint32_t changed_mask;  // 状态发生变化的通道
+    int64_t time_us;        // 中断发生时间
+} touch_event_t;
+
+/**
+ * @brief 通道是否启用
+ */
+static inline bool touch_sensor_pad_enabled(touch_pad_t pad)
+{
+    return pad < TOUCH_PAD_MAX && (TOUCH_PAD_MASK & (1UL << pad)) != 0;
+}
+
+/**
+ * @brief 按基准值和噪声估计计算按下/释放阈值增量
+ */
+static void touch_sensor_update_deltas(touch_channel_t *ch)
+{
+    uint32_t base = (uint32_t)ch->baseline >> TOUCH_Q;
+    uint32_t press = base * TOUCH_PRESS_PERMILLE / 1000;
+    uint32_t noise_floor = ((uint32_t)ch->noise >> TOUCH_Q) * TOUCH_NOISE_MARGIN;
+    if (press < noise_floor) {
+        press = noise_floor;
+    }
+    ch->press_delta = press;
+    ch->release_delta = press * TOUCH_RELEASE_PERCENT / 100;
+}
+
+/**
+ * @brief 处理一个通道的新样本: 平滑、基准值跟踪、噪声估计和带迟滞的触摸判定
+ * @note 只使用整数运算, 在中断中执行
+ * @return 新的触摸状态
+ */
+static bool touch_sensor_update_channel(touch_channel_t *ch, uint32_t raw, bool touched)
+{
+    int32_t sample = (int32_t)(raw << TOUCH_Q);
+    
+    ch->raw = raw;
+    if (!ch->seeded) {
+        ch->filtered = sample;
+        ch->baseline = sample;
+        ch->noise = 0;
+        ch->seeded = true;
+        touched = false;
+    }
+    
+    // 平滑值和噪声估计 (原始值相对平滑值的平均偏差)
+    int32_t dev = sample - ch->filtered;
+    ch->filtered += dev >> TOUCH_FILTER_SHIFT;
+    
+    // 阈值随基准值和噪声变化, 按下和释放之间留有迟滞
+    touch_sensor_update_deltas(ch);
+    
+    int32_t delta = (ch->filtered - ch->baseline) >> TOUCH_Q;
+    if (touched) {
+        touched = (delta >= (int32_t)ch->release_delta);
+    } else {
+        touched = (delta > (int32_t)ch->press_delta);
+    }
+    
+    // 只在未触摸且远离阈值时跟踪基准值: 上升慢, 下降快 (手指在启动时按着也能恢复)
+    if (!touched && delta < (int32_t)ch->release_delta) {
+        int32_t diff = ch->filtered - ch->baseline;
+        ch->baseline += diff >> ((diff < 0) ? TOUCH_BASELINE_FAST_SHIFT : TOUCH_BASELINE_SHIFT);
+        int32_t abs_dev = (dev < 0) ? -dev : dev;
+        ch->noise += (abs_dev - ch->noise) >> TOUCH_NOISE_SHIFT;
+    }
+    return touched;
+}
+
+/**
+ * @brief 自适应模式: 用一次原始值和硬件平滑值跟踪基准值和噪声, 返回新的按下阈值增量
+ * @note 硬件平滑值已经在每次扫描时滤波, 这里只需要低频跟踪; 调用者保证没有通道被触摸
+ */
+static uint32_t touch_sensor_track_channel(touch_channel_t *ch, uint32_t raw, uint32_t smooth)
+{
+    int32_t sample = (int32_t)(smooth << TOUCH_Q);
+    
+    ch->raw = raw;
+    if (!ch->seeded) {
+        ch->baseline = sample;
+        ch->noise = 0;
+        ch->seeded = true;
+    }
+    ch->filtered = sample;
+    
+    // 噪声估计: 单次原始值相对硬件平滑值的平均偏差
+    int32_t dev = (int32_t)(raw << TOUCH_Q) - sample;
+    int32_t abs_dev = (dev < 0) ? -dev : dev;
+    ch->noise += (abs_dev - ch->noise) >> TOUCH_TRACK_NOISE_SHIFT;
+    
+    // 上升慢, 下降快
+    int32_t diff = sample - ch->baseline;
+    ch->baseline += diff >> ((diff < 0) ? TOUCH_TRACK_BASELINE_FAST_SHIFT : TOUCH_TRACK_BASELINE_SHIFT);
+    
+    touch_sensor_update_deltas(ch);
+    return ch->press_delta;
+}
+
+/**
+ * @brief 发布本次扫描的快照 (顺序锁写端, 只在中断中调用)
+ */
+static void touch_sensor_publish(int64_t time_us)
+{
+    uint32_t seq = snap_seq;
+    
+    // 先把顺序号变成奇数, 再写数据, 最后变回偶数
+    __atomic_store_n(&snap_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    snap_data.seq = (seq + 2) / 2;
+    snap_data.timestamp_us = time_us;
+    snap_data.touched_mask = touched_mask;
+    snap_data.change_count = change_count;
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        const touch_channel_t *ch = &channels[pad];
+        touch_pad_data_t *d = &snap_data.pads[pad];
+        // 平滑值、基准值和阈值都来自外设; 自适应和对比模式另有软件噪声估计
+        d->raw = (hw_config.mode == TOUCH_DETECT_AB) ? ch->raw : ch->hw_smooth;
+        d->filtered = ch->hw_smooth;
+        d->baseline = ch->hw_benchmark;
+        d->threshold = ch->hw_benchmark + ch->hw_thresh;
+        d->release_threshold = d->threshold;
+        d->noise = (hw_config.mode == TOUCH_DETECT_HARDWARE) ? 0 : (uint32_t)ch->noise >> TOUCH_Q;
+    }
+    
+    __atomic_store_n(&snap_seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 顺序锁读端: 等到没有正在进行的写入, 返回当前顺序号
+ */
+static inline uint32_t touch_sensor_read_begin(void)
+{
+    uint32_t seq;
+    // 写者是中断, 同一核心上的读者不会看到奇数; 另一核心最多等一次发布的时间
+    while ((seq = __atomic_load_n(&snap_seq, __ATOMIC_ACQUIRE)) & 1) {
+    }
+    return seq;
+}
+
+/**
+ * @brief 顺序锁读端: 读取期间有新的写入时返回true, 需要重读
+ */
+static inline bool touch_sensor_read_retry(uint32_t seq)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&snap_seq, __ATOMIC_RELAXED) != seq;
+}
+
+/**
+ * @brief 唤醒等待的任务
+ * @param changed 本次扫描触摸状态是否变化
+ */
+static void touch_sensor_wake_waiters(bool changed)
+{
+    BaseType_t task_woken = pdFALSE;
+    
+    portENTER_CRITICAL_ISR(&wait_lock);
+    for (int i = 0; i < TOUCH_MAX_WAITERS; i++) {
+        if (waiters[i].sem != NULL && (changed || waiters[i].every_scan)) {
+            xSemaphoreGiveFromISR(waiters[i].sem, &task_woken);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&wait_lock);
+    
+    if (task_woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief 软件路径: 读取原始值, 滤波并判定所有启用通道
+ * @return 软件判定的触摸状态位图
+ */
+static uint32_t touch_sensor_software_scan(uint32_t previous)
+{
+    uint32_t reseed = __atomic_exchange_n(&reseed_mask, 0, __ATOMIC_RELAXED);
+    uint32_t current = 0;
+    
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        if (reseed & (1UL << pad)) {
+            channels[pad].seeded = false;
+        }
+        uint32_t raw = 0;
+        touch_pad_read_raw_data(pad, &raw);
+        if (touch_sensor_update_channel(&channels[pad], raw, (previous & (1UL << pad)) != 0)) {
+            current |= (1UL << pad);
+        }
+    }
+    return current;
+}
+
+/**
+ * @brief 硬件路径: 只读取外设已经滤波好的平滑值和基准值
+ */
+static void touch_sensor_hardware_read(void)
+{
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        touch_pad_filter_read_smooth(pad, &channels[pad].hw_smooth);
+        touch_pad_read_benchmark(pad, &channels[pad].hw_benchmark);
+    }
+}
+
+/**
+ * @brief 对比模式: 按通道匹配两条路径的按下, 统计检测时间差和只有一条路径检测到的按下
+ */
+static void touch_sensor_ab_update(uint32_t sw_prev, uint32_t sw, uint32_t hw_prev, uint32_t hw, int64_t now)
+{
+    portENTER_CRITICAL_ISR(&ab_lock);
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        uint32_t bit = 1UL << pad;
+        if (!(TOUCH_PAD_MASK & bit)) {
+            continue;
+        }
+        touch_ab_pad_t *p = &ab_pads[pad];
+        if (sw & ~sw_prev & bit) {
+            ab_stats.sw_presses++;
+            if (!p->sw_seen) {
+                p->sw_seen = true;
+                p->sw_time = now;
+            }
+        }
+        if (hw & ~hw_prev & bit) {
+            ab_stats.hw_presses++;
+            if (!p->hw_seen) {
+                p->hw_seen = true;
+                p->hw_time = now;
+            }
+        }
+        if (p->sw_seen && p->hw_seen && !p->matched) {
+            int32_t diff = (int32_t)(p->hw_time - p->sw_time);
+            if (ab_stats.matched == 0 || diff < ab_stats.latency_min_us) {
+                ab_stats.latency_min_us = diff;
+            }
+            if (ab_stats.matched == 0 || diff > ab_stats.latency_max_us) {
+                ab_stats.latency_max_us = diff;
+            }
+            ab_stats.matched++;
+            ab_latency_sum += diff;
+            p->matched = true;
+        }
+        // 两条路径都已释放: 这次按下结束
+        if (!(sw & bit) && !(hw & bit) && (p->sw_seen || p->hw_seen)) {
+            if (!p->matched) {
+                if (p->sw_seen) {
+                    ab_stats.sw_only++;
+                } else {
+                    ab_stats.hw_only++;
+                }
+            }
+            *p = (touch_ab_pad_t){0};
+        }
+    }
+    portEXIT_CRITICAL_ISR(&ab_lock);
+}
+
 /**
- * @brief 触摸检测任务
+ * @brief 触摸中断: 处理硬件判定的状态变化, 对比模式下还处理每次扫描; 状态变化时通知检测任务
+ */
+static void touch_sensor_isr(void *arg)
+{
+    uint32_t start = esp_cpu_get_cycle_count();
+    uint32_t intr = touch_pad_read_intr_status_mask();
+    touch_event_t evt = {
+        .intr_mask = intr,
+        .time_us = esp_timer_get_time(),
+    };
+    bool scan_done = (intr & TOUCH_PAD_INTR_MASK_SCAN_DONE) != 0;
+    bool hw_change = (intr & (TOUCH_PAD_INTR_MASK_ACTIVE | TOUCH_PAD_INTR_MASK_INACTIVE)) != 0;
+    
+    if (scan_done || hw_change) {
+        uint32_t previous = touched_mask;
+        
+        // 状态寄存器一次给出所有通道的硬件判定结果
+        uint32_t current = touch_pad_get_status() & TOUCH_PAD_MASK;
+        touch_sensor_hardware_read();
+        if (hw_config.mode == TOUCH_DETECT_AB) {
+            uint32_t sw_prev = sw_touched_mask;
+            if (scan_done) {
+                sw_touched_mask = touch_sensor_software_scan(sw_prev);
+            }
+            touch_sensor_ab_update(sw_prev, sw_touched_mask, previous, current, evt.time_us);
+        }
+        
+        touched_mask = current;
+        evt.touched_mask = current;
+        evt.changed_mask = previous ^ current;
+        if (evt.changed_mask != 0) {
+            change_count++;
+        }
+        
+        touch_sensor_publish(evt.time_us);
+        
+        if (evt.changed_mask != 0 || __atomic_load_n(&scan_waiter_count, __ATOMIC_RELAXED) > 0) {
+            touch_sensor_wake_waiters(evt.changed_mask != 0);
+        }
+        
+        // 钩子在检测路径处理完之后调用, 每次扫描一次; 参数先于钩子写入, 读到钩子时参数一定有效
+        touch_scan_hook_t hook = __atomic_load_n(&scan_hook, __ATOMIC_ACQUIRE);
+        if (hook != NULL && scan_done) {
+            hook(&snap_data, scan_hook_arg);
+        }
+    }
+    
+    portENTER_CRITICAL_ISR(&ab_lock);
+    ab_stats.isr_count++;
+    ab_isr_cycles += esp_cpu_get_cycle_count() - start;
+    portEXIT_CRITICAL_ISR(&ab_lock);
+    
+    // 只有状态变化或超时才唤醒任务
+    if (evt.changed_mask == 0 && !(intr & TOUCH_PAD_INTR_MASK_TIMEOUT)) {
+        return;
+    }
+    BaseType_t task_woken = pdFALSE;
+    xQueueSendFromISR(touch_event_queue, &evt, &task_woken);
+    if (task_woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief 处理一个触摸事件: 恢复超时的扫描, 打印变化的通道并调用回调
+ * @param evt 中断发来的事件
+ */
+static void touch_sensor_handle_event(const touch_event_t *evt)
+{
+    // 测量超时会让FSM停在当前通道, 需要恢复扫描
+    if (evt->intr_mask & TOUCH_PAD_INTR_MASK_TIMEOUT) {
+        ESP_LOGW(TAG, "触摸测量超时, 恢复扫描");
+        touch_pad_timeout_resume();
+    }
+    
+    if (evt->changed_mask == 0) {
+        return;
+    }
+    
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (evt->changed_mask & (1UL << pad)) {
+            ESP_LOGI(TAG, "T%d: 原始值=%" PRIu32 ", 基准值=%" PRIu32 ", 阈值=%" PRIu32 "/%" PRIu32 ", 噪声=%" PRIu32 ", 状态=%s",
+                    pad, touch_sensor_get_value(pad), touch_sensor_get_baseline(pad),
+                    touch_sensor_get_threshold(pad), touch_sensor_get_release_threshold(pad),
+                    touch_sensor_get_noise(pad),
+                    (evt->touched_mask & (1UL << pad)) ? "已触摸" : "未触摸");
+        }
+    }
+    
+    // 检查状态变化并触发中断回调
+    if (interrupt_enabled && interrupt_callback) {
+        ESP_LOGI(TAG, "触摸状态变化，触发中断回调: 0x%04" PRIx32 " (中断到任务 %" PRId64 "us)",
+                evt->touched_mask, esp_timer_get_time() - evt->time_us);
+        interrupt_callback(evt->touched_mask, evt->changed_mask);
+    }
+}
+
+/**
+ * @brief 触摸检测任务, 阻塞等待状态变化事件并在任务上下文中调用回调
  * @param pvParameters 任务参数
  */
 static void touch_detection_task(void *pvParameters)
 {
-    uint32_t touch_value_raw = 0;
+    touch_event_t evt;
     
     ESP_LOGI(TAG, "触摸检测任务启动");
     
     while (1) {
-        // 读取原始触摸值
-        if (touch_pad_read_raw_data(TOUCH_PAD_NUM, &touch_value_raw) == ESP_OK) {
-            touch_value = touch_value_raw;
-            
-            // 判断是否触摸 (使用自适应阈值)
-            if (is_calibrated) {
-                bool previous_touched = is_touched;
-                
-                if (touch_value > touch_threshold) {
-                    is_touched = true;
-                    ESP_LOGI(TAG, "触摸检测: 原始值=%" PRIu32 ", 基准值=%" PRIu32 ", 阈值=%" PRIu32 ", 状态=已触摸", 
-                            touch_value_raw, touch_baseline, touch_threshold);
-                } else {
-                    is_touched = false;
-                    //ESP_LOGI(TAG, "触摸检测: 原始值=%" PRIu32 ", 基准值=%" PRIu32 ", 阈值=%" PRIu32 ", 状态=未触摸", 
-                            //touch_value_raw, touch_baseline, touch_threshold);
-                }
-                
-                // 检查状态变化并触发中断回调
-                if (interrupt_enabled && interrupt_callback && (previous_touched != is_touched)) {
-                    ESP_LOGI(TAG, "触摸状态变化，触发中断回调: %s -> %s", 
-                            previous_touched ? "已触摸" : "未触摸", 
-                            is_touched ? "已触摸" : "未触摸");
-                    interrupt_callback(is_touched);
-                }
-            } else {
-                ESP_LOGW(TAG, "触摸检测: 原始值=%" PRIu32 ", 状态=未校准", touch_value_raw);
-            }
-        } else {
-            ESP_LOGE(TAG, "读取原始触摸值失败");
+        // 没有事件时一直阻塞, 不会周期性唤醒
+        if (xQueueReceive(touch_event_queue, &evt, portMAX_DELAY) != pdTRUE) {
+            continue;
         }
         
-        // 延时100ms (0.1秒)
-        vTaskDelay(pdMS_TO_TICKS(100));
+        // 只在处理事件期间持有PM锁, 空闲时可以降频和自动轻度睡眠
+        power_manager_lock_acquire(pm_lock);
+        touch_sensor_handle_event(&evt);
+        power_manager_lock_release(pm_lock);
+    }
+}
+
+/**
+ * @brief 按判定方式选择中断类型: 只有对比模式常开扫描完成中断
+ */
+static uint32_t touch_sensor_intr_mask(void)
+{
+    return (hw_config.mode == TOUCH_DETECT_AB) ? (TOUCH_INTR_MASK_HW | TOUCH_INTR_MASK_SW) : TOUCH_INTR_MASK_HW;
+}
+
+/**
+ * @brief 自适应模式的基准值跟踪: 低频读取原始值和硬件平滑值, 按软件基准值和噪声估计重设硬件阈值
+ * @note 在esp_timer任务中每TOUCH_TRACK_INTERVAL_MS运行一次, 触摸判定仍然完全由外设完成
+ */
+static void touch_sensor_track(void *arg)
+{
+    uint32_t raw[TOUCH_PAD_MAX] = {0};
+    uint32_t smooth[TOUCH_PAD_MAX] = {0};
+    uint32_t thresh[TOUCH_PAD_MAX] = {0};
+    
+    // 按下期间平滑值不代表环境, 不跟踪也不改阈值; 重新初始化的请求留到下一次
+    if ((touch_pad_get_status() & TOUCH_PAD_MASK) != 0) {
+        return;
+    }
+    uint32_t reseed = __atomic_exchange_n(&reseed_mask, 0, __ATOMIC_RELAXED);
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (touch_sensor_pad_enabled(pad)) {
+            touch_pad_read_raw_data(pad, &raw[pad]);
+            touch_pad_filter_read_smooth(pad, &smooth[pad]);
+        }
+    }
+    
+    // 通道状态和快照与中断共用, 临界区屏蔽本核心上的触摸中断, 保证只有一个写者
+    portENTER_CRITICAL(&ab_lock);
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        if (reseed & (1UL << pad)) {
+            channels[pad].seeded = false;
+        }
+        thresh[pad] = touch_sensor_track_channel(&channels[pad], raw[pad], smooth[pad]);
+    }
+    touch_sensor_hardware_read();
+    touch_sensor_publish(esp_timer_get_time());
+    portEXIT_CRITICAL(&ab_lock);
+    
+    // 变化明显时才重写阈值寄存器
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad) || thresh[pad] == 0) {
+            continue;
+        }
+        uint32_t old = channels[pad].hw_thresh;
+        uint32_t diff = (thresh[pad] > old) ? thresh[pad] - old : old - thresh[pad];
+        if (diff > (old >> TOUCH_TRACK_RETUNE_SHIFT) && touch_pad_set_thresh(pad, thresh[pad]) == ESP_OK) {
+            channels[pad].hw_thresh = thresh[pad];
+        }
     }
 }
 
+/**
+ * @brief 配置硬件滤波、降噪和防水
+ */
+static esp_err_t touch_sensor_apply_hw_config(void)
+{
+    esp_err_t ret = ESP_OK;
+    
+    // 所有判定方式都由外设判定, 都需要硬件滤波
+    touch_filter_config_t filter = {
+        .mode = hw_config.filter_mode,
+        .debounce_cnt = hw_config.debounce_cnt,
+        .noise_thr = hw_config.noise_thr,
+        .jitter_step = hw_config.jitter_step,
+        .smh_lvl = hw_config.smooth_mode,
+    };
+    ret = touch_pad_filter_set_config(&filter);
+    if (ret == ESP_OK) {
+        ret = touch_pad_filter_enable();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "配置硬件滤波失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    if (hw_config.denoise) {
+        touch_pad_denoise_t denoise = {
+            .grade = hw_config.denoise_grade,
+            .cap_level = hw_config.denoise_cap,
+        };
+        ret = touch_pad_denoise_set_config(&denoise);
+        if (ret == ESP_OK) {
+            ret = touch_pad_denoise_enable();
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "配置降噪通道失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    
+    if (hw_config.waterproof) {
+        touch_pad_waterproof_t waterproof = {
+            .guard_ring_pad = hw_config.guard_pad,
+            .shield_driver = hw_config.shield_driver,
+        };
+        ret = touch_pad_waterproof_set_config(&waterproof);
+        if (ret == ESP_OK) {
+            ret = touch_pad_waterproof_enable();
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "配置防水功能失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 等待硬件基准值稳定后按基准值设置硬件阈值
+ */
+static esp_err_t touch_sensor_setup_hw_thresholds(void)
+{
+    // 从深度睡眠恢复时阈值已知, 不用等待硬件基准值稳定
+    if (!restored) {
+        vTaskDelay(pdMS_TO_TICKS(TOUCH_HW_SETTLE_MS));
+    }
+    
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        uint32_t benchmark = 0;
+        esp_err_t ret = touch_pad_read_benchmark(pad, &benchmark);
+        if (ret == ESP_OK) {
+            channels[pad].hw_benchmark = benchmark;
+            if (!restored) {
+                channels[pad].hw_thresh = benchmark * TOUCH_PRESS_PERMILLE / 1000;
+            }
+            ret = touch_pad_set_thresh(pad, channels[pad].hw_thresh);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "设置通道T%d硬件阈值失败: %s", pad, esp_err_to_name(ret));
+            return ret;
+        }
+        ESP_LOGI(TAG, "T%d 硬件基准值: %lu, 阈值: %lu", pad, (unsigned long)benchmark,
+                 (unsigned long)channels[pad].hw_thresh);
+    }
+    
+    // 硬件判定只在状态变化时发布快照, 先发布一次初始数据; 临界区屏蔽本核心上的触摸中断, 保证只有一个写者
+    if (hw_config.mode != TOUCH_DETECT_AB) {
+        portENTER_CRITICAL(&ab_lock);
+        touch_sensor_hardware_read();
+        touch_sensor_publish(esp_timer_get_time());
+        portEXIT_CRITICAL(&ab_lock);
+    }
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_set_hw_config(const touch_sensor_hw_config_t *config)
+{
+    if (config == NULL || config->mode > TOUCH_DETECT_AB) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config->waterproof) {
+        // 屏蔽通道不能同时作为普通通道, 保护环通道必须已经启用
+        if (TOUCH_PAD_MASK & (1UL << TOUCH_SHIELD_PAD)) {
+            ESP_LOGE(TAG, "防水模式下T%d用作屏蔽通道, 不能在TOUCH_PAD_MASK中", TOUCH_SHIELD_PAD);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (config->guard_pad != TOUCH_PAD_MAX && !touch_sensor_pad_enabled(config->guard_pad)) {
+            ESP_LOGE(TAG, "保护环通道T%d未启用", config->guard_pad);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    
+    hw_config = *config;
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_get_ab_stats(touch_sensor_ab_stats_t *stats, bool reset)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&ab_lock);
+    *stats = ab_stats;
+    int64_t latency_sum = ab_latency_sum;
+    uint64_t isr_cycles = ab_isr_cycles;
+    if (reset) {
+        ab_stats = (touch_sensor_ab_stats_t){0};
+        ab_latency_sum = 0;
+        ab_isr_cycles = 0;
+    }
+    portEXIT_CRITICAL(&ab_lock);
+    
+    stats->latency_avg_us = stats->matched ? (int32_t)(latency_sum / stats->matched) : 0;
+    stats->isr_avg_cycles = stats->isr_count ? (uint32_t)(isr_cycles / stats->isr_count) : 0;
+    return ESP_OK;
+}
+
+/**
+ * @brief 从RTC内存恢复基准值
+ * @note 只在深度睡眠唤醒且通道和判定方式与保存时相同时有效; 其他复位时清除旧数据
+ * @return 是否已恢复
+ */
+static bool touch_sensor_restore_state(void)
+{
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP || rtc_state.magic != TOUCH_RTC_MAGIC ||
+        rtc_state.pad_mask != TOUCH_PAD_MASK || rtc_state.mode != hw_config.mode) {
+        rtc_state.magic = 0;
+        return false;
+    }
+    
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        touch_channel_t *ch = &channels[pad];
+        ch->baseline = rtc_state.baseline[pad];
+        ch->filtered = rtc_state.baseline[pad];
+        ch->noise = rtc_state.noise[pad];
+        ch->hw_thresh = rtc_state.hw_thresh[pad];
+        ch->seeded = true;
+    }
+    ESP_LOGI(TAG, "触摸基准值已从睡眠前恢复");
+    return true;
+}
+
 esp_err_t touch_sensor_init(void)
 {
     esp_err_t ret = ESP_OK;
     
     ESP_LOGI(TAG, "初始化触摸传感器...");
     
+    if ((TOUCH_PAD_MASK & ~TOUCH_PAD_VALID_MASK) != 0 || TOUCH_PAD_MASK == 0) {
+        ESP_LOGE(TAG, "触摸通道配置无效: 0x%04lx", (unsigned long)TOUCH_PAD_MASK);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
     // 初始化触摸传感器驱动
     ret = touch_pad_init();
     if (ret != ESP_OK) {
@@ -81,10 +737,56 @@ esp_err_t touch_sensor_init(void)
         return ret;
     }
     
-    // 配置触摸传感器GPIO (GPIO6)
-    ret = touch_pad_config(TOUCH_PAD_NUM);
+    // 所有通道加入同一个FSM扫描周期; 硬件阈值先设为最大, 硬件判定模式在基准值稳定后再设置
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        ret = touch_pad_config(pad);
+        if (ret == ESP_OK) {
+            ret = touch_pad_set_thresh(pad, TOUCH_PAD_THRESHOLD_MAX);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "配置触摸通道T%d失败: %s", pad, esp_err_to_name(ret));
+            return ret;
+        }
+        channels[pad].seeded = false;
+    }
+    
+    // 深度睡眠唤醒: 恢复睡眠前的基准值, 由触摸唤醒时手指还在通道上也能立即判定为触摸
+    restored = touch_sensor_restore_state();
+    
+    ret = touch_sensor_apply_hw_config();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 扫描间隔决定检测延迟, 对比模式下也是扫描完成中断的频率
+    ret = touch_pad_set_measurement_interval(TOUCH_MEAS_INTERVAL_CYCLES);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "设置扫描间隔失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // 测量超时时产生中断, 由检测任务恢复扫描
+    touch_pad_timeout_set(true, TOUCH_PAD_THRESHOLD_MAX);
+    
+    touch_event_queue = xQueueCreate(TOUCH_EVENT_QUEUE_LEN, sizeof(touch_event_t));
+    if (touch_event_queue == NULL) {
+        ESP_LOGE(TAG, "创建触摸事件队列失败");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 硬件判定只在状态变化时中断, 对比模式每次扫描完成还要运行软件路径; 检测任务只在状态变化时唤醒
+    // 中断处理函数注册所有类型 (逐次扫描等待者和钩子会临时打开扫描完成中断), 只使能当前判定方式需要的类型
+    ret = touch_pad_isr_register(touch_sensor_isr, NULL, TOUCH_INTR_MASK_SW | TOUCH_INTR_MASK_HW);
+    if (ret == ESP_OK) {
+        ret = touch_pad_intr_enable(touch_sensor_intr_mask());
+    }
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "配置触摸传感器GPIO失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "注册触摸中断失败: %s", esp_err_to_name(ret));
+        vQueueDelete(touch_event_queue);
+        touch_event_queue = NULL;
         return ret;
     }
     
@@ -102,21 +804,44 @@ esp_err_t touch_sensor_init(void)
         return ret;
     }
     
-    // 等待触摸传感器稳定
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
-    ESP_LOGI(TAG, "触摸传感器初始化成功");
-    
-    // 等待系统稳定后进行校准
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    
-    // 执行初始校准
-    ret = touch_sensor_recalibrate();
+    ret = touch_sensor_setup_hw_thresholds();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "初始校准失败");
         return ret;
     }
     
+    // 自动轻度睡眠只由唤醒源唤醒: 按下通道 (ACTIVE中断) 唤醒CPU, 扫描完成不行, 需要逐次扫描时禁止轻度睡眠
+    if (scan_pm_lock == NULL && power_manager_lock_create(ESP_PM_NO_LIGHT_SLEEP, "touch_scan", &scan_pm_lock) != ESP_OK) {
+        ESP_LOGW(TAG, "创建触摸扫描PM锁失败");
+    }
+    if (hw_config.mode == TOUCH_DETECT_AB) {
+        power_manager_lock_acquire(scan_pm_lock);
+    } else {
+        esp_sleep_enable_touchpad_wakeup();
+    }
+    
+    // 自适应模式: 低频跟踪代替逐次扫描中断, 自动轻度睡眠期间每个周期唤醒一次; 睡眠错过的周期不补
+    if (hw_config.mode == TOUCH_DETECT_ADAPTIVE) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = touch_sensor_track,
+            .name = "touch_track",
+            .skip_unhandled_events = true,
+        };
+        ret = esp_timer_create(&timer_args, &track_timer);
+        if (ret == ESP_OK) {
+            ret = esp_timer_start_periodic(track_timer, (uint64_t)TOUCH_TRACK_INTERVAL_MS * 1000);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "启动基准值跟踪失败: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    
+    is_initialized = true;
+    
+    static const char *mode_names[] = {"自适应", "硬件", "对比"};
+    ESP_LOGI(TAG, "触摸传感器初始化成功, 通道: 0x%04lx, 判定方式: %s", (unsigned long)TOUCH_PAD_MASK,
+             mode_names[hw_config.mode]);
+    
     return ESP_OK;
 }
 
@@ -127,12 +852,22 @@ esp_err_t touch_sensor_start_task(void)
         return ESP_OK;
     }
     
+    if (!is_initialized) {
+        ESP_LOGE(TAG, "触摸传感器未初始化");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 没有PM锁时照常处理, 只是不统计
+    if (pm_lock == NULL && power_manager_lock_create(ESP_PM_CPU_FREQ_MAX, "touch", &pm_lock) != ESP_OK) {
+        ESP_LOGW(TAG, "创建触摸PM锁失败");
+    }
+    
     // 创建触摸检测任务
-    BaseType_t ret = xTaskCreate(touch_detection_task, 
-                                 "touch_detection", 
-                                 TOUCH_TASK_STACK_SIZE, 
-                                 NULL, 
-                                 TOUCH_TASK_PRIORITY, 
+    BaseType_t ret = xTaskCreate(touch_detection_task,
+                                 "touch_detection",
+                                 TOUCH_TASK_STACK_SIZE,
+                                 NULL,
+                                 TOUCH_TASK_PRIORITY,
                                  &touch_task_handle);
     
     if (ret != pdPASS) {
@@ -144,60 +879,320 @@ esp_err_t touch_sensor_start_task(void)
     return ESP_OK;
 }
 
-uint32_t touch_sensor_get_value(void)
+/**
+ * @brief 无锁读取一个通道的数据
+ */
+static void touch_sensor_read_pad(touch_pad_t pad, touch_pad_data_t *data)
+{
+    uint32_t seq;
+    do {
+        seq = touch_sensor_read_begin();
+        *data = snap_data.pads[pad];
+    } while (touch_sensor_read_retry(seq));
+}
+
+uint32_t touch_sensor_get_value(touch_pad_t pad)
 {
-    return touch_value;
+    if (!touch_sensor_pad_enabled(pad)) {
+        return 0;
+    }
+    touch_pad_data_t data;
+    touch_sensor_read_pad(pad, &data);
+    return data.raw;
 }
 
-bool touch_sensor_is_touched(void)
+bool touch_sensor_is_touched(touch_pad_t pad)
 {
-    return is_touched;
+    return pad < TOUCH_PAD_MAX && (touch_sensor_get_touched_mask() & (1UL << pad)) != 0;
 }
 
-esp_err_t touch_sensor_recalibrate(void)
+uint32_t touch_sensor_get_touched_mask(void)
 {
-    esp_err_t ret = ESP_OK;
-    uint32_t touch_value_raw = 0;
-    uint32_t sum = 0;
+    // 单个32位字, 读取本身是原子的
+    return __atomic_load_n(&snap_data.touched_mask, __ATOMIC_ACQUIRE);
+}
+
+esp_err_t touch_sensor_read_all(uint32_t raw[TOUCH_PAD_MAX], uint32_t *mask)
+{
+    if (raw == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    ESP_LOGI(TAG, "开始校准触摸传感器...");
+    // 同一次扫描的结果
+    uint32_t seq;
+    uint32_t touched;
+    do {
+        seq = touch_sensor_read_begin();
+        for (int pad = 0; pad < TOUCH_PAD_MAX; pad++) {
+            raw[pad] = snap_data.pads[pad].raw;
+        }
+        touched = snap_data.touched_mask;
+    } while (touch_sensor_read_retry(seq));
     
-    // 多次采样获取基准值
-    for (int i = 0; i < TOUCH_CALIBRATION_SAMPLES; i++) {
-        ret = touch_pad_read_raw_data(TOUCH_PAD_NUM, &touch_value_raw);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "校准采样失败: %s", esp_err_to_name(ret));
-            return ret;
+    if (mask != NULL) {
+        *mask = touched;
+    }
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_get_snapshot(touch_sensor_snapshot_t *snap)
+{
+    if (snap == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint32_t seq;
+    do {
+        seq = touch_sensor_read_begin();
+        memcpy(snap, &snap_data, sizeof(*snap));
+    } while (touch_sensor_read_retry(seq));
+    
+    snap->seq = seq / 2;
+    return ESP_OK;
+}
+
+/**
+ * @brief 等待下一次状态变化或下一次扫描
+ */
+static esp_err_t touch_sensor_wait(touch_sensor_snapshot_t *snap, TickType_t timeout, bool every_scan)
+{
+    if (snap == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 信号量在栈上, 不占用任务通知
+    StaticSemaphore_t sem_buf;
+    SemaphoreHandle_t sem = xSemaphoreCreateBinaryStatic(&sem_buf);
+    uint32_t *counter = every_scan ? &snap_seq : &snap_data.change_count;
+    uint32_t last = every_scan ? snap->seq * 2 : snap->change_count;
+    int slot = -1;
+    
+    // 检查和登记在同一个临界区内: 检查之后发生的变化一定会唤醒本任务
+    portENTER_CRITICAL(&wait_lock);
+    if (__atomic_load_n(counter, __ATOMIC_ACQUIRE) == last) {
+        for (int i = 0; i < TOUCH_MAX_WAITERS; i++) {
+            if (waiters[i].sem == NULL) {
+                waiters[i].sem = sem;
+                waiters[i].every_scan = every_scan;
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            portEXIT_CRITICAL(&wait_lock);
+            vSemaphoreDelete(sem);
+            return ESP_ERR_NO_MEM;
+        }
+        if (every_scan) {
+            scan_waiter_count++;
+        }
+    }
+    portEXIT_CRITICAL(&wait_lock);
+    
+    // 只有对比模式常开扫描完成中断, 其他模式有任务等待每次扫描时才打开
+    bool scan_intr = every_scan && slot >= 0 && hw_config.mode != TOUCH_DETECT_AB;
+    if (scan_intr) {
+        power_manager_lock_acquire(scan_pm_lock);
+        touch_pad_intr_enable(TOUCH_PAD_INTR_MASK_SCAN_DONE);
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (slot >= 0) {
+        // 中断先发布快照再唤醒, 被唤醒时计数已经更新
+        if (xSemaphoreTake(sem, timeout) != pdTRUE) {
+            ret = ESP_ERR_TIMEOUT;
+        }
+        
+        portENTER_CRITICAL(&wait_lock);
+        waiters[slot].sem = NULL;
+        if (every_scan) {
+            scan_waiter_count--;
         }
+        bool last_scan_waiter = (scan_waiter_count == 0 && scan_hook == NULL);
+        portEXIT_CRITICAL(&wait_lock);
         
-        sum += touch_value_raw;
-        ESP_LOGI(TAG, "校准采样 %d: %" PRIu32, i + 1, touch_value_raw);
+        if (scan_intr && last_scan_waiter) {
+            touch_pad_intr_disable(TOUCH_PAD_INTR_MASK_SCAN_DONE);
+        }
+        if (scan_intr) {
+            power_manager_lock_release(scan_pm_lock);
+        }
         
-        // 采样间隔
-        vTaskDelay(pdMS_TO_TICKS(TOUCH_CALIBRATION_DELAY));
+        // 超时和状态变化同时发生时以状态为准
+        if (__atomic_load_n(counter, __ATOMIC_ACQUIRE) != last) {
+            ret = ESP_OK;
+        }
+    }
+    vSemaphoreDelete(sem);
+    
+    if (ret == ESP_OK) {
+        touch_sensor_get_snapshot(snap);
+    }
+    return ret;
+}
+
+esp_err_t touch_sensor_wait_change(touch_sensor_snapshot_t *snap, TickType_t timeout)
+{
+    return touch_sensor_wait(snap, timeout, false);
+}
+
+esp_err_t touch_sensor_wait_scan(touch_sensor_snapshot_t *snap, TickType_t timeout)
+{
+    return touch_sensor_wait(snap, timeout, true);
+}
+
+esp_err_t touch_sensor_set_scan_hook(touch_scan_hook_t hook, void *arg)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    portENTER_CRITICAL(&wait_lock);
+    if (hook != NULL && scan_hook != NULL) {
+        portEXIT_CRITICAL(&wait_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (hook != NULL) {
+        scan_hook_arg = arg;
     }
+    bool had_hook = (scan_hook != NULL);
+    __atomic_store_n(&scan_hook, hook, __ATOMIC_RELEASE);
+    bool scan_needed = (hook != NULL || scan_waiter_count > 0);
+    portEXIT_CRITICAL(&wait_lock);
     
-    // 计算平均基准值
-    touch_baseline = sum / TOUCH_CALIBRATION_SAMPLES;
+    // 只有对比模式常开扫描完成中断; 钩子安装期间禁止自动轻度睡眠
+    if (hw_config.mode != TOUCH_DETECT_AB) {
+        if (hook != NULL && !had_hook) {
+            power_manager_lock_acquire(scan_pm_lock);
+        } else if (hook == NULL && had_hook) {
+            power_manager_lock_release(scan_pm_lock);
+        }
+        if (scan_needed) {
+            touch_pad_intr_enable(TOUCH_PAD_INTR_MASK_SCAN_DONE);
+        } else {
+            touch_pad_intr_disable(TOUCH_PAD_INTR_MASK_SCAN_DONE);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_recalibrate(void)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    __atomic_fetch_or(&reseed_mask, TOUCH_PAD_MASK, __ATOMIC_RELAXED);
+    
+    // 同时复位硬件基准值, 硬件阈值是相对基准值的增量, 不需要重新设置
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (touch_sensor_pad_enabled(pad)) {
+            touch_pad_reset_benchmark(pad);
+        }
+    }
+    
+    ESP_LOGI(TAG, "基准值将在下一次扫描或跟踪周期重新初始化");
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_suspend(void)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    touch_pad_intr_disable(TOUCH_INTR_MASK_SW | TOUCH_INTR_MASK_HW);
+    if (track_timer != NULL) {
+        esp_timer_stop(track_timer);
+    }
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_resume(bool reseed)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
-    // 计算动态阈值 (基准值 * 倍数)
-    touch_threshold = (uint32_t)(touch_baseline * TOUCH_BASELINE_MULTIPLIER);
+    if (reseed) {
+        touch_sensor_recalibrate();
+    }
+    
+    // 睡眠期间超时中断也被关闭, 无条件恢复一次扫描
+    touch_pad_timeout_resume();
     
-    is_calibrated = true;
+    if (track_timer != NULL) {
+        esp_timer_start_periodic(track_timer, (uint64_t)TOUCH_TRACK_INTERVAL_MS * 1000);
+    }
     
-    ESP_LOGI(TAG, "校准完成 - 基准值: %" PRIu32 ", 阈值: %" PRIu32, touch_baseline, touch_threshold);
+    uint32_t intr_mask = touch_sensor_intr_mask();
+    if (hw_config.mode != TOUCH_DETECT_AB &&
+        (__atomic_load_n(&scan_hook, __ATOMIC_RELAXED) != NULL || __atomic_load_n(&scan_waiter_count, __ATOMIC_RELAXED) > 0)) {
+        intr_mask |= TOUCH_PAD_INTR_MASK_SCAN_DONE;
+    }
+    touch_pad_intr_enable(intr_mask);
+    return ESP_OK;
+}
+
+esp_err_t touch_sensor_save_state(void)
+{
+    if (!is_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
     
+    // 基准值只在中断中按字更新, 暂停后或扫描间隙读取, 每个值都是完整的
+    for (int pad = TOUCH_PAD_NUM1; pad < TOUCH_PAD_MAX; pad++) {
+        if (!touch_sensor_pad_enabled(pad)) {
+            continue;
+        }
+        rtc_state.baseline[pad] = channels[pad].baseline;
+        rtc_state.noise[pad] = channels[pad].noise;
+        rtc_state.hw_thresh[pad] = channels[pad].hw_thresh;
+    }
+    rtc_state.pad_mask = TOUCH_PAD_MASK;
+    rtc_state.mode = hw_config.mode;
+    rtc_state.magic = TOUCH_RTC_MAGIC;
     return ESP_OK;
 }
 
-uint32_t touch_sensor_get_baseline(void)
+uint32_t touch_sensor_get_baseline(touch_pad_t pad)
+{
+    if (!touch_sensor_pad_enabled(pad)) {
+        return 0;
+    }
+    touch_pad_data_t data;
+    touch_sensor_read_pad(pad, &data);
+    return data.baseline;
+}
+
+uint32_t touch_sensor_get_threshold(touch_pad_t pad)
 {
-    return touch_baseline;
+    if (!touch_sensor_pad_enabled(pad)) {
+        return 0;
+    }
+    touch_pad_data_t data;
+    touch_sensor_read_pad(pad, &data);
+    return data.threshold;
+}
+
+uint32_t touch_sensor_get_release_threshold(touch_pad_t pad)
+{
+    if (!touch_sensor_pad_enabled(pad)) {
+        return 0;
+    }
+    touch_pad_data_t data;
+    touch_sensor_read_pad(pad, &data);
+    return data.release_threshold;
 }
 
-uint32_t touch_sensor_get_threshold(void)
+uint32_t touch_sensor_get_noise(touch_pad_t pad)
 {
-    return touch_threshold;
+    if (!touch_sensor_pad_enabled(pad)) {
+        return 0;
+    }
+    touch_pad_data_t data;
+    touch_sensor_read_pad(pad, &data);
+    return data.noise;
 }
 
 void touch_sensor_set_interrupt_callback(touch_interrupt_callback_t callback)
@@ -220,4 +1215,3 @@ esp_err_t touch_sensor_disable_interrupt(void)
     return ESP_OK;
 }
 
- 
\ No newline at end of file
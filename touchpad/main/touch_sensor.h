@@ -1,18 +1,39 @@
 #ifndef TOUCH_SENSOR_H
 #define TOUCH_SENSOR_H
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "driver/touch_pad.h"
 
-// 触摸传感器通道定义 (GPIO6 对应 T6)
-#define TOUCH_PAD_NUM TOUCH_PAD_NUM6
+// 触摸通道定义: 位n对应Tn (GPIOn), T1~T14可用, T0是内部降噪通道
+// 立创实战派ESP32-S3上GPIO1/2是I2C, GPIO3~9是摄像头, 与这些外设同时使用时不要启用对应通道
+#define TOUCH_PAD_MASK            (1UL << TOUCH_PAD_NUM6)
+#define TOUCH_SENSOR_MAX_CHANNELS 14    // 最多同时扫描的通道数
+#define TOUCH_PAD_VALID_MASK      (((1UL << (TOUCH_SENSOR_MAX_CHANNELS + 1)) - 1) & ~1UL)
 
-// 自适应阈值配置
-#define TOUCH_BASELINE_MULTIPLIER 1.3f  // 基准值倍数
-#define TOUCH_THRESHOLD_OFFSET    50    // 阈值偏移量
-#define TOUCH_CALIBRATION_SAMPLES 10    // 校准采样次数
-#define TOUCH_CALIBRATION_DELAY   100   // 校准延时(ms)
+// 测量配置
+#define TOUCH_MEAS_INTERVAL_CYCLES 2720 // 扫描间隔 (RTC慢速时钟周期, 136kHz时约20ms)
+
+// 自适应判定的低频跟踪 (定点IIR, 系数为 1/2^shift, 只在没有通道被触摸时更新)
+#define TOUCH_TRACK_INTERVAL_MS   500   // 跟踪周期, 唤醒CPU的次数是逐次扫描中断的1/25
+#define TOUCH_TRACK_BASELINE_SHIFT 3    // 基准值上升跟踪 (约8个周期)
+#define TOUCH_TRACK_BASELINE_FAST_SHIFT 1   // 平滑值低于基准值时快速下降
+#define TOUCH_TRACK_NOISE_SHIFT   2     // 噪声估计
+#define TOUCH_TRACK_RETUNE_SHIFT  4     // 阈值变化超过1/16才重写硬件阈值寄存器
+
+// 对比模式软件路径的基准值跟踪配置 (每次扫描, 只在未触摸时更新)
+#define TOUCH_FILTER_SHIFT        2     // 原始值平滑
+#define TOUCH_BASELINE_SHIFT      7     // 基准值上升跟踪 (约128次扫描)
+#define TOUCH_BASELINE_FAST_SHIFT 3     // 平滑值低于基准值时快速下降
+#define TOUCH_NOISE_SHIFT         5     // 噪声估计
+
+// 自适应阈值配置 (相对基准值的增量)
+#define TOUCH_PRESS_PERMILLE      300   // 按下阈值: 基准值的30%
+#define TOUCH_RELEASE_PERCENT     60    // 释放阈值: 按下阈值的60%
+#define TOUCH_NOISE_MARGIN        8     // 按下阈值至少为噪声估计的8倍
 
 // 任务优先级
 #define TOUCH_TASK_PRIORITY      5
@@ -20,55 +41,258 @@
 
 // 中断配置
 #define TOUCH_INTERRUPT_PRIORITY 5
+#define TOUCH_EVENT_QUEUE_LEN    8      // 中断事件队列长度
+#define TOUCH_MAX_WAITERS        4      // 同时调用touch_sensor_wait_change/wait_scan的任务数上限
 
+// 硬件判定配置
+#define TOUCH_HW_SETTLE_MS       100    // 硬件模式启动后等待硬件基准值稳定的时间
+#define TOUCH_SHIELD_PAD         TOUCH_PAD_NUM14    // 防水模式的屏蔽通道, 不能作为普通通道
+
+/**
+ * @brief 触摸判定方式
+ */
+typedef enum {
+    TOUCH_DETECT_ADAPTIVE,      // 自适应: 硬件判定, 只在状态变化时中断; 软件每TOUCH_TRACK_INTERVAL_MS跟踪基准值和噪声并重设硬件阈值
+    TOUCH_DETECT_HARDWARE,      // 硬件: 滤波、基准值和阈值判定都在外设中完成, 只在状态变化时中断, 阈值只在初始化时设置一次
+    TOUCH_DETECT_AB,            // 对比: 以硬件判定为准, 软件路径每次扫描在中断中同时运行, 统计两者的延迟差和误触发
+} touch_detect_mode_t;
+
+/**
+ * @brief 触摸外设硬件功能配置
+ */
+typedef struct {
+    touch_detect_mode_t mode;                   // 判定方式
+    touch_filter_mode_t filter_mode;            // 硬件基准值滤波 (IIR或抖动滤波)
+    touch_smooth_mode_t smooth_mode;            // 硬件平滑值滤波
+    uint8_t debounce_cnt;                       // 连续超过阈值多少次才判定为触摸
+    uint8_t noise_thr;                          // 噪声阈值系数 (0~3, 越小越能抵抗噪声)
+    uint8_t jitter_step;                        // 抖动滤波步长
+    bool denoise;                               // 使用T0内部降噪通道抵消电源和温度噪声
+    touch_pad_denoise_grade_t denoise_grade;    // 降噪位数
+    touch_pad_denoise_cap_t denoise_cap;        // 降噪通道内部电容
+    bool waterproof;                            // 防水: T14作为屏蔽通道跟随被测通道驱动
+    touch_pad_t guard_pad;                      // 保护环通道 (须在TOUCH_PAD_MASK中), TOUCH_PAD_MAX表示不使用
+    touch_pad_shield_driver_t shield_driver;    // 屏蔽通道驱动能力, 与屏蔽电极面积匹配
+} touch_sensor_hw_config_t;
 
+/**
+ * @brief 默认配置: 自适应判定, 硬件滤波参数与ESP-IDF示例一致, 不使用降噪和防水
+ */
+#define TOUCH_SENSOR_HW_DEFAULT_CONFIG() {              \
+    .mode = TOUCH_DETECT_ADAPTIVE,                      \
+    .filter_mode = TOUCH_PAD_FILTER_IIR_16,             \
+    .smooth_mode = TOUCH_PAD_SMOOTH_IIR_2,              \
+    .debounce_cnt = 1,                                  \
+    .noise_thr = 0,                                     \
+    .jitter_step = 4,                                   \
+    .denoise = false,                                   \
+    .denoise_grade = TOUCH_PAD_DENOISE_BIT4,            \
+    .denoise_cap = TOUCH_PAD_DENOISE_CAP_L4,            \
+    .waterproof = false,                                \
+    .guard_pad = TOUCH_PAD_MAX,                         \
+    .shield_driver = TOUCH_PAD_SHIELD_DRV_L2,           \
+}
+
+/**
+ * @brief 硬件/软件判定对比统计
+ * @note 按下次数和延迟差只在TOUCH_DETECT_AB模式下统计; 中断次数和开销在所有模式下统计,
+ *       用于比较各模式每个样本的CPU开销
+ */
+typedef struct {
+    uint32_t sw_presses;        // 软件路径检测到的按下次数
+    uint32_t hw_presses;        // 硬件路径检测到的按下次数
+    uint32_t matched;           // 两条路径都检测到的按下
+    uint32_t sw_only;           // 只有软件检测到的按下 (硬件漏检或软件误触发)
+    uint32_t hw_only;           // 只有硬件检测到的按下 (软件漏检或硬件误触发)
+    int32_t latency_avg_us;     // 平均检测时间差: 硬件 - 软件, 负数表示硬件更快
+    int32_t latency_min_us;     // 最小检测时间差
+    int32_t latency_max_us;     // 最大检测时间差
+    uint32_t isr_count;         // 触摸中断次数
+    uint32_t isr_avg_cycles;    // 每次中断的平均CPU周期
+} touch_sensor_ab_stats_t;
+
+/**
+ * @brief 单个通道的数据
+ */
+typedef struct {
+    uint32_t raw;               // 原始值
+    uint32_t filtered;          // 平滑值
+    uint32_t baseline;          // 基准值
+    uint32_t threshold;         // 按下阈值 (绝对值)
+    uint32_t release_threshold; // 释放阈值 (绝对值)
+    uint32_t noise;             // 噪声估计
+} touch_pad_data_t;
 
 /**
- * @brief 初始化触摸传感器
+ * @brief 触摸状态快照, 所有字段来自同一次扫描
+ * @note 自适应和硬件模式下filtered/baseline是硬件平滑值和硬件基准值, raw等于平滑值, 释放阈值等于按下阈值
+ *       (迟滞由硬件防抖完成), noise是软件噪声估计 (硬件模式为0); 快照在状态变化、有逐次扫描等待者时更新,
+ *       自适应模式下每个跟踪周期也更新一次
+ */
+typedef struct {
+    uint32_t seq;               // 扫描序号, 每次扫描加1
+    int64_t timestamp_us;       // 扫描完成时间 (esp_timer_get_time)
+    uint32_t touched_mask;      // 触摸状态位图, 位n对应Tn
+    uint32_t change_count;      // 触摸状态变化次数
+    touch_pad_data_t pads[TOUCH_PAD_MAX];   // 按通道号索引, 未启用的通道为0
+} touch_sensor_snapshot_t;
+
+
+
+/**
+ * @brief 设置触摸外设硬件功能 (判定方式、硬件滤波、降噪、防水)
+ * @note 需要在touch_sensor_init之前调用, 不调用时使用TOUCH_SENSOR_HW_DEFAULT_CONFIG
+ * @param config 配置
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 配置无效, ESP_ERR_INVALID_STATE 已经初始化
+ */
+esp_err_t touch_sensor_set_hw_config(const touch_sensor_hw_config_t *config);
+
+/**
+ * @brief 获取硬件/软件判定对比统计
+ * @param stats 返回的统计数据
+ * @param reset 读取后清零
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t touch_sensor_get_ab_stats(touch_sensor_ab_stats_t *stats, bool reset);
+
+/**
+ * @brief 初始化触摸传感器, 注册触摸中断并开始跟踪基准值
+ * @note 自适应和硬件判定等待TOUCH_HW_SETTLE_MS后按硬件基准值设置阈值 (从深度睡眠恢复时不等待);
+ *       对比模式的软件路径用第一次扫描的结果初始化基准值
  * @return ESP_OK 成功, ESP_FAIL 失败
  */
 esp_err_t touch_sensor_init(void);
 
 /**
  * @brief 启动触摸检测任务
- * @return ESP_OK 成功, ESP_FAIL 失败
+ * @note 任务只在触摸状态变化时被唤醒, 回调在任务上下文中执行
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化, ESP_FAIL 失败
  */
 esp_err_t touch_sensor_start_task(void);
 
 /**
- * @brief 获取当前触摸值
- * @return 当前触摸值
+ * @brief 获取通道最近一次扫描的触摸值
+ * @param pad 通道
+ * @return 原始触摸值, 通道未启用时为0
  */
-uint32_t touch_sensor_get_value(void);
+uint32_t touch_sensor_get_value(touch_pad_t pad);
 
 /**
- * @brief 获取当前触摸状态
+ * @brief 获取通道当前触摸状态
+ * @param pad 通道
  * @return true 已触摸, false 未触摸
  */
-bool touch_sensor_is_touched(void);
+bool touch_sensor_is_touched(touch_pad_t pad);
 
 /**
- * @brief 重新校准触摸传感器基准值
- * @return ESP_OK 成功, ESP_FAIL 失败
+ * @brief 获取所有通道的触摸状态
+ * @return 位n为1表示Tn已触摸
+ */
+uint32_t touch_sensor_get_touched_mask(void);
+
+/**
+ * @brief 获取所有启用通道最近一次扫描的原始值
+ * @param raw 按通道号索引的原始值, 未启用的通道填0
+ * @param touched_mask 返回触摸状态位图, 可以为NULL
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效, 其他值表示读取失败
+ */
+esp_err_t touch_sensor_read_all(uint32_t raw[TOUCH_PAD_MAX], uint32_t *touched_mask);
+
+/**
+ * @brief 获取触摸状态快照
+ * @note 无锁 (顺序锁), 可以在任意核心的任务中调用, 不会读到不同扫描拼在一起的数据
+ * @param snap 返回的快照
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t touch_sensor_get_snapshot(touch_sensor_snapshot_t *snap);
+
+/**
+ * @brief 阻塞等待触摸状态变化
+ * @note 等到change_count与snap中的不同为止 (调用前已经发生的变化会立即返回), 然后把新快照写入snap;
+ *       只能在任务中调用
+ * @param snap 上一次得到的快照, 返回新快照
+ * @param timeout 超时时间
+ * @return ESP_OK 状态已变化, ESP_ERR_TIMEOUT 超时, ESP_ERR_NO_MEM 等待的任务过多,
+ *         ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t touch_sensor_wait_change(touch_sensor_snapshot_t *snap, TickType_t timeout);
+
+/**
+ * @brief 阻塞等待下一次扫描完成
+ * @note 等到扫描序号与snap中的不同为止, 然后把新快照写入snap; 用于需要逐次扫描处理的
+ *       上层组件 (滑条、滚轮), 等待期间打开扫描完成中断, 每次扫描都会唤醒本任务; 只能在任务中调用
+ * @param snap 上一次得到的快照, 返回新快照
+ * @param timeout 超时时间
+ * @return ESP_OK 有新的扫描, ESP_ERR_TIMEOUT 超时, ESP_ERR_NO_MEM 等待的任务过多,
+ *         ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t touch_sensor_wait_scan(touch_sensor_snapshot_t *snap, TickType_t timeout);
+
+/**
+ * @brief 让所有通道在下一次扫描时用当前值重新初始化基准值
+ * @note 基准值一直在跟踪漂移, 一般不需要调用; 不阻塞
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化
  */
 esp_err_t touch_sensor_recalibrate(void);
 
 /**
- * @brief 获取当前基准值
+ * @brief 睡眠前暂停触摸中断处理和基准值跟踪
+ * @note FSM继续扫描 (触摸唤醒需要), 只是不再进入中断; 基准值和触摸状态保持睡眠前的值
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t touch_sensor_suspend(void);
+
+/**
+ * @brief 唤醒后恢复触摸中断处理和基准值跟踪
+ * @param reseed 是否用下一次扫描重新初始化基准值; 长时间睡眠后环境可能变化, 但由触摸唤醒时
+ *               手指还在通道上, 不能重新初始化
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t touch_sensor_resume(bool reseed);
+
+/**
+ * @brief 深度睡眠前把基准值、噪声估计和硬件阈值保存到RTC内存
+ * @note 唤醒复位后touch_sensor_init直接恢复, 不用重新建立基准值, 硬件判定也不用等待
+ *       TOUCH_HW_SETTLE_MS; 通道或判定方式变化后不使用. 最好在touch_sensor_suspend之后调用
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t touch_sensor_save_state(void);
+
+/**
+ * @brief 获取通道当前基准值
+ * @param pad 通道
  * @return 当前基准值
  */
-uint32_t touch_sensor_get_baseline(void);
+uint32_t touch_sensor_get_baseline(touch_pad_t pad);
+
+/**
+ * @brief 获取通道当前按下阈值
+ * @param pad 通道
+ * @return 当前按下阈值 (绝对值, 平滑值超过它判定为触摸)
+ */
+uint32_t touch_sensor_get_threshold(touch_pad_t pad);
+
+/**
+ * @brief 获取通道当前释放阈值
+ * @param pad 通道
+ * @return 当前释放阈值 (绝对值, 已触摸时平滑值低于它判定为释放)
+ */
+uint32_t touch_sensor_get_release_threshold(touch_pad_t pad);
 
 /**
- * @brief 获取当前阈值
- * @return 当前阈值
+ * @brief 获取通道噪声估计
+ * @param pad 通道
+ * @return 未触摸时原始值相对平滑值的平均偏差
  */
-uint32_t touch_sensor_get_threshold(void);
+uint32_t touch_sensor_get_noise(touch_pad_t pad);
 
 /**
  * @brief 触摸中断回调函数类型
+ * @note 由检测任务在收到硬件中断后调用, 可以使用阻塞API
+ * @param touched_mask 所有通道的触摸状态, 位n对应Tn
+ * @param changed_mask 本次状态发生变化的通道
  */
-typedef void (*touch_interrupt_callback_t)(bool is_touched);
+typedef void (*touch_interrupt_callback_t)(uint32_t touched_mask, uint32_t changed_mask);
 
 /**
  * @brief 设置触摸中断回调函数
@@ -88,6 +312,24 @@ esp_err_t touch_sensor_enable_interrupt(void);
  */
 esp_err_t touch_sensor_disable_interrupt(void);
 
+/**
+ * @brief 扫描钩子, 每次扫描完成发布快照并唤醒等待的任务之后在触摸中断中调用
+ * @param snap 本次扫描的快照, 只在调用期间有效
+ * @param arg 注册时的参数
+ * @note 运行在中断中, 只能做很少的工作 (如复制到环形缓冲区), 不能调用阻塞API
+ */
+typedef void (*touch_scan_hook_t)(const touch_sensor_snapshot_t *snap, void *arg);
+
+/**
+ * @brief 设置扫描钩子, 用于高速采集等需要每次扫描数据的功能
+ * @note 同时只能有一个钩子; 自适应和硬件判定平时不处理扫描完成中断, 设置钩子期间才打开,
+ *       并持有ESP_PM_NO_LIGHT_SLEEP锁 (扫描完成中断不能唤醒自动轻度睡眠)
+ * @param hook 钩子函数, NULL表示取消
+ * @param arg 钩子参数
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 未初始化或已有其他钩子
+ */
+esp_err_t touch_sensor_set_scan_hook(touch_scan_hook_t hook, void *arg);
+
 
 
 #endif // TOUCH_SENSOR_H 
\ No newline at end of file
@@ -0,0 +1,286 @@
+/*
+ * 触摸滑条/滚轮实现
+ * 每次扫描取各通道 (平滑值 - 基准值) / 基准值 作为信号, 以信号最大的通道和它的两个相邻通道做
+ * 质心插值, 全部使用整数运算; 位置经IIR平滑后换算到输出范围, 速度由相邻两次扫描的时间差计算
+ */
+
+#include "touch_slider.h"
+#include "touch_sensor.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <inttypes.h>
+
+static const char *TAG = "TOUCH_SLIDER";
+
+#define TOUCH_SLIDER_SIGNAL_SHIFT   12      // 信号归一化: 增量 * 4096 / 基准值
+#define TOUCH_SLIDER_SCAN_TIMEOUT   100     // 逐次扫描时的等待超时 (ms), 扫描停止时仍能退出跟踪
+
+// 单个滑条的状态
+typedef struct {
+    touch_slider_type_t type;
+    touch_pad_t pads[TOUCH_SLIDER_MAX_PADS];
+    uint8_t pad_num;
+    uint16_t range;
+    int32_t span;                       // 内部位置范围
+    uint32_t mask;                      // 通道位图
+    touch_slider_callback_t callback;
+    void *arg;
+    volatile bool active;               // 是否正在触摸
+    int32_t pos;                        // 平滑后的内部位置
+    volatile uint16_t out;              // 上一次输出的位置
+    int64_t last_us;                    // 上一次处理的扫描时间
+} touch_slider_t;
+
+static touch_slider_t sliders[TOUCH_SLIDER_MAX_GROUPS];
+static int slider_count = 0;
+static uint32_t slider_mask = 0;        // 所有滑条的通道
+static TaskHandle_t slider_task_handle = NULL;
+
+/**
+ * @brief 通道信号: 相对基准值的增量, 按基准值归一化, 消除各通道灵敏度差异
+ */
+static int32_t touch_slider_signal(const touch_pad_data_t *data)
+{
+    if (data->baseline == 0 || data->filtered <= data->baseline) {
+        return 0;
+    }
+    return (int32_t)(((uint64_t)(data->filtered - data->baseline) << TOUCH_SLIDER_SIGNAL_SHIFT) / data->baseline);
+}
+
+/**
+ * @brief 由一次扫描插值出内部位置
+ * @return 内部位置 0 ~ span (滚轮不含span), 没有信号时返回-1
+ */
+static int32_t touch_slider_interpolate(const touch_slider_t *s, const touch_sensor_snapshot_t *snap)
+{
+    int32_t sig[TOUCH_SLIDER_MAX_PADS];
+    int n = s->pad_num;
+    int k = 0;
+
+    for (int i = 0; i < n; i++) {
+        sig[i] = touch_slider_signal(&snap->pads[s->pads[i]]);
+        if (sig[i] > sig[k]) {
+            k = i;
+        }
+    }
+
+    // 最大通道和相邻通道做质心插值, 滚轮首尾相邻
+    int32_t prev, next;
+    if (s->type == TOUCH_SLIDER_WHEEL) {
+        prev = sig[(k + n - 1) % n];
+        next = sig[(k + 1) % n];
+    } else {
+        prev = (k > 0) ? sig[k - 1] : 0;
+        next = (k < n - 1) ? sig[k + 1] : 0;
+    }
+    int32_t sum = prev + sig[k] + next;
+    if (sum <= 0) {
+        return -1;
+    }
+
+    int32_t pos = k * TOUCH_SLIDER_SEGMENT + (next - prev) * TOUCH_SLIDER_SEGMENT / sum;
+    if (s->type == TOUCH_SLIDER_WHEEL) {
+        pos = (pos + s->span) % s->span;
+    } else if (pos < 0) {
+        pos = 0;
+    } else if (pos > s->span) {
+        pos = s->span;
+    }
+    return pos;
+}
+
+/**
+ * @brief 内部位置换算到输出范围
+ */
+static uint16_t touch_slider_output(const touch_slider_t *s, int32_t pos)
+{
+    uint32_t out = (uint32_t)pos * s->range / (uint32_t)s->span;
+    return (out >= s->range) ? s->range - 1 : (uint16_t)out;
+}
+
+/**
+ * @brief 调用回调
+ */
+static void touch_slider_emit(touch_slider_t *s, int id, touch_slider_event_type_t type,
+                              int32_t velocity, int64_t time_us)
+{
+    touch_slider_event_t evt = {
+        .type = type,
+        .id = id,
+        .position = s->out,
+        .velocity = velocity,
+        .timestamp_us = time_us,
+    };
+    s->callback(&evt, s->arg);
+}
+
+/**
+ * @brief 用一次扫描更新滑条状态并产生事件
+ */
+static void touch_slider_process(touch_slider_t *s, int id, const touch_sensor_snapshot_t *snap)
+{
+    bool touched = (snap->touched_mask & s->mask) != 0;
+    int32_t pos = touched ? touch_slider_interpolate(s, snap) : -1;
+
+    if (pos < 0) {
+        if (s->active) {
+            s->active = false;
+            touch_slider_emit(s, id, TOUCH_SLIDER_EVT_RELEASE, 0, snap->timestamp_us);
+        }
+        return;
+    }
+
+    if (!s->active) {
+        s->pos = pos;
+        s->out = touch_slider_output(s, pos);
+        s->last_us = snap->timestamp_us;
+        s->active = true;
+        touch_slider_emit(s, id, TOUCH_SLIDER_EVT_PRESS, 0, snap->timestamp_us);
+        return;
+    }
+
+    // 滚轮走最短方向
+    int32_t diff = pos - s->pos;
+    if (s->type == TOUCH_SLIDER_WHEEL) {
+        if (diff > s->span / 2) {
+            diff -= s->span;
+        } else if (diff < -s->span / 2) {
+            diff += s->span;
+        }
+    }
+    int32_t step = diff / (1 << TOUCH_SLIDER_SMOOTH_SHIFT);
+    s->pos += step;
+    if (s->type == TOUCH_SLIDER_WHEEL) {
+        s->pos = (s->pos + s->span) % s->span;
+    }
+
+    int64_t dt = snap->timestamp_us - s->last_us;
+    s->last_us = snap->timestamp_us;
+    uint16_t out = touch_slider_output(s, s->pos);
+    if (out == s->out) {
+        return;
+    }
+    s->out = out;
+
+    int32_t velocity = 0;
+    if (dt > 0) {
+        velocity = (int32_t)((int64_t)step * s->range * 1000000 / ((int64_t)s->span * dt));
+    }
+    touch_slider_emit(s, id, TOUCH_SLIDER_EVT_MOVE, velocity, snap->timestamp_us);
+}
+
+/**
+ * @brief 滑条任务: 没有触摸时等待状态变化, 触摸期间逐次扫描处理
+ */
+static void touch_slider_task(void *pvParameters)
+{
+    touch_sensor_snapshot_t snap;
+
+    touch_sensor_get_snapshot(&snap);
+    ESP_LOGI(TAG, "滑条任务启动, %d个滑条", slider_count);
+
+    while (1) {
+        bool tracking = (snap.touched_mask & slider_mask) != 0;
+        for (int i = 0; i < slider_count && !tracking; i++) {
+            tracking = sliders[i].active;
+        }
+
+        esp_err_t ret = tracking ? touch_sensor_wait_scan(&snap, pdMS_TO_TICKS(TOUCH_SLIDER_SCAN_TIMEOUT))
+                                 : touch_sensor_wait_change(&snap, portMAX_DELAY);
+        if (ret == ESP_ERR_TIMEOUT) {
+            continue;
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "等待触摸扫描失败: %s", esp_err_to_name(ret));
+            vTaskDelay(pdMS_TO_TICKS(TOUCH_SLIDER_SCAN_TIMEOUT));
+            continue;
+        }
+
+        for (int i = 0; i < slider_count; i++) {
+            touch_slider_process(&sliders[i], i, &snap);
+        }
+    }
+}
+
+/**
+ * @brief 创建滑条/滚轮
+ */
+esp_err_t touch_slider_create(const touch_slider_config_t *config, touch_slider_callback_t callback,
+                              void *arg, int *id)
+{
+    if (config == NULL || config->pads == NULL || callback == NULL || id == NULL || config->range == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int min_pads = (config->type == TOUCH_SLIDER_WHEEL) ? 3 : 2;
+    if (config->pad_num < min_pads || config->pad_num > TOUCH_SLIDER_MAX_PADS) {
+        ESP_LOGE(TAG, "通道数无效: %d", config->pad_num);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (slider_task_handle != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (slider_count >= TOUCH_SLIDER_MAX_GROUPS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    touch_slider_t *s = &sliders[slider_count];
+    *s = (touch_slider_t){
+        .type = config->type,
+        .pad_num = config->pad_num,
+        .range = config->range,
+        .callback = callback,
+        .arg = arg,
+    };
+    for (int i = 0; i < config->pad_num; i++) {
+        touch_pad_t pad = config->pads[i];
+        if (pad >= TOUCH_PAD_MAX || !(TOUCH_PAD_MASK & (1UL << pad)) || (s->mask & (1UL << pad))) {
+            ESP_LOGE(TAG, "通道T%d未启用或重复", pad);
+            return ESP_ERR_INVALID_ARG;
+        }
+        s->pads[i] = pad;
+        s->mask |= (1UL << pad);
+    }
+    s->span = (config->type == TOUCH_SLIDER_WHEEL ? config->pad_num : config->pad_num - 1) * TOUCH_SLIDER_SEGMENT;
+
+    slider_mask |= s->mask;
+    *id = slider_count++;
+    ESP_LOGI(TAG, "%s %d: 通道0x%04" PRIx32 ", 范围0~%d", (config->type == TOUCH_SLIDER_WHEEL) ? "滚轮" : "滑条",
+             *id, s->mask, config->range - 1);
+    return ESP_OK;
+}
+
+/**
+ * @brief 启动滑条任务
+ */
+esp_err_t touch_slider_start(void)
+{
+    if (slider_count == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (slider_task_handle != NULL) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreate(touch_slider_task, "touch_slider", TOUCH_SLIDER_TASK_STACK, NULL,
+                    TOUCH_SLIDER_TASK_PRIO, &slider_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "创建滑条任务失败");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取滑条当前位置
+ */
+esp_err_t touch_slider_get_position(int id, uint16_t *position)
+{
+    if (id < 0 || id >= slider_count || position == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sliders[id].active) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *position = sliders[id].out;
+    return ESP_OK;
+}
@@ -0,0 +1,102 @@
+/*
+ * 触摸滑条/滚轮头文件
+ * 在触摸驱动之上把一组按物理顺序排列的触摸通道当作滑条或滚轮, 用各通道相对基准值的增量
+ * 整数插值出连续位置, 平滑后按扫描频率输出按下/移动/释放事件 (带速度)
+ */
+
+#ifndef TOUCH_SLIDER_H
+#define TOUCH_SLIDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/touch_pad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 滑条配置
+#define TOUCH_SLIDER_MAX_GROUPS     4       // 最多滑条/滚轮数
+#define TOUCH_SLIDER_MAX_PADS       8       // 每组最多通道数
+#define TOUCH_SLIDER_SEGMENT        256     // 相邻两个通道之间的内部插值精度
+#define TOUCH_SLIDER_SMOOTH_SHIFT   2       // 位置平滑系数 (1/4)
+#define TOUCH_SLIDER_TASK_STACK     3072    // 滑条任务栈大小
+#define TOUCH_SLIDER_TASK_PRIO      5       // 滑条任务优先级
+
+/**
+ * @brief 滑条类型
+ */
+typedef enum {
+    TOUCH_SLIDER_LINEAR,                // 线性滑条: 第一个通道为0, 最后一个通道为range-1
+    TOUCH_SLIDER_WHEEL,                 // 滚轮: 首尾相接, range为一圈
+} touch_slider_type_t;
+
+/**
+ * @brief 滑条配置
+ */
+typedef struct {
+    touch_slider_type_t type;           // 类型
+    const touch_pad_t *pads;            // 按物理顺序排列的通道, 必须都在TOUCH_PAD_MASK中
+    uint8_t pad_num;                    // 通道数 (线性滑条至少2个, 滚轮至少3个)
+    uint16_t range;                     // 输出位置范围 0 ~ range-1
+} touch_slider_config_t;
+
+/**
+ * @brief 滑条事件类型
+ */
+typedef enum {
+    TOUCH_SLIDER_EVT_PRESS,             // 开始触摸, 给出初始位置
+    TOUCH_SLIDER_EVT_MOVE,              // 位置变化
+    TOUCH_SLIDER_EVT_RELEASE,           // 松开, 给出最后位置
+} touch_slider_event_type_t;
+
+/**
+ * @brief 滑条事件
+ */
+typedef struct {
+    touch_slider_event_type_t type;     // 事件类型
+    int id;                             // touch_slider_create返回的编号
+    uint16_t position;                  // 平滑后的位置
+    int32_t velocity;                   // 速度 (位置单位/秒, 滚轮取最短方向)
+    int64_t timestamp_us;               // 对应扫描的完成时间
+} touch_slider_event_t;
+
+/**
+ * @brief 滑条事件回调, 在滑条任务中调用
+ */
+typedef void (*touch_slider_callback_t)(const touch_slider_event_t *event, void *arg);
+
+/**
+ * @brief 创建滑条/滚轮
+ * @note 需要在touch_slider_start之前调用
+ * @param config 配置
+ * @param callback 事件回调
+ * @param arg 回调参数
+ * @param id 返回编号
+ * @return ESP_OK 成功, ESP_ERR_INVALID_ARG 配置无效, ESP_ERR_NO_MEM 滑条数量已满,
+ *         ESP_ERR_INVALID_STATE 滑条任务已启动
+ */
+esp_err_t touch_slider_create(const touch_slider_config_t *config, touch_slider_callback_t callback,
+                              void *arg, int *id);
+
+/**
+ * @brief 启动滑条任务
+ * @note 需要先初始化触摸驱动; 没有触摸时任务只等待状态变化, 触摸期间逐次扫描处理
+ * @return ESP_OK 成功, ESP_ERR_INVALID_STATE 没有创建滑条, ESP_FAIL 创建任务失败
+ */
+esp_err_t touch_slider_start(void);
+
+/**
+ * @brief 获取滑条当前位置
+ * @param id 编号
+ * @param position 返回平滑后的位置
+ * @return ESP_OK 正在触摸, ESP_ERR_NOT_FOUND 未触摸, ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t touch_slider_get_position(int id, uint16_t *position);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOUCH_SLIDER_H
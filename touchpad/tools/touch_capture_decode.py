@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# 触摸采集流解码工具
+#
+# 解码 touch_capture.c 输出的二进制流 (串口抓取的文件或SD卡上的文件), 输出CSV:
+#   seq,time_us,touched,T6_raw,T6_filtered,...
+# 按同步字节和校验重新同步, 串口流中夹杂日志文本或从中间开始抓取也能解码;
+# 流头之前的样本因为不知道通道号会被跳过。结束时在stderr打印样本数、丢失的扫描和实际采样率。
+#
+# 用法:
+#   python touch_capture_decode.py capture.bin > capture.csv
+#   python touch_capture_decode.py --port /dev/ttyUSB0 --baud 921600 --out capture.csv   # 需要pyserial
+#
+# 依赖: 无 (直接读串口时需要 pyserial)
+
+import argparse
+import struct
+import sys
+
+# 与 touch_capture.h 保持一致
+SYNC = 0xA5
+VERSION = 1
+FRAME_HEADER = 0x01
+FRAME_SAMPLE = 0x02
+FRAME_DROP = 0x03
+
+
+def u24(data, offset):
+    return data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16)
+
+
+class Decoder:
+    """逐字节喂入数据, 解出完整的帧"""
+
+    def __init__(self, out):
+        self.out = out
+        self.buf = bytearray()
+        self.pads = None
+        self.samples = 0
+        self.lost = 0
+        self.dropped = 0
+        self.bad_frames = 0
+        self.last_seq = None
+        self.first_time = None
+        self.last_time = None
+        self.time_high = 0          # 32位时间回绕的高位
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                self.buf.clear()
+                return
+            del self.buf[:start]
+            if len(self.buf) < 3:
+                return
+            length = self.buf[2]
+            if len(self.buf) < 4 + length:
+                return
+            frame = self.buf[:4 + length]
+            if sum(frame[1:3 + length]) & 0xFF != frame[3 + length]:
+                # 不是帧头, 跳过这个同步字节继续找
+                self.bad_frames += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:4 + length]
+            self.handle(frame[1], bytes(frame[3:3 + length]))
+
+    def handle(self, ftype, payload):
+        if ftype == FRAME_HEADER:
+            version, interval, count = struct.unpack_from('<BHB', payload)
+            if version != VERSION:
+                sys.exit('不支持的版本: %d' % version)
+            pads = list(payload[4:4 + count])
+            if pads != self.pads:
+                if self.pads is not None:
+                    print('警告: 通道变化 %s -> %s' % (self.pads, pads), file=sys.stderr)
+                self.pads = pads
+                cols = ['seq', 'time_us', 'touched']
+                for pad in pads:
+                    cols += ['T%d_raw' % pad, 'T%d_filtered' % pad]
+                self.out.write(','.join(cols) + '\n')
+                print('流头: 扫描间隔%d个RTC慢速时钟周期, 通道%s' % (interval, pads), file=sys.stderr)
+        elif ftype == FRAME_SAMPLE:
+            if self.pads is None:
+                return
+            seq, time_us, touched = struct.unpack_from('<HIH', payload)
+            if self.last_seq is not None:
+                self.lost += (seq - self.last_seq - 1) & 0xFFFF
+            self.last_seq = seq
+            if self.last_time is not None and time_us < (self.last_time & 0xFFFFFFFF):
+                self.time_high += 1 << 32
+            time_us += self.time_high
+            if self.first_time is None:
+                self.first_time = time_us
+            self.last_time = time_us
+            row = [seq, time_us, '0x%04x' % touched]
+            for i in range(len(self.pads)):
+                row += [u24(payload, 8 + 6 * i), u24(payload, 11 + 6 * i)]
+            self.out.write(','.join(str(v) for v in row) + '\n')
+            self.samples += 1
+        elif ftype == FRAME_DROP:
+            self.dropped = struct.unpack_from('<I', payload)[0]
+
+    def summary(self):
+        print('样本: %d, 丢失的扫描: %d (设备端缓冲区满丢弃 %d), 校验错误: %d'
+              % (self.samples, self.lost, self.dropped, self.bad_frames), file=sys.stderr)
+        if self.samples > 1 and self.last_time > self.first_time:
+            rate = (self.samples + self.lost - 1) * 1e6 / (self.last_time - self.first_time)
+            print('扫描频率: %.1f Hz' % rate, file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='解码触摸采集流')
+    parser.add_argument('input', nargs='?', help='采集文件')
+    parser.add_argument('--port', help='直接从串口读取, 按Ctrl+C结束')
+    parser.add_argument('--baud', type=int, default=921600, help='串口波特率')
+    parser.add_argument('--out', help='CSV输出文件, 默认stdout')
+    args = parser.parse_args()
+    if (args.input is None) == (args.port is None):
+        parser.error('需要指定采集文件或 --port')
+
+    out = open(args.out, 'w', newline='') if args.out else sys.stdout
+    decoder = Decoder(out)
+    try:
+        if args.port:
+            import serial
+            with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+                while True:
+                    decoder.feed(port.read(4096))
+        else:
+            with open(args.input, 'rb') as f:
+                while True:
+                    data = f.read(65536)
+                    if not data:
+                        break
+                    decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        decoder.summary()
+        if out is not sys.stdout:
+            out.close()
+
+
+if __name__ == '__main__':
+    main()